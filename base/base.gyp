@@ -161,6 +161,7 @@
         'mac/mac_util_unittest.mm',
         'mac/objc_property_releaser_unittest.mm',
         'md5_unittest.cc',
+        'memory/arena_unittest.cc',
         'memory/linked_ptr_unittest.cc',
         'memory/mru_cache_unittest.cc',
         'memory/ref_counted_memory_unittest.cc',
@@ -168,6 +169,7 @@
         'memory/scoped_ptr_unittest.cc',
         'memory/scoped_vector_unittest.cc',
         'memory/singleton_unittest.cc',
+        'memory/slab_allocator_unittest.cc',
         'memory/weak_ptr_unittest.cc',
         'message_loop_proxy_impl_unittest.cc',
         'message_loop_proxy_unittest.cc',
@@ -405,6 +407,21 @@
         'test/trace_event_analyzer.h',
       ],
     },
+    {
+      'target_name': 'base_perftests',
+      'type': 'executable',
+      'dependencies': [
+        'base',
+        'test_support_perf',
+        '../testing/gtest.gyp:gtest',
+      ],
+      'sources': [
+        'logging_perftest.cc',
+        'memory/slab_allocator_perftest.cc',
+        'message_loop_perftest.cc',
+        'time_perftest.cc',
+      ],
+    },
     {
       'target_name': 'test_support_perf',
       'type': 'static_library',
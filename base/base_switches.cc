@@ -6,6 +6,10 @@
 
 namespace switches {
 
+// Makes log statements return without waiting for their message to be
+// written; see logging::SetAsyncLogging().
+const char kAsyncLogging[]                  = "async-logging";
+
 // If the program includes base/debug/debug_on_start_win.h, the process will
 // (on Windows only) start the JIT system-registered debugger on itself and
 // will wait for 60 seconds for the debugger to attach to itself. Then a break
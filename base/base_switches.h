@@ -10,6 +10,7 @@
 
 namespace switches {
 
+extern const char kAsyncLogging[];
 extern const char kDebugOnStart[];
 extern const char kDisableBreakpad[];
 extern const char kEnableDCHECK[];
@@ -261,6 +261,10 @@ class Callback<R(void)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run() const {
     PolymorphicInvoke f =
         reinterpret_cast<PolymorphicInvoke>(polymorphic_invoke_);
@@ -302,6 +306,10 @@ class Callback<R(A1)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1) const {
     PolymorphicInvoke f =
         reinterpret_cast<PolymorphicInvoke>(polymorphic_invoke_);
@@ -344,6 +352,10 @@ class Callback<R(A1, A2)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2) const {
     PolymorphicInvoke f =
@@ -389,6 +401,10 @@ class Callback<R(A1, A2, A3)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3) const {
@@ -437,6 +453,10 @@ class Callback<R(A1, A2, A3, A4)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3,
@@ -489,6 +509,10 @@ class Callback<R(A1, A2, A3, A4, A5)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3,
@@ -544,6 +568,10 @@ class Callback<R(A1, A2, A3, A4, A5, A6)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3,
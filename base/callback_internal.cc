@@ -4,9 +4,37 @@
 
 #include "base/callback_internal.h"
 
+#include <algorithm>
+
+#include "base/lazy_instance.h"
+#include "base/memory/slab_allocator.h"
+
 namespace base {
 namespace internal {
 
+namespace {
+
+// Leaky so that tasks destroyed during shutdown can still free their
+// BindStates.
+LazyInstance<SlabAllocator, LeakyLazyInstanceTraits<SlabAllocator> >
+    g_bind_state_allocator = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+int GetBindStateHeapAllocationCount() {
+  return g_bind_state_allocator.Get().new_block_count();
+}
+
+// static
+void* BindStateBase::operator new(size_t size) {
+  return g_bind_state_allocator.Pointer()->Allocate(size);
+}
+
+// static
+void BindStateBase::operator delete(void* block, size_t size) {
+  g_bind_state_allocator.Pointer()->Free(block, size);
+}
+
 bool CallbackBase::is_null() const {
   return bind_state_.get() == NULL;
 }
@@ -21,6 +49,11 @@ bool CallbackBase::Equals(const CallbackBase& other) const {
          polymorphic_invoke_ == other.polymorphic_invoke_;
 }
 
+void CallbackBase::Swap(CallbackBase* other) {
+  bind_state_.swap(other->bind_state_);
+  std::swap(polymorphic_invoke_, other->polymorphic_invoke_);
+}
+
 CallbackBase::CallbackBase(InvokeFuncStorage polymorphic_invoke,
                            scoped_refptr<BindStateBase>* bind_state)
     : polymorphic_invoke_(polymorphic_invoke) {
@@ -23,12 +23,25 @@ namespace internal {
 // DoInvoke function to perform the function execution.  This allows
 // us to shield the Callback class from the types of the bound argument via
 // "type erasure."
-class BindStateBase : public RefCountedThreadSafe<BindStateBase> {
+//
+// A BindState is allocated by every Bind() and freed on whichever thread
+// drops the last Callback, which for a posted task is right after it runs.
+// Small BindStates therefore come from a SlabAllocator, which keeps freed
+// blocks in per-thread magazines, rather than the heap.
+class BASE_EXPORT BindStateBase : public RefCountedThreadSafe<BindStateBase> {
+ public:
+  static void* operator new(size_t size);
+  static void operator delete(void* block, size_t size);
+
  protected:
   friend class RefCountedThreadSafe<BindStateBase>;
   virtual ~BindStateBase() {}
 };
 
+// Returns how many blocks BindStateBase::operator new has handed out that were
+// not reused from an earlier BindState.  For tests and benchmarks.
+BASE_EXPORT int GetBindStateHeapAllocationCount();
+
 // This structure exists purely to pass the returned |bind_state_| from
 // Bind() to Callback while avoiding an extra AddRef/Release() pair.
 //
@@ -72,6 +85,10 @@ class BASE_EXPORT CallbackBase {
   // Returns true if this callback equals |other|. |other| may be null.
   bool Equals(const CallbackBase& other) const;
 
+  // Exchanges the bound state of this callback and |other|.  Unlike a copy,
+  // this does not touch the reference count of either BindState.
+  void Swap(CallbackBase* other);
+
   CallbackBase(InvokeFuncStorage polymorphic_invoke,
                scoped_refptr<BindStateBase>* bind_state);
 
@@ -0,0 +1,104 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/callback.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_internal.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+int Return(int value) {
+  return value;
+}
+
+// A bound argument too large for a BindState to come from the SlabAllocator.
+struct LargeArgument {
+  char data[256];
+};
+
+int ReturnFirstByte(const LargeArgument& argument) {
+  return argument.data[0];
+}
+
+// Drops a set of callbacks on its own thread.
+class ResetDelegate : public DelegateSimpleThread::Delegate {
+ public:
+  explicit ResetDelegate(std::vector<Closure>* callbacks)
+      : callbacks_(callbacks) {
+  }
+
+  virtual void Run() {
+    callbacks_->clear();
+  }
+
+ private:
+  std::vector<Closure>* callbacks_;
+};
+
+void DoNothing(int) {
+}
+
+TEST(CallbackTest, Swap) {
+  Callback<int(void)> one = Bind(&Return, 1);
+  Callback<int(void)> two = Bind(&Return, 2);
+  Callback<int(void)> first_one = one;
+  one.Swap(&two);
+  EXPECT_EQ(2, one.Run());
+  EXPECT_EQ(1, two.Run());
+  EXPECT_TRUE(two.Equals(first_one));
+
+  Callback<int(void)> null_callback;
+  null_callback.Swap(&two);
+  EXPECT_TRUE(two.is_null());
+  EXPECT_EQ(1, null_callback.Run());
+}
+
+TEST(CallbackTest, FreedBindStatesAreReused) {
+  // Warm up this thread's magazine.
+  Bind(&DoNothing, 0);
+
+  int allocations = internal::GetBindStateHeapAllocationCount();
+  for (int i = 0; i < 1000; ++i) {
+    Closure callback = Bind(&DoNothing, i);
+    callback.Run();
+  }
+  EXPECT_EQ(allocations, internal::GetBindStateHeapAllocationCount());
+}
+
+TEST(CallbackTest, BindStatesFreedOnOtherThreadsAreReused) {
+  const int kCallbacks = 1000;
+  std::vector<Closure> callbacks;
+  for (int i = 0; i < kCallbacks; ++i)
+    callbacks.push_back(Bind(&DoNothing, i));
+
+  // The thread frees the BindStates, and its magazines go to the allocator's
+  // depot when it exits.
+  ResetDelegate delegate(&callbacks);
+  DelegateSimpleThread thread(&delegate, "reset");
+  thread.Start();
+  thread.Join();
+
+  int allocations = internal::GetBindStateHeapAllocationCount();
+  for (int i = 0; i < kCallbacks; ++i)
+    callbacks.push_back(Bind(&DoNothing, i));
+  EXPECT_EQ(allocations, internal::GetBindStateHeapAllocationCount());
+}
+
+TEST(CallbackTest, LargeBindState) {
+  LargeArgument argument;
+  argument.data[0] = 7;
+  int allocations = internal::GetBindStateHeapAllocationCount();
+  Callback<int(void)> callback = Bind(&ReturnFirstByte, argument);
+  EXPECT_EQ(allocations + 1, internal::GetBindStateHeapAllocationCount());
+  EXPECT_EQ(7, callback.Run());
+}
+
+}  // namespace
+}  // namespace base
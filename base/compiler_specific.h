@@ -96,6 +96,15 @@
 #define NOINLINE
 #endif
 
+// Return the byte alignment of the given type (available at compile time).
+// Use like:
+//   ALIGNOF(int32)  // this would be 4
+#if defined(COMPILER_MSVC)
+#define ALIGNOF(type) __alignof(type)
+#elif defined(COMPILER_GCC)
+#define ALIGNOF(type) __alignof__(type)
+#endif
+
 // Annotate a virtual method indicating it must be overriding a virtual
 // method in the parent class.
 // Use like:
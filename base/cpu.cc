@@ -4,6 +4,8 @@
 
 #include "base/cpu.h"
 
+#include "build/build_config.h"
+
 #if defined(ARCH_CPU_X86_FAMILY)
 #if defined(_MSC_VER)
 #include <intrin.h>
@@ -28,6 +30,7 @@ CPU::CPU()
     has_ssse3_(false),
     has_sse41_(false),
     has_sse42_(false),
+    has_non_stop_time_stamp_counter_(false),
     cpu_vendor_("unknown") {
   Initialize();
 }
@@ -117,6 +120,14 @@ void CPU::Initialize() {
     has_sse41_ = (cpu_info[2] & 0x00080000) != 0;
     has_sse42_ = (cpu_info[2] & 0x00100000) != 0;
   }
+
+  // The extended leaves start at 0x80000000, which returns the highest one.
+  __cpuid(cpu_info, static_cast<int>(0x80000000));
+  unsigned int max_extended_id = cpu_info[0];
+  if (max_extended_id >= 0x80000007) {
+    __cpuid(cpu_info, static_cast<int>(0x80000007));
+    has_non_stop_time_stamp_counter_ = (cpu_info[3] & 0x00000100) != 0;
+  }
 #endif
 }
 
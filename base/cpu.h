@@ -33,6 +33,11 @@ class BASE_EXPORT CPU {
   int has_ssse3() const { return has_ssse3_; }
   int has_sse41() const { return has_sse41_; }
   int has_sse42() const { return has_sse42_; }
+  // Returns true if the time stamp counter ticks at a constant rate in every
+  // P-state and C-state ("invariant TSC").
+  bool has_non_stop_time_stamp_counter() const {
+    return has_non_stop_time_stamp_counter_;
+  }
 
  private:
   // Query the processor for CPUID information.
@@ -51,6 +56,7 @@ class BASE_EXPORT CPU {
   bool has_ssse3_;
   bool has_sse41_;
   bool has_sse42_;
+  bool has_non_stop_time_stamp_counter_;
   std::string cpu_vendor_;
 };
 
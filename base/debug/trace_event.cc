@@ -539,7 +539,7 @@ int TraceLog::AddTraceEvent(TraceEventPhase phase,
                             int64 threshold,
                             EventFlags flags) {
   DCHECK(name);
-  TimeTicks now = TimeTicks::HighResNow();
+  TimeTicks now = TimeTicks::NowFast();
   BufferFullCallback buffer_full_callback_copy;
   int ret_begin_id = -1;
   {
@@ -4,6 +4,8 @@
 
 #include "base/json/json_reader.h"
 
+#include <algorithm>
+
 #include "base/float_util.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -169,6 +171,7 @@ Value* JSONReader::JsonToValue(const std::string& json, bool check_root,
 
   json_pos_ = start_pos_;
   allow_trailing_comma_ = allow_trailing_comma;
+  arena_.Reset();
   stack_depth_ = 0;
   error_code_ = JSON_NO_ERROR;
 
@@ -293,14 +296,15 @@ Value* JSONReader::BuildValue(bool is_root) {
             SetErrorCode(JSON_UNQUOTED_DICTIONARY_KEY, json_pos_);
             return NULL;
           }
-          scoped_ptr<Value> dict_key_value(DecodeString(token));
-          if (!dict_key_value.get())
-            return NULL;
-
-          // Convert the key into a wstring.
+          // Convert the key straight to UTF-8, without building a Value.
           std::string dict_key;
-          bool success = dict_key_value->GetAsString(&dict_key);
-          DCHECK(success);
+          Arena::Mark mark = arena_.GetMark();
+          ArenaVector<wchar_t> decoded_key(&arena_);
+          if (!DecodeStringChars(token, &decoded_key))
+            return NULL;
+          if (!decoded_key.empty())
+            WideToUTF8(&decoded_key[0], decoded_key.size(), &dict_key);
+          arena_.Rewind(mark);
 
           json_pos_ += token.length;
           token = ParseToken();
@@ -390,18 +394,24 @@ JSONReader::Token JSONReader::ParseNumberToken() {
 }
 
 Value* JSONReader::DecodeNumber(const Token& token) {
-  const std::wstring num_string(token.begin, token.length);
+  // ParseNumberToken only accepts ASCII, so the characters can be narrowed
+  // one by one.
+  Arena::Mark mark = arena_.GetMark();
+  char* num_string = arena_.AllocateArray<char>(token.length);
+  std::copy(token.begin, token.begin + token.length, num_string);
 
+  Value* value = NULL;
   int num_int;
-  if (StringToInt(WideToUTF8(num_string), &num_int))
-    return Value::CreateIntegerValue(num_int);
-
   double num_double;
-  if (StringToDouble(WideToUTF8(num_string), &num_double) &&
-      base::IsFinite(num_double))
-    return Value::CreateDoubleValue(num_double);
-
-  return NULL;
+  if (StringToInt(num_string, num_string + token.length, &num_int)) {
+    value = Value::CreateIntegerValue(num_int);
+  } else if (StringToDouble(std::string(num_string, token.length),
+                            &num_double) &&
+             base::IsFinite(num_double)) {
+    value = Value::CreateDoubleValue(num_double);
+  }
+  arena_.Rewind(mark);
+  return value;
 }
 
 JSONReader::Token JSONReader::ParseStringToken() {
@@ -450,8 +460,21 @@ JSONReader::Token JSONReader::ParseStringToken() {
 }
 
 Value* JSONReader::DecodeString(const Token& token) {
-  std::wstring decoded_str;
-  decoded_str.reserve(token.length - 2);
+  Arena::Mark mark = arena_.GetMark();
+  ArenaVector<wchar_t> decoded_str(&arena_);
+  if (!DecodeStringChars(token, &decoded_str))
+    return NULL;
+
+  string16 str;
+  if (!decoded_str.empty())
+    WideToUTF16(&decoded_str[0], decoded_str.size(), &str);
+  arena_.Rewind(mark);
+  return Value::CreateStringValue(str);
+}
+
+bool JSONReader::DecodeStringChars(const Token& token,
+                                   ArenaVector<wchar_t>* decoded) {
+  decoded->reserve(token.length - 2);
 
   for (int i = 1; i < token.length - 1; ++i) {
     wchar_t c = *(token.begin + i);
@@ -462,37 +485,37 @@ Value* JSONReader::DecodeString(const Token& token) {
         case '"':
         case '/':
         case '\\':
-          decoded_str.push_back(c);
+          decoded->push_back(c);
           break;
         case 'b':
-          decoded_str.push_back('\b');
+          decoded->push_back('\b');
           break;
         case 'f':
-          decoded_str.push_back('\f');
+          decoded->push_back('\f');
           break;
         case 'n':
-          decoded_str.push_back('\n');
+          decoded->push_back('\n');
           break;
         case 'r':
-          decoded_str.push_back('\r');
+          decoded->push_back('\r');
           break;
         case 't':
-          decoded_str.push_back('\t');
+          decoded->push_back('\t');
           break;
         case 'v':
-          decoded_str.push_back('\v');
+          decoded->push_back('\v');
           break;
 
         case 'x':
-          decoded_str.push_back((HexDigitToInt(*(token.begin + i + 1)) << 4) +
-                                HexDigitToInt(*(token.begin + i + 2)));
+          decoded->push_back((HexDigitToInt(*(token.begin + i + 1)) << 4) +
+                             HexDigitToInt(*(token.begin + i + 2)));
           i += 2;
           break;
         case 'u':
-          decoded_str.push_back((HexDigitToInt(*(token.begin + i + 1)) << 12 ) +
-                                (HexDigitToInt(*(token.begin + i + 2)) << 8) +
-                                (HexDigitToInt(*(token.begin + i + 3)) << 4) +
-                                HexDigitToInt(*(token.begin + i + 4)));
+          decoded->push_back((HexDigitToInt(*(token.begin + i + 1)) << 12 ) +
+                             (HexDigitToInt(*(token.begin + i + 2)) << 8) +
+                             (HexDigitToInt(*(token.begin + i + 3)) << 4) +
+                             HexDigitToInt(*(token.begin + i + 4)));
           i += 4;
           break;
 
@@ -500,14 +523,14 @@ Value* JSONReader::DecodeString(const Token& token) {
           // We should only have valid strings at this point.  If not,
           // ParseStringToken didn't do it's job.
           NOTREACHED();
-          return NULL;
+          return false;
       }
     } else {
       // Not escaped
-      decoded_str.push_back(c);
+      decoded->push_back(c);
     }
   }
-  return Value::CreateStringValue(WideToUTF16Hack(decoded_str));
+  return true;
 }
 
 JSONReader::Token JSONReader::ParseToken() {
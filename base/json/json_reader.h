@@ -33,6 +33,7 @@
 
 #include "base/base_export.h"
 #include "base/basictypes.h"
+#include "base/memory/arena.h"
 
 // Chromium and Chromium OS check out gtest to different places, so we're
 // unable to compile on both if we include gtest_prod.h here.  Instead, include
@@ -180,6 +181,10 @@ class BASE_EXPORT JSONReader {
   // (otherwise ParseStringToken would have failed).
   Value* DecodeString(const Token& token);
 
+  // Unescapes the substring that |token| holds into |decoded|.  Returns false
+  // if ParseStringToken let through an invalid escape.
+  bool DecodeStringChars(const Token& token, ArenaVector<wchar_t>* decoded);
+
   // Grabs the next token in the JSON stream.  This does not increment the
   // stream so it can be used to look ahead at the next token.
   Token ParseToken();
@@ -215,6 +220,10 @@ class BASE_EXPORT JSONReader {
   int error_line_;
   int error_col_;
 
+  // Holds the strings decoded while parsing until they are copied into
+  // Values.  Reset at the start of each call to JsonToValue().
+  Arena arena_;
+
   DISALLOW_COPY_AND_ASSIGN(JSONReader);
 };
 
@@ -31,9 +31,12 @@ typedef HANDLE MutexHandle;
 #if defined(OS_POSIX)
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/time.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #define MAX_PATH PATH_MAX
 typedef FILE* FileHandle;
@@ -46,6 +49,7 @@ typedef pthread_mutex_t* MutexHandle;
 #include <iomanip>
 #include <ostream>
 
+#include "base/atomicops.h"
 #include "base/base_switches.h"
 #include "base/command_line.h"
 #include "base/debug/debugger.h"
@@ -63,6 +67,12 @@ typedef pthread_mutex_t* MutexHandle;
 #include <android/log.h>
 #endif
 
+// Log messages can be handed to a writer thread instead of being written by
+// the logging thread.
+#if defined(OS_POSIX) && !defined(OS_ANDROID) && !defined(OS_NACL)
+#define ASYNC_LOGGING_SUPPORTED 1
+#endif
+
 namespace logging {
 
 DcheckState g_dcheck_state = DISABLE_DCHECK_FOR_NON_OFFICIAL_RELEASE_BUILDS;
@@ -352,6 +362,319 @@ bool InitializeLogFileHandle() {
   return true;
 }
 
+#if defined(ASYNC_LOGGING_SUPPORTED)
+
+// Asynchronous logging. Each logging thread copies its messages into a ring
+// buffer of its own, which only that thread writes to and only the writer
+// thread reads from, so neither takes a lock. The writer thread collects the
+// messages waiting in all the buffers and writes them with one writev() per
+// batch. A message that does not fit in the free space of its thread's
+// buffer is dropped and counted, which bounds the memory used.
+
+// Bytes of messages each thread can have waiting. A power of two, so that
+// positions in the ring are found with a mask.
+const size_t kAsyncLogBufferSize = 64 * 1024;
+
+// Threads that can have a buffer at the same time. The others log
+// synchronously.
+const int kMaxAsyncLogBuffers = 128;
+
+// How long the writer thread sleeps when nothing wakes it earlier.
+const int kAsyncLogWriteIntervalMs = 10;
+
+// Pieces of messages written by one writev(). Each buffer with messages
+// waiting adds one or two.
+const int kMaxAsyncLogPieces = 64;
+
+struct AsyncLogBuffer {
+  AsyncLogBuffer() : head(0), tail(0), dropped(0), in_use(1), next(NULL) {
+  }
+
+  char data[kAsyncLogBufferSize];
+
+  // Bytes ever copied in by the owning thread, and written out by the
+  // writer. The head - tail bytes in between are waiting to be written.
+  base::subtle::AtomicWord head;
+  base::subtle::AtomicWord tail;
+
+  // Messages that did not fit.
+  base::subtle::AtomicWord dropped;
+
+  // 1 while a thread owns the buffer. A thread that exits leaves its buffer
+  // to the next thread that logs.
+  base::subtle::AtomicWord in_use;
+
+  // Buffers are never freed, so the list is only ever added to.
+  AsyncLogBuffer* next;
+};
+
+// 1 while log messages are handed to the writer thread.
+base::subtle::Atomic32 g_async_logging = 0;
+
+// Threads inside StageAsyncLogMessage(). Turning asynchronous logging off
+// waits for it to drop to zero, so that no message is staged after the
+// writer thread's last write.
+base::subtle::Atomic32 g_async_log_stagers = 0;
+
+// The first of the list of buffers, and how many there are.
+base::subtle::AtomicWord g_async_log_buffers = 0;
+base::subtle::Atomic32 g_async_log_buffer_count = 0;
+
+// Holds the buffer of each thread that has one.
+pthread_key_t g_async_log_buffer_key;
+pthread_once_t g_async_log_buffer_key_once = PTHREAD_ONCE_INIT;
+
+// Wake up the writer thread, and tell it to stop.
+pthread_t g_async_log_writer;
+pthread_mutex_t g_async_log_wake_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t g_async_log_wake = PTHREAD_COND_INITIALIZER;
+bool g_async_log_stopping = false;
+
+// Held while the buffers are written out, by the writer thread or by
+// FlushAsyncLog(), and guards the count of drops already reported.
+pthread_mutex_t g_async_log_write_mutex = PTHREAD_MUTEX_INITIALIZER;
+int64 g_async_log_reported_drops = 0;
+
+void ReleaseAsyncLogBuffer(void* buffer) {
+  base::subtle::Release_Store(&static_cast<AsyncLogBuffer*>(buffer)->in_use,
+                              0);
+}
+
+void CreateAsyncLogBufferKey() {
+  pthread_key_create(&g_async_log_buffer_key, &ReleaseAsyncLogBuffer);
+}
+
+AsyncLogBuffer* FirstAsyncLogBuffer() {
+  return reinterpret_cast<AsyncLogBuffer*>(
+      base::subtle::Acquire_Load(&g_async_log_buffers));
+}
+
+// Returns the buffer of the current thread, taking over the buffer of a
+// thread that exited or making a new one the first time, or NULL if there
+// are already too many.
+AsyncLogBuffer* GetAsyncLogBuffer() {
+  pthread_once(&g_async_log_buffer_key_once, &CreateAsyncLogBufferKey);
+  AsyncLogBuffer* buffer =
+      static_cast<AsyncLogBuffer*>(pthread_getspecific(g_async_log_buffer_key));
+  if (buffer)
+    return buffer;
+
+  for (buffer = FirstAsyncLogBuffer(); buffer; buffer = buffer->next) {
+    if (base::subtle::Acquire_CompareAndSwap(&buffer->in_use, 0, 1) == 0)
+      break;
+  }
+  if (!buffer) {
+    if (base::subtle::Acquire_Load(&g_async_log_buffer_count) >=
+            kMaxAsyncLogBuffers ||
+        base::subtle::NoBarrier_AtomicIncrement(&g_async_log_buffer_count, 1) >
+            kMaxAsyncLogBuffers) {
+      return NULL;
+    }
+    buffer = new AsyncLogBuffer;
+    base::subtle::AtomicWord first;
+    do {
+      first = base::subtle::NoBarrier_Load(&g_async_log_buffers);
+      buffer->next = reinterpret_cast<AsyncLogBuffer*>(first);
+    } while (base::subtle::Release_CompareAndSwap(
+                 &g_async_log_buffers, first,
+                 reinterpret_cast<base::subtle::AtomicWord>(buffer)) != first);
+  }
+  pthread_setspecific(g_async_log_buffer_key, buffer);
+  return buffer;
+}
+
+void WakeAsyncLogWriter() {
+  // Signaling without the mutex can miss a writer that is about to wait,
+  // which then only waits until its timeout.
+  pthread_cond_signal(&g_async_log_wake);
+}
+
+// Counts the current thread in g_async_log_stagers while in scope. Both
+// changes are full barriers: together with the one in SetAsyncLogging(false),
+// either the thread sees asynchronous logging turned off, or turning it off
+// waits for the thread.
+class ScopedAsyncLogStager {
+ public:
+  ScopedAsyncLogStager() {
+    base::subtle::Barrier_AtomicIncrement(&g_async_log_stagers, 1);
+  }
+  ~ScopedAsyncLogStager() {
+    base::subtle::Barrier_AtomicIncrement(&g_async_log_stagers, -1);
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ScopedAsyncLogStager);
+};
+
+// Copies |message| into the buffer of the current thread for the writer
+// thread, or drops it if it does not fit. Returns false if the message has
+// to be written synchronously instead.
+bool StageAsyncLogMessage(const std::string& message) {
+  ScopedAsyncLogStager stager;
+  if (!base::subtle::Acquire_Load(&g_async_logging) ||
+      logging_destination == LOG_NONE ||
+      message.size() > kAsyncLogBufferSize) {
+    return false;
+  }
+  AsyncLogBuffer* buffer = GetAsyncLogBuffer();
+  if (!buffer)
+    return false;
+
+  size_t head = base::subtle::NoBarrier_Load(&buffer->head);
+  size_t tail = base::subtle::Acquire_Load(&buffer->tail);
+  size_t used = head - tail;
+  if (kAsyncLogBufferSize - used < message.size()) {
+    base::subtle::NoBarrier_AtomicIncrement(&buffer->dropped, 1);
+    return true;
+  }
+
+  size_t offset = head & (kAsyncLogBufferSize - 1);
+  size_t first = std::min(message.size(), kAsyncLogBufferSize - offset);
+  memcpy(buffer->data + offset, message.data(), first);
+  memcpy(buffer->data, message.data() + first, message.size() - first);
+  base::subtle::Release_Store(&buffer->head, head + message.size());
+
+  if (used + message.size() > kAsyncLogBufferSize / 2)
+    WakeAsyncLogWriter();
+  return true;
+}
+
+// Writes the |count| pieces at |pieces| to |fd|, carrying on after short
+// writes.
+void WriteAsyncLogPieces(int fd, const struct iovec* pieces, int count) {
+  struct iovec iov[kMaxAsyncLogPieces];
+  std::copy(pieces, pieces + count, iov);
+  struct iovec* next = iov;
+  while (count > 0) {
+    ssize_t written = HANDLE_EINTR(writev(fd, next, count));
+    if (written < 0)
+      return;
+    while (count > 0 && static_cast<size_t>(written) >= next->iov_len) {
+      written -= next->iov_len;
+      ++next;
+      --count;
+    }
+    if (count > 0) {
+      next->iov_base = static_cast<char*>(next->iov_base) + written;
+      next->iov_len -= written;
+    }
+  }
+}
+
+void WriteAsyncLogBatch(const struct iovec* pieces, int count) {
+  if (count == 0)
+    return;
+  // The lock keeps InitLogging() from changing the destination or closing
+  // the file during the batch.
+  LoggingLock logging_lock;
+  if (logging_destination == LOG_ONLY_TO_SYSTEM_DEBUG_LOG ||
+      logging_destination == LOG_TO_BOTH_FILE_AND_SYSTEM_DEBUG_LOG) {
+    WriteAsyncLogPieces(STDERR_FILENO, pieces, count);
+  }
+  if (logging_destination == LOG_ONLY_TO_FILE ||
+      logging_destination == LOG_TO_BOTH_FILE_AND_SYSTEM_DEBUG_LOG) {
+    if (InitializeLogFileHandle())
+      WriteAsyncLogPieces(fileno(log_file), pieces, count);
+  }
+}
+
+// Writes everything waiting in the buffers, and the number of messages
+// dropped since the last time.
+void WriteAsyncLog() {
+  pthread_mutex_lock(&g_async_log_write_mutex);
+  struct iovec pieces[kMaxAsyncLogPieces];
+  AsyncLogBuffer* written_buffers[kMaxAsyncLogPieces];
+  size_t written_heads[kMaxAsyncLogPieces];
+  int piece_count = 0;
+  int buffer_count = 0;
+  int64 dropped = 0;
+  for (AsyncLogBuffer* buffer = FirstAsyncLogBuffer(); buffer;
+       buffer = buffer->next) {
+    dropped += base::subtle::NoBarrier_Load(&buffer->dropped);
+    size_t head = base::subtle::Acquire_Load(&buffer->head);
+    size_t tail = base::subtle::NoBarrier_Load(&buffer->tail);
+    if (head == tail)
+      continue;
+
+    if (piece_count + 2 > kMaxAsyncLogPieces) {
+      WriteAsyncLogBatch(pieces, piece_count);
+      for (int i = 0; i < buffer_count; ++i) {
+        base::subtle::Release_Store(&written_buffers[i]->tail,
+                                    written_heads[i]);
+      }
+      piece_count = 0;
+      buffer_count = 0;
+    }
+
+    // The waiting bytes wrap around the end of the ring at most once.
+    size_t offset = tail & (kAsyncLogBufferSize - 1);
+    size_t size = head - tail;
+    size_t first = std::min(size, kAsyncLogBufferSize - offset);
+    pieces[piece_count].iov_base = buffer->data + offset;
+    pieces[piece_count].iov_len = first;
+    ++piece_count;
+    if (size > first) {
+      pieces[piece_count].iov_base = buffer->data;
+      pieces[piece_count].iov_len = size - first;
+      ++piece_count;
+    }
+    written_buffers[buffer_count] = buffer;
+    written_heads[buffer_count] = head;
+    ++buffer_count;
+  }
+  WriteAsyncLogBatch(pieces, piece_count);
+  for (int i = 0; i < buffer_count; ++i)
+    base::subtle::Release_Store(&written_buffers[i]->tail, written_heads[i]);
+
+  if (dropped > g_async_log_reported_drops) {
+    char line[80];
+    int size = snprintf(line, sizeof(line),
+                        "[async logging dropped %lld messages]\n",
+                        static_cast<long long>(
+                            dropped - g_async_log_reported_drops));
+    struct iovec piece = { line, static_cast<size_t>(size) };
+    WriteAsyncLogBatch(&piece, 1);
+    g_async_log_reported_drops = dropped;
+  }
+  pthread_mutex_unlock(&g_async_log_write_mutex);
+}
+
+void* AsyncLogWriterMain(void* unused) {
+  pthread_mutex_lock(&g_async_log_wake_mutex);
+  while (!g_async_log_stopping) {
+    pthread_mutex_unlock(&g_async_log_wake_mutex);
+    WriteAsyncLog();
+    pthread_mutex_lock(&g_async_log_wake_mutex);
+    if (g_async_log_stopping)
+      break;
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64 deadline_us = static_cast<int64>(now.tv_sec) * 1000000 +
+        now.tv_usec + kAsyncLogWriteIntervalMs * 1000;
+    struct timespec deadline;
+    deadline.tv_sec = deadline_us / 1000000;
+    deadline.tv_nsec = (deadline_us % 1000000) * 1000;
+    pthread_cond_timedwait(&g_async_log_wake, &g_async_log_wake_mutex,
+                           &deadline);
+  }
+  pthread_mutex_unlock(&g_async_log_wake_mutex);
+
+  // Messages logged while asynchronous logging was being turned off.
+  WriteAsyncLog();
+  return NULL;
+}
+
+// Registered with atexit() the first time asynchronous logging is turned on,
+// so that the messages still waiting when the process exits normally are
+// written. Stopping the writer thread writes them.
+void StopAsyncLoggingAtExit() {
+  SetAsyncLogging(false);
+}
+bool g_async_log_exit_registered = false;
+
+#endif  // ASYNC_LOGGING_SUPPORTED
+
 bool BaseInitLoggingImpl(const PathChar* new_log_file,
                          LoggingDestination logging_dest,
                          LogLockingState lock_log,
@@ -373,6 +696,9 @@ bool BaseInitLoggingImpl(const PathChar* new_log_file,
 
   LoggingLock::Init(lock_log, new_log_file);
 
+  if (command_line->HasSwitch(switches::kAsyncLogging))
+    SetAsyncLogging(true);
+
   LoggingLock logging_lock;
 
   if (log_file) {
@@ -447,6 +773,62 @@ LogMessageHandlerFunction GetLogMessageHandler() {
   return log_message_handler;
 }
 
+bool SetAsyncLogging(bool enabled) {
+#if defined(ASYNC_LOGGING_SUPPORTED)
+  if (enabled == (base::subtle::Acquire_Load(&g_async_logging) != 0))
+    return true;
+
+  if (enabled) {
+    // The writer thread takes the lock to write to the log file.
+    LoggingLock::Init(LOCK_LOG_FILE, NULL);
+    g_async_log_stopping = false;
+    if (pthread_create(&g_async_log_writer, NULL, &AsyncLogWriterMain,
+                       NULL) != 0) {
+      return false;
+    }
+    base::subtle::Release_Store(&g_async_logging, 1);
+    if (!g_async_log_exit_registered) {
+      atexit(&StopAsyncLoggingAtExit);
+      g_async_log_exit_registered = true;
+    }
+  } else {
+    base::subtle::Release_Store(&g_async_logging, 0);
+    // Messages staged from here on are written synchronously. Wait for the
+    // threads that already saw asynchronous logging on, so that the writer
+    // thread's last write includes their messages.
+    base::subtle::MemoryBarrier();
+    while (base::subtle::Acquire_Load(&g_async_log_stagers) != 0)
+      sched_yield();
+    pthread_mutex_lock(&g_async_log_wake_mutex);
+    g_async_log_stopping = true;
+    pthread_cond_signal(&g_async_log_wake);
+    pthread_mutex_unlock(&g_async_log_wake_mutex);
+    pthread_join(g_async_log_writer, NULL);
+  }
+  return true;
+#else
+  return !enabled;
+#endif
+}
+
+void FlushAsyncLog() {
+#if defined(ASYNC_LOGGING_SUPPORTED)
+  if (FirstAsyncLogBuffer())
+    WriteAsyncLog();
+#endif
+}
+
+int64 GetAsyncLogDroppedCount() {
+  int64 dropped = 0;
+#if defined(ASYNC_LOGGING_SUPPORTED)
+  for (AsyncLogBuffer* buffer = FirstAsyncLogBuffer(); buffer;
+       buffer = buffer->next) {
+    dropped += base::subtle::NoBarrier_Load(&buffer->dropped);
+  }
+#endif
+  return dropped;
+}
+
 // MSVC doesn't like complex extern templates and DLLs.
 #if !defined(COMPILER_MSVC)
 // Explicit instantiations for commonly used comparisons.
@@ -574,8 +956,26 @@ LogMessage::~LogMessage() {
     return;
   }
 
-  if (logging_destination == LOG_ONLY_TO_SYSTEM_DEBUG_LOG ||
-      logging_destination == LOG_TO_BOTH_FILE_AND_SYSTEM_DEBUG_LOG) {
+  // Hand the message to the writer thread if logging is asynchronous. A
+  // fatal message is written right away, after all those before it.
+  bool staged = false;
+#if defined(ASYNC_LOGGING_SUPPORTED)
+  if (severity_ == LOG_FATAL)
+    FlushAsyncLog();
+  else
+    staged = StageAsyncLogMessage(str_newline);
+#endif
+
+  if (staged) {
+    // The writer thread writes the message to the log, but errors logged
+    // only to a file are still printed right away, as below.
+    if (logging_destination == LOG_ONLY_TO_FILE &&
+        severity_ >= kAlwaysPrintErrorLevel) {
+      fprintf(stderr, "%s", str_newline.c_str());
+      fflush(stderr);
+    }
+  } else if (logging_destination == LOG_ONLY_TO_SYSTEM_DEBUG_LOG ||
+             logging_destination == LOG_TO_BOTH_FILE_AND_SYSTEM_DEBUG_LOG) {
 #if defined(OS_WIN)
     OutputDebugStringA(str_newline.c_str());
 #elif defined(OS_ANDROID)
@@ -616,7 +1016,7 @@ LogMessage::~LogMessage() {
   // thread at the beginning of execution.
   LoggingLock::Init(LOCK_LOG_FILE, NULL);
   // write to log file
-  if (logging_destination != LOG_NONE &&
+  if (!staged && logging_destination != LOG_NONE &&
       logging_destination != LOG_ONLY_TO_SYSTEM_DEBUG_LOG) {
     LoggingLock logging_lock;
     if (InitializeLogFileHandle()) {
@@ -799,6 +1199,10 @@ ErrnoLogMessage::~ErrnoLogMessage() {
 #endif  // OS_WIN
 
 void CloseLogFile() {
+  // Write the waiting messages to the file first. The writer thread takes
+  // the logging lock itself.
+  FlushAsyncLog();
+
   LoggingLock logging_lock;
 
   if (!log_file)
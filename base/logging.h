@@ -278,6 +278,30 @@ typedef bool (*LogMessageHandlerFunction)(int severity,
 BASE_EXPORT void SetLogMessageHandler(LogMessageHandlerFunction handler);
 BASE_EXPORT LogMessageHandlerFunction GetLogMessageHandler();
 
+// Sets whether log messages are written asynchronously, which is off by
+// default, or on with --async-logging. When it is on, a log statement only
+// copies its message into a buffer of the logging thread, without taking a
+// lock, and a background thread writes the messages of all the threads in
+// batches. Messages of different threads may then be written out of order.
+// A thread that logs faster than its messages are written has the messages
+// that do not fit in its buffer dropped, and the number of messages dropped
+// is written to the log. FATAL messages are still written synchronously,
+// after everything logged before them, as are messages of threads beyond
+// the first hundred or so that log. The waiting messages are written when
+// the process exits normally and by CloseLogFile(). Call it from one thread
+// at a time, as InitLogging().
+//
+// Asynchronous logging is only implemented on POSIX (not Android or NaCl).
+// Elsewhere, including Windows, this returns false when |enabled| is true,
+// and --async-logging is ignored: logging stays synchronous.
+BASE_EXPORT bool SetAsyncLogging(bool enabled);
+
+// Writes all the messages logged asynchronously so far before returning.
+BASE_EXPORT void FlushAsyncLog();
+
+// Returns the number of messages asynchronous logging has dropped.
+BASE_EXPORT int64 GetAsyncLogDroppedCount();
+
 typedef int LogSeverity;
 const LogSeverity LOG_VERBOSE = -1;  // This is level 1 verbosity
 // Note: the log severities are used to index into the array of names,
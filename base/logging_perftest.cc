@@ -0,0 +1,78 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/logging.h"
+
+#include "base/file_path.h"
+#include "base/perftimer.h"
+#include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace logging {
+
+namespace {
+
+const int kThreads = 32;
+const int kMessagesPerThread = 20000;
+
+class LoggingDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  virtual void Run() {
+    for (int i = 0; i < kMessagesPerThread; ++i)
+      LOG(INFO) << "Renderer reported paint time " << i << " ms";
+  }
+};
+
+// Logs from kThreads threads at once to a file. Reports how many messages
+// the threads logged per second, how many of them were written per second,
+// and how many asynchronous logging dropped.
+void RunLoggingTest(const char* test_name, bool async) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath log_path = temp_dir.path().AppendASCII("perf.log");
+  ASSERT_TRUE(InitLogging(log_path.value().c_str(), LOG_ONLY_TO_FILE,
+                          LOCK_LOG_FILE, DELETE_OLD_LOG_FILE,
+                          DISABLE_DCHECK_FOR_NON_OFFICIAL_RELEASE_BUILDS));
+  if (async)
+    ASSERT_TRUE(SetAsyncLogging(true));
+  int64 dropped_before = GetAsyncLogDroppedCount();
+
+  LoggingDelegate delegate;
+  base::DelegateSimpleThreadPool pool("logging", kThreads);
+  pool.AddWork(&delegate, kThreads);
+  PerfTimer timer;
+  pool.Start();
+  pool.JoinAll();
+  double logged_seconds = timer.Elapsed().InSecondsF();
+  FlushAsyncLog();
+  double written_seconds = timer.Elapsed().InSecondsF();
+
+  int64 logged = kThreads * kMessagesPerThread;
+  int64 dropped = GetAsyncLogDroppedCount() - dropped_before;
+  LogPerfResult(base::StringPrintf("%s_logged", test_name).c_str(),
+                logged / logged_seconds, "messages/s");
+  LogPerfResult(base::StringPrintf("%s_written", test_name).c_str(),
+                (logged - dropped) / written_seconds, "messages/s");
+  LogPerfResult(base::StringPrintf("%s_dropped", test_name).c_str(),
+                static_cast<double>(dropped), "messages");
+
+  SetAsyncLogging(false);
+  InitLogging(NULL, LOG_ONLY_TO_SYSTEM_DEBUG_LOG, LOCK_LOG_FILE,
+              APPEND_TO_OLD_LOG_FILE,
+              DISABLE_DCHECK_FOR_NON_OFFICIAL_RELEASE_BUILDS);
+}
+
+}  // namespace
+
+TEST(LoggingPerfTest, Synchronous) {
+  RunLoggingTest("logging_sync", false);
+}
+
+TEST(LoggingPerfTest, Asynchronous) {
+  RunLoggingTest("logging_async", true);
+}
+
+}  // namespace logging
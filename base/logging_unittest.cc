@@ -0,0 +1,167 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/logging.h"
+
+#include <string>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/scoped_temp_dir.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace logging {
+
+namespace {
+
+// Counts the lines of |log| that contain |text|.
+int CountLines(const std::string& log, const std::string& text) {
+  int count = 0;
+  size_t start = 0;
+  while (start < log.size()) {
+    size_t end = log.find('\n', start);
+    if (end == std::string::npos)
+      end = log.size();
+    if (log.substr(start, end - start).find(text) != std::string::npos)
+      ++count;
+    start = end + 1;
+  }
+  return count;
+}
+
+// Logs |count| numbered messages that start with |name|.
+class LoggingDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  LoggingDelegate(const std::string& name, int count)
+      : name_(name),
+        count_(count) {
+  }
+
+  virtual void Run() {
+    for (int i = 0; i < count_; ++i)
+      LOG(INFO) << name_ << " message " << i;
+  }
+
+ private:
+  std::string name_;
+  int count_;
+};
+
+class AsyncLoggingTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    log_path_ = temp_dir_.path().AppendASCII("test.log");
+    ASSERT_TRUE(InitLogging(log_path_.value().c_str(), LOG_ONLY_TO_FILE,
+                            LOCK_LOG_FILE, DELETE_OLD_LOG_FILE,
+                            DISABLE_DCHECK_FOR_NON_OFFICIAL_RELEASE_BUILDS));
+  }
+
+  virtual void TearDown() {
+    SetAsyncLogging(false);
+    InitLogging(NULL, LOG_ONLY_TO_SYSTEM_DEBUG_LOG, LOCK_LOG_FILE,
+                APPEND_TO_OLD_LOG_FILE,
+                DISABLE_DCHECK_FOR_NON_OFFICIAL_RELEASE_BUILDS);
+  }
+
+  std::string ReadLog() {
+    std::string log;
+    EXPECT_TRUE(file_util::ReadFileToString(log_path_, &log));
+    return log;
+  }
+
+  ScopedTempDir temp_dir_;
+  FilePath log_path_;
+};
+
+}  // namespace
+
+#if defined(OS_POSIX) && !defined(OS_ANDROID) && !defined(OS_NACL)
+
+TEST_F(AsyncLoggingTest, FlushWritesMessages) {
+  ASSERT_TRUE(SetAsyncLogging(true));
+  LOG(INFO) << "first";
+  LOG(WARNING) << "second";
+  FlushAsyncLog();
+
+  std::string log = ReadLog();
+  EXPECT_EQ(1, CountLines(log, "first"));
+  EXPECT_EQ(1, CountLines(log, "second"));
+  EXPECT_LT(log.find("first"), log.find("second"));
+}
+
+TEST_F(AsyncLoggingTest, DisablingWritesMessages) {
+  ASSERT_TRUE(SetAsyncLogging(true));
+  LOG(INFO) << "before";
+  ASSERT_TRUE(SetAsyncLogging(false));
+  EXPECT_EQ(1, CountLines(ReadLog(), "before"));
+
+  // Logging is synchronous again.
+  LOG(INFO) << "after";
+  EXPECT_EQ(1, CountLines(ReadLog(), "after"));
+}
+
+TEST_F(AsyncLoggingTest, ManyThreads) {
+  const int kThreads = 8;
+  const int kMessages = 2000;
+  ASSERT_TRUE(SetAsyncLogging(true));
+  int64 dropped_before = GetAsyncLogDroppedCount();
+
+  LoggingDelegate* delegates[kThreads];
+  base::DelegateSimpleThread* threads[kThreads];
+  for (int i = 0; i < kThreads; ++i) {
+    delegates[i] = new LoggingDelegate(base::StringPrintf("thread%d", i),
+                                       kMessages);
+    threads[i] = new base::DelegateSimpleThread(delegates[i], "logging");
+    threads[i]->Start();
+  }
+  for (int i = 0; i < kThreads; ++i) {
+    threads[i]->Join();
+    delete threads[i];
+    delete delegates[i];
+  }
+  FlushAsyncLog();
+
+  // Every message is either written whole, in the order of its thread, or
+  // counted as dropped.
+  std::string log = ReadLog();
+  int written = 0;
+  for (int i = 0; i < kThreads; ++i) {
+    std::string name = base::StringPrintf("thread%d message ", i);
+    size_t last = 0;
+    for (int j = 0; j < kMessages; ++j) {
+      size_t pos = log.find(name + base::IntToString(j) + "\n");
+      if (pos == std::string::npos)
+        continue;
+      EXPECT_LE(last, pos);
+      last = pos;
+      ++written;
+    }
+  }
+  int64 dropped = GetAsyncLogDroppedCount() - dropped_before;
+  EXPECT_EQ(kThreads * kMessages, written + dropped);
+  if (dropped > 0)
+    EXPECT_LE(1, CountLines(log, "[async logging dropped"));
+}
+
+TEST_F(AsyncLoggingTest, LongMessageIsWrittenSynchronously) {
+  ASSERT_TRUE(SetAsyncLogging(true));
+  std::string message(1024 * 1024, 'x');
+  LOG(INFO) << message;
+  EXPECT_EQ(1, CountLines(ReadLog(), message));
+}
+
+#else
+
+TEST_F(AsyncLoggingTest, NotSupported) {
+  EXPECT_FALSE(SetAsyncLogging(true));
+  EXPECT_TRUE(SetAsyncLogging(false));
+}
+
+#endif
+
+}  // namespace logging
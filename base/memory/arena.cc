@@ -0,0 +1,115 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/arena.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace base {
+
+namespace {
+
+// Returns the offset into |data|, at or after |offset|, of the first byte
+// aligned to |alignment|.
+size_t AlignedOffset(const char* data, size_t offset, size_t alignment) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(data) + offset;
+  uintptr_t aligned = (address + alignment - 1) & ~(alignment - 1);
+  return offset + (aligned - address);
+}
+
+}  // namespace
+
+Arena::Arena()
+    : block_size_(kDefaultBlockSize),
+      current_block_(0),
+      offset_(0),
+      bytes_reserved_(0) {
+}
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size),
+      current_block_(0),
+      offset_(0),
+      bytes_reserved_(0) {
+  DCHECK_GT(block_size, 0u);
+}
+
+Arena::~Arena() {
+  for (size_t i = 0; i < blocks_.size(); ++i)
+    delete[] blocks_[i].data;
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  DCHECK(alignment != 0 && (alignment & (alignment - 1)) == 0)
+      << "Alignment " << alignment << " is not a power of two";
+
+  if (current_block_ < blocks_.size()) {
+    const Block& block = blocks_[current_block_];
+    size_t start = AlignedOffset(block.data, offset_, alignment);
+    if (start + size <= block.size) {
+      offset_ = start + size;
+      return block.data + start;
+    }
+  }
+
+  MoveToBlockWithRoom(size, alignment);
+  const Block& block = blocks_[current_block_];
+  size_t start = AlignedOffset(block.data, 0, alignment);
+  DCHECK_LE(start + size, block.size);
+  offset_ = start + size;
+  return block.data + start;
+}
+
+Arena::Mark Arena::GetMark() const {
+  Mark mark;
+  mark.block = current_block_;
+  mark.offset = offset_;
+  return mark;
+}
+
+void Arena::Rewind(const Mark& mark) {
+  DCHECK(mark.block < current_block_ ||
+         (mark.block == current_block_ && mark.offset <= offset_))
+      << "Rewinding to a mark that is no longer valid";
+  current_block_ = mark.block;
+  offset_ = mark.offset;
+}
+
+void Arena::Reset() {
+  current_block_ = 0;
+  offset_ = 0;
+}
+
+size_t Arena::bytes_allocated() const {
+  size_t bytes = offset_;
+  for (size_t i = 0; i < current_block_ && i < blocks_.size(); ++i)
+    bytes += blocks_[i].size;
+  return bytes;
+}
+
+void Arena::MoveToBlockWithRoom(size_t size, size_t alignment) {
+  // Before the first allocation there is no current block to move past.
+  size_t next = blocks_.empty() ? 0 : current_block_ + 1;
+  // Blocks come from operator new[], which aligns them for any fundamental
+  // type, so |alignment| bytes of slack is more than enough.
+  size_t needed = size + alignment;
+  if (next < blocks_.size() && blocks_[next].size >= needed) {
+    current_block_ = next;
+    offset_ = 0;
+    return;
+  }
+
+  // Blocks after |next| that were too small are kept for later.
+  Block block;
+  block.size = std::max(block_size_, needed);
+  block.data = new char[block.size];
+  bytes_reserved_ += block.size;
+  blocks_.insert(blocks_.begin() + next, block);
+  current_block_ = next;
+  offset_ = 0;
+}
+
+}  // namespace base
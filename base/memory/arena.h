@@ -0,0 +1,181 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Arena hands out memory by bumping a pointer through large blocks, and takes
+// it all back at once with Reset(), or back to an earlier point with
+// Rewind().  Allocating is a few instructions and freeing is free, which suits
+// the many short-lived allocations made while building a result, such as the
+// temporaries of a parse.
+//
+// Nothing allocated from an Arena is destroyed: only put objects in it whose
+// destructors need not run, or destroy them yourself.  ArenaVector and
+// ArenaString are STL containers whose storage comes from an Arena; they are
+// destroyed normally, but their storage is only reclaimed by Reset() or
+// Rewind().
+//
+// An Arena is not thread-safe.
+//
+// Example:
+//   base::Arena arena;
+//   base::ArenaVector<int> numbers(&arena);
+//   numbers.push_back(1);
+//   base::ArenaString name(base::ArenaAllocator<char>(&arena));
+//   name = "widget";
+//   ...
+//   arena.Reset();  // After |numbers| and |name| are gone.
+
+#ifndef BASE_MEMORY_ARENA_H_
+#define BASE_MEMORY_ARENA_H_
+#pragma once
+
+#include <stddef.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+
+namespace base {
+
+class BASE_EXPORT Arena {
+ public:
+  // A point in the Arena's allocations that Rewind() can return to.
+  struct Mark {
+    size_t block;
+    size_t offset;
+  };
+
+  static const size_t kDefaultBlockSize = 16 * 1024;
+
+  // Memory is reserved |block_size| bytes at a time; an allocation that does
+  // not fit in a block gets a block of its own size.
+  Arena();
+  explicit Arena(size_t block_size);
+  ~Arena();
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of
+  // two.  Never returns NULL.
+  void* Allocate(size_t size, size_t alignment);
+
+  // Allocates suitably aligned room for |count| objects of type T, without
+  // constructing them.
+  template <typename T>
+  T* AllocateArray(size_t count) {
+    return static_cast<T*>(Allocate(count * sizeof(T), ALIGNOF(T)));
+  }
+
+  // Returns a point that Rewind() can return to.
+  Mark GetMark() const;
+
+  // Takes back everything allocated since |mark| was taken.  |mark| must not
+  // be older than the last Reset() or a Rewind() to an earlier mark.
+  void Rewind(const Mark& mark);
+
+  // Takes back everything.  The blocks are kept for reuse until the Arena is
+  // destroyed.
+  void Reset();
+
+  // Bytes used since the last Reset(), counting alignment padding and the
+  // unused ends of blocks that have been moved past.
+  size_t bytes_allocated() const;
+
+  // Bytes held in blocks.
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  struct Block {
+    char* data;
+    size_t size;
+  };
+
+  // Makes |current_block_| a block with room for |size| bytes at |alignment|,
+  // reusing the next block if it is big enough.
+  void MoveToBlockWithRoom(size_t size, size_t alignment);
+
+  const size_t block_size_;
+  std::vector<Block> blocks_;
+
+  // The block being allocated from, and the offset of its first free byte.
+  // |current_block_| is blocks_.size() before the first allocation.
+  size_t current_block_;
+  size_t offset_;
+
+  size_t bytes_reserved_;
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+// An STL allocator that allocates from an Arena.  deallocate() does nothing;
+// the memory is reclaimed when the Arena is reset or rewound.
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <typename U>
+  struct rebind {
+    typedef ArenaAllocator<U> other;
+  };
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  pointer address(reference value) const { return &value; }
+  const_pointer address(const_reference value) const { return &value; }
+
+  pointer allocate(size_type count, const void* hint = 0) {
+    return arena_->AllocateArray<T>(count);
+  }
+  void deallocate(pointer p, size_type count) {}
+
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max() / sizeof(T);
+  }
+
+  void construct(pointer p, const T& value) { new (p) T(value); }
+  void destroy(pointer p) { p->~T(); }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() != b.arena();
+}
+
+// A std::vector whose storage comes from an Arena.
+template <typename T>
+class ArenaVector : public std::vector<T, ArenaAllocator<T> > {
+ public:
+  explicit ArenaVector(Arena* arena)
+      : std::vector<T, ArenaAllocator<T> >(ArenaAllocator<T>(arena)) {
+  }
+};
+
+// A std::string whose storage comes from an Arena.  Construct it with
+// ArenaAllocator<char>(arena).
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> >
+    ArenaString;
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_ARENA_H_
@@ -0,0 +1,117 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/arena.h"
+
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+bool IsAligned(const void* p, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+}  // namespace
+
+TEST(ArenaTest, Allocate) {
+  Arena arena(1024);
+  char* a = static_cast<char*>(arena.Allocate(10, 1));
+  char* b = static_cast<char*>(arena.Allocate(10, 1));
+  EXPECT_EQ(a + 10, b);
+  EXPECT_EQ(20u, arena.bytes_allocated());
+  EXPECT_EQ(1024u, arena.bytes_reserved());
+}
+
+TEST(ArenaTest, Alignment) {
+  Arena arena(1024);
+  arena.Allocate(1, 1);
+  EXPECT_TRUE(IsAligned(arena.Allocate(8, 8), 8));
+  arena.Allocate(3, 1);
+  EXPECT_TRUE(IsAligned(arena.Allocate(16, 16), 16));
+  arena.Allocate(1, 1);
+  EXPECT_TRUE(IsAligned(arena.AllocateArray<double>(4), ALIGNOF(double)));
+}
+
+TEST(ArenaTest, NewBlocks) {
+  Arena arena(64);
+  arena.Allocate(60, 1);
+  // Doesn't fit in the rest of the first block.
+  arena.Allocate(10, 1);
+  EXPECT_EQ(128u, arena.bytes_reserved());
+  EXPECT_EQ(74u, arena.bytes_allocated());
+
+  // Bigger than a block.
+  void* big = arena.Allocate(1000, 1);
+  ASSERT_TRUE(big);
+  memset(big, 0, 1000);
+  EXPECT_EQ(128u + 1001u, arena.bytes_reserved());
+}
+
+TEST(ArenaTest, Reset) {
+  Arena arena(64);
+  void* first = arena.Allocate(40, 1);
+  arena.Allocate(40, 1);
+  arena.Allocate(40, 1);
+  size_t reserved = arena.bytes_reserved();
+
+  arena.Reset();
+  EXPECT_EQ(0u, arena.bytes_allocated());
+  EXPECT_EQ(first, arena.Allocate(40, 1));
+  arena.Allocate(40, 1);
+  arena.Allocate(40, 1);
+  // The blocks were reused.
+  EXPECT_EQ(reserved, arena.bytes_reserved());
+}
+
+TEST(ArenaTest, Rewind) {
+  Arena arena(64);
+  arena.Allocate(8, 1);
+  Arena::Mark mark = arena.GetMark();
+  void* after_mark = arena.Allocate(8, 1);
+  arena.Allocate(60, 1);
+  arena.Allocate(60, 1);
+  size_t reserved = arena.bytes_reserved();
+
+  arena.Rewind(mark);
+  EXPECT_EQ(8u, arena.bytes_allocated());
+  EXPECT_EQ(after_mark, arena.Allocate(8, 1));
+  arena.Allocate(60, 1);
+  arena.Allocate(60, 1);
+  EXPECT_EQ(reserved, arena.bytes_reserved());
+}
+
+TEST(ArenaTest, SkipsRetainedBlocksThatAreTooSmall) {
+  Arena arena(64);
+  arena.Allocate(60, 1);
+  arena.Allocate(60, 1);
+  arena.Reset();
+
+  arena.Allocate(60, 1);
+  // The second block can't hold this, so a new block goes before it.
+  arena.Allocate(200, 1);
+  // Which leaves the second block for this.
+  arena.Allocate(60, 1);
+  EXPECT_EQ(64u + 64u + 201u, arena.bytes_reserved());
+}
+
+TEST(ArenaTest, Containers) {
+  Arena arena;
+  ArenaVector<int> numbers(&arena);
+  for (int i = 0; i < 1000; ++i)
+    numbers.push_back(i);
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(i, numbers[i]);
+
+  ArenaString name((ArenaAllocator<char>(&arena)));
+  name = "widget";
+  name += " factory";
+  EXPECT_STREQ("widget factory", name.c_str());
+  EXPECT_LT(0u, arena.bytes_allocated());
+}
+
+}  // namespace base
@@ -0,0 +1,196 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/slab_allocator.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace base {
+
+struct SlabAllocator::Magazine {
+  int count;
+  void* blocks[kMagazineSize];
+};
+
+struct SlabAllocator::ThreadCache {
+  SlabAllocator* allocator;
+  // Allocations pop from |loaded|, and frees push onto it.  When it runs out
+  // it is swapped with |previous|, so that a thread that alternates between
+  // allocating and freeing around a magazine boundary does not go to the
+  // depot every time.  Both are NULL until the size class is first used.
+  Magazine* loaded[kSizeClasses];
+  Magazine* previous[kSizeClasses];
+};
+
+SlabAllocator::SlabAllocator()
+    : thread_cache_(&ReturnThreadCache),
+      heap_blocks_(0),
+      carved_blocks_(0),
+      bytes_reserved_(0) {
+  std::fill(slab_free_, slab_free_ + kSizeClasses, static_cast<char*>(NULL));
+  std::fill(slab_end_, slab_end_ + kSizeClasses, static_cast<char*>(NULL));
+}
+
+void* SlabAllocator::Allocate(size_t size) {
+  int size_class = SizeClass(size);
+  if (size_class < 0) {
+    subtle::NoBarrier_AtomicIncrement(&heap_blocks_, 1);
+    return ::operator new(size);
+  }
+
+  ThreadCache* cache = GetThreadCache();
+  Magazine* loaded = cache->loaded[size_class];
+  if (loaded && loaded->count > 0)
+    return loaded->blocks[--loaded->count];
+  Magazine* previous = cache->previous[size_class];
+  if (previous && previous->count > 0) {
+    cache->loaded[size_class] = previous;
+    cache->previous[size_class] = loaded;
+    return previous->blocks[--previous->count];
+  }
+  return AllocateSlow(cache, size_class);
+}
+
+void SlabAllocator::Free(void* block, size_t size) {
+  int size_class = SizeClass(size);
+  if (size_class < 0) {
+    ::operator delete(block);
+    return;
+  }
+
+  ThreadCache* cache = GetThreadCache();
+  Magazine* loaded = cache->loaded[size_class];
+  if (loaded && loaded->count < kMagazineSize) {
+    loaded->blocks[loaded->count++] = block;
+    return;
+  }
+  Magazine* previous = cache->previous[size_class];
+  if (previous && previous->count < kMagazineSize) {
+    cache->loaded[size_class] = previous;
+    cache->previous[size_class] = loaded;
+    previous->blocks[previous->count++] = block;
+    return;
+  }
+  FreeSlow(cache, size_class, block);
+}
+
+int SlabAllocator::new_block_count() const {
+  int heap_blocks = subtle::NoBarrier_Load(&heap_blocks_);
+  AutoLock lock(lock_);
+  return carved_blocks_ + heap_blocks;
+}
+
+size_t SlabAllocator::bytes_reserved() const {
+  AutoLock lock(lock_);
+  return bytes_reserved_;
+}
+
+// static
+int SlabAllocator::SizeClass(size_t size) {
+  if (size > kMaxBlockSize)
+    return -1;
+  return static_cast<int>((std::max<size_t>(size, 1) - 1) / kGranularity);
+}
+
+// static
+void SlabAllocator::ReturnThreadCache(void* value) {
+  ThreadCache* cache = static_cast<ThreadCache*>(value);
+  SlabAllocator* allocator = cache->allocator;
+  AutoLock lock(allocator->lock_);
+  for (int size_class = 0; size_class < kSizeClasses; ++size_class) {
+    Magazine* magazines[] = {
+      cache->loaded[size_class], cache->previous[size_class]
+    };
+    for (size_t i = 0; i < arraysize(magazines); ++i) {
+      Magazine* magazine = magazines[i];
+      if (!magazine)
+        continue;
+      if (magazine->count > 0)
+        allocator->full_[size_class].push_back(magazine);
+      else
+        allocator->empty_[size_class].push_back(magazine);
+    }
+  }
+  delete cache;
+}
+
+SlabAllocator::ThreadCache* SlabAllocator::GetThreadCache() {
+  ThreadCache* cache = static_cast<ThreadCache*>(thread_cache_.Get());
+  if (!cache) {
+    cache = new ThreadCache;
+    cache->allocator = this;
+    std::fill(cache->loaded, cache->loaded + kSizeClasses,
+              static_cast<Magazine*>(NULL));
+    std::fill(cache->previous, cache->previous + kSizeClasses,
+              static_cast<Magazine*>(NULL));
+    thread_cache_.Set(cache);
+  }
+  return cache;
+}
+
+void* SlabAllocator::AllocateSlow(ThreadCache* cache, int size_class) {
+  Magazine* empty = cache->previous[size_class];
+  {
+    AutoLock lock(lock_);
+    std::vector<Magazine*>& full = full_[size_class];
+    if (full.empty())
+      return CarveBlock(size_class);
+
+    if (empty)
+      empty_[size_class].push_back(empty);
+    cache->previous[size_class] = cache->loaded[size_class];
+    cache->loaded[size_class] = full.back();
+    full.pop_back();
+  }
+  Magazine* loaded = cache->loaded[size_class];
+  return loaded->blocks[--loaded->count];
+}
+
+void SlabAllocator::FreeSlow(ThreadCache* cache, int size_class,
+                             void* block) {
+  Magazine* empty = NULL;
+  {
+    AutoLock lock(lock_);
+    if (cache->previous[size_class])
+      full_[size_class].push_back(cache->previous[size_class]);
+    if (!empty_[size_class].empty()) {
+      empty = empty_[size_class].back();
+      empty_[size_class].pop_back();
+    }
+  }
+  if (!empty) {
+    empty = new Magazine;
+    empty->count = 0;
+  }
+  cache->previous[size_class] = cache->loaded[size_class];
+  cache->loaded[size_class] = empty;
+  empty->blocks[empty->count++] = block;
+}
+
+void* SlabAllocator::CarveBlock(int size_class) {
+  lock_.AssertAcquired();
+  size_t block_size = (size_class + 1) * kGranularity;
+  if (slab_end_[size_class] - slab_free_[size_class] <
+      static_cast<ptrdiff_t>(block_size)) {
+    // Whatever is left of the old slab is too small to be a block.  The heap
+    // only promises 8-byte alignment on some platforms (32-bit Windows among
+    // them), so the slab is over-allocated and its start rounded up to
+    // kGranularity.  Slabs are never freed, so the original pointer is not
+    // kept.
+    char* slab = new char[kSlabSize + kGranularity - 1];
+    uintptr_t start = (reinterpret_cast<uintptr_t>(slab) + kGranularity - 1) &
+                      ~static_cast<uintptr_t>(kGranularity - 1);
+    slab_free_[size_class] = reinterpret_cast<char*>(start);
+    slab_end_[size_class] = slab_free_[size_class] + kSlabSize;
+    bytes_reserved_ += kSlabSize;
+  }
+  void* block = slab_free_[size_class];
+  slab_free_[size_class] += block_size;
+  ++carved_blocks_;
+  return block;
+}
+
+}  // namespace base
@@ -0,0 +1,128 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SlabAllocator hands out small fixed-size blocks for classes that are
+// allocated and freed at a high rate, usually by giving them a class-specific
+// operator new and operator delete.  Blocks are grouped into size classes
+// kGranularity bytes apart; blocks larger than kMaxBlockSize go to the heap.
+//
+// Each thread keeps two magazines of free blocks per size class, and only
+// takes a lock to trade a whole magazine with the shared depot, so most
+// allocations and frees touch no shared state.  A block may be freed on any
+// thread.  Fresh blocks are carved out of kSlabSize slabs.
+//
+// Memory is never returned to the system: the allocator holds on to the
+// largest number of blocks that were ever in use at once, so it suits classes
+// with a steady population (such as BindStates) and not ones that come in
+// large short-lived bursts (such as the Values of a parsed document).
+//
+// A SlabAllocator must outlive every thread that uses it, so keep it in a
+// leaky LazyInstance.  Each one uses a ThreadLocalStorage slot.
+//
+// Example:
+//   static base::LazyInstance<base::SlabAllocator,
+//       base::LeakyLazyInstanceTraits<base::SlabAllocator> >
+//       g_foo_allocator = LAZY_INSTANCE_INITIALIZER;
+//
+//   void* Foo::operator new(size_t size) {
+//     return g_foo_allocator.Pointer()->Allocate(size);
+//   }
+//   void Foo::operator delete(void* block, size_t size) {
+//     g_foo_allocator.Pointer()->Free(block, size);
+//   }
+
+#ifndef BASE_MEMORY_SLAB_ALLOCATOR_H_
+#define BASE_MEMORY_SLAB_ALLOCATOR_H_
+#pragma once
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+
+class BASE_EXPORT SlabAllocator {
+ public:
+  static const size_t kGranularity = 16;
+  static const size_t kMaxBlockSize = 256;
+  static const size_t kSlabSize = 16 * 1024;
+
+  // Free blocks held in one magazine.
+  static const int kMagazineSize = 32;
+
+  SlabAllocator();
+
+  // Returns a block of at least |size| bytes, aligned to kGranularity bytes
+  // when |size| is at most kMaxBlockSize.
+  void* Allocate(size_t size);
+
+  // Frees a block returned by Allocate(|size|).
+  void Free(void* block, size_t size);
+
+  // The number of blocks handed out that were not reused: those carved from a
+  // slab and those taken from the heap.
+  int new_block_count() const;
+
+  // Bytes held in slabs.
+  size_t bytes_reserved() const;
+
+ private:
+  struct Magazine;
+  struct ThreadCache;
+
+  static const int kSizeClasses = kMaxBlockSize / kGranularity;
+
+  // Returns the size class of a block of |size| bytes, or -1 if blocks of
+  // that size go to the heap.
+  static int SizeClass(size_t size);
+
+  // Moves an exiting thread's magazines to the depot.
+  static void ReturnThreadCache(void* value);
+
+  ThreadCache* GetThreadCache();
+
+  // Called when both of |cache|'s magazines for |size_class| are empty.
+  // Trades the empty one for a non-empty one from the depot, or carves a new
+  // block.
+  void* AllocateSlow(ThreadCache* cache, int size_class);
+
+  // Called when both of |cache|'s magazines for |size_class| are full.
+  // Trades the full one for an empty one from the depot, and frees |block|.
+  void FreeSlow(ThreadCache* cache, int size_class, void* block);
+
+  // Returns a new block of |size_class|.  |lock_| must be held.
+  void* CarveBlock(int size_class);
+
+  ThreadLocalStorage::Slot thread_cache_;
+
+  // Counts the blocks taken from the heap.
+  mutable subtle::Atomic32 heap_blocks_;
+
+  // Protects the members below.
+  mutable Lock lock_;
+
+  // The depot.  |full_| holds magazines with at least one block, so that a
+  // partly used magazine returned by an exiting thread is not lost.
+  std::vector<Magazine*> full_[kSizeClasses];
+  std::vector<Magazine*> empty_[kSizeClasses];
+
+  // The unused part of the newest slab of each size class.
+  char* slab_free_[kSizeClasses];
+  char* slab_end_[kSizeClasses];
+
+  int carved_blocks_;
+  size_t bytes_reserved_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_SLAB_ALLOCATOR_H_
@@ -0,0 +1,157 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/slab_allocator.h"
+
+#include <vector>
+
+#include "base/memory/arena.h"
+#include "base/perftimer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Blocks alive at once.
+const int kLiveBlocks = 10000;
+
+// Blocks freed and replaced in the churn tests.
+const int kOperations = 2000000;
+
+// Rounds of allocating kLiveBlocks blocks and then freeing them all.
+const int kRounds = 200;
+
+// Sizes typical of small objects such as BindStates.
+const size_t kSizes[] = { 16, 24, 40, 48, 64, 96 };
+
+// A small deterministic generator, so that each test sees the same sizes.
+class Random {
+ public:
+  Random() : state_(12345) {}
+  uint32 Next() {
+    state_ = state_ * 1103515245 + 12345;
+    return state_ >> 8;
+  }
+  size_t NextSize() { return kSizes[Next() % arraysize(kSizes)]; }
+
+ private:
+  uint32 state_;
+};
+
+class HeapAllocator {
+ public:
+  void* Allocate(size_t size) { return ::operator new(size); }
+  void Free(void* block, size_t size) { ::operator delete(block); }
+};
+
+class SlabAdapter {
+ public:
+  explicit SlabAdapter(SlabAllocator* allocator) : allocator_(allocator) {}
+  void* Allocate(size_t size) { return allocator_->Allocate(size); }
+  void Free(void* block, size_t size) { allocator_->Free(block, size); }
+
+ private:
+  SlabAllocator* allocator_;
+};
+
+// Keeps kLiveBlocks blocks of mixed sizes alive while freeing and replacing
+// one at random kOperations times, and reports the time per pair.
+template <typename Allocator>
+void RunChurnTest(const char* test_name, Allocator* allocator) {
+  Random random;
+  std::vector<void*> blocks(kLiveBlocks);
+  std::vector<size_t> sizes(kLiveBlocks);
+  for (int i = 0; i < kLiveBlocks; ++i) {
+    sizes[i] = random.NextSize();
+    blocks[i] = allocator->Allocate(sizes[i]);
+  }
+
+  PerfTimer timer;
+  for (int i = 0; i < kOperations; ++i) {
+    int index = random.Next() % kLiveBlocks;
+    allocator->Free(blocks[index], sizes[index]);
+    sizes[index] = random.NextSize();
+    blocks[index] = allocator->Allocate(sizes[index]);
+  }
+  double seconds = timer.Elapsed().InSecondsF();
+  LogPerfResult(test_name, seconds * 1e9 / kOperations, "ns/allocation");
+
+  for (int i = 0; i < kLiveBlocks; ++i)
+    allocator->Free(blocks[i], sizes[i]);
+}
+
+// Allocates kLiveBlocks blocks of mixed sizes and then frees them all, kRounds
+// times, and reports the time per allocation.
+template <typename Allocator>
+void RunRoundsTest(const char* test_name, Allocator* allocator) {
+  Random random;
+  std::vector<void*> blocks(kLiveBlocks);
+  std::vector<size_t> sizes(kLiveBlocks);
+
+  PerfTimer timer;
+  for (int round = 0; round < kRounds; ++round) {
+    for (int i = 0; i < kLiveBlocks; ++i) {
+      sizes[i] = random.NextSize();
+      blocks[i] = allocator->Allocate(sizes[i]);
+    }
+    for (int i = 0; i < kLiveBlocks; ++i)
+      allocator->Free(blocks[i], sizes[i]);
+  }
+  double seconds = timer.Elapsed().InSecondsF();
+  LogPerfResult(test_name, seconds * 1e9 / (kRounds * kLiveBlocks),
+                "ns/allocation");
+}
+
+}  // namespace
+
+TEST(AllocatorPerfTest, Churn) {
+  HeapAllocator heap;
+  RunChurnTest("churn_heap", &heap);
+
+  // SlabAllocators are never destroyed; see slab_allocator.h.
+  SlabAllocator* slab_allocator = new SlabAllocator;
+  SlabAdapter slab(slab_allocator);
+  RunChurnTest("churn_slab", &slab);
+
+  // Blocks freed in one size class can't be used by another, so as the mix of
+  // live sizes drifts the slabs hold more than the working set.  Report how
+  // much, per byte of the starting working set.
+  Random random;
+  size_t live_bytes = 0;
+  for (int i = 0; i < kLiveBlocks; ++i)
+    live_bytes += random.NextSize();
+  LogPerfResult("churn_slab_fragmentation",
+                static_cast<double>(slab_allocator->bytes_reserved()) /
+                    live_bytes,
+                "reserved/live");
+}
+
+TEST(AllocatorPerfTest, Rounds) {
+  HeapAllocator heap;
+  RunRoundsTest("rounds_heap", &heap);
+
+  SlabAdapter slab(new SlabAllocator);
+  RunRoundsTest("rounds_slab", &slab);
+
+  // The Arena equivalent of freeing everything is a Reset().
+  Arena arena;
+  Random random;
+  PerfTimer timer;
+  for (int round = 0; round < kRounds; ++round) {
+    for (int i = 0; i < kLiveBlocks; ++i)
+      arena.Allocate(random.NextSize(), 16);
+    if (round < kRounds - 1)
+      arena.Reset();
+  }
+  double seconds = timer.Elapsed().InSecondsF();
+  LogPerfResult("rounds_arena", seconds * 1e9 / (kRounds * kLiveBlocks),
+                "ns/allocation");
+  LogPerfResult("rounds_arena_fragmentation",
+                static_cast<double>(arena.bytes_reserved()) /
+                    arena.bytes_allocated(),
+                "reserved/allocated");
+}
+
+}  // namespace base
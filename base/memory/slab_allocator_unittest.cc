@@ -0,0 +1,123 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/slab_allocator.h"
+
+#include <string.h>
+
+#include <set>
+#include <vector>
+
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// A SlabAllocator must outlive the threads that use it, so each test leaks
+// its own.
+SlabAllocator* NewAllocator() {
+  return new SlabAllocator;
+}
+
+// Frees |blocks| of |size| bytes from another thread.
+class FreeDelegate : public DelegateSimpleThread::Delegate {
+ public:
+  FreeDelegate(SlabAllocator* allocator, std::vector<void*>* blocks,
+               size_t size)
+      : allocator_(allocator), blocks_(blocks), size_(size) {
+  }
+
+  virtual void Run() {
+    for (size_t i = 0; i < blocks_->size(); ++i)
+      allocator_->Free((*blocks_)[i], size_);
+    blocks_->clear();
+  }
+
+ private:
+  SlabAllocator* allocator_;
+  std::vector<void*>* blocks_;
+  size_t size_;
+};
+
+}  // namespace
+
+TEST(SlabAllocatorTest, DistinctAlignedBlocks) {
+  SlabAllocator* allocator = NewAllocator();
+  std::set<void*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    void* block = allocator->Allocate(24);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(block) % 16);
+    memset(block, 0xAB, 24);
+    EXPECT_TRUE(blocks.insert(block).second);
+  }
+  EXPECT_EQ(1000, allocator->new_block_count());
+  for (std::set<void*>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+    allocator->Free(*it, 24);
+}
+
+TEST(SlabAllocatorTest, FreedBlocksAreReused) {
+  SlabAllocator* allocator = NewAllocator();
+  std::vector<void*> blocks;
+  for (int i = 0; i < 500; ++i)
+    blocks.push_back(allocator->Allocate(40));
+  for (size_t i = 0; i < blocks.size(); ++i)
+    allocator->Free(blocks[i], 40);
+  size_t reserved = allocator->bytes_reserved();
+
+  // Enough rounds to go through the depot in both directions.
+  for (int round = 0; round < 10; ++round) {
+    blocks.clear();
+    for (int i = 0; i < 500; ++i)
+      blocks.push_back(allocator->Allocate(40));
+    for (size_t i = 0; i < blocks.size(); ++i)
+      allocator->Free(blocks[i], 40);
+  }
+  EXPECT_EQ(500, allocator->new_block_count());
+  EXPECT_EQ(reserved, allocator->bytes_reserved());
+}
+
+TEST(SlabAllocatorTest, SizeClasses) {
+  SlabAllocator* allocator = NewAllocator();
+  void* small = allocator->Allocate(16);
+  allocator->Free(small, 16);
+  // A block of the next size class doesn't reuse it.
+  void* larger = allocator->Allocate(17);
+  EXPECT_NE(small, larger);
+  // One of the same size class does.
+  EXPECT_EQ(small, allocator->Allocate(1));
+  EXPECT_EQ(2, allocator->new_block_count());
+}
+
+TEST(SlabAllocatorTest, LargeBlocksGoToTheHeap) {
+  SlabAllocator* allocator = NewAllocator();
+  void* block = allocator->Allocate(SlabAllocator::kMaxBlockSize + 1);
+  memset(block, 0, SlabAllocator::kMaxBlockSize + 1);
+  EXPECT_EQ(1, allocator->new_block_count());
+  EXPECT_EQ(0u, allocator->bytes_reserved());
+  allocator->Free(block, SlabAllocator::kMaxBlockSize + 1);
+}
+
+TEST(SlabAllocatorTest, BlocksFreedOnOtherThreadsAreReused) {
+  SlabAllocator* allocator = NewAllocator();
+  const int kBlocks = 1000;
+  std::vector<void*> blocks;
+  for (int i = 0; i < kBlocks; ++i)
+    blocks.push_back(allocator->Allocate(64));
+
+  // The thread's magazines go to the depot when it exits.
+  FreeDelegate delegate(allocator, &blocks, 64);
+  DelegateSimpleThread thread(&delegate, "free");
+  thread.Start();
+  thread.Join();
+
+  for (int i = 0; i < kBlocks; ++i)
+    blocks.push_back(allocator->Allocate(64));
+  EXPECT_EQ(kBlocks, allocator->new_block_count());
+  for (int i = 0; i < kBlocks; ++i)
+    allocator->Free(blocks[i], 64);
+}
+
+}  // namespace base
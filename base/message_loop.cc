@@ -466,8 +466,7 @@ bool MessageLoop::ProcessNextDelayedNonNestableTask() {
   if (deferred_non_nestable_work_queue_.empty())
     return false;
 
-  PendingTask pending_task = deferred_non_nestable_work_queue_.front();
-  deferred_non_nestable_work_queue_.pop();
+  PendingTask pending_task = deferred_non_nestable_work_queue_.Pop();
 
   RunTask(pending_task);
   return true;
@@ -641,8 +640,7 @@ void MessageLoop::AddToIncomingQueue(PendingTask* pending_task) {
     base::AutoLock locked(incoming_queue_lock_);
 
     bool was_empty = incoming_queue_.empty();
-    incoming_queue_.push(*pending_task);
-    pending_task->task.Reset();
+    incoming_queue_.Push(pending_task);
     if (!was_empty)
       return;  // Someone else should have started the sub-pump.
 
@@ -691,8 +689,7 @@ bool MessageLoop::DoWork() {
 
     // Execute oldest task.
     do {
-      PendingTask pending_task = work_queue_.front();
-      work_queue_.pop();
+      PendingTask pending_task = work_queue_.Pop();
       if (!pending_task.delayed_run_time.is_null()) {
         AddToDelayedWorkQueue(pending_task);
         // If we changed the topmost task, then it is time to reschedule.
@@ -0,0 +1,99 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop.h"
+
+#include "base/bind.h"
+#include "base/callback_internal.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kTasks = 100000;
+
+// Tasks to the current loop are posted this many at a time between runs, so
+// that few BindStates are alive at once.
+const int kBatch = 100;
+
+void Increment(int* counter) {
+  ++*counter;
+}
+
+// Reports how long posting and running |tasks| tasks took per task, and how
+// many BindStates were taken from the heap per task.
+void LogPostTaskResults(const char* test_name, int tasks,
+                        double post_seconds, double total_seconds,
+                        int heap_allocations) {
+  LogPerfResult(base::StringPrintf("%s_post", test_name).c_str(),
+                post_seconds * 1e9 / tasks, "ns/task");
+  LogPerfResult(base::StringPrintf("%s_post_and_run", test_name).c_str(),
+                total_seconds * 1e9 / tasks, "ns/task");
+  LogPerfResult(base::StringPrintf("%s_allocations", test_name).c_str(),
+                static_cast<double>(heap_allocations) / tasks,
+                "allocations/task");
+}
+
+// Posts kTasks tasks to the current loop, kBatch at a time, and runs them.
+// The first batch warms up this thread's BindState magazines.
+TEST(MessageLoopPerfTest, PostTaskToCurrentLoop) {
+  MessageLoop loop;
+  int counter = 0;
+  for (int i = 0; i < kBatch; ++i)
+    loop.PostTask(FROM_HERE, base::Bind(&Increment, &counter));
+  loop.RunAllPending();
+
+  int allocations_before = base::internal::GetBindStateHeapAllocationCount();
+  base::TimeDelta post_time;
+  PerfTimer timer;
+  for (int i = 0; i < kTasks; i += kBatch) {
+    PerfTimer post_timer;
+    for (int j = 0; j < kBatch; ++j)
+      loop.PostTask(FROM_HERE, base::Bind(&Increment, &counter));
+    post_time += post_timer.Elapsed();
+    loop.RunAllPending();
+  }
+  double total_seconds = timer.Elapsed().InSecondsF();
+  EXPECT_EQ(kBatch + kTasks, counter);
+
+  LogPostTaskResults(
+      "post_task_current_loop", kTasks, post_time.InSecondsF(), total_seconds,
+      base::internal::GetBindStateHeapAllocationCount() - allocations_before);
+}
+
+// Posts kTasks tasks to another thread, which frees their BindStates.  The
+// first round fills the BindState allocator's depot.
+TEST(MessageLoopPerfTest, PostTaskToOtherThread) {
+  base::Thread thread("PostTaskToOtherThread");
+  ASSERT_TRUE(thread.Start());
+  MessageLoop* loop = thread.message_loop();
+  int counter = 0;
+  base::TimeDelta post_time;
+  base::TimeDelta total_time;
+  int allocations_before = 0;
+  for (int round = 0; round < 2; ++round) {
+    allocations_before = base::internal::GetBindStateHeapAllocationCount();
+    base::WaitableEvent done(false, false);
+    PerfTimer timer;
+    for (int i = 0; i < kTasks; ++i)
+      loop->PostTask(FROM_HERE, base::Bind(&Increment, &counter));
+    post_time = timer.Elapsed();
+    loop->PostTask(FROM_HERE, base::Bind(&base::WaitableEvent::Signal,
+                                         base::Unretained(&done)));
+    done.Wait();
+    total_time = timer.Elapsed();
+  }
+  thread.Stop();
+  EXPECT_EQ(2 * kTasks, counter);
+
+  LogPostTaskResults(
+      "post_task_other_thread", kTasks, post_time.InSecondsF(),
+      total_time.InSecondsF(),
+      base::internal::GetBindStateHeapAllocationCount() - allocations_before);
+}
+
+}  // namespace
@@ -51,4 +51,20 @@ void TaskQueue::Swap(TaskQueue* queue) {
   c.swap(queue->c);  // Calls std::deque::swap.
 }
 
+void TaskQueue::Push(PendingTask* pending_task) {
+  Closure task;
+  task.Swap(&pending_task->task);
+  push(*pending_task);
+  back().task.Swap(&task);
+}
+
+PendingTask TaskQueue::Pop() {
+  Closure task;
+  task.Swap(&front().task);
+  PendingTask pending_task(front());
+  pending_task.task.Swap(&task);
+  pop();
+  return pending_task;
+}
+
 }  // namespace base
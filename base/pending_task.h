@@ -44,10 +44,19 @@ struct BASE_EXPORT PendingTask : public TrackingInfo {
 };
 
 // Wrapper around std::queue specialized for PendingTask which adds a Swap
-// helper method.
+// helper method, and Push() and Pop() variants that hand the closure over
+// without copying it.  A copy costs an AddRef() and a later Release() on the
+// BindState, both atomic.
 class BASE_EXPORT TaskQueue : public std::queue<PendingTask> {
  public:
   void Swap(TaskQueue* queue);
+
+  // Pushes |pending_task|, taking its task.  |pending_task->task| is null
+  // afterwards.
+  void Push(PendingTask* pending_task);
+
+  // Pops the front task and returns it.
+  PendingTask Pop();
 };
 
 // PendingTasks are sorted by their |delayed_run_time| property.
@@ -60,8 +60,10 @@ TrackedTime TrackedTime::Now() {
   // TODO(jar): Surface this interface via something in base/time.h.
   return TrackedTime(static_cast<int32>(timeGetTime()));
 #else
-  // Posix has nice cheap 64 bit times, so we just down-convert it.
-  return TrackedTime(base::TimeTicks::Now());
+  // Posix has nice cheap 64 bit times, so we just down-convert it.  NowFast()
+  // is calibrated against TimeTicks::Now(), so the result can be compared with
+  // down-converted TimeTicks such as PendingTask::time_posted.
+  return TrackedTime(base::TimeTicks::NowFast());
 #endif  // OS_WIN
 }
 
@@ -482,6 +482,13 @@ class BASE_EXPORT TimeTicks {
   // SHOULD ONLY BE USED WHEN IT IS REALLY NEEDED.
   static TimeTicks HighResNow();
 
+  // Returns a high-resolution tick count that is cheap enough to read several
+  // times per task.  On Linux, when the CPU has an invariant time stamp
+  // counter that the kernel also trusts, this reads the TSC and converts it
+  // with a rate that is regularly recalibrated against Now(), so the two can
+  // be compared to within a few microseconds.  Elsewhere it is HighResNow().
+  static TimeTicks NowFast();
+
 #if defined(OS_WIN)
   // Get the absolute value of QPC time drift. For testing.
   static int64 GetQPCDriftMicroseconds();
@@ -0,0 +1,67 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/time.h"
+
+#include "base/perftimer.h"
+#include "base/profiler/tracked_time.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kCalls = 10000000;
+
+// Reports how long one call to |now| takes.  Sums the results so that the
+// calls can't be optimized away.
+template <typename Clock>
+void RunClockTest(const char* test_name, Clock now) {
+  int64 sum = 0;
+  PerfTimer timer;
+  for (int i = 0; i < kCalls; ++i)
+    sum += now();
+  double seconds = timer.Elapsed().InSecondsF();
+  EXPECT_NE(0, sum);
+  LogPerfResult(test_name, seconds * 1e9 / kCalls, "ns/call");
+}
+
+int64 TimeNow() {
+  return Time::Now().ToInternalValue();
+}
+
+int64 TimeTicksNow() {
+  return TimeTicks::Now().ToInternalValue();
+}
+
+int64 TimeTicksHighResNow() {
+  return TimeTicks::HighResNow().ToInternalValue();
+}
+
+int64 TimeTicksNowFast() {
+  return TimeTicks::NowFast().ToInternalValue();
+}
+
+int64 TrackedTimeNow() {
+  return (tracked_objects::TrackedTime::Now() -
+          tracked_objects::TrackedTime()).InMilliseconds();
+}
+
+}  // namespace
+
+TEST(TimePerfTest, Sources) {
+  // Give NowFast() time to calibrate.
+  TimeTicks::NowFast();
+  PlatformThread::Sleep(100);
+  TimeTicks::NowFast();
+
+  RunClockTest("time_now", &TimeNow);
+  RunClockTest("time_ticks_now", &TimeTicksNow);
+  RunClockTest("time_ticks_high_res_now", &TimeTicksHighResNow);
+  RunClockTest("time_ticks_now_fast", &TimeTicksNowFast);
+  RunClockTest("tracked_time_now", &TrackedTimeNow);
+}
+
+}  // namespace base
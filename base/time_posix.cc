@@ -0,0 +1,429 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/time.h"
+
+#include <sys/time.h>
+#include <time.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+
+// The time stamp counter is only read on Linux, where the kernel reports
+// whether it trusts the counter to be synchronized across CPUs.
+#if defined(OS_LINUX) && defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#define TIME_STAMP_COUNTER_SUPPORTED
+#endif
+
+#if defined(TIME_STAMP_COUNTER_SUPPORTED)
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "base/atomicops.h"
+#include "base/cpu.h"
+#include "base/eintr_wrapper.h"
+#include "base/memory/singleton.h"
+#include "base/synchronization/lock.h"
+#endif
+
+namespace base {
+
+struct timespec TimeDelta::ToTimeSpec() const {
+  int64 microseconds = InMicroseconds();
+  time_t seconds = 0;
+  if (microseconds >= Time::kMicrosecondsPerSecond) {
+    seconds = InSeconds();
+    microseconds -= seconds * Time::kMicrosecondsPerSecond;
+  }
+  struct timespec result =
+      {seconds,
+       microseconds * Time::kNanosecondsPerMicrosecond};
+  return result;
+}
+
+#if !defined(OS_MACOSX)
+// The Time routines in this file use standard POSIX routines, or almost-
+// standard routines in the case of timegm.  We need to use a Mach-specific
+// function for TimeTicks::Now() on Mac OS X.
+
+// Time -----------------------------------------------------------------------
+
+// Windows uses a Gregorian epoch of 1601.  We need to match this internally
+// so that our time representations match across all platforms.  See bug 14734.
+//   irb(main):010:0> Time.at(0).getutc()
+//   => Thu Jan 01 00:00:00 UTC 1970
+//   irb(main):011:0> Time.at(-11644473600).getutc()
+//   => Mon Jan 01 00:00:00 UTC 1601
+static const int64 kWindowsEpochDeltaSeconds = GG_INT64_C(11644473600);
+static const int64 kWindowsEpochDeltaMilliseconds =
+    kWindowsEpochDeltaSeconds * Time::kMillisecondsPerSecond;
+
+// static
+const int64 Time::kWindowsEpochDeltaMicroseconds =
+    kWindowsEpochDeltaSeconds * Time::kMicrosecondsPerSecond;
+
+// Some functions in time.cc use time_t directly, so we provide an offset
+// to convert from time_t (Unix epoch) and internal (Windows epoch).
+// static
+const int64 Time::kTimeTToMicrosecondsOffset = kWindowsEpochDeltaMicroseconds;
+
+// static
+Time Time::Now() {
+  struct timeval tv;
+  struct timezone tz = { 0, 0 };  // UTC
+  if (gettimeofday(&tv, &tz) != 0) {
+    DCHECK(0) << "Could not determine time of day";
+  }
+  // Combine seconds and microseconds in a 64-bit field containing microseconds
+  // since the epoch.  That's enough for nearly 600 centuries.  Adjust from
+  // Unix (1970) to Windows (1601) epoch.
+  return Time((tv.tv_sec * kMicrosecondsPerSecond + tv.tv_usec) +
+      kWindowsEpochDeltaMicroseconds);
+}
+
+// static
+Time Time::NowFromSystemTime() {
+  // Just use Now() because Now() returns the system time.
+  return Now();
+}
+
+void Time::Explode(bool is_local, Exploded* exploded) const {
+  // Time stores times with microsecond resolution, but Exploded only carries
+  // millisecond resolution, so begin by being lossy.  Adjust from Windows
+  // epoch (1601) to Unix epoch (1970);
+  int64 milliseconds = (us_ - kWindowsEpochDeltaMicroseconds) /
+      kMicrosecondsPerMillisecond;
+  time_t seconds = milliseconds / kMillisecondsPerSecond;
+
+  struct tm timestruct;
+  if (is_local)
+    localtime_r(&seconds, &timestruct);
+  else
+    gmtime_r(&seconds, &timestruct);
+
+  exploded->year         = timestruct.tm_year + 1900;
+  exploded->month        = timestruct.tm_mon + 1;
+  exploded->day_of_week  = timestruct.tm_wday;
+  exploded->day_of_month = timestruct.tm_mday;
+  exploded->hour         = timestruct.tm_hour;
+  exploded->minute       = timestruct.tm_min;
+  exploded->second       = timestruct.tm_sec;
+  exploded->millisecond  = milliseconds % kMillisecondsPerSecond;
+}
+
+// static
+Time Time::FromExploded(bool is_local, const Exploded& exploded) {
+  struct tm timestruct;
+  timestruct.tm_sec    = exploded.second;
+  timestruct.tm_min    = exploded.minute;
+  timestruct.tm_hour   = exploded.hour;
+  timestruct.tm_mday   = exploded.day_of_month;
+  timestruct.tm_mon    = exploded.month - 1;
+  timestruct.tm_year   = exploded.year - 1900;
+  timestruct.tm_wday   = exploded.day_of_week;  // mktime/timegm ignore this
+  timestruct.tm_yday   = 0;     // mktime/timegm ignore this
+  timestruct.tm_isdst  = -1;    // attempt to figure it out
+#if !defined(OS_NACL) && !defined(OS_SOLARIS)
+  timestruct.tm_gmtoff = 0;     // not a POSIX field, so mktime/timegm ignore
+  timestruct.tm_zone   = NULL;  // not a POSIX field, so mktime/timegm ignore
+#endif
+
+  time_t seconds;
+  if (is_local)
+    seconds = mktime(&timestruct);
+  else
+    seconds = timegm(&timestruct);
+
+  int64 milliseconds;
+  // Handle overflow.  Clamping the range to what mktime and timegm might
+  // return is the best that can be done here.  It's not ideal, but it's better
+  // than failing here or ignoring the overflow case and treating each time
+  // overflow as one second prior to the epoch.
+  if (seconds == -1 &&
+      (exploded.year < 1969 || exploded.year > 1970)) {
+    // If exploded.year is 1969 or 1970, take -1 as correct, with the
+    // time indicating 1 second prior to the epoch.  (1970 is allowed to handle
+    // time zone and DST offsets.)  Otherwise, return the most future or past
+    // time representable.  Assumes the time_t epoch is 1970-01-01 00:00:00 UTC.
+    //
+    // The minimum and maximum representible times that mktime and timegm could
+    // return are used here instead of values outside that range to allow for
+    // proper round-tripping between exploded and counter-type time
+    // representations in the presence of possible truncation to time_t by
+    // division and use with other functions that accept time_t.
+    //
+    // When representing the most distant time in the future, add in an extra
+    // 999ms to avoid the time being less than any other possible value that
+    // this function can return.
+    //
+    // A 64-bit time_t holds more seconds than a Time does, so the range is
+    // also clamped to what a Time can hold.
+    const int64 kMinSeconds =
+        (kint64min + kWindowsEpochDeltaMicroseconds) / kMicrosecondsPerSecond +
+        1;
+    const int64 kMaxSeconds =
+        (kint64max - kWindowsEpochDeltaMicroseconds) / kMicrosecondsPerSecond -
+        1;
+    if (exploded.year < 1969) {
+      milliseconds = std::max<int64>(std::numeric_limits<time_t>::min(),
+                                     kMinSeconds) * kMillisecondsPerSecond;
+    } else {
+      milliseconds = (std::min<int64>(std::numeric_limits<time_t>::max(),
+                                      kMaxSeconds) * kMillisecondsPerSecond) +
+                     kMillisecondsPerSecond - 1;
+    }
+  } else {
+    milliseconds = seconds * kMillisecondsPerSecond + exploded.millisecond;
+  }
+
+  // Adjust from Unix (1970) to Windows (1601) epoch.
+  return Time((milliseconds * kMicrosecondsPerMillisecond) +
+      kWindowsEpochDeltaMicroseconds);
+}
+
+// TimeTicks ------------------------------------------------------------------
+// FreeBSD 6 has CLOCK_MONOLITHIC but defines _POSIX_MONOTONIC_CLOCK to -1.
+#if (defined(OS_POSIX) &&                                               \
+     defined(_POSIX_MONOTONIC_CLOCK) && _POSIX_MONOTONIC_CLOCK >= 0) || \
+     defined(OS_FREEBSD) || defined(OS_OPENBSD)
+
+// static
+TimeTicks TimeTicks::Now() {
+  // On Linux, glibc answers CLOCK_MONOTONIC from the vDSO without entering
+  // the kernel whenever the kernel's clocksource allows it.
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+    NOTREACHED() << "clock_gettime(CLOCK_MONOTONIC) failed.";
+    return TimeTicks();
+  }
+
+  int64 absolute_micro =
+      (static_cast<int64>(ts.tv_sec) * Time::kMicrosecondsPerSecond) +
+      (static_cast<int64>(ts.tv_nsec) / Time::kNanosecondsPerMicrosecond);
+
+  return TimeTicks(absolute_micro);
+}
+
+#else  // _POSIX_MONOTONIC_CLOCK
+#error No usable tick clock function on this platform.
+#endif  // _POSIX_MONOTONIC_CLOCK
+
+// static
+TimeTicks TimeTicks::HighResNow() {
+  return Now();
+}
+
+#endif  // !OS_MACOSX
+
+#if defined(TIME_STAMP_COUNTER_SUPPORTED)
+
+namespace {
+
+// Once calibrated, the TSC rate is re-derived and the TSC re-anchored to
+// Now() whenever a reading is this far from the last anchor.
+const int64 kRecalibrationIntervalMicroseconds = Time::kMicrosecondsPerSecond;
+
+// The first rate is derived once the TSC has been watched for this long.
+// Until then NowFast() returns Now().
+const int64 kMinCalibrationMicroseconds =
+    50 * Time::kMicrosecondsPerMillisecond;
+
+// If the TSC advanced at a rate that differs from the calibrated one by more
+// than this fraction since the last anchor, the counter was stopped or reset
+// (e.g. across a suspend), and calibration starts over.
+const double kMaxRateChange = 0.001;
+
+uint64 ReadTimeStampCounter() {
+  uint32 low;
+  uint32 high;
+  __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+  return (static_cast<uint64>(high) << 32) | low;
+}
+
+// x86 does not reorder loads with other loads or stores with other stores, so
+// the sequence counter below only has to stop the compiler from doing so.
+void CompilerBarrier() {
+  __asm__ __volatile__("" : : : "memory");
+}
+
+// Returns true if the kernel itself keeps time with the TSC, which it only
+// does once it has checked that the counters of all CPUs are synchronized.
+bool KernelUsesTimeStampCounter() {
+  int fd = HANDLE_EINTR(open(
+      "/sys/devices/system/clocksource/clocksource0/current_clocksource",
+      O_RDONLY));
+  if (fd < 0)
+    return false;
+  char clocksource[16];
+  ssize_t length = HANDLE_EINTR(read(fd, clocksource, sizeof(clocksource)));
+  HANDLE_EINTR(close(fd));
+  return length == 4 && memcmp(clocksource, "tsc\n", 4) == 0;
+}
+
+// Converts TSC readings to TimeTicks.  The conversion is anchored at a
+// (TSC, Now()) pair and uses a rate measured against Now() over the whole
+// time since calibration started, so it becomes more accurate the longer the
+// process runs.  Re-anchoring may step the result by a microsecond or so.
+//
+// Only the thread that wins |calibration_lock_| updates the anchor.  Readers
+// check |sequence_| around their copy and fall back to Now() if it changed
+// rather than wait.
+class TimeStampCounterClock {
+ public:
+  static TimeStampCounterClock* GetInstance() {
+    return Singleton<TimeStampCounterClock,
+                     LeakySingletonTraits<TimeStampCounterClock> >::get();
+  }
+
+  // Stores the current time in |ticks| and returns true, or returns false if
+  // the caller should use TimeTicks::Now() instead.
+  bool Now(TimeTicks* ticks) {
+    if (!usable_)
+      return false;
+
+    subtle::Atomic32 sequence = subtle::Acquire_Load(&sequence_);
+    uint64 anchor_tsc = anchor_tsc_;
+    int64 anchor_us = anchor_us_;
+    double microseconds_per_tick = microseconds_per_tick_;
+    CompilerBarrier();
+    if ((sequence & 1) || subtle::NoBarrier_Load(&sequence_) != sequence)
+      return false;
+
+    uint64 tsc = ReadTimeStampCounter();
+    if (microseconds_per_tick == 0.0 || tsc < anchor_tsc) {
+      Calibrate();
+      return false;
+    }
+    int64 elapsed_us =
+        static_cast<int64>((tsc - anchor_tsc) * microseconds_per_tick);
+    if (elapsed_us >= kRecalibrationIntervalMicroseconds) {
+      Calibrate();
+      return false;
+    }
+    *ticks = TimeTicks::FromInternalValue(anchor_us + elapsed_us);
+    return true;
+  }
+
+ private:
+  friend struct DefaultSingletonTraits<TimeStampCounterClock>;
+
+  TimeStampCounterClock()
+      : usable_(CPU().has_non_stop_time_stamp_counter() &&
+                KernelUsesTimeStampCounter()),
+        sequence_(0),
+        anchor_tsc_(0),
+        anchor_us_(0),
+        microseconds_per_tick_(0.0),
+        first_tsc_(0),
+        first_us_(0) {
+    if (usable_)
+      Sample(&first_tsc_, &first_us_);
+  }
+
+  // Reads the TSC and Now() as close together as it can.
+  static void Sample(uint64* tsc, int64* us) {
+    uint64 best_window = std::numeric_limits<uint64>::max();
+    for (int i = 0; i < 3; ++i) {
+      uint64 before = ReadTimeStampCounter();
+      int64 now = TimeTicks::Now().ToInternalValue();
+      uint64 after = ReadTimeStampCounter();
+      if (after >= before && after - before < best_window) {
+        best_window = after - before;
+        *tsc = before + (after - before) / 2;
+        *us = now;
+      }
+    }
+  }
+
+  // Re-derives the rate from the first sample and moves the anchor to now.
+  // Does nothing if another thread is already calibrating.
+  void Calibrate() {
+    if (!calibration_lock_.Try())
+      return;
+
+    uint64 tsc = 0;
+    int64 us = 0;
+    Sample(&tsc, &us);
+    double microseconds_per_tick = 0.0;
+    if (tsc <= first_tsc_ || us < first_us_ ||
+        (microseconds_per_tick_ != 0.0 && !TicksAtRate(tsc, us))) {
+      // The counter went backwards, or it stopped or jumped relative to Now()
+      // since the last anchor (e.g. across a suspend): start over.
+      first_tsc_ = tsc;
+      first_us_ = us;
+    } else if (us - first_us_ >= kMinCalibrationMicroseconds) {
+      microseconds_per_tick =
+          static_cast<double>(us - first_us_) / (tsc - first_tsc_);
+    }
+
+    subtle::NoBarrier_Store(&sequence_, sequence_ + 1);
+    CompilerBarrier();
+    anchor_tsc_ = tsc;
+    anchor_us_ = us;
+    microseconds_per_tick_ = microseconds_per_tick;
+    CompilerBarrier();
+    subtle::Release_Store(&sequence_, sequence_ + 1);
+
+    calibration_lock_.Release();
+  }
+
+  // Returns true if the TSC advanced at the calibrated rate between the anchor
+  // and the sample (|tsc|, |us|).
+  bool TicksAtRate(uint64 tsc, int64 us) const {
+    if (tsc <= anchor_tsc_)
+      return false;
+    double rate = static_cast<double>(us - anchor_us_) / (tsc - anchor_tsc_);
+    return fabs(rate - microseconds_per_tick_) <=
+        microseconds_per_tick_ * kMaxRateChange;
+  }
+
+  const bool usable_;
+
+  // Odd while the anchor and rate are being updated.
+  subtle::Atomic32 sequence_;
+  uint64 anchor_tsc_;
+  int64 anchor_us_;
+  double microseconds_per_tick_;  // 0 until calibrated.
+
+  // Only accessed with |calibration_lock_| held, except in the constructor.
+  Lock calibration_lock_;
+  uint64 first_tsc_;
+  int64 first_us_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeStampCounterClock);
+};
+
+}  // namespace
+
+// static
+TimeTicks TimeTicks::NowFast() {
+  TimeTicks ticks;
+  if (TimeStampCounterClock::GetInstance()->Now(&ticks))
+    return ticks;
+  return Now();
+}
+
+#else  // TIME_STAMP_COUNTER_SUPPORTED
+
+// static
+TimeTicks TimeTicks::NowFast() {
+  return HighResNow();
+}
+
+#endif  // TIME_STAMP_COUNTER_SUPPORTED
+
+struct timeval Time::ToTimeVal() const {
+  struct timeval result;
+  int64 us = us_ - kTimeTToMicrosecondsOffset;
+  result.tv_sec = us / Time::kMicrosecondsPerSecond;
+  result.tv_usec = us % Time::kMicrosecondsPerSecond;
+  return result;
+}
+
+}  // namespace base
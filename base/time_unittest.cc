@@ -0,0 +1,36 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/time.h"
+
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::PlatformThread;
+using base::TimeDelta;
+using base::TimeTicks;
+
+TEST(TimeTicks, NowFast) {
+  // NowFast() is calibrated lazily; give it time to start using the TSC if
+  // it can.
+  TimeTicks::NowFast();
+  PlatformThread::Sleep(100);
+
+  // Readings never go back by more than the step a recalibration may take,
+  // and stay close to Now() while they advance.
+  const TimeDelta kTolerance = TimeDelta::FromMilliseconds(1);
+  TimeTicks start = TimeTicks::Now();
+  TimeTicks last = TimeTicks::NowFast();
+  while (TimeTicks::Now() - start < TimeDelta::FromMilliseconds(1500)) {
+    TimeTicks before = TimeTicks::Now();
+    TimeTicks fast = TimeTicks::NowFast();
+    TimeTicks after = TimeTicks::Now();
+    EXPECT_LE((last - fast).InMicroseconds(), 10);
+    EXPECT_LE(before - kTolerance, fast);
+    EXPECT_GE(after + kTolerance, fast);
+    last = fast;
+    if (testing::Test::HasFailure())
+      break;
+  }
+}
@@ -435,6 +435,11 @@ TimeTicks TimeTicks::HighResNow() {
   return TimeTicks() + HighResNowSingleton::GetInstance()->Now();
 }
 
+// static
+TimeTicks TimeTicks::NowFast() {
+  return HighResNow();
+}
+
 // static
 int64 TimeTicks::GetQPCDriftMicroseconds() {
   return HighResNowSingleton::GetInstance()->GetQPCDriftMicroseconds();
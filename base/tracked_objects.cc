@@ -9,6 +9,7 @@
 #include "base/format_macros.h"
 #include "base/message_loop.h"
 #include "base/stringprintf.h"
+#include "base/threading/platform_thread.h"
 #include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
 #include "base/port.h"
@@ -28,6 +29,46 @@ static const bool kTrackAllTaskObjects = true;
 // period of time up until that flag is parsed. If there is no flag seen, then
 // this state may prevail for much or all of the process lifetime.
 static const ThreadData::Status kInitialStartupState = ThreadData::ACTIVE;
+
+// Number of slots in the birth and death tables of a new ThreadData.  Most
+// threads tally births and deaths at fewer locations than this, so their
+// tables never grow.
+static const size_t kInitialTableSize = 64;
+
+// Number of times SnapshotMaps() tries to copy the tables while their thread
+// is updating them, before it settles for a copy that may be inconsistent (as
+// all copies could be before the seqlock).
+static const int kMaxSnapshotAttempts = 100;
+
+// Locations are equal when they have the same (atom) strings and line.
+bool IsSameLocation(const Location& a, const Location& b) {
+  return a.line_number() == b.line_number() &&
+         a.file_name() == b.file_name() &&
+         a.function_name() == b.function_name();
+}
+
+// Hashes the identity of a location, i.e., the addresses of its strings and
+// its line number.
+size_t HashLocation(const Location& location) {
+  uintptr_t hash = reinterpret_cast<uintptr_t>(location.file_name()) ^
+      (reinterpret_cast<uintptr_t>(location.function_name()) << 7) ^
+      location.line_number();
+  hash *= 2654435761u;
+  return hash ^ (hash >> 16);
+}
+
+size_t HashPointer(const void* pointer) {
+  uintptr_t hash = reinterpret_cast<uintptr_t>(pointer) * 2654435761u;
+  return hash ^ (hash >> 16);
+}
+
+// Stores a pointer that other threads read during a ThreadData update.
+template <typename T>
+void ReleaseStorePointer(T** location, T* value) {
+  base::subtle::Release_Store(
+      reinterpret_cast<volatile base::subtle::AtomicWord*>(location),
+      reinterpret_cast<base::subtle::AtomicWord>(value));
+}
 }  // anonymous namespace.
 
 //------------------------------------------------------------------------------
@@ -35,7 +76,9 @@ static const ThreadData::Status kInitialStartupState = ThreadData::ACTIVE;
 
 void DeathData::RecordDeath(DurationInt queue_duration,
                             DurationInt run_duration) {
-  ++count_;
+  // Other threads may read the tallies of a live DeathData, so the stores are
+  // release stores; see ThreadData::BeginUpdate().
+  base::subtle::Release_Store(&count_, count_ + 1);
   queue_time_.AddDuration(queue_duration);
   run_time_.AddDuration(run_duration);
 }
@@ -84,10 +127,10 @@ void DeathData::Data::AddData(const Data& other) {
 }
 
 void DeathData::Data::AddDuration(DurationInt duration) {
-  duration_ += duration;
+  base::subtle::Release_Store(&duration_, duration_ + duration);
   if (max_ > duration)
     return;
-  max_ = duration;
+  base::subtle::Release_Store(&max_, duration);
 }
 
 DurationInt DeathData::Data::AverageMsDuration(int count) const {
@@ -111,6 +154,42 @@ Births::Births(const Location& location, const ThreadData& current)
     : BirthOnThread(location, current),
       birth_count_(1) { }
 
+//------------------------------------------------------------------------------
+// The tables in which a ThreadData records its births and deaths.  Slots are
+// found by linear probing, and a table is never more than three quarters full,
+// so that probing stops at an empty slot.  Entries are never removed.
+
+struct ThreadData::BirthTable {
+  explicit BirthTable(size_t size)
+      : slots(size, static_cast<Births*>(NULL)),
+        used(0),
+        previous(NULL) {
+  }
+
+  std::vector<Births*> slots;  // NULL when empty.
+  size_t used;                 // Slots that are not empty.
+  BirthTable* previous;        // The smaller table this one replaced.
+};
+
+struct ThreadData::DeathSlot {
+  DeathSlot() : birth(NULL) {}
+
+  const Births* birth;  // NULL when empty.
+  DeathData death_data;
+};
+
+struct ThreadData::DeathTable {
+  explicit DeathTable(size_t size)
+      : slots(size),
+        used(0),
+        previous(NULL) {
+  }
+
+  std::vector<DeathSlot> slots;
+  size_t used;
+  DeathTable* previous;
+};
+
 //------------------------------------------------------------------------------
 // ThreadData maintains the central data for all births and deaths.
 
@@ -151,7 +230,10 @@ ThreadData::ThreadData(const std::string& suggested_name)
     : incarnation_count_for_pool_(-1),
       next_(NULL),
       next_retired_worker_(NULL),
-      worker_thread_number_(0) {
+      worker_thread_number_(0),
+      birth_table_(new BirthTable(kInitialTableSize)),
+      death_table_(new DeathTable(kInitialTableSize)),
+      update_sequence_(0) {
   DCHECK_GE(suggested_name.size(), 0u);
   thread_name_ = suggested_name;
   PushToHeadOfList();  // Which sets real incarnation_count_for_pool_.
@@ -161,13 +243,27 @@ ThreadData::ThreadData(int thread_number)
     : incarnation_count_for_pool_(-1),
       next_(NULL),
       next_retired_worker_(NULL),
-      worker_thread_number_(thread_number) {
+      worker_thread_number_(thread_number),
+      birth_table_(new BirthTable(kInitialTableSize)),
+      death_table_(new DeathTable(kInitialTableSize)),
+      update_sequence_(0) {
   CHECK_GT(thread_number, 0);
   base::StringAppendF(&thread_name_, "WorkerThread-%d", thread_number);
   PushToHeadOfList();  // Which sets real incarnation_count_for_pool_.
 }
 
-ThreadData::~ThreadData() {}
+ThreadData::~ThreadData() {
+  while (birth_table_) {
+    BirthTable* previous = birth_table_->previous;
+    delete birth_table_;
+    birth_table_ = previous;
+  }
+  while (death_table_) {
+    DeathTable* previous = death_table_->previous;
+    delete death_table_;
+    death_table_ = previous;
+  }
+}
 
 void ThreadData::PushToHeadOfList() {
   DCHECK(!next_);
@@ -262,32 +358,117 @@ base::DictionaryValue* ThreadData::ToValue() {
 }
 
 Births* ThreadData::TallyABirth(const Location& location) {
-  BirthMap::iterator it = birth_map_.find(location);
-  if (it != birth_map_.end()) {
-    it->second->RecordBirth();
-    return it->second;
+  Births** slot = FindBirthSlot(location);
+  if (*slot) {
+    BeginUpdate();
+    (*slot)->RecordBirth();
+    EndUpdate();
+    return *slot;
   }
 
+  GrowBirthTableIfNeeded();
+  slot = FindBirthSlot(location);  // The table may have been replaced.
   Births* tracker = new Births(location, *this);
-  // Lock since the map may get relocated now, and other threads sometimes
-  // snapshot it (but they lock before copying it).
-  base::AutoLock lock(map_lock_);
-  birth_map_[location] = tracker;
+  BeginUpdate();
+  ReleaseStorePointer(slot, tracker);
+  ++birth_table_->used;
+  EndUpdate();
   return tracker;
 }
 
 void ThreadData::TallyADeath(const Births& birth,
                              DurationInt queue_duration,
                              DurationInt run_duration) {
-  DeathMap::iterator it = death_map_.find(&birth);
-  DeathData* death_data;
-  if (it != death_map_.end()) {
-    death_data = &it->second;
-  } else {
-    base::AutoLock lock(map_lock_);  // Lock as the map may get relocated now.
-    death_data = &death_map_[&birth];
-  }  // Release lock ASAP.
-  death_data->RecordDeath(queue_duration, run_duration);
+  DeathSlot* slot = FindDeathSlot(&birth);
+  if (!slot->birth) {
+    GrowDeathTableIfNeeded();
+    slot = FindDeathSlot(&birth);  // The table may have been replaced.
+  }
+  BeginUpdate();
+  if (!slot->birth) {
+    ReleaseStorePointer(&slot->birth, &birth);
+    ++death_table_->used;
+  }
+  slot->death_data.RecordDeath(queue_duration, run_duration);
+  EndUpdate();
+}
+
+Births** ThreadData::FindBirthSlot(const Location& location) const {
+  std::vector<Births*>& slots = birth_table_->slots;
+  size_t mask = slots.size() - 1;
+  size_t index = HashLocation(location) & mask;
+  while (slots[index] && !IsSameLocation(slots[index]->location(), location))
+    index = (index + 1) & mask;
+  return &slots[index];
+}
+
+ThreadData::DeathSlot* ThreadData::FindDeathSlot(const Births* birth) const {
+  std::vector<DeathSlot>& slots = death_table_->slots;
+  size_t mask = slots.size() - 1;
+  size_t index = HashPointer(birth) & mask;
+  while (slots[index].birth && slots[index].birth != birth)
+    index = (index + 1) & mask;
+  return &slots[index];
+}
+
+void ThreadData::GrowBirthTableIfNeeded() {
+  BirthTable* table = birth_table_;
+  if ((table->used + 1) * 4 <= table->slots.size() * 3)
+    return;
+
+  // Other threads only read the tables, so the new one can be filled before
+  // it is swapped in.
+  BirthTable* bigger = new BirthTable(table->slots.size() * 2);
+  size_t mask = bigger->slots.size() - 1;
+  for (size_t i = 0; i < table->slots.size(); ++i) {
+    Births* births = table->slots[i];
+    if (!births)
+      continue;
+    size_t index = HashLocation(births->location()) & mask;
+    while (bigger->slots[index])
+      index = (index + 1) & mask;
+    bigger->slots[index] = births;
+  }
+  bigger->used = table->used;
+  bigger->previous = table;
+  BeginUpdate();
+  ReleaseStorePointer(&birth_table_, bigger);
+  EndUpdate();
+}
+
+void ThreadData::GrowDeathTableIfNeeded() {
+  DeathTable* table = death_table_;
+  if ((table->used + 1) * 4 <= table->slots.size() * 3)
+    return;
+
+  DeathTable* bigger = new DeathTable(table->slots.size() * 2);
+  size_t mask = bigger->slots.size() - 1;
+  for (size_t i = 0; i < table->slots.size(); ++i) {
+    const DeathSlot& slot = table->slots[i];
+    if (!slot.birth)
+      continue;
+    size_t index = HashPointer(slot.birth) & mask;
+    while (bigger->slots[index].birth)
+      index = (index + 1) & mask;
+    bigger->slots[index] = slot;
+  }
+  bigger->used = table->used;
+  bigger->previous = table;
+  BeginUpdate();
+  ReleaseStorePointer(&death_table_, bigger);
+  EndUpdate();
+}
+
+void ThreadData::BeginUpdate() {
+  // Only this thread writes update_sequence_, so it can read it plainly.  The
+  // changes that follow are release stores, which can't become visible to
+  // other threads before the odd value, so no barrier is needed here.  (On x86
+  // a release store is a plain store.)
+  base::subtle::NoBarrier_Store(&update_sequence_, update_sequence_ + 1);
+}
+
+void ThreadData::EndUpdate() {
+  base::subtle::Release_Store(&update_sequence_, update_sequence_ + 1);
 }
 
 // static
@@ -416,19 +597,47 @@ ThreadData* ThreadData::first() {
 }
 
 // This may be called from another thread.
-void ThreadData::SnapshotBirthMap(BirthMap *output) const {
-  base::AutoLock lock(map_lock_);
-  for (BirthMap::const_iterator it = birth_map_.begin();
-       it != birth_map_.end(); ++it)
-    (*output)[it->first] = it->second;
-}
+bool ThreadData::SnapshotMaps(BirthCountMap* birth_counts,
+                              DeathMap* deaths) const {
+  // Copy into vectors first, to keep the time in which an update can spoil
+  // the copy short.
+  std::vector<std::pair<const Births*, int> > birth_copy;
+  std::vector<DeathSlot> death_copy;
+  bool consistent = false;
+  for (int attempt = 1; attempt <= kMaxSnapshotAttempts; ++attempt) {
+    base::subtle::Atomic32 sequence =
+        base::subtle::Acquire_Load(&update_sequence_);
+    if (!(sequence & 1) || attempt == kMaxSnapshotAttempts) {
+      birth_copy.clear();
+      death_copy.clear();
+      // The tables that were current are kept even if they are replaced
+      // meanwhile, so they can be read safely.
+      const BirthTable* birth_table = birth_table_;
+      for (size_t i = 0; i < birth_table->slots.size(); ++i) {
+        const Births* births = birth_table->slots[i];
+        if (births)
+          birth_copy.push_back(std::make_pair(births, births->birth_count()));
+      }
+      const DeathTable* death_table = death_table_;
+      for (size_t i = 0; i < death_table->slots.size(); ++i) {
+        if (death_table->slots[i].birth)
+          death_copy.push_back(death_table->slots[i]);
+      }
+      // Finish reading the copy before checking that it was not spoiled.
+      base::subtle::MemoryBarrier();
+      consistent = !(sequence & 1) &&
+          base::subtle::NoBarrier_Load(&update_sequence_) == sequence;
+      if (consistent)
+        break;
+    }
+    base::PlatformThread::YieldCurrentThread();
+  }
 
-// This may be called from another thread.
-void ThreadData::SnapshotDeathMap(DeathMap *output) const {
-  base::AutoLock lock(map_lock_);
-  for (DeathMap::const_iterator it = death_map_.begin();
-       it != death_map_.end(); ++it)
-    (*output)[it->first] = it->second;
+  for (size_t i = 0; i < birth_copy.size(); ++i)
+    (*birth_counts)[birth_copy[i].first] = birth_copy[i].second;
+  for (size_t i = 0; i < death_copy.size(); ++i)
+    (*deaths)[death_copy[i].birth] = death_copy[i].death_data;
+  return consistent;
 }
 
 // static
@@ -442,13 +651,16 @@ void ThreadData::ResetAllThreadData() {
 }
 
 void ThreadData::Reset() {
-  base::AutoLock lock(map_lock_);
-  for (DeathMap::iterator it = death_map_.begin();
-       it != death_map_.end(); ++it)
-    it->second.Clear();
-  for (BirthMap::iterator it = birth_map_.begin();
-       it != birth_map_.end(); ++it)
-    it->second->Clear();
+  // The tables that were current are kept even if they are replaced
+  // meanwhile, so they can be cleared safely.
+  DeathTable* death_table = death_table_;
+  for (size_t i = 0; i < death_table->slots.size(); ++i)
+    death_table->slots[i].death_data.Clear();
+  BirthTable* birth_table = birth_table_;
+  for (size_t i = 0; i < birth_table->slots.size(); ++i) {
+    if (birth_table->slots[i])
+      birth_table->slots[i]->Clear();
+  }
 }
 
 bool ThreadData::Initialize() {
@@ -570,12 +782,10 @@ void ThreadData::ShutdownSingleThreadedCleanup(bool leak) {
     ThreadData* next_thread_data = thread_data_list;
     thread_data_list = thread_data_list->next();
 
-    for (BirthMap::iterator it = next_thread_data->birth_map_.begin();
-         next_thread_data->birth_map_.end() != it; ++it)
-      delete it->second;  // Delete the Birth Records.
-    next_thread_data->birth_map_.clear();
-    next_thread_data->death_map_.clear();
-    delete next_thread_data;  // Includes all Death Records.
+    std::vector<Births*>& births = next_thread_data->birth_table_->slots;
+    for (size_t i = 0; i < births.size(); ++i)
+      delete births[i];  // Delete the Birth Records.
+    delete next_thread_data;  // Includes all tables and Death Records.
   }
 }
 
@@ -642,20 +852,19 @@ DataCollector::~DataCollector() {
 
 void DataCollector::Append(const ThreadData& thread_data) {
   // Get copy of data.
-  ThreadData::BirthMap birth_map;
-  thread_data.SnapshotBirthMap(&birth_map);
+  ThreadData::BirthCountMap birth_counts;
   ThreadData::DeathMap death_map;
-  thread_data.SnapshotDeathMap(&death_map);
+  thread_data.SnapshotMaps(&birth_counts, &death_map);
 
   for (ThreadData::DeathMap::const_iterator it = death_map.begin();
        it != death_map.end(); ++it) {
     collection_.push_back(Snapshot(*it->first, thread_data, it->second));
-    global_birth_count_[it->first] -= it->first->birth_count();
+    global_birth_count_[it->first] -= it->second.count();
   }
 
-  for (ThreadData::BirthMap::const_iterator it = birth_map.begin();
-       it != birth_map.end(); ++it) {
-    global_birth_count_[it->second] += it->second->birth_count();
+  for (ThreadData::BirthCountMap::const_iterator it = birth_counts.begin();
+       it != birth_counts.end(); ++it) {
+    global_birth_count_[it->first] += it->second;
   }
 }
 
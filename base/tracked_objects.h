@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 
+#include "base/atomicops.h"
 #include "base/base_export.h"
 #include "base/lazy_instance.h"
 #include "base/location.h"
@@ -99,10 +100,16 @@
 // Each thread maintains a list of data items specific to that thread in a
 // ThreadData instance (for that specific thread only).  The two critical items
 // are lists of DeathData and Births instances.  These lists are maintained in
-// STL maps, which are indexed by Location. As noted earlier, we can compare
+// open-addressed hash tables, which are indexed by Location (for Births) and
+// by Births pointer (for DeathData).  As noted earlier, we can compare
 // locations very efficiently as we consider the underlying data (file,
 // function, line) to be atoms, and hence pointer comparison is used rather than
-// (slow) string comparisons.
+// (slow) string comparisons.  Only the owning thread writes to its tables, so
+// it never takes a lock.  Each update is bracketed by a sequence number (a
+// seqlock), which other threads read before and after copying the tables, and
+// they retry the copy if an update took place meanwhile.  A table that fills
+// up is replaced by one twice its size, and the old one is kept (until test
+// cleanup), since another thread may still be copying it.
 //
 // To provide a mechanism for iterating over all "known threads," which means
 // threads that have recorded a birth or a death, we create a singly linked list
@@ -137,14 +144,11 @@
 //
 // A DataCollector is a container object that holds a set of Snapshots. The
 // statistics in a snapshot are gathered asynhcronously relative to their
-// ongoing updates.  It is possible, though highly unlikely, that stats could be
-// incorrectly recorded by this process (all data is held in 32 bit ints, but we
-// are not atomically collecting all data, so we could have count that does not,
-// for example, match with the number of durations we accumulated).  The
-// advantage to having fast (non-atomic) updates of the data outweighs the
-// minimal risk of a singular corrupt statistic snapshot (only the snapshot
-// could be corrupt, not the underlying and ongoing statistic).  In constrast,
-// pointer data that is accessed during snapshotting is completely invariant,
+// ongoing updates.  The seqlock ensures that the data copied from each thread
+// is consistent (for example, a count always matches the sum of durations
+// accumulated with it), but the threads are copied one after another, so
+// births and deaths tallied on different threads may not match exactly.
+// Pointer data that is accessed during snapshotting is completely invariant,
 // and hence is perfectly acquired (i.e., no potential corruption, and no risk
 // of a bad memory reference).
 //
@@ -222,8 +226,12 @@ class BASE_EXPORT Births: public BirthOnThread {
 
   int birth_count() const { return birth_count_; }
 
-  // When we have a birth we update the count for this BirhPLace.
-  void RecordBirth() { ++birth_count_; }
+  // When we have a birth we update the count for this BirhPLace.  This is a
+  // release store, since other threads may read the count; see
+  // ThreadData::BeginUpdate().
+  void RecordBirth() {
+    base::subtle::Release_Store(&birth_count_, birth_count_ + 1);
+  }
 
   // When a birthplace is changed (updated), we need to decrement the counter
   // for the old instance.
@@ -376,8 +384,8 @@ class BASE_EXPORT DataCollector {
   ~DataCollector();
 
   // Adds all stats from the indicated thread into our arrays.  This function
-  // uses locks at the lowest level (when accessing the underlying maps which
-  // could change when not locked), and can be called from any threads.
+  // copies the underlying tables without a lock (see
+  // ThreadData::SnapshotMaps()), and can be called from any threads.
   void Append(const ThreadData& thread_data);
 
   // After the accumulation phase, the following accessor is used to process the
@@ -426,7 +434,7 @@ class BASE_EXPORT ThreadData {
     DEACTIVATED,
   };
 
-  typedef std::map<Location, Births*> BirthMap;
+  typedef std::map<const Births*, int> BirthCountMap;
   typedef std::map<const Births*, DeathData> DeathMap;
 
   // Initialize the current thread context with a new instance of ThreadData.
@@ -496,17 +504,19 @@ class BASE_EXPORT ThreadData {
   static ThreadData* first();
   // Iterate through the null terminated list of ThreadData instances.
   ThreadData* next() const { return next_; }
-  // Using our lock, make a copy of the specified maps.  These calls may arrive
-  // from non-local threads, and are used to quickly scan data from all threads
-  // in order to build JSON for about:profiler.
-  void SnapshotBirthMap(BirthMap *output) const;
-  void SnapshotDeathMap(DeathMap *output) const;
+  // Make a consistent copy of the birth counts and death data tallied on this
+  // thread, retrying while this thread updates them.  Returns false if this
+  // thread kept updating them, and the copy may be (very slightly)
+  // inconsistent.  These calls may arrive from non-local threads, and are used
+  // to quickly scan data from all threads in order to build JSON for
+  // about:profiler.
+  bool SnapshotMaps(BirthCountMap* birth_counts, DeathMap* deaths) const;
   // -------- end of should be private methods.
 
   // Hack: asynchronously clear all birth counts and death tallies data values
   // in all ThreadData instances.  The numerical (zeroing) part is done without
-  // use of a locks or atomics exchanges, and may (for int64 values) produce
-  // bogus counts VERY rarely.
+  // use of a locks or atomics exchanges, or the seqlock, and may produce bogus
+  // counts VERY rarely.
   static void ResetAllThreadData();
 
   // Initializes all statics if needed (this initialization call should be made
@@ -542,6 +552,12 @@ class BASE_EXPORT ThreadData {
   // in production code.
   friend class TrackedObjectsTest;
 
+  // Open-addressed hash tables holding a power of two of slots, defined in
+  // the .cc file.
+  struct BirthTable;
+  struct DeathSlot;
+  struct DeathTable;
+
   // Worker thread construction creates a name since there is none.
   explicit ThreadData(int thread_number);
 
@@ -563,9 +579,28 @@ class BASE_EXPORT ThreadData {
                    DurationInt queue_duration,
                    DurationInt duration);
 
-  // Using our lock to protect the iteration, Clear all birth and death data.
+  // Clear all birth and death data.
   void Reset();
 
+  // Return the slot of the current table that holds the Births for
+  // |location|, or the empty slot where it belongs.
+  Births** FindBirthSlot(const Location& location) const;
+
+  // Return the slot of the current table that holds the DeathData for
+  // |birth|, or the empty slot where it belongs.
+  DeathSlot* FindDeathSlot(const Births* birth) const;
+
+  // Replace the current table with one twice its size, if adding a slot
+  // would make it more than three quarters full.
+  void GrowBirthTableIfNeeded();
+  void GrowDeathTableIfNeeded();
+
+  // Bracket every change to the tables (including the counts they hold), so
+  // that SnapshotMaps() can tell when its copy is inconsistent.  The changes
+  // in between must be release stores.
+  void BeginUpdate();
+  void EndUpdate();
+
   // This method is called by the TLS system when a thread terminates.
   // The argument may be NULL if this thread has never tracked a birth or death.
   static void OnThreadTermination(void* thread_data);
@@ -649,25 +684,18 @@ class BASE_EXPORT ThreadData {
   // corresponding to the created thread name if it is a worker thread.
   int worker_thread_number_;
 
-  // A map used on each thread to keep track of Births on this thread.
-  // This map should only be accessed on the thread it was constructed on.
-  // When a snapshot is needed, this structure can be locked in place for the
-  // duration of the snapshotting activity.
-  BirthMap birth_map_;
+  // A table used on each thread to keep track of Births on this thread.
+  // This table should only be changed on the thread it was constructed on.
+  // Other threads copy it with SnapshotMaps().
+  BirthTable* birth_table_;
 
-  // Similar to birth_map_, this records informations about death of tracked
+  // Similar to birth_table_, this records informations about death of tracked
   // instances (i.e., when a tracked instance was destroyed on this thread).
-  // It is locked before changing, and hence other threads may access it by
-  // locking before reading it.
-  DeathMap death_map_;
-
-  // Lock to protect *some* access to BirthMap and DeathMap.  The maps are
-  // regularly read and written on this thread, but may only be read from other
-  // threads.  To support this, we acquire this lock if we are writing from this
-  // thread, or reading from another thread.  For reading from this thread we
-  // don't need a lock, as there is no potential for a conflict since the
-  // writing is only done from this thread.
-  mutable base::Lock map_lock_;
+  DeathTable* death_table_;
+
+  // Odd while this thread is changing its tables, and incremented twice by
+  // each change.
+  base::subtle::Atomic32 update_sequence_;
 
   DISALLOW_COPY_AND_ASSIGN(ThreadData);
 };
@@ -0,0 +1,197 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Test of classes in the tracked_objects.h classes.
+
+#include "base/tracked_objects.h"
+
+#include "base/atomicops.h"
+#include "base/profiler/tracked_time.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace tracked_objects {
+
+class TrackedObjectsTest : public testing::Test {
+ protected:
+  TrackedObjectsTest() {
+    // On entry, leak any database structures in case they are still in use by
+    // prior threads.
+    ThreadData::ShutdownSingleThreadedCleanup(true);
+  }
+
+  virtual ~TrackedObjectsTest() {
+    // We should not need to leak any structures we create, since we are
+    // single threaded, and carefully accounting for items.
+    ThreadData::ShutdownSingleThreadedCleanup(false);
+  }
+
+  // Tallies the death of an instance born at |births| that ran for
+  // |run_ms| milliseconds.
+  static void TallyADeath(const Births* births, int run_ms) {
+    TrackedTime start_of_run = TrackedTime() + Duration::FromMilliseconds(1);
+    ThreadData::TallyRunInAScopedRegionIfTracking(
+        births, start_of_run,
+        start_of_run + Duration::FromMilliseconds(run_ms));
+  }
+};
+
+namespace {
+
+// Locations are identified by the addresses of their strings.
+const char kFunctionName[] = "ManyLocations";
+const char kFileName[] = "file.cc";
+
+// Tallies births and deaths at one location on its own thread, and publishes
+// its ThreadData once the first birth is tallied.
+class TallyingDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  TallyingDelegate(int deaths, int run_ms)
+      : deaths_(deaths),
+        run_ms_(run_ms),
+        thread_data_(0) {
+  }
+
+  const ThreadData* WaitForThreadData() {
+    while (!base::subtle::Acquire_Load(&thread_data_))
+      base::PlatformThread::YieldCurrentThread();
+    return reinterpret_cast<const ThreadData*>(thread_data_);
+  }
+
+  virtual void Run() {
+    Location location("Run", "tallying_thread.cc", 1, NULL);
+    const Births* births = ThreadData::TallyABirthIfActive(location);
+    base::subtle::Release_Store(
+        &thread_data_, reinterpret_cast<base::subtle::AtomicWord>(
+                           births->birth_thread()));
+    TrackedTime start_of_run = TrackedTime() + Duration::FromMilliseconds(1);
+    for (int i = 0; i < deaths_; ++i) {
+      ThreadData::TallyRunInAScopedRegionIfTracking(
+          births, start_of_run,
+          start_of_run + Duration::FromMilliseconds(run_ms_));
+    }
+  }
+
+ private:
+  int deaths_;
+  int run_ms_;
+  base::subtle::AtomicWord thread_data_;
+};
+
+}  // namespace
+
+TEST_F(TrackedObjectsTest, BirthsAtOneLocation) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(true))
+    return;
+
+  Location location("BirthsAtOneLocation", "file.cc", 10, NULL);
+  Births* first = ThreadData::TallyABirthIfActive(location);
+  ASSERT_TRUE(first);
+  Births* second = ThreadData::TallyABirthIfActive(location);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(2, first->birth_count());
+
+  // Another line is another location.
+  Location other("BirthsAtOneLocation", "file.cc", 11, NULL);
+  EXPECT_NE(first, ThreadData::TallyABirthIfActive(other));
+
+  ThreadData::BirthCountMap birth_counts;
+  ThreadData::DeathMap deaths;
+  ThreadData::Get()->SnapshotMaps(&birth_counts, &deaths);
+  EXPECT_EQ(2u, birth_counts.size());
+  EXPECT_EQ(2, birth_counts[first]);
+  EXPECT_TRUE(deaths.empty());
+}
+
+TEST_F(TrackedObjectsTest, ManyLocations) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(true))
+    return;
+
+  // Enough locations to make the tables grow several times.
+  const int kLocations = 1000;
+  Births* births[kLocations];
+  for (int i = 0; i < kLocations; ++i) {
+    births[i] = ThreadData::TallyABirthIfActive(
+        Location(kFunctionName, kFileName, i, NULL));
+    TallyADeath(births[i], i);
+  }
+  for (int i = 0; i < kLocations; ++i) {
+    EXPECT_EQ(births[i], ThreadData::TallyABirthIfActive(
+        Location(kFunctionName, kFileName, i, NULL)));
+    TallyADeath(births[i], i);
+  }
+
+  ThreadData::BirthCountMap birth_counts;
+  ThreadData::DeathMap deaths;
+  ThreadData::Get()->SnapshotMaps(&birth_counts, &deaths);
+  ASSERT_EQ(static_cast<size_t>(kLocations), birth_counts.size());
+  ASSERT_EQ(static_cast<size_t>(kLocations), deaths.size());
+  for (int i = 0; i < kLocations; ++i) {
+    EXPECT_EQ(2, birth_counts[births[i]]);
+    EXPECT_EQ(2, deaths[births[i]].count());
+    EXPECT_EQ(2 * i, deaths[births[i]].run_duration());
+    EXPECT_EQ(i, deaths[births[i]].run_duration_max());
+  }
+}
+
+TEST_F(TrackedObjectsTest, LivingObjects) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(true))
+    return;
+
+  Location location("LivingObjects", "file.cc", 20, NULL);
+  const Births* births = NULL;
+  for (int i = 0; i < 3; ++i)
+    births = ThreadData::TallyABirthIfActive(location);
+  TallyADeath(births, 5);
+  TallyADeath(births, 7);
+
+  DataCollector collector;
+  collector.AddListOfLivingObjects();
+  DataCollector::Collection* collection = collector.collection();
+  ASSERT_EQ(2u, collection->size());
+  EXPECT_EQ(2, (*collection)[0].count());
+  EXPECT_EQ(12, (*collection)[0].run_duration());
+  EXPECT_EQ(7, (*collection)[0].run_duration_max());
+  EXPECT_EQ(1, (*collection)[1].count());
+  EXPECT_EQ("Still_Alive", (*collection)[1].DeathThreadName());
+}
+
+TEST_F(TrackedObjectsTest, SnapshotWhileTallying) {
+  if (!ThreadData::InitializeAndSetTrackingStatus(true))
+    return;
+
+  const int kDeaths = 200000;
+  const int kRunMs = 3;
+  TallyingDelegate delegate(kDeaths, kRunMs);
+  base::DelegateSimpleThread thread(&delegate, "tallying");
+  thread.Start();
+  const ThreadData* thread_data = delegate.WaitForThreadData();
+
+  // Every copy that SnapshotMaps() vouches for is consistent: the durations
+  // add up to the count.
+  int count = 0;
+  int consistent_copies = 0;
+  while (count < kDeaths) {
+    ThreadData::BirthCountMap birth_counts;
+    ThreadData::DeathMap deaths;
+    bool consistent = thread_data->SnapshotMaps(&birth_counts, &deaths);
+    if (deaths.empty())
+      continue;
+    EXPECT_EQ(1u, deaths.size());
+    const DeathData& death_data = deaths.begin()->second;
+    EXPECT_LE(count, death_data.count());
+    count = death_data.count();
+    if (consistent) {
+      EXPECT_EQ(kRunMs * count, death_data.run_duration());
+      ++consistent_copies;
+    }
+    if (HasFailure())
+      break;
+  }
+  EXPECT_LT(0, consistent_copies);
+  thread.Join();
+}
+
+}  // namespace tracked_objects
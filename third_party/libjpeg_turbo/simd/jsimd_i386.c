@@ -29,36 +29,43 @@
 
 #define IS_ALIGNED_SSE(ptr) (IS_ALIGNED(ptr, 4)) /* 16 byte alignment */
 
-static unsigned int simd_support = ~0;
+static unsigned int simd_support = ~0U;
 
 /*
  * Check what SIMD accelerations are supported.
  *
- * FIXME: This code is racy under a multi-threaded environment.
+ * Several threads may get here at once (the strip decoder runs one
+ * decompressor per thread).  The result is computed in a local and
+ * published with a single store, so a concurrent caller sees either ~0U,
+ * and computes the same value itself, or the final value; never one with
+ * the environment overrides half applied.
  */
 LOCAL(void)
 init_simd (void)
 {
   char *env = NULL;
+  unsigned int support;
 
-  if (simd_support != ~0)
+  if (simd_support != ~0U)
     return;
 
-  simd_support = jpeg_simd_cpu_support();
+  support = jpeg_simd_cpu_support();
 
   /* Force different settings through environment variables */
   env = getenv("JSIMD_FORCEMMX");
   if ((env != NULL) && (strcmp(env, "1") == 0))
-    simd_support &= JSIMD_MMX;
+    support &= JSIMD_MMX;
   env = getenv("JSIMD_FORCE3DNOW");
   if ((env != NULL) && (strcmp(env, "1") == 0))
-    simd_support &= JSIMD_3DNOW|JSIMD_MMX;
+    support &= JSIMD_3DNOW|JSIMD_MMX;
   env = getenv("JSIMD_FORCESSE");
   if ((env != NULL) && (strcmp(env, "1") == 0))
-    simd_support &= JSIMD_SSE|JSIMD_MMX;
+    support &= JSIMD_SSE|JSIMD_MMX;
   env = getenv("JSIMD_FORCESSE2");
   if ((env != NULL) && (strcmp(env, "1") == 0))
-    simd_support &= JSIMD_SSE2;
+    support &= JSIMD_SSE2;
+
+  simd_support = support;
 }
 
 GLOBAL(int)
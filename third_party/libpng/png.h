@@ -3406,6 +3406,12 @@ PNG_EXTERN void png_read_filter_row PNGARG((png_structp png_ptr,
    png_row_infop row_info, png_bytep row, png_bytep prev_row,
    int filter)) PNG_PRIVATE;
 
+#ifdef PNG_READ_FILTER_SSE2_SUPPORTED
+/* Unfilter a row with SSE2; returns 0 if the row is left to the C code */
+PNG_EXTERN int png_read_filter_row_sse2 PNGARG((png_row_infop row_info,
+   png_bytep row, png_bytep prev_row, int filter)) PNG_PRIVATE;
+#endif
+
 /* Choose the best filter to use and filter the row data */
 PNG_EXTERN void png_write_find_filter PNGARG((png_structp png_ptr,
    png_row_infop row_info)) PNG_PRIVATE;
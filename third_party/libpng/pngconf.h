@@ -800,6 +800,24 @@
 #  endif
 #endif
 
+/* pngfilter_sse2.c undoes the row filters with SSE2.  It is opt-in: a build
+ * that compiles pngfilter_sse2.c defines PNG_READ_FILTER_SSE2, so that a
+ * build listing only the stock sources still links.  The compiler must
+ * accept SSE2 intrinsics: GCC only does when it targets SSE2, while MSVC
+ * always does on x86.  An x86 build that doesn't target SSE2 (such as the
+ * default VS2008 Win32 build) checks the processor with CPUID at run time.
+ */
+#if defined(PNG_READ_SUPPORTED) && defined(PNG_READ_FILTER_SSE2) && \
+    (defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86))
+#  ifndef PNG_READ_FILTER_SSE2_SUPPORTED
+#    define PNG_READ_FILTER_SSE2_SUPPORTED
+#  endif
+#  if !defined(__SSE2__) && !defined(_M_X64) && \
+      !(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define PNG_READ_FILTER_SSE2_CHECK
+#  endif
+#endif
+
 #if defined(PNG_READ_SUPPORTED) && !defined(PNG_NO_ASSEMBLER_CODE)
 #  ifndef PNG_ASSEMBLER_CODE_SUPPORTED
 #    define PNG_ASSEMBLER_CODE_SUPPORTED
@@ -0,0 +1,333 @@
+/* pngfilter_sse2.c - SSE2 row filters for reading 3 and 4 byte pixels
+ *
+ * This code is released under the libpng license.
+ * For conditions of distribution and use, see the disclaimer
+ * and license in png.h
+ *
+ * png_read_filter_row() calls png_read_filter_row_sse2() first.  It
+ * undoes the Up filter for any pixel size, and the Sub, Average and Paeth
+ * filters for 3 byte (RGB) and 4 byte (RGBA) pixels, and returns 0 for
+ * the rows it leaves to the C code.
+ *
+ * Sub is a prefix sum of the row, computed 16 bytes at a time with
+ * shifted adds.  Average and Paeth depend on the pixel just decoded, so
+ * they go one pixel at a time, with all the bytes of the pixel at once.
+ * Paeth uses SSSE3 for the absolute values when the compiler targets it.
+ *
+ * A build that lists this file must define PNG_READ_FILTER_SSE2 for all of
+ * libpng's sources; without it this file is empty and pngrutil.c does not
+ * call it.
+ */
+
+#define PNG_INTERNAL
+#define PNG_NO_PEDANTIC_WARNINGS
+#include "png.h"
+#ifdef PNG_READ_FILTER_SSE2_SUPPORTED
+
+#include <string.h>
+#include <emmintrin.h>
+#ifdef __SSSE3__
+#  include <tmmintrin.h>
+#endif
+#ifdef PNG_READ_FILTER_SSE2_CHECK
+#  include <intrin.h>
+#endif
+
+/* Rows have no alignment, so 4 byte pixels go through memcpy().  A 3 byte
+ * pixel must not touch the byte after it, and is put together a byte at a
+ * time: a 3 byte memcpy() into a stack word stalls the load that follows.
+ */
+static __m128i
+png_load4(png_bytep p)
+{
+   int value;
+
+   memcpy(&value, p, 4);
+   return _mm_cvtsi32_si128(value);
+}
+
+static void
+png_store4(png_bytep p, __m128i v)
+{
+   int value = _mm_cvtsi128_si32(v);
+
+   memcpy(p, &value, 4);
+}
+
+static __m128i
+png_load3(png_bytep p)
+{
+   return _mm_cvtsi32_si128(p[0] | (p[1] << 8) | (p[2] << 16));
+}
+
+static void
+png_store3(png_bytep p, __m128i v)
+{
+   int value = _mm_cvtsi128_si32(v);
+
+   p[0] = (png_byte)value;
+   p[1] = (png_byte)(value >> 8);
+   p[2] = (png_byte)(value >> 16);
+}
+
+static void
+png_read_filter_row_up_sse2(png_uint_32 rowbytes, png_bytep row,
+   png_bytep prev_row)
+{
+   png_uint_32 i = 0;
+
+   for (; i + 16 <= rowbytes; i += 16)
+   {
+      __m128i x = _mm_loadu_si128((const __m128i *)(row + i));
+      __m128i b = _mm_loadu_si128((const __m128i *)(prev_row + i));
+
+      _mm_storeu_si128((__m128i *)(row + i), _mm_add_epi8(x, b));
+   }
+   for (; i < rowbytes; i++)
+      row[i] = (png_byte)(row[i] + prev_row[i]);
+}
+
+/* Each pass adds the decoded pixel before the block to the first pixel of
+ * the block, then turns the block into a running sum of its pixels.  With
+ * 3 byte pixels a block is five pixels.  It is stored as two overlapping
+ * 8 byte halves, leaving its 16th byte, which belongs to the next block,
+ * untouched and the next load clear of the stores.
+ */
+static void
+png_read_filter_row_sub4_sse2(png_uint_32 rowbytes, png_bytep row)
+{
+   __m128i a = _mm_setzero_si128();
+   png_uint_32 i = 0;
+
+   for (; i + 16 <= rowbytes; i += 16)
+   {
+      __m128i x = _mm_loadu_si128((const __m128i *)(row + i));
+
+      x = _mm_add_epi8(x, a);
+      x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+      x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+      _mm_storeu_si128((__m128i *)(row + i), x);
+      a = _mm_srli_si128(x, 12);
+   }
+   for (; i < rowbytes; i += 4)
+   {
+      a = _mm_add_epi8(png_load4(row + i), a);
+      png_store4(row + i, a);
+   }
+}
+
+static void
+png_read_filter_row_sub3_sse2(png_uint_32 rowbytes, png_bytep row)
+{
+   __m128i a = _mm_setzero_si128();
+   png_uint_32 i = 0;
+
+   for (; i + 16 <= rowbytes; i += 15)
+   {
+      __m128i x = _mm_loadu_si128((const __m128i *)(row + i));
+
+      x = _mm_add_epi8(x, a);
+      x = _mm_add_epi8(x, _mm_slli_si128(x, 3));
+      x = _mm_add_epi8(x, _mm_slli_si128(x, 6));
+      x = _mm_add_epi8(x, _mm_slli_si128(x, 12));
+      _mm_storel_epi64((__m128i *)(row + i), x);
+      _mm_storel_epi64((__m128i *)(row + i + 7), _mm_srli_si128(x, 7));
+      a = _mm_srli_si128(_mm_slli_si128(x, 1), 13);
+   }
+   for (; i < rowbytes; i += 3)
+   {
+      a = _mm_add_epi8(png_load3(row + i), a);
+      png_store3(row + i, a);
+   }
+}
+
+/* The byte average (a + b + 1) >> 1 rounds up; Average rounds down, which
+ * differs when a + b is odd.
+ */
+static __m128i
+png_avg_floor(__m128i a, __m128i b)
+{
+   __m128i odd = _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1));
+
+   return _mm_sub_epi8(_mm_avg_epu8(a, b), odd);
+}
+
+static void
+png_read_filter_row_avg4_sse2(png_uint_32 rowbytes, png_bytep row,
+   png_bytep prev_row)
+{
+   __m128i a = _mm_setzero_si128();
+   png_uint_32 i;
+
+   for (i = 0; i < rowbytes; i += 4)
+   {
+      __m128i b = png_load4(prev_row + i);
+
+      a = _mm_add_epi8(png_load4(row + i), png_avg_floor(a, b));
+      png_store4(row + i, a);
+   }
+}
+
+static void
+png_read_filter_row_avg3_sse2(png_uint_32 rowbytes, png_bytep row,
+   png_bytep prev_row)
+{
+   __m128i a = _mm_setzero_si128();
+   png_uint_32 i;
+
+   for (i = 0; i < rowbytes; i += 3)
+   {
+      __m128i b = png_load3(prev_row + i);
+
+      a = _mm_add_epi8(png_load3(row + i), png_avg_floor(a, b));
+      png_store3(row + i, a);
+   }
+}
+
+static __m128i
+png_abs_epi16(__m128i x)
+{
+#ifdef __SSSE3__
+   return _mm_abs_epi16(x);
+#else
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+#endif
+}
+
+static __m128i
+png_select(__m128i mask, __m128i if_set, __m128i if_clear)
+{
+   return _mm_or_si128(_mm_and_si128(mask, if_set),
+      _mm_andnot_si128(mask, if_clear));
+}
+
+/* Paeth predictor of the pixels a (left), b (above) and c (above left),
+ * all widened to 16 bits, with the ties broken as in the C code.  The
+ * callers keep the decoded pixel in 16 bit lanes too, so that the chain
+ * from one pixel to the next has no packs or unpacks in it.
+ */
+static __m128i
+png_paeth_predict(__m128i a, __m128i b, __m128i c)
+{
+   __m128i pa = _mm_sub_epi16(b, c);
+   __m128i pb = _mm_sub_epi16(a, c);
+   __m128i pc = _mm_add_epi16(pa, pb);
+   __m128i smallest;
+
+   pa = png_abs_epi16(pa);
+   pb = png_abs_epi16(pb);
+   pc = png_abs_epi16(pc);
+   smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+   return png_select(_mm_cmpeq_epi16(pa, smallest), a,
+      png_select(_mm_cmpeq_epi16(pb, smallest), b, c));
+}
+
+static void
+png_read_filter_row_paeth4_sse2(png_uint_32 rowbytes, png_bytep row,
+   png_bytep prev_row)
+{
+   __m128i zero = _mm_setzero_si128();
+   __m128i low_bytes = _mm_set1_epi16(0xff);
+   __m128i a = zero;
+   __m128i c = zero;
+   png_uint_32 i;
+
+   for (i = 0; i < rowbytes; i += 4)
+   {
+      __m128i b = _mm_unpacklo_epi8(png_load4(prev_row + i), zero);
+      __m128i x = _mm_unpacklo_epi8(png_load4(row + i), zero);
+
+      a = _mm_add_epi16(x, png_paeth_predict(a, b, c));
+      a = _mm_and_si128(a, low_bytes);
+      png_store4(row + i, _mm_packus_epi16(a, a));
+      c = b;
+   }
+}
+
+static void
+png_read_filter_row_paeth3_sse2(png_uint_32 rowbytes, png_bytep row,
+   png_bytep prev_row)
+{
+   __m128i zero = _mm_setzero_si128();
+   __m128i low_bytes = _mm_set1_epi16(0xff);
+   __m128i a = zero;
+   __m128i c = zero;
+   png_uint_32 i;
+
+   for (i = 0; i < rowbytes; i += 3)
+   {
+      __m128i b = _mm_unpacklo_epi8(png_load3(prev_row + i), zero);
+      __m128i x = _mm_unpacklo_epi8(png_load3(row + i), zero);
+
+      a = _mm_add_epi16(x, png_paeth_predict(a, b, c));
+      a = _mm_and_si128(a, low_bytes);
+      png_store3(row + i, _mm_packus_epi16(a, a));
+      c = b;
+   }
+}
+
+#ifdef PNG_READ_FILTER_SSE2_CHECK
+/* Returns 1 if the processor has SSE2.  The answer is the same on every
+ * thread, so racing to fill in the cache is harmless.
+ */
+static int
+png_sse2_available(void)
+{
+   static int available = -1;
+
+   if (available < 0)
+   {
+      int regs[4];
+
+      __cpuid(regs, 1);
+      available = (regs[3] & (1 << 26)) != 0;  /* EDX bit 26: SSE2 */
+   }
+   return available;
+}
+#endif
+
+int /* PRIVATE */
+png_read_filter_row_sse2(png_row_infop row_info, png_bytep row,
+   png_bytep prev_row, int filter)
+{
+   png_uint_32 rowbytes = row_info->rowbytes;
+   png_uint_32 bpp = (row_info->pixel_depth + 7) >> 3;
+
+#ifdef PNG_READ_FILTER_SSE2_CHECK
+   if (!png_sse2_available())
+      return 0;
+#endif
+   if (filter == PNG_FILTER_VALUE_UP)
+   {
+      png_read_filter_row_up_sse2(rowbytes, row, prev_row);
+      return 1;
+   }
+   /* The pixel loops below step a whole pixel at a time. */
+   if ((bpp != 3 && bpp != 4) || rowbytes % bpp != 0)
+      return 0;
+
+   switch (filter)
+   {
+      case PNG_FILTER_VALUE_SUB:
+         if (bpp == 4)
+            png_read_filter_row_sub4_sse2(rowbytes, row);
+         else
+            png_read_filter_row_sub3_sse2(rowbytes, row);
+         return 1;
+      case PNG_FILTER_VALUE_AVG:
+         if (bpp == 4)
+            png_read_filter_row_avg4_sse2(rowbytes, row, prev_row);
+         else
+            png_read_filter_row_avg3_sse2(rowbytes, row, prev_row);
+         return 1;
+      case PNG_FILTER_VALUE_PAETH:
+         if (bpp == 4)
+            png_read_filter_row_paeth4_sse2(rowbytes, row, prev_row);
+         else
+            png_read_filter_row_paeth3_sse2(rowbytes, row, prev_row);
+         return 1;
+      default:
+         return 0;
+   }
+}
+#endif /* PNG_READ_FILTER_SSE2_SUPPORTED */
@@ -2936,6 +2936,10 @@ png_read_filter_row(png_structp png_ptr, png_row_infop row_info, png_bytep row,
 {
    png_debug(1, "in png_read_filter_row");
    png_debug2(2, "row = %lu, filter = %d", png_ptr->row_number, filter);
+#ifdef PNG_READ_FILTER_SSE2_SUPPORTED
+   if (png_read_filter_row_sse2(row_info, row, prev_row, filter))
+      return;
+#endif
    switch (filter)
    {
       case PNG_FILTER_VALUE_NONE:
@@ -339,6 +339,7 @@
 #define png_read_destroy                wk_png_read_destroy
 #define png_read_end                    wk_png_read_end
 #define png_read_filter_row             wk_png_read_filter_row
+#define png_read_filter_row_sse2        wk_png_read_filter_row_sse2
 #define png_read_finish_row             wk_png_read_finish_row
 #define png_read_image                  wk_png_read_image
 #define png_read_info                   wk_png_read_info
@@ -6,7 +6,8 @@
 /* @(#) $Id: adler32.c,v 3.6 2005/08/04 19:14:14 tor%cs.brown.edu Exp $ */
 
 #define ZLIB_INTERNAL
-#include "zlib.h"
+#include "zutil.h"
+#include "adler32_simd.h"
 
 #define BASE 65521UL    /* largest prime smaller than 65536 */
 #define NMAX 5552
@@ -81,6 +82,22 @@ uLong ZEXPORT adler32(adler, buf, len)
     if (buf == Z_NULL)
         return 1L;
 
+#ifdef X86_SIMD
+    /* use the widest vector code the processor supports for long buffers */
+    if (len >= ADLER32_SIMD_MIN_LEN) {
+        int features = x86_cpu_features();
+
+        adler |= sum2 << 16;
+#  ifdef X86_AVX2
+        if (features & X86_CPU_AVX2)
+            return adler32_avx2(adler, buf, len);
+#  endif
+        if (features & X86_CPU_SSSE3)
+            return adler32_ssse3(adler, buf, len);
+        adler &= 0xffff;
+    }
+#endif /* X86_SIMD */
+
     /* in case short lengths are provided, keep it somewhat fast */
     if (len < 16) {
         while (len--) {
@@ -141,9 +158,9 @@ uLong ZEXPORT adler32_combine(adler1, adler2, len2)
     MOD(sum2);
     sum1 += (adler2 & 0xffff) + BASE - 1;
     sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + BASE - rem;
-    if (sum1 > BASE) sum1 -= BASE;
-    if (sum1 > BASE) sum1 -= BASE;
-    if (sum2 > (BASE << 1)) sum2 -= (BASE << 1);
-    if (sum2 > BASE) sum2 -= BASE;
+    if (sum1 >= BASE) sum1 -= BASE;
+    if (sum1 >= BASE) sum1 -= BASE;
+    if (sum2 >= (BASE << 1)) sum2 -= (BASE << 1);
+    if (sum2 >= BASE) sum2 -= BASE;
     return sum1 | (sum2 << 16);
 }
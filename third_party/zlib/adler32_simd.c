@@ -0,0 +1,193 @@
+/* adler32_simd.c -- Adler-32 using SSSE3 or AVX2
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Per block of n bytes b[0..n-1], the sums are updated as
+ *
+ *   s1' = s1 + b[0] + b[1] + ... + b[n-1]
+ *   s2' = s2 + n * s1 + n * b[0] + (n-1) * b[1] + ... + 1 * b[n-1]
+ *
+ * The byte sums come from PSADBW and the weighted sums from PMADDUBSW
+ * against a vector of descending taps.  The n * s1 terms are accumulated
+ * per block in v_ps and scaled once at the end of a run of blocks.  Runs
+ * are at most NMAX bytes long so that the 32 bit lanes cannot overflow
+ * before the sums are reduced modulo BASE.
+ */
+
+#include "zutil.h"
+#include "adler32_simd.h"
+
+#ifdef X86_SIMD
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#ifdef X86_AVX2
+#  include <immintrin.h>
+#endif
+
+#define BASE 65521U     /* largest prime smaller than 65536 */
+#define NMAX 5552
+/* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
+
+local uLong adler32_tail OF((unsigned s1, unsigned s2, const Bytef *buf,
+                             uInt len));
+
+/* ========================================================================= */
+/* Adds the last |len| bytes, fewer than a block, and joins the sums. */
+local uLong adler32_tail(s1, s2, buf, len)
+    unsigned s1;
+    unsigned s2;
+    const Bytef *buf;
+    uInt len;
+{
+    if (len) {
+        while (len--) {
+            s1 += *buf++;
+            s2 += s1;
+        }
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+    return (uLong)s1 | ((uLong)s2 << 16);
+}
+
+/* ========================================================================= */
+TARGET("ssse3")
+uLong adler32_ssse3(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    uInt len;
+{
+    unsigned s1 = (unsigned)(adler & 0xffff);
+    unsigned s2 = (unsigned)((adler >> 16) & 0xffff);
+    unsigned blocks = len / 32;
+
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                       24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                                       8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    len -= blocks * 32;
+    while (blocks) {
+        unsigned n = NMAX / 32;
+        __m128i v_ps, v_s1, v_s2, bytes1, bytes2, mad1, mad2;
+
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        v_ps = _mm_cvtsi32_si128((int)(s1 * n));
+        v_s1 = zero;
+        v_s2 = _mm_cvtsi32_si128((int)s2);
+        do {
+            bytes1 = _mm_loadu_si128((const __m128i *)buf);
+            bytes2 = _mm_loadu_si128((const __m128i *)(buf + 16));
+
+            /* The previous blocks' byte sums count once more per block. */
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            mad1 = _mm_maddubs_epi16(bytes1, tap1);
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(mad1, ones));
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            mad2 = _mm_maddubs_epi16(bytes2, tap2);
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(mad2, ones));
+
+            buf += 32;
+        } while (--n);
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        /* Sum the 32 bit lanes. */
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, 0xb1));
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, 0x4e));
+        s1 += (unsigned)_mm_cvtsi128_si32(v_s1);
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, 0xb1));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, 0x4e));
+        s2 = (unsigned)_mm_cvtsi128_si32(v_s2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+    return adler32_tail(s1, s2, buf, len);
+}
+
+#ifdef X86_AVX2
+
+/* ========================================================================= */
+TARGET("avx2")
+uLong adler32_avx2(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    uInt len;
+{
+    unsigned s1 = (unsigned)(adler & 0xffff);
+    unsigned s2 = (unsigned)((adler >> 16) & 0xffff);
+    unsigned blocks = len / 64;
+
+    const __m256i tap1 = _mm256_setr_epi8(64, 63, 62, 61, 60, 59, 58, 57,
+                                          56, 55, 54, 53, 52, 51, 50, 49,
+                                          48, 47, 46, 45, 44, 43, 42, 41,
+                                          40, 39, 38, 37, 36, 35, 34, 33);
+    const __m256i tap2 = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                          24, 23, 22, 21, 20, 19, 18, 17,
+                                          16, 15, 14, 13, 12, 11, 10, 9,
+                                          8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    len -= blocks * 64;
+    while (blocks) {
+        unsigned n = NMAX / 64;
+        __m256i v_ps, v_s1, v_s2, bytes1, bytes2, mad1, mad2;
+        __m128i sum1, sum2;
+
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        v_ps = _mm256_setr_epi32((int)(s1 * n), 0, 0, 0, 0, 0, 0, 0);
+        v_s1 = zero;
+        v_s2 = _mm256_setr_epi32((int)s2, 0, 0, 0, 0, 0, 0, 0);
+        do {
+            bytes1 = _mm256_loadu_si256((const __m256i *)buf);
+            bytes2 = _mm256_loadu_si256((const __m256i *)(buf + 32));
+
+            v_ps = _mm256_add_epi32(v_ps, v_s1);
+
+            v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes1, zero));
+            mad1 = _mm256_maddubs_epi16(bytes1, tap1);
+            v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(mad1, ones));
+
+            v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes2, zero));
+            mad2 = _mm256_maddubs_epi16(bytes2, tap2);
+            v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(mad2, ones));
+
+            buf += 64;
+        } while (--n);
+
+        v_s2 = _mm256_add_epi32(v_s2, _mm256_slli_epi32(v_ps, 6));
+
+        /* Sum the 32 bit lanes. */
+        sum1 = _mm_add_epi32(_mm256_castsi256_si128(v_s1),
+                             _mm256_extracti128_si256(v_s1, 1));
+        sum1 = _mm_add_epi32(sum1, _mm_shuffle_epi32(sum1, 0xb1));
+        sum1 = _mm_add_epi32(sum1, _mm_shuffle_epi32(sum1, 0x4e));
+        s1 += (unsigned)_mm_cvtsi128_si32(sum1);
+        sum2 = _mm_add_epi32(_mm256_castsi256_si128(v_s2),
+                             _mm256_extracti128_si256(v_s2, 1));
+        sum2 = _mm_add_epi32(sum2, _mm_shuffle_epi32(sum2, 0xb1));
+        sum2 = _mm_add_epi32(sum2, _mm_shuffle_epi32(sum2, 0x4e));
+        s2 = (unsigned)_mm_cvtsi128_si32(sum2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+    return adler32_tail(s1, s2, buf, len);
+}
+
+#endif /* X86_AVX2 */
+
+#endif /* X86_SIMD */
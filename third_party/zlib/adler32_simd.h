@@ -0,0 +1,29 @@
+/* adler32_simd.h -- Adler-32 using SSSE3 or AVX2
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef ADLER32_SIMD_H
+#define ADLER32_SIMD_H
+
+#include "cpu_features.h"
+
+#ifdef X86_SIMD
+
+/* adler32() uses the vector code for buffers of at least this many bytes. */
+#define ADLER32_SIMD_MIN_LEN 64
+
+/* Same as adler32() for a non-NULL |buf|.  Require X86_CPU_SSSE3 and
+   X86_CPU_AVX2 respectively. */
+uLong adler32_ssse3 OF((uLong adler, const Bytef *buf, uInt len));
+#ifdef X86_AVX2
+uLong adler32_avx2 OF((uLong adler, const Bytef *buf, uInt len));
+#endif
+
+#endif /* X86_SIMD */
+
+#endif /* ADLER32_SIMD_H */
@@ -0,0 +1,158 @@
+/* checksum_bench.c -- check and time crc32() and adler32()
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Checks the checksums against known values and against the table code,
+ * which is used for buffers shorter than the vector code's minimum length,
+ * over random lengths and alignments.  Then prints the throughput of both
+ * checksums for a range of buffer sizes.
+ *
+ * usage: checksum_bench [megabytes per size]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zlib.h"
+
+#define MAX_LEN (1 << 20)
+#define CHECK_ROUNDS 2000
+#define PIECE 15    /* below every vector code minimum length */
+
+typedef uLong (*checksum_func)(uLong, const Bytef *, uInt);
+
+static uLong crc32_func(uLong crc, const Bytef *buf, uInt len)
+{
+    return crc32(crc, buf, len);
+}
+
+static uLong adler32_func(uLong adler, const Bytef *buf, uInt len)
+{
+    return adler32(adler, buf, len);
+}
+
+/* Computes the checksum in pieces too short for the vector code. */
+static uLong checksum_pieces(checksum_func func, uLong sum, const Bytef *buf,
+                             uInt len)
+{
+    while (len > PIECE) {
+        sum = func(sum, buf, PIECE);
+        buf += PIECE;
+        len -= PIECE;
+    }
+    return func(sum, buf, len);
+}
+
+static int check_known(void)
+{
+    const Bytef *digits = (const Bytef *)"123456789";
+    const Bytef *word = (const Bytef *)"Wikipedia";
+    int failures = 0;
+    uLong sum;
+
+    sum = crc32(crc32(0L, Z_NULL, 0), digits, 9);
+    if (sum != 0xcbf43926UL) {
+        fprintf(stderr, "crc32(\"123456789\") = %08lx\n", sum);
+        failures++;
+    }
+    sum = adler32(adler32(0L, Z_NULL, 0), word, 9);
+    if (sum != 0x11e60398UL) {
+        fprintf(stderr, "adler32(\"Wikipedia\") = %08lx\n", sum);
+        failures++;
+    }
+    return failures;
+}
+
+static int check_random(const char *name, checksum_func func, Bytef *data)
+{
+    int failures = 0;
+    int round;
+
+    for (round = 0; round < CHECK_ROUNDS && failures < 10; round++) {
+        uInt offset = (uInt)(rand() % 64);
+        uInt len = (uInt)(rand() % (round < CHECK_ROUNDS / 2 ? 1024 : 65536));
+        uLong start = func(0L, Z_NULL, 0);
+        uLong expected, actual;
+
+        /* start from a non-trivial running sum every other round */
+        if (round & 1)
+            start = func(start, data + MAX_LEN - 100, 100);
+        expected = checksum_pieces(func, start, data + offset, len);
+        actual = func(start, data + offset, len);
+        if (actual != expected) {
+            fprintf(stderr, "%s mismatch: offset %u, length %u: "
+                    "%08lx != %08lx\n", name, offset, len, actual, expected);
+            failures++;
+        }
+    }
+
+    /* all 0xff bytes give the largest intermediate sums */
+    memset(data, 0xff, MAX_LEN);
+    if (func(1L, data, MAX_LEN) !=
+        checksum_pieces(func, 1L, data, MAX_LEN)) {
+        fprintf(stderr, "%s mismatch on 0xff bytes\n", name);
+        failures++;
+    }
+    return failures;
+}
+
+static void time_checksum(const char *name, checksum_func func,
+                          const Bytef *data, uInt len, double megabytes)
+{
+    long rounds = (long)(megabytes * 1024 * 1024 / len);
+    volatile uLong sink = 0;
+    clock_t start;
+    double seconds;
+    long i;
+
+    if (rounds < 1)
+        rounds = 1;
+    start = clock();
+    for (i = 0; i < rounds; i++)
+        sink += func(0L, data, len);
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (seconds <= 0)
+        seconds = 1e-9;
+    printf("%-8s %8u bytes: %9.1f MB/s\n", name, len,
+           (double)rounds * len / (1024 * 1024) / seconds);
+}
+
+int main(int argc, char **argv)
+{
+    static const uInt sizes[] = { 16, 64, 256, 1024, 4096, 65536, MAX_LEN };
+    double megabytes = argc > 1 ? atof(argv[1]) : 256;
+    Bytef *data;
+    int failures;
+    unsigned i;
+
+    data = (Bytef *)malloc(MAX_LEN);
+    if (data == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    srand(1);
+    for (i = 0; i < MAX_LEN; i++)
+        data[i] = (Bytef)rand();
+
+    failures = check_known();
+    failures += check_random("crc32", crc32_func, data);
+    for (i = 0; i < MAX_LEN; i++)
+        data[i] = (Bytef)rand();
+    failures += check_random("adler32", adler32_func, data);
+    if (failures) {
+        fprintf(stderr, "%d failures\n", failures);
+        free(data);
+        return 1;
+    }
+    printf("checksums match\n");
+
+    for (i = 0; i < MAX_LEN; i++)
+        data[i] = (Bytef)rand();
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        time_checksum("crc32", crc32_func, data, sizes[i], megabytes);
+        time_checksum("adler32", adler32_func, data, sizes[i], megabytes);
+    }
+    free(data);
+    return 0;
+}
@@ -0,0 +1,228 @@
+/* deflate_bench.c -- compression ratio and speed of deflate on sample data
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Compresses three generated corpora at several levels, checks that each
+ * stream inflates back to its input, and prints the ratio and speed:
+ *
+ *   png   filtered RGBA scanlines of a synthetic user interface screenshot
+ *   json  an array of similar records, as sent by web services
+ *   log   timestamped log lines
+ *
+ * The vector code (64-bit match compares, SSE2 hash table slides) is picked
+ * at run time.  Build a second copy with -DNO_SIMD and run both to compare
+ * against the portable code.  The CRC-32C hash, which changes the output, is
+ * only used in builds with -DDEFLATE_CRC32C_HASH.
+ *
+ * usage: deflate_bench [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zlib.h"
+
+#define PNG_WIDTH 1024
+#define PNG_HEIGHT 768
+#define TEXT_SIZE (2 * 1024 * 1024)
+
+typedef struct {
+    const char *name;
+    Bytef *data;
+    uLong size;
+} corpus;
+
+/* Appends the string to buf at *pos, up to limit bytes in all. */
+static void append(Bytef *buf, uLong *pos, uLong limit, const char *str)
+{
+    uLong len = (uLong)strlen(str);
+
+    if (len > limit - *pos)
+        len = limit - *pos;
+    memcpy(buf + *pos, str, len);
+    *pos += len;
+}
+
+/* A screenshot: a title bar, a toolbar of buttons, a list of rows of
+   "text", and a gradient side panel, stored as PNG scanlines with the Sub
+   filter that libpng picks for such images. */
+static corpus make_png(void)
+{
+    const uLong stride = PNG_WIDTH * 4 + 1;
+    corpus c;
+    Bytef *row;
+    int x, y;
+
+    c.name = "png";
+    c.size = stride * PNG_HEIGHT;
+    c.data = (Bytef *)malloc(c.size);
+    row = (Bytef *)malloc(PNG_WIDTH * 4);
+    if (c.data == NULL || row == NULL)
+        exit(1);
+    srand(2);
+    for (y = 0; y < PNG_HEIGHT; y++) {
+        Bytef *out = c.data + y * stride;
+
+        for (x = 0; x < PNG_WIDTH; x++) {
+            Bytef *px = row + x * 4;
+            int r = 0xf4, g = 0xf4, b = 0xf4;
+
+            if (y < 28) {                               /* title bar */
+                r = 0x3d; g = 0x6f; b = 0xb8 + y;
+            } else if (y < 60) {                        /* toolbar */
+                if ((x % 40) > 4 && (x % 40) < 36 && y > 32 && y < 56)
+                    r = g = b = 0xe0 - (y - 32) * 2;
+            } else if (x > PNG_WIDTH - 200) {           /* side panel */
+                r = 0xd0 + (y * 0x20) / PNG_HEIGHT;
+                g = 0xd8;
+                b = 0xe8 - (x - (PNG_WIDTH - 200)) / 8;
+            } else if ((y - 60) % 20 < 12 && x > 16 &&  /* list text */
+                       x < 16 + ((y / 20) * 37) % 500 + 100 &&
+                       (rand() & 3) == 0) {
+                r = g = b = 0x20 + (rand() & 0x3f);
+            }
+            if ((y - 60) % 20 == 19)                    /* row separator */
+                r = g = b = 0xdc;
+            px[0] = (Bytef)r;
+            px[1] = (Bytef)g;
+            px[2] = (Bytef)b;
+            px[3] = 0xff;
+        }
+        out[0] = 1;                                     /* Sub filter */
+        for (x = 0; x < PNG_WIDTH * 4; x++)
+            out[1 + x] = (Bytef)(row[x] - (x >= 4 ? row[x - 4] : 0));
+    }
+    free(row);
+    return c;
+}
+
+static corpus make_json(void)
+{
+    static const char *names[] = { "bookmark", "history", "download",
+                                   "extension", "preference" };
+    corpus c;
+    uLong pos = 0;
+    char item[512];
+    int i = 0;
+
+    c.name = "json";
+    c.data = (Bytef *)malloc(TEXT_SIZE);
+    if (c.data == NULL)
+        exit(1);
+    srand(3);
+    append(c.data, &pos, TEXT_SIZE, "[\n");
+    while (pos < TEXT_SIZE) {
+        sprintf(item,
+                "  {\"id\": %d, \"type\": \"%s\", \"title\": \"Item %d\", "
+                "\"url\": \"http://www.example.com/%s/%x\", "
+                "\"visits\": %d, \"starred\": %s, "
+                "\"last_visit\": \"2011-%02d-%02dT%02d:%02d:%02dZ\"},\n",
+                i, names[i % 5], i, names[rand() % 5], rand(),
+                rand() % 1000, rand() & 1 ? "true" : "false",
+                1 + rand() % 12, 1 + rand() % 28, rand() % 24, rand() % 60,
+                rand() % 60);
+        append(c.data, &pos, TEXT_SIZE, item);
+        i++;
+    }
+    c.size = pos;
+    return c;
+}
+
+static corpus make_log(void)
+{
+    static const char *messages[] = {
+        "Connection established to %d.%d.%d.%d:443",
+        "Cache hit for resource id %d (%d bytes)",
+        "Cache miss for resource id %d, fetching (%d bytes)",
+        "Renderer %d reported paint time %d ms",
+        "Checking for updates, next check in %d minutes (%d)",
+    };
+    static const char *levels[] = { "INFO", "INFO", "VERBOSE1", "WARNING" };
+    corpus c;
+    uLong pos = 0;
+    char message[256], line[512];
+    long ms = 0;
+
+    c.name = "log";
+    c.data = (Bytef *)malloc(TEXT_SIZE);
+    if (c.data == NULL)
+        exit(1);
+    srand(4);
+    while (pos < TEXT_SIZE) {
+        int kind = rand() % 5;
+
+        ms += rand() % 250;
+        sprintf(message, messages[kind], rand() % 256, rand() % 65536,
+                rand() % 256, rand() % 256);
+        sprintf(line, "[%d:%d:%02ld%02ld/%02ld%02ld%02ld.%03ld:%s:%s.cc(%d)] %s\n",
+                1000 + rand() % 4, 1000 + rand() % 16, 10L, 17L,
+                (ms / 3600000) % 24, (ms / 60000) % 60, (ms / 1000) % 60,
+                ms % 1000, levels[rand() % 4],
+                kind < 3 ? "network_delegate" : "render_process",
+                100 + kind * 37, message);
+        append(c.data, &pos, TEXT_SIZE, line);
+    }
+    c.size = pos;
+    return c;
+}
+
+/* Returns 0 if the data compresses and inflates back. */
+static int run(const corpus *c, int level, int rounds)
+{
+    uLong bound = compressBound(c->size);
+    Bytef *packed = (Bytef *)malloc(bound);
+    Bytef *unpacked = (Bytef *)malloc(c->size);
+    uLongf packed_size = 0, unpacked_size = c->size;
+    clock_t start;
+    double seconds;
+    int i;
+
+    if (packed == NULL || unpacked == NULL)
+        exit(1);
+    start = clock();
+    for (i = 0; i < rounds; i++) {
+        packed_size = bound;
+        if (compress2(packed, &packed_size, c->data, c->size, level) != Z_OK) {
+            fprintf(stderr, "%s: compress2 failed\n", c->name);
+            return 1;
+        }
+    }
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (seconds <= 0)
+        seconds = 1e-9;
+
+    if (uncompress(unpacked, &unpacked_size, packed, packed_size) != Z_OK ||
+        unpacked_size != c->size || memcmp(unpacked, c->data, c->size)) {
+        fprintf(stderr, "%s: level %d does not round trip\n", c->name, level);
+        return 1;
+    }
+    printf("%-5s level %d: %8lu -> %8lu bytes, ratio %6.2f, %7.1f MB/s\n",
+           c->name, level, c->size, (unsigned long)packed_size,
+           (double)c->size / packed_size,
+           (double)c->size * rounds / (1024 * 1024) / seconds);
+    free(packed);
+    free(unpacked);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const int levels[] = { 1, 3, 6, 9 };
+    int rounds = argc > 1 ? atoi(argv[1]) : 5;
+    corpus corpora[3];
+    int failures = 0;
+    unsigned i, j;
+
+    if (rounds < 1)
+        rounds = 1;
+    corpora[0] = make_png();
+    corpora[1] = make_json();
+    corpora[2] = make_log();
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < sizeof(levels) / sizeof(levels[0]); j++)
+            failures += run(&corpora[i], levels[j], rounds);
+        free(corpora[i].data);
+    }
+    return failures ? 1 : 0;
+}
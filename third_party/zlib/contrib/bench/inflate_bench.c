@@ -0,0 +1,235 @@
+/* inflate_bench.c -- check and time inflate()
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Compresses generated text, filtered image rows and random bytes with
+ * several window sizes, levels and strategies, and checks that inflate()
+ * gives the input back both with one large output buffer, where
+ * inflate_fast_chunk() does most of the work, and with small odd-sized
+ * buffers, where it runs at the edges of the buffers or not at all.  Then
+ * prints the inflate throughput for each kind of data.
+ *
+ * usage: inflate_bench [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zlib.h"
+
+#define DATA_SIZE (4 * 1024 * 1024)
+
+typedef struct {
+    const char *name;
+    Bytef *data;
+    uLong size;
+} sample;
+
+static void make_text(sample *s)
+{
+    static const char *words[] = { "the", "window", "view", "paint",
+                                   "layout", "bounds", "message", "loop",
+                                   "thread", "resource", "bitmap", "a" };
+    uLong pos = 0;
+
+    s->name = "text";
+    s->data = (Bytef *)malloc(DATA_SIZE);
+    if (s->data == NULL)
+        exit(1);
+    srand(6);
+    while (pos < DATA_SIZE) {
+        const char *word = words[rand() % 12];
+        size_t len = strlen(word);
+
+        if (len > DATA_SIZE - pos - 1)
+            break;
+        memcpy(s->data + pos, word, len);
+        pos += len;
+        s->data[pos++] = (Bytef)(rand() % 9 ? ' ' : '\n');
+    }
+    s->size = pos;
+}
+
+/* Rows of a 1024 pixel wide RGBA image with runs and short repeats, after
+   the PNG Sub filter: many matches at distances 1 to 16. */
+static void make_image(sample *s)
+{
+    uLong i;
+
+    s->name = "image";
+    s->size = DATA_SIZE;
+    s->data = (Bytef *)malloc(DATA_SIZE);
+    if (s->data == NULL)
+        exit(1);
+    srand(7);
+    for (i = 0; i < DATA_SIZE; i++) {
+        uLong x = (i / 4) % 1024;
+
+        if ((x / 64) % 3 == 0)
+            s->data[i] = 0;
+        else if ((x / 64) % 3 == 1)
+            s->data[i] = (Bytef)(i % 4 == 3 ? 0 : (x / 64) * 7);
+        else
+            s->data[i] = (Bytef)(rand() % 4 ? (int)(i % 5) : rand());
+    }
+}
+
+static void make_random(sample *s)
+{
+    uLong i;
+
+    s->name = "random";
+    s->size = DATA_SIZE / 4;
+    s->data = (Bytef *)malloc(s->size);
+    if (s->data == NULL)
+        exit(1);
+    srand(8);
+    for (i = 0; i < s->size; i++)
+        s->data[i] = (Bytef)rand();
+}
+
+static Bytef *deflate_sample(const sample *s, int level, int window_bits,
+                             int strategy, uLong *packed_size)
+{
+    z_stream strm;
+    /* Z_FIXED codes expand random bytes by up to an eighth. */
+    uLong bound = s->size + s->size / 4 + 1024;
+    Bytef *packed = (Bytef *)malloc(bound);
+
+    memset(&strm, 0, sizeof(strm));
+    if (packed == NULL ||
+        deflateInit2(&strm, level, Z_DEFLATED, window_bits, 8,
+                     strategy) != Z_OK)
+        exit(1);
+    strm.next_in = s->data;
+    strm.avail_in = (uInt)s->size;
+    strm.next_out = packed;
+    strm.avail_out = (uInt)bound;
+    if (deflate(&strm, Z_FINISH) != Z_STREAM_END)
+        exit(1);
+    *packed_size = strm.total_out;
+    deflateEnd(&strm);
+    return packed;
+}
+
+/* Inflates with output buffers of out_chunk bytes and input buffers of
+   in_chunk bytes, and compares the output with the sample. */
+static int check_inflate(const sample *s, const Bytef *packed,
+                         uLong packed_size, int window_bits,
+                         uInt in_chunk, uInt out_chunk)
+{
+    z_stream strm;
+    Bytef *out = (Bytef *)malloc(s->size + out_chunk);
+    uLong in_pos = 0;
+    int ret = Z_OK;
+
+    memset(&strm, 0, sizeof(strm));
+    if (out == NULL || inflateInit2(&strm, window_bits) != Z_OK)
+        exit(1);
+    strm.next_out = out;
+    while (ret == Z_OK) {
+        if (strm.avail_in == 0) {
+            uLong left = packed_size - in_pos;
+
+            strm.next_in = (Bytef *)packed + in_pos;
+            strm.avail_in = (uInt)(left < in_chunk ? left : in_chunk);
+            in_pos += strm.avail_in;
+        }
+        strm.avail_out = out_chunk;
+        ret = inflate(&strm, Z_NO_FLUSH);
+        if (ret == Z_BUF_ERROR && in_pos < packed_size)
+            ret = Z_OK;
+    }
+    inflateEnd(&strm);
+    ret = ret == Z_STREAM_END && strm.total_out == s->size &&
+          memcmp(out, s->data, s->size) == 0;
+    free(out);
+    if (!ret) {
+        fprintf(stderr, "%s: inflate mismatch (window %d, input %u, "
+                "output %u)\n", s->name, window_bits, in_chunk, out_chunk);
+        return 1;
+    }
+    return 0;
+}
+
+static int check_sample(const sample *s)
+{
+    static const int levels[] = { 1, 6, 9 };
+    static const int windows[] = { 9, 12, 15, -15, 31 };
+    static const int strategies[] = { Z_DEFAULT_STRATEGY, Z_FILTERED,
+                                      Z_RLE, Z_FIXED };
+    int failures = 0;
+    unsigned l, w, t;
+
+    for (l = 0; l < 3; l++)
+        for (w = 0; w < 5; w++)
+            for (t = 0; t < 4; t++) {
+                uLong packed_size;
+                Bytef *packed = deflate_sample(s, levels[l], windows[w],
+                                               strategies[t], &packed_size);
+
+                failures += check_inflate(s, packed, packed_size, windows[w],
+                                          (uInt)packed_size, (uInt)s->size);
+                failures += check_inflate(s, packed, packed_size, windows[w],
+                                          4093, 8191);
+                if (l == 1 && t == 0)
+                    failures += check_inflate(s, packed, packed_size,
+                                              windows[w], 7, 271);
+                free(packed);
+            }
+    return failures;
+}
+
+static void time_sample(const sample *s, int rounds)
+{
+    uLong packed_size;
+    Bytef *packed = deflate_sample(s, 6, 15, Z_DEFAULT_STRATEGY, &packed_size);
+    Bytef *out = (Bytef *)malloc(s->size);
+    uLongf out_size;
+    clock_t start;
+    double seconds;
+    int i;
+
+    if (out == NULL)
+        exit(1);
+    start = clock();
+    for (i = 0; i < rounds; i++) {
+        out_size = s->size;
+        if (uncompress(out, &out_size, packed, packed_size) != Z_OK)
+            exit(1);
+    }
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (seconds <= 0)
+        seconds = 1e-9;
+    printf("%-7s %8lu -> %8lu bytes: %7.1f MB/s\n", s->name, packed_size,
+           s->size, (double)s->size * rounds / (1024 * 1024) / seconds);
+    free(packed);
+    free(out);
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 20;
+    sample samples[3];
+    int failures = 0;
+    int i;
+
+    if (rounds < 1)
+        rounds = 1;
+    make_text(&samples[0]);
+    make_image(&samples[1]);
+    make_random(&samples[2]);
+    for (i = 0; i < 3; i++)
+        failures += check_sample(&samples[i]);
+    if (failures) {
+        fprintf(stderr, "%d failures\n", failures);
+        return 1;
+    }
+    printf("inflate output matches\n");
+    for (i = 0; i < 3; i++) {
+        time_sample(&samples[i], rounds);
+        free(samples[i].data);
+    }
+    return 0;
+}
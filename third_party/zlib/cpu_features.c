@@ -0,0 +1,103 @@
+/* cpu_features.c -- runtime detection of processor features
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zutil.h"
+#include "cpu_features.h"
+
+#ifdef X86_SIMD
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#else
+#  include <cpuid.h>
+#endif
+
+/* -1 until the processor has been queried */
+local volatile int features = -1;
+
+local void cpuid OF((unsigned leaf, unsigned subleaf, unsigned regs[4]));
+local int os_saves_ymm OF((void));
+local int query_features OF((void));
+
+/* ========================================================================= */
+local void cpuid(leaf, subleaf, regs)
+    unsigned leaf;
+    unsigned subleaf;
+    unsigned regs[4];
+{
+#if defined(_MSC_VER)
+    int info[4];
+
+    __cpuidex(info, (int)leaf, (int)subleaf);
+    regs[0] = (unsigned)info[0];
+    regs[1] = (unsigned)info[1];
+    regs[2] = (unsigned)info[2];
+    regs[3] = (unsigned)info[3];
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/* ========================================================================= */
+/* Returns true if the operating system saves the YMM registers on context
+   switches, which AVX2 code needs. */
+local int os_saves_ymm()
+{
+#if defined(_MSC_VER) && _MSC_FULL_VER >= 160040219
+    return (_xgetbv(0) & 6) == 6;
+#elif defined(_MSC_VER)
+    return 0;
+#else
+    unsigned eax, edx;
+
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (eax & 6) == 6;
+#endif
+}
+
+/* ========================================================================= */
+local int query_features()
+{
+    unsigned regs[4];
+    unsigned max_leaf;
+    int result = 0;
+
+    cpuid(0, 0, regs);
+    max_leaf = regs[0];
+    if (max_leaf < 1)
+        return 0;
+
+    cpuid(1, 0, regs);
+    if ((regs[2] & (1 << 1)) && (regs[2] & (1 << 19)))  /* PCLMUL, SSE4.1 */
+        result |= X86_CPU_PCLMUL;
+    if (regs[2] & (1 << 9))                             /* SSSE3 */
+        result |= X86_CPU_SSSE3;
+    if (regs[3] & (1 << 26))                            /* SSE2 */
+        result |= X86_CPU_SSE2;
+    if (regs[2] & (1 << 20))                            /* SSE4.2 */
+        result |= X86_CPU_SSE42;
+
+    /* AVX2 needs the AVX and OSXSAVE bits, the OS support and leaf 7. */
+    if ((regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && max_leaf >= 7 &&
+        os_saves_ymm()) {
+        cpuid(7, 0, regs);
+        if (regs[1] & (1 << 5))
+            result |= X86_CPU_AVX2;
+    }
+    return result;
+}
+
+/* ========================================================================= */
+int x86_cpu_features()
+{
+    int result = features;
+
+    if (result < 0) {
+        result = query_features();
+        features = result;
+    }
+    return result;
+}
+
+#endif /* X86_SIMD */
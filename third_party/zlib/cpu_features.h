@@ -0,0 +1,49 @@
+/* cpu_features.h -- runtime detection of processor features
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/* X86_SIMD is defined when the compiler can build the SSE/AVX2 code paths
+   without special command line flags.  Define NO_SIMD to build the portable
+   C code only. */
+#if !defined(NO_SIMD) && \
+    (defined(__x86_64__) || defined(__i386__) || \
+     defined(_M_X64) || defined(_M_IX86))
+#  if defined(__clang__) || (defined(__GNUC__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#    define X86_SIMD
+#    define X86_AVX2
+#    define TARGET(features) __attribute__((target(features)))
+#  elif defined(_MSC_VER) && _MSC_VER >= 1500
+#    define X86_SIMD
+#    if _MSC_VER >= 1700
+#      define X86_AVX2
+#    endif
+#    define TARGET(features)
+#  endif
+#endif
+
+#ifdef X86_SIMD
+
+/* Bits returned by x86_cpu_features() */
+#define X86_CPU_PCLMUL  1   /* PCLMULQDQ and SSE4.1 */
+#define X86_CPU_SSSE3   2
+#define X86_CPU_AVX2    4   /* AVX2, enabled by the operating system */
+#define X86_CPU_SSE2    8
+#define X86_CPU_SSE42   16  /* SSE4.2, including the CRC32 instruction */
+
+/* Returns the X86_CPU_* bits for the processor.  The first call queries the
+   processor; the result is then cached.  Safe to call from several threads:
+   racing first calls store the same value. */
+int x86_cpu_features OF((void));
+
+#endif /* X86_SIMD */
+
+#endif /* CPU_FEATURES_H */
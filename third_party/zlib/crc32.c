@@ -27,6 +27,7 @@
 #endif /* MAKECRCH */
 
 #include "zutil.h"      /* for STDC and FAR definitions */
+#include "crc32_simd.h"
 
 #define local static
 
@@ -228,6 +229,20 @@ unsigned long ZEXPORT crc32(crc, buf, len)
         make_crc_table();
 #endif /* DYNAMIC_CRC_TABLE */
 
+#ifdef X86_SIMD
+    /* fold the 16 byte multiple with PCLMULQDQ, then the rest by table */
+    if (len >= CRC32_PCLMUL_MIN_LEN && (x86_cpu_features() & X86_CPU_PCLMUL)) {
+        unsigned chunk = len & ~15U;
+
+        crc = crc32_pclmul((unsigned)crc ^ 0xffffffffU, buf, chunk) ^
+              0xffffffffUL;
+        buf += chunk;
+        len -= chunk;
+        if (len == 0)
+            return crc;
+    }
+#endif /* X86_SIMD */
+
 #ifdef BYFOUR
     if (sizeof(void *) == sizeof(ptrdiff_t)) {
         u4 endian;
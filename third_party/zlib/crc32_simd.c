@@ -0,0 +1,125 @@
+/* crc32_simd.c -- CRC-32 using carry-less multiplication
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Folds the data 64 bytes at a time with PCLMULQDQ and reduces the result
+ * with a Barrett reduction, as described in "Fast CRC Computation for
+ * Generic Polynomials Using PCLMULQDQ Instruction", V. Gopal, E. Ozturk,
+ * et al., Intel, 2009.  The constants are for the bit-reflected CRC-32
+ * polynomial 0x04c11db7 used by zlib.
+ */
+
+#include "zutil.h"
+#include "crc32_simd.h"
+
+#ifdef X86_SIMD
+
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+
+/* ========================================================================= */
+TARGET("sse4.1,pclmul")
+unsigned crc32_pclmul(crc, buf, len)
+    unsigned crc;
+    const unsigned char FAR *buf;
+    unsigned len;
+{
+    /* k1 = x^(4*128+32) mod P, k2 = x^(4*128-32) mod P: fold by 64 bytes.
+       k3 = x^(128+32) mod P, k4 = x^(128-32) mod P: fold by 16 bytes.
+       k5 = x^64 mod P: fold 96 bits to 64.
+       The low and high 32 bits of each 33-bit constant are given apart. */
+    const __m128i k1k2 = _mm_setr_epi32(0x54442bd4, 0x1, (int)0xc6e41596, 0x1);
+    const __m128i k3k4 = _mm_setr_epi32(0x751997d0, 0x1, (int)0xccaa009e, 0x0);
+    const __m128i k5k0 = _mm_setr_epi32(0x63cd6124, 0x1, 0x0, 0x0);
+    /* P' and mu for the Barrett reduction */
+    const __m128i poly = _mm_setr_epi32((int)0xdb710641, 0x1,
+                                        (int)0xf7011641, 0x1);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    /* There is at least one 64 byte block. */
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    buf += 64;
+    len -= 64;
+
+    /* Fold four 128 bit lanes in parallel while 64 byte blocks remain. */
+    x0 = k1k2;
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+        y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+        y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+        y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        buf += 64;
+        len -= 64;
+    }
+
+    /* Fold the four lanes into one. */
+    x0 = k3k4;
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* Fold in the remaining 16 byte blocks. */
+    while (len >= 16) {
+        x2 = _mm_loadu_si128((const __m128i *)buf);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        buf += 16;
+        len -= 16;
+    }
+
+    /* Fold 128 bits to 64. */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = k5k0;
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits. */
+    x0 = poly;
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (unsigned)_mm_extract_epi32(x1, 1);
+}
+
+#endif /* X86_SIMD */
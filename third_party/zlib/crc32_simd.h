@@ -0,0 +1,28 @@
+/* crc32_simd.h -- CRC-32 using carry-less multiplication
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef CRC32_SIMD_H
+#define CRC32_SIMD_H
+
+#include "cpu_features.h"
+
+#ifdef X86_SIMD
+
+/* crc32() uses crc32_pclmul() for buffers of at least this many bytes. */
+#define CRC32_PCLMUL_MIN_LEN 64
+
+/* Updates the bit-inverted CRC-32 |crc| (that is, the shift register value,
+   not the value crc32() returns) with |len| bytes at |buf|.  |len| must be a
+   multiple of 16 and at least 64.  Requires X86_CPU_PCLMUL. */
+unsigned crc32_pclmul OF((unsigned crc, const unsigned char FAR *buf,
+                          unsigned len));
+
+#endif /* X86_SIMD */
+
+#endif /* CRC32_SIMD_H */
@@ -50,6 +50,7 @@
 /* @(#) $Id: deflate.c,v 3.6 2005/08/04 19:14:14 tor%cs.brown.edu Exp $ */
 
 #include "deflate.h"
+#include "deflate_simd.h"
 
 const char deflate_copyright[] =
    " deflate 1.2.3 Copyright 1995-2005 Jean-loup Gailly ";
@@ -74,6 +75,7 @@ typedef block_state (*compress_func) OF((deflate_state *s, int flush));
 /* Compression function. Returns the block state after the call. */
 
 local void fill_window    OF((deflate_state *s));
+local void slide_hash     OF((deflate_state *s));
 local block_state deflate_stored OF((deflate_state *s, int flush));
 local block_state deflate_fast   OF((deflate_state *s, int flush));
 #ifndef FASTEST
@@ -169,6 +171,33 @@ struct static_tree_desc_s {int dummy;}; /* for buggy compilers */
  */
 #define UPDATE_HASH(s,h,c) (h = (((h)<<s->hash_shift) ^ (c)) & s->hash_mask)
 
+/* ===========================================================================
+ * The CRC-32C hash puts strings on different chains than the rolling hash, so
+ * deflate finds different matches with it. Choosing it by CPU would make the
+ * compressed bytes depend on the machine, so it is only used when the library
+ * is built with DEFLATE_CRC32C_HASH, by embedders that do not need identical
+ * output everywhere. Either way the output inflates with any zlib.
+ */
+#if defined(X86_SIMD) && defined(DEFLATE_CRC32C_HASH)
+#  define CRC32C_HASH
+#endif
+
+/* ===========================================================================
+ * Set ins_h to the hash of the string at window index str: either the rolling
+ * hash updated with the string's third byte, or the CRC-32C of its first four
+ * bytes when s->crc32c_hash is set. The CRC-32C hash does not depend on the
+ * previous value of ins_h, so the UPDATE_HASH calls that prime ins_h for the
+ * rolling hash are harmless for it.
+ */
+#ifdef CRC32C_HASH
+#define HASH_STRING(s, str) \
+   (s->crc32c_hash ? \
+    (s->ins_h = deflate_hash_crc32c(s->window + (str)) & s->hash_mask) : \
+    UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]))
+#else
+#define HASH_STRING(s, str) \
+   UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)])
+#endif
 
 /* ===========================================================================
  * Insert string str in the dictionary and set match_head to the previous head
@@ -182,12 +211,12 @@ struct static_tree_desc_s {int dummy;}; /* for buggy compilers */
  */
 #ifdef FASTEST
 #define INSERT_STRING(s, str, match_head) \
-   (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
+   (HASH_STRING(s, str), \
     match_head = s->head[s->ins_h], \
     s->head[s->ins_h] = (Pos)(str))
 #else
 #define INSERT_STRING(s, str, match_head) \
-   (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
+   (HASH_STRING(s, str), \
     match_head = s->prev[(str) & s->w_mask] = s->head[s->ins_h], \
     s->head[s->ins_h] = (Pos)(str))
 #endif
@@ -284,7 +313,8 @@ int ZEXPORT deflateInit2_(strm, level, method, windowBits, memLevel, strategy,
     s->hash_mask = s->hash_size - 1;
     s->hash_shift =  ((s->hash_bits+MIN_MATCH-1)/MIN_MATCH);
 
-    s->window = (Bytef *) ZALLOC(strm, s->w_size, 2*sizeof(Byte));
+    s->window = (Bytef *) ZALLOC(strm, s->w_size + WINDOW_PADDING,
+                                 2*sizeof(Byte));
     s->prev   = (Posf *)  ZALLOC(strm, s->w_size, sizeof(Pos));
     s->head   = (Posf *)  ZALLOC(strm, s->hash_size, sizeof(Pos));
 
@@ -304,6 +334,18 @@ int ZEXPORT deflateInit2_(strm, level, method, windowBits, memLevel, strategy,
     s->d_buf = overlay + s->lit_bufsize/sizeof(ush);
     s->l_buf = s->pending_buf + (1+sizeof(ush))*s->lit_bufsize;
 
+#ifdef CRC32C_HASH
+    s->crc32c_hash = (x86_cpu_features() & X86_CPU_SSE42) != 0;
+#else
+    s->crc32c_hash = 0;
+#endif
+    if (s->crc32c_hash) {
+        /* The hash reads a byte past the input at its end; zero the window
+         * so that the output does not depend on uninitialized memory.
+         */
+        zmemzero(s->window, (s->w_size + WINDOW_PADDING) * (2*sizeof(Byte)));
+    }
+
     s->level = level;
     s->strategy = strategy;
     s->method = (Byte)method;
@@ -917,7 +959,8 @@ int ZEXPORT deflateCopy (dest, source)
     zmemcpy(ds, ss, sizeof(deflate_state));
     ds->strm = dest;
 
-    ds->window = (Bytef *) ZALLOC(dest, ds->w_size, 2*sizeof(Byte));
+    ds->window = (Bytef *) ZALLOC(dest, ds->w_size + WINDOW_PADDING,
+                                  2*sizeof(Byte));
     ds->prev   = (Posf *)  ZALLOC(dest, ds->w_size, sizeof(Pos));
     ds->head   = (Posf *)  ZALLOC(dest, ds->hash_size, sizeof(Pos));
     overlay = (ushf *) ZALLOC(dest, ds->lit_bufsize, sizeof(ush)+2);
@@ -929,7 +972,8 @@ int ZEXPORT deflateCopy (dest, source)
         return Z_MEM_ERROR;
     }
     /* following zmemcpy do not work for 16-bit MSDOS */
-    zmemcpy(ds->window, ss->window, ds->w_size * 2 * sizeof(Byte));
+    zmemcpy(ds->window, ss->window,
+            (ds->w_size + WINDOW_PADDING) * 2 * sizeof(Byte));
     zmemcpy(ds->prev, ss->prev, ds->w_size * sizeof(Pos));
     zmemcpy(ds->head, ss->head, ds->hash_size * sizeof(Pos));
     zmemcpy(ds->pending_buf, ss->pending_buf, (uInt)ds->pending_buf_size);
@@ -1011,6 +1055,48 @@ local void lm_init (s)
 }
 
 #ifndef FASTEST
+/* ===========================================================================
+ * On 64-bit little-endian processors that allow unaligned loads, compare
+ * eight bytes at a time: the first differing byte is the lowest nonzero byte
+ * of the exclusive or of the two words. The match lengths are the same as
+ * with byte compares, so the output does not change.
+ */
+#if !defined(UNALIGNED_OK) && !defined(NO_UNALIGNED64) && \
+    (defined(__x86_64__) || defined(_M_X64)) && \
+    (defined(__GNUC__) || defined(_MSC_VER))
+#  define UNALIGNED64_OK
+#  ifdef _MSC_VER
+#    include <intrin.h>
+     typedef unsigned __int64 u8w;
+#  else
+     typedef unsigned long long u8w;
+#  endif
+
+local u8w load64 OF((const Bytef *p));
+local int first_diff_byte OF((u8w diff));
+
+local u8w load64(p)
+    const Bytef *p;
+{
+    u8w w;
+    zmemcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/* Returns the index of the lowest nonzero byte of diff, which is not 0. */
+local int first_diff_byte(diff)
+    u8w diff;
+{
+#  ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward64(&bit, diff);
+    return (int)(bit >> 3);
+#  else
+    return __builtin_ctzll(diff) >> 3;
+#  endif
+}
+#endif /* UNALIGNED64_OK */
+
 /* ===========================================================================
  * Set match_start to the longest match starting at the given string and
  * return its length. Matches shorter or equal to prev_length are discarded,
@@ -1054,6 +1140,9 @@ local uInt longest_match(s, cur_match)
     register Byte scan_end1  = scan[best_len-1];
     register Byte scan_end   = scan[best_len];
 #endif
+#ifdef UNALIGNED64_OK
+    u8w diff;
+#endif
 
     /* The code is optimized for HASH_BITS >= 8 and MAX_MATCH-2 multiple of 16.
      * It is easy to get rid of this optimization if necessary.
@@ -1116,6 +1205,32 @@ local uInt longest_match(s, cur_match)
         len = (MAX_MATCH - 1) - (int)(strend-scan);
         scan = strend - (MAX_MATCH-1);
 
+#elif defined(UNALIGNED64_OK) && MAX_MATCH == 258
+
+        if (match[best_len]   != scan_end  ||
+            match[best_len-1] != scan_end1 ||
+            *match            != *scan     ||
+            match[1]          != scan[1])      continue;
+
+        /* Compare 8 bytes at a time at strstart+2, +10, ... up to
+         * strstart+257: MAX_MATCH-2 is a multiple of 8, so the loads never
+         * go past strend.
+         */
+        scan += 2, match += 2;
+        do {
+            diff = load64(scan) ^ load64(match);
+            if (diff != 0) {
+                scan += first_diff_byte(diff);
+                break;
+            }
+            scan += 8, match += 8;
+        } while (scan < strend);
+
+        Assert(scan <= s->window+(unsigned)(s->window_size-1), "wild scan");
+
+        len = MAX_MATCH - (int)(strend - scan);
+        scan = strend - MAX_MATCH;
+
 #else /* UNALIGNED_OK */
 
         if (match[best_len]   != scan_end  ||
@@ -1253,6 +1368,51 @@ local void check_match(s, start, match, length)
 #  define check_match(s, start, match, length)
 #endif /* DEBUG */
 
+/* ===========================================================================
+ * Slide the hash table (could be avoided with 32 bit values at the expense
+ * of memory usage) after the window has moved down by w_size. We slide even
+ * when level == 0 to keep the hash table consistent if we switch back to
+ * level > 0 later. (Using level 0 permanently is not an optimal usage of
+ * zlib, so we don't care about this pathological case.)
+ */
+local void slide_hash(s)
+    deflate_state *s;
+{
+    register unsigned n, m;
+    register Posf *p;
+    uInt wsize = s->w_size;
+
+#ifdef X86_SIMD
+    if (x86_cpu_features() & X86_CPU_SSE2) {
+        slide_hash_sse2(s->head, s->hash_size, wsize);
+#ifndef FASTEST
+        slide_hash_sse2(s->prev, wsize, wsize);
+#endif
+        return;
+    }
+#endif /* X86_SIMD */
+
+    /* %%% avoid this when Z_RLE */
+    n = s->hash_size;
+    p = &s->head[n];
+    do {
+        m = *--p;
+        *p = (Pos)(m >= wsize ? m-wsize : NIL);
+    } while (--n);
+
+    n = wsize;
+#ifndef FASTEST
+    p = &s->prev[n];
+    do {
+        m = *--p;
+        *p = (Pos)(m >= wsize ? m-wsize : NIL);
+        /* If n is not on any hash chain, prev[n] is garbage but
+         * its value will never be used.
+         */
+    } while (--n);
+#endif
+}
+
 /* ===========================================================================
  * Fill the window when the lookahead becomes insufficient.
  * Updates strstart and lookahead.
@@ -1266,8 +1426,7 @@ local void check_match(s, start, match, length)
 local void fill_window(s)
     deflate_state *s;
 {
-    register unsigned n, m;
-    register Posf *p;
+    register unsigned n;
     unsigned more;    /* Amount of free space at the end of the window. */
     uInt wsize = s->w_size;
 
@@ -1297,31 +1456,7 @@ local void fill_window(s)
             s->strstart    -= wsize; /* we now have strstart >= MAX_DIST */
             s->block_start -= (long) wsize;
 
-            /* Slide the hash table (could be avoided with 32 bit values
-               at the expense of memory usage). We slide even when level == 0
-               to keep the hash table consistent if we switch back to level > 0
-               later. (Using level 0 permanently is not an optimal usage of
-               zlib, so we don't care about this pathological case.)
-             */
-            /* %%% avoid this when Z_RLE */
-            n = s->hash_size;
-            p = &s->head[n];
-            do {
-                m = *--p;
-                *p = (Pos)(m >= wsize ? m-wsize : NIL);
-            } while (--n);
-
-            n = wsize;
-#ifndef FASTEST
-            p = &s->prev[n];
-            do {
-                m = *--p;
-                *p = (Pos)(m >= wsize ? m-wsize : NIL);
-                /* If n is not on any hash chain, prev[n] is garbage but
-                 * its value will never be used.
-                 */
-            } while (--n);
-#endif
+            slide_hash(s);
             more += wsize;
         }
         if (s->strm->avail_in == 0) return;
@@ -122,7 +122,8 @@ typedef struct internal_state {
 
     ulg window_size;
     /* Actual size of window: 2*wSize, except when the user input buffer
-     * is directly used as sliding window.
+     * is directly used as sliding window.  The allocation has
+     * 2*WINDOW_PADDING more bytes at the end; see deflate_hash_crc32c().
      */
 
     Posf *prev;
@@ -260,6 +261,12 @@ typedef struct internal_state {
      * are always zero.
      */
 
+    int crc32c_hash;
+    /* Hash the four bytes at a position with CRC-32C instead of keeping the
+     * rolling hash of three bytes in ins_h.  Strings that only share three
+     * bytes no longer share hash chains, so the chains are shorter.
+     */
+
 } FAR deflate_state;
 
 /* Output a byte on the stream.
@@ -268,6 +275,11 @@ typedef struct internal_state {
 #define put_byte(s, c) {s->pending_buf[s->pending++] = (c);}
 
 
+#define WINDOW_PADDING 8
+/* The window is allocated as 2*(w_size+WINDOW_PADDING) bytes, so that
+ * hashes may read a few bytes past the end of the input.
+ */
+
 #define MIN_LOOKAHEAD (MAX_MATCH+MIN_MATCH+1)
 /* Minimum amount of lookahead, except at the end of the input file.
  * See deflate.c for comments about the MIN_MATCH+1.
@@ -0,0 +1,41 @@
+/* deflate_simd.c -- vector helpers for deflate
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "deflate.h"
+#include "deflate_simd.h"
+
+#ifdef X86_SIMD
+
+#include <emmintrin.h>
+#include <nmmintrin.h>
+
+/* ========================================================================= */
+TARGET("sse4.2")
+unsigned deflate_hash_crc32c(str)
+    const Bytef *str;
+{
+    unsigned value;
+
+    zmemcpy(&value, str, sizeof(value));
+    return _mm_crc32_u32(0, value);
+}
+
+/* ========================================================================= */
+TARGET("sse2")
+void slide_hash_sse2(table, entries, wsize)
+    Posf *table;
+    unsigned entries;
+    unsigned wsize;
+{
+    /* The unsigned saturating subtraction maps m to m - wsize when
+       m >= wsize and to NIL (0) otherwise, as the scalar loop does. */
+    const __m128i delta = _mm_set1_epi16((short)wsize);
+    __m128i *p = (__m128i *)table;
+
+    Assert(entries % 8 == 0, "slide_hash_sse2: entries % 8 != 0");
+    for (entries /= 8; entries; entries--, p++)
+        _mm_storeu_si128(p, _mm_subs_epu16(_mm_loadu_si128(p), delta));
+}
+
+#endif /* X86_SIMD */
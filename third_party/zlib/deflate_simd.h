@@ -0,0 +1,30 @@
+/* deflate_simd.h -- vector helpers for deflate
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef DEFLATE_SIMD_H
+#define DEFLATE_SIMD_H
+
+#include "cpu_features.h"
+
+#ifdef X86_SIMD
+
+/* Returns the CRC-32C of the four bytes at |str|, to be masked down to a
+   hash index.  Reads one byte beyond the MIN_MATCH bytes the rolling hash
+   uses, so the window has WINDOW_PADDING bytes of slack.  Requires
+   X86_CPU_SSE42. */
+unsigned deflate_hash_crc32c OF((const Bytef *str));
+
+/* Rebases the |entries| positions of a hash table after the window slides
+   down by |wsize|: positions below |wsize| become NIL.  |entries| must be a
+   multiple of 8.  Requires X86_CPU_SSE2. */
+void slide_hash_sse2 OF((Posf *table, unsigned entries, unsigned wsize));
+
+#endif /* X86_SIMD */
+
+#endif /* DEFLATE_SIMD_H */
@@ -0,0 +1,379 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "third_party/zlib/google/gzip_stream.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/file_path.h"
+#include "base/logging.h"
+#include "build/build_config.h"
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <fcntl.h>
+#endif
+
+namespace {
+
+// Bytes read from the file at a time by the reader.
+const size_t kInputSize = 1024 * 1024;
+
+// Bytes past the chunk being inflated that the reader asks the kernel to
+// read ahead.
+const size_t kReadAheadSize = 2 * kInputSize;
+
+// Size of each of the two buffers the reader inflates into and the writer
+// fills, and of the output the writer deflates into.
+const size_t kBufferSize = 1024 * 1024;
+
+// windowBits for a gzip header and trailer instead of zlib ones.
+const int kGzipWindowBits = MAX_WBITS + 16;
+
+// Same as deflateInit().
+const int kMemLevel = 8;
+
+// Tells the kernel that |file| will be read sequentially from |offset|, so
+// that it reads ahead of the reader.
+void AdviseReadAhead(base::PlatformFile file, int64 offset, bool sequential) {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  if (sequential)
+    posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+  posix_fadvise(file, offset, kReadAheadSize, POSIX_FADV_WILLNEED);
+#endif
+}
+
+}  // namespace
+
+namespace zlib {
+
+GzipReader::Buffer::Buffer()
+    : size(0),
+      read_pos(0),
+      full(false),
+      last(false) {
+}
+
+GzipReader::GzipReader()
+    : file_(base::kInvalidPlatformFileValue),
+      input_offset_(0),
+      member_ended_(false),
+      read_index_(0),
+      buffer_changed_(&lock_),
+      stopping_(false),
+      succeeded_(true) {
+  memset(&stream_, 0, sizeof(stream_));
+}
+
+GzipReader::~GzipReader() {
+  if (thread_.get()) {
+    {
+      base::AutoLock lock(lock_);
+      stopping_ = true;
+      buffer_changed_.Signal();
+    }
+    thread_->Join();
+    inflateEnd(&stream_);
+  }
+  if (file_ != base::kInvalidPlatformFileValue)
+    base::ClosePlatformFile(file_);
+}
+
+bool GzipReader::Open(const FilePath& path) {
+  base::PlatformFile file = base::CreatePlatformFile(
+      path, base::PLATFORM_FILE_OPEN | base::PLATFORM_FILE_READ, NULL, NULL);
+  if (file == base::kInvalidPlatformFileValue)
+    return false;
+  return Open(file);
+}
+
+bool GzipReader::Open(base::PlatformFile file) {
+  DCHECK(!thread_.get());
+  DCHECK_EQ(file_, base::kInvalidPlatformFileValue);
+  file_ = file;
+  if (inflateInit2(&stream_, kGzipWindowBits) != Z_OK)
+    return false;
+
+  AdviseReadAhead(file_, 0, true);
+  input_.resize(kInputSize);
+  for (size_t i = 0; i < arraysize(buffers_); ++i)
+    buffers_[i].data.resize(kBufferSize);
+  thread_.reset(new base::DelegateSimpleThread(this, "gzip_reader"));
+  thread_->Start();
+  return true;
+}
+
+int GzipReader::Read(char* data, int size) {
+  DCHECK(thread_.get());
+  DCHECK_GE(size, 0);
+  int copied = 0;
+  while (copied < size) {
+    Buffer* buffer = &buffers_[read_index_];
+    if (buffer->read_pos == 0) {
+      // Wait for the background thread to fill the buffer. A buffer that
+      // has been read from is known to be full.
+      base::AutoLock lock(lock_);
+      while (!buffer->full)
+        buffer_changed_.Wait();
+    }
+
+    size_t available = buffer->size - buffer->read_pos;
+    size_t chunk = std::min(available, static_cast<size_t>(size - copied));
+    memcpy(data + copied, &buffer->data[buffer->read_pos], chunk);
+    copied += static_cast<int>(chunk);
+    buffer->read_pos += chunk;
+    if (buffer->read_pos < buffer->size)
+      continue;
+
+    if (buffer->last) {
+      // The last buffer is kept, so that later calls end here too.
+      if (copied > 0)
+        return copied;
+      base::AutoLock lock(lock_);
+      return succeeded_ ? 0 : -1;
+    }
+
+    // Give the buffer back to the background thread.
+    base::AutoLock lock(lock_);
+    buffer->read_pos = 0;
+    buffer->full = false;
+    buffer_changed_.Signal();
+    read_index_ ^= 1;
+  }
+  return copied;
+}
+
+void GzipReader::Run() {
+  bool end = false;
+  for (int index = 0; !end; index ^= 1) {
+    Buffer* buffer = &buffers_[index];
+    {
+      base::AutoLock lock(lock_);
+      while (buffer->full && !stopping_)
+        buffer_changed_.Wait();
+      if (stopping_)
+        return;
+    }
+
+    bool succeeded = FillBuffer(buffer, &end);
+
+    base::AutoLock lock(lock_);
+    if (!succeeded) {
+      succeeded_ = false;
+      end = true;
+    }
+    buffer->last = end;
+    buffer->full = true;
+    buffer_changed_.Signal();
+  }
+}
+
+bool GzipReader::FillBuffer(Buffer* buffer, bool* end) {
+  stream_.next_out = reinterpret_cast<Bytef*>(&buffer->data[0]);
+  stream_.avail_out = static_cast<uInt>(buffer->data.size());
+  bool succeeded = true;
+  while (stream_.avail_out > 0) {
+    if (stream_.avail_in == 0) {
+      succeeded = ReadInput(end);
+      if (!succeeded || *end)
+        break;
+    }
+
+    // Another gzip member follows the one that ended.
+    if (member_ended_) {
+      inflateReset(&stream_);
+      member_ended_ = false;
+    }
+
+    int result = inflate(&stream_, Z_NO_FLUSH);
+    if (result == Z_STREAM_END) {
+      member_ended_ = true;
+    } else if (result != Z_OK) {
+      succeeded = false;
+      break;
+    }
+  }
+  buffer->size = buffer->data.size() - stream_.avail_out;
+
+  // A file that ends inside a member is truncated, and an empty one is not
+  // a gzip file.
+  if (*end && !member_ended_)
+    succeeded = false;
+  return succeeded;
+}
+
+bool GzipReader::ReadInput(bool* end) {
+  int read = base::ReadPlatformFile(file_, input_offset_, &input_[0],
+                                    static_cast<int>(input_.size()));
+  if (read < 0)
+    return false;
+  if (read == 0) {
+    *end = true;
+    return true;
+  }
+  input_offset_ += read;
+  AdviseReadAhead(file_, input_offset_, false);
+  stream_.next_in = reinterpret_cast<Bytef*>(&input_[0]);
+  stream_.avail_in = static_cast<uInt>(read);
+  return true;
+}
+
+GzipWriter::Buffer::Buffer()
+    : size(0),
+      flush(Z_NO_FLUSH),
+      queued(false) {
+}
+
+GzipWriter::GzipWriter(int level)
+    : level_(level),
+      file_(base::kInvalidPlatformFileValue),
+      output_offset_(0),
+      write_index_(0),
+      write_failed_(false),
+      buffer_changed_(&lock_),
+      succeeded_(true) {
+  memset(&stream_, 0, sizeof(stream_));
+}
+
+GzipWriter::~GzipWriter() {
+  if (thread_.get())
+    Close();
+  else if (file_ != base::kInvalidPlatformFileValue)
+    base::ClosePlatformFile(file_);
+}
+
+bool GzipWriter::Open(const FilePath& path) {
+  base::PlatformFile file = base::CreatePlatformFile(
+      path, base::PLATFORM_FILE_CREATE_ALWAYS | base::PLATFORM_FILE_WRITE,
+      NULL, NULL);
+  if (file == base::kInvalidPlatformFileValue)
+    return false;
+  return Open(file);
+}
+
+bool GzipWriter::Open(base::PlatformFile file) {
+  DCHECK(!thread_.get());
+  DCHECK_EQ(file_, base::kInvalidPlatformFileValue);
+  file_ = file;
+  if (deflateInit2(&stream_, level_, Z_DEFLATED, kGzipWindowBits, kMemLevel,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+
+  output_.resize(kBufferSize);
+  for (size_t i = 0; i < arraysize(buffers_); ++i)
+    buffers_[i].data.resize(kBufferSize);
+  thread_.reset(new base::DelegateSimpleThread(this, "gzip_writer"));
+  thread_->Start();
+  return true;
+}
+
+bool GzipWriter::Write(const char* data, size_t size) {
+  DCHECK(thread_.get());
+  while (size > 0) {
+    Buffer* buffer = &buffers_[write_index_];
+    size_t chunk = std::min(size, buffer->data.size() - buffer->size);
+    memcpy(&buffer->data[buffer->size], data, chunk);
+    buffer->size += chunk;
+    data += chunk;
+    size -= chunk;
+    if (buffer->size == buffer->data.size())
+      Submit(Z_NO_FLUSH);
+  }
+  return !write_failed_;
+}
+
+void GzipWriter::Append(const std::string& data) {
+  Write(data.data(), data.size());
+}
+
+GzipWriter::OutputCallback GzipWriter::GetCallback() {
+  return base::Bind(&GzipWriter::Append, base::Unretained(this));
+}
+
+void GzipWriter::Flush() {
+  DCHECK(thread_.get());
+  Submit(Z_SYNC_FLUSH);
+}
+
+bool GzipWriter::Close() {
+  DCHECK(thread_.get());
+  Submit(Z_FINISH);
+  thread_->Join();
+  thread_.reset();
+  deflateEnd(&stream_);
+
+  bool succeeded = base::ClosePlatformFile(file_);
+  file_ = base::kInvalidPlatformFileValue;
+  base::AutoLock lock(lock_);
+  return succeeded_ && succeeded;
+}
+
+void GzipWriter::Run() {
+  for (int index = 0; ; index ^= 1) {
+    Buffer* buffer = &buffers_[index];
+    bool succeeded;
+    {
+      base::AutoLock lock(lock_);
+      while (!buffer->queued)
+        buffer_changed_.Wait();
+      succeeded = succeeded_;
+    }
+
+    // After a failure the rest of the data is dropped.
+    if (succeeded)
+      succeeded = DeflateBuffer(*buffer);
+
+    int flush = buffer->flush;
+    {
+      base::AutoLock lock(lock_);
+      if (!succeeded)
+        succeeded_ = false;
+      buffer->size = 0;
+      buffer->queued = false;
+      buffer_changed_.Signal();
+    }
+    if (flush == Z_FINISH)
+      return;
+  }
+}
+
+bool GzipWriter::DeflateBuffer(const Buffer& buffer) {
+  stream_.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(&buffer.data[0]));
+  stream_.avail_in = static_cast<uInt>(buffer.size);
+  do {
+    stream_.next_out = reinterpret_cast<Bytef*>(&output_[0]);
+    stream_.avail_out = static_cast<uInt>(output_.size());
+    if (deflate(&stream_, buffer.flush) == Z_STREAM_ERROR)
+      return false;
+    int size = static_cast<int>(output_.size() - stream_.avail_out);
+    if (size > 0 &&
+        base::WritePlatformFile(file_, output_offset_, &output_[0], size) !=
+            size) {
+      return false;
+    }
+    output_offset_ += size;
+  } while (stream_.avail_out == 0);
+  return true;
+}
+
+void GzipWriter::Submit(int flush) {
+  base::AutoLock lock(lock_);
+  Buffer* buffer = &buffers_[write_index_];
+  buffer->flush = flush;
+  buffer->queued = true;
+  buffer_changed_.Signal();
+
+  // Wait for the background thread to finish with the other buffer, if it
+  // has not yet.
+  write_index_ ^= 1;
+  while (buffers_[write_index_].queued)
+    buffer_changed_.Wait();
+  write_failed_ = !succeeded_;
+}
+
+}  // namespace zlib
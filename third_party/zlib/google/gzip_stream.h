@@ -0,0 +1,203 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef THIRD_PARTY_ZLIB_GOOGLE_GZIP_STREAM_H_
+#define THIRD_PARTY_ZLIB_GOOGLE_GZIP_STREAM_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/platform_file.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/simple_thread.h"
+#include "third_party/zlib/zlib.h"
+
+class FilePath;
+
+namespace zlib {
+
+// Reads a gzip file on a background thread. gzread() reads 16 KB at a time
+// through stdio and inflates on the caller's thread; the reader instead
+// reads the file in large chunks, asks the kernel to read ahead of them, and
+// inflates into two buffers in turn, so that reading the file and inflating
+// it overlap with the caller using the data. Files of several concatenated
+// gzip members, as written by "cat a.gz b.gz", are read as one.
+//
+// The reader is used from one thread, as a file is.
+class GzipReader : public base::DelegateSimpleThread::Delegate {
+ public:
+  GzipReader();
+  virtual ~GzipReader();
+
+  // Opens the file at |path| and starts inflating it. Returns false if the
+  // file cannot be opened.
+  bool Open(const FilePath& path);
+
+  // Same as above for a file that is already open, for instance by
+  // base::FileUtilProxy::CreateOrOpen(). The reader takes ownership of
+  // |file| and reads it from the start.
+  bool Open(base::PlatformFile file);
+
+  // Copies up to |size| bytes of the inflated data to |data|. Returns the
+  // number of bytes copied, which is less than |size| only at the end of the
+  // data, 0 at the end, or -1 if the file cannot be read or is not a valid
+  // gzip file. The data before a corrupt part is returned first.
+  int Read(char* data, int size);
+
+ private:
+  struct Buffer {
+    Buffer();
+
+    std::vector<char> data;
+    size_t size;
+    size_t read_pos;
+
+    // Set by the background thread when it has filled the buffer, and
+    // cleared by Read() when it has copied all of it.
+    bool full;
+
+    // The last buffer the background thread fills.
+    bool last;
+  };
+
+  // Inflates the file into the buffers, in turn, as they are emptied.
+  // Overridden from base::DelegateSimpleThread::Delegate:
+  virtual void Run() OVERRIDE;
+
+  // Inflates into |buffer| until it is full or the file ends, and sets
+  // |*end| at the end of the file. Returns false on a read error or corrupt
+  // data.
+  bool FillBuffer(Buffer* buffer, bool* end);
+
+  // Reads the next chunk of the file into |input_|.
+  bool ReadInput(bool* end);
+
+  base::PlatformFile file_;
+  scoped_ptr<base::DelegateSimpleThread> thread_;
+
+  // Used on the background thread only.
+  z_stream stream_;
+  std::vector<char> input_;
+  int64 input_offset_;
+  bool member_ended_;
+
+  // The buffer Read() copies from.
+  int read_index_;
+
+  // Guards |full| in the buffers, |stopping_| and |succeeded_|.
+  base::Lock lock_;
+  base::ConditionVariable buffer_changed_;
+  Buffer buffers_[2];
+  bool stopping_;
+  bool succeeded_;
+
+  DISALLOW_COPY_AND_ASSIGN(GzipReader);
+};
+
+// Writes a gzip file on a background thread. Write() only copies the data
+// into one of two buffers; when it is full it is handed to the background
+// thread, which deflates it and writes it to the file while the caller
+// fills the other one.
+//
+// To write trace events compressed, pass GetCallback() to
+// base::debug::TraceResultBuffer::SetOutputCallback(). JSON from
+// base::JSONWriter is written with Write() or Append().
+class GzipWriter : public base::DelegateSimpleThread::Delegate {
+ public:
+  typedef base::Callback<void(const std::string&)> OutputCallback;
+
+  // |level| is the zlib compression level, 0 to 9, or
+  // Z_DEFAULT_COMPRESSION.
+  explicit GzipWriter(int level);
+
+  // Closes the file if Close() was not called.
+  virtual ~GzipWriter();
+
+  // Creates the file at |path|, replacing any file there. Returns false if
+  // the file cannot be created.
+  bool Open(const FilePath& path);
+
+  // Same as above for a file that is already open for writing, for instance
+  // by base::FileUtilProxy::CreateOrOpen(). The writer takes ownership of
+  // |file| and writes it from the start.
+  bool Open(base::PlatformFile file);
+
+  // Compresses |size| bytes at |data| into the file. Returns false once
+  // writing to the file has failed. As the file is written in the
+  // background, a failure is only reported by a later call, or by Close().
+  bool Write(const char* data, size_t size);
+
+  // Same as Write(), for use as an OutputCallback.
+  void Append(const std::string& data);
+
+  // Returns a callback that calls Append(). The writer must outlive it.
+  OutputCallback GetCallback();
+
+  // Makes all the data written so far reach the file, with a zlib sync
+  // flush, so that a reader can inflate it before the file is closed. Does
+  // not wait for it to be written.
+  void Flush();
+
+  // Finishes the gzip stream, waits for all of it to be written and closes
+  // the file. Returns false if anything could not be written.
+  bool Close();
+
+ private:
+  struct Buffer {
+    Buffer();
+
+    std::vector<char> data;
+    size_t size;
+
+    // The flush mode to deflate the buffer with.
+    int flush;
+
+    // Set when the buffer is handed to the background thread, and cleared
+    // by the background thread when it has written it.
+    bool queued;
+  };
+
+  // Deflates and writes the buffers, in turn, as they are handed over.
+  // Overridden from base::DelegateSimpleThread::Delegate:
+  virtual void Run() OVERRIDE;
+
+  // Deflates |buffer| and writes the output to the file.
+  bool DeflateBuffer(const Buffer& buffer);
+
+  // Hands the buffer Write() fills to the background thread, to deflate
+  // with |flush|, and waits until the other one is free.
+  void Submit(int flush);
+
+  const int level_;
+  base::PlatformFile file_;
+  scoped_ptr<base::DelegateSimpleThread> thread_;
+
+  // Used on the background thread only.
+  z_stream stream_;
+  std::vector<char> output_;
+  int64 output_offset_;
+
+  // The buffer Write() copies into, and whether writing had failed the last
+  // time a buffer was handed over.
+  int write_index_;
+  bool write_failed_;
+
+  // Guards |queued| in the buffers and |succeeded_|.
+  base::Lock lock_;
+  base::ConditionVariable buffer_changed_;
+  Buffer buffers_[2];
+  bool succeeded_;
+
+  DISALLOW_COPY_AND_ASSIGN(GzipWriter);
+};
+
+}  // namespace zlib
+
+#endif  // THIRD_PARTY_ZLIB_GOOGLE_GZIP_STREAM_H_
@@ -0,0 +1,235 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares GzipWriter and GzipReader with gzwrite() and gzread(). Writes
+// --size MB of generated log text to a gzip file in --write-size KB pieces
+// with each writer, reads the file the other one wrote in --read-size KB
+// pieces with each reader, checks the data and prints the speeds in the perf
+// bot format. Usage:
+//
+//   gzip_stream_benchmark [--size=MB] [--level=N] [--write-size=KB]
+//                         [--read-size=KB] [--rounds=N]
+//
+// The files are read back while they are in the page cache, so the reads
+// measure inflating and copying rather than the disk.
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/file_path.h"
+#include "base/scoped_temp_dir.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "third_party/zlib/google/gzip_stream.h"
+#include "third_party/zlib/zlib.h"
+
+namespace {
+
+const char kSizeSwitch[] = "size";
+const char kLevelSwitch[] = "level";
+const char kWriteSizeSwitch[] = "write-size";
+const char kReadSizeSwitch[] = "read-size";
+const char kRoundsSwitch[] = "rounds";
+
+const int kDefaultSizeMB = 64;
+const int kDefaultLevel = 6;
+const int kDefaultWriteSizeKB = 4;
+const int kDefaultReadSizeKB = 64;
+const int kDefaultRounds = 3;
+
+int GetIntSwitch(const CommandLine& command_line,
+                 const char* name,
+                 int default_value) {
+  if (!command_line.HasSwitch(name))
+    return default_value;
+  int value = 0;
+  if (!base::StringToInt(command_line.GetSwitchValueASCII(name), &value) ||
+      value <= 0) {
+    fprintf(stderr, "Invalid value for --%s, using %d\n", name,
+            default_value);
+    return default_value;
+  }
+  return value;
+}
+
+// Log lines with enough variety that deflate does real work on them.
+std::string GenerateInput(size_t size) {
+  static const char* const kMessages[] = {
+    "Connection established to %d.%d.%d.%d:443",
+    "Cache hit for resource id %d (%d bytes)",
+    "Cache miss for resource id %d, fetching (%d bytes)",
+    "Renderer %d reported paint time %d ms",
+  };
+  std::string input;
+  input.reserve(size + 256);
+  unsigned seed = 1;
+  for (int line = 0; input.size() < size; ++line) {
+    seed = seed * 1103515245 + 12345;
+    int kind = (seed >> 16) % arraysize(kMessages);
+    input += base::StringPrintf("[%d:%d:%08d:INFO:net.cc(%d)] ",
+                                1000 + (seed >> 20) % 4, 1000 + line % 16,
+                                line * 37, 100 + kind);
+    input += base::StringPrintf(kMessages[kind], (seed >> 8) & 0xff,
+                                (seed >> 4) & 0xffff, (seed >> 12) & 0xff,
+                                (seed >> 2) & 0xff);
+    input += "\n";
+  }
+  input.resize(size);
+  return input;
+}
+
+bool WriteWithGzio(const FilePath& path, const std::string& input,
+                   int level, size_t write_size) {
+  gzFile file = gzopen(path.AsUTF8Unsafe().c_str(),
+                       base::StringPrintf("wb%d", level).c_str());
+  if (!file)
+    return false;
+  for (size_t pos = 0; pos < input.size(); pos += write_size) {
+    unsigned size =
+        static_cast<unsigned>(std::min(write_size, input.size() - pos));
+    if (gzwrite(file, input.data() + pos, size) != static_cast<int>(size)) {
+      gzclose(file);
+      return false;
+    }
+  }
+  return gzclose(file) == Z_OK;
+}
+
+bool WriteWithGzipWriter(const FilePath& path, const std::string& input,
+                         int level, size_t write_size) {
+  zlib::GzipWriter writer(level);
+  if (!writer.Open(path))
+    return false;
+  for (size_t pos = 0; pos < input.size(); pos += write_size) {
+    if (!writer.Write(input.data() + pos,
+                      std::min(write_size, input.size() - pos))) {
+      return false;
+    }
+  }
+  return writer.Close();
+}
+
+bool ReadWithGzio(const FilePath& path, size_t read_size,
+                  std::string* output) {
+  gzFile file = gzopen(path.AsUTF8Unsafe().c_str(), "rb");
+  if (!file)
+    return false;
+  output->clear();
+  std::string buffer(read_size, '\0');
+  int read;
+  while ((read = gzread(file, &buffer[0],
+                        static_cast<unsigned>(buffer.size()))) > 0) {
+    output->append(buffer.data(), read);
+  }
+  return gzclose(file) == Z_OK && read == 0;
+}
+
+bool ReadWithGzipReader(const FilePath& path, size_t read_size,
+                        std::string* output) {
+  zlib::GzipReader reader;
+  if (!reader.Open(path))
+    return false;
+  output->clear();
+  std::string buffer(read_size, '\0');
+  int read;
+  while ((read = reader.Read(&buffer[0],
+                             static_cast<int>(buffer.size()))) > 0) {
+    output->append(buffer.data(), read);
+  }
+  return read == 0;
+}
+
+typedef bool (*WriteFunction)(const FilePath&, const std::string&, int,
+                              size_t);
+typedef bool (*ReadFunction)(const FilePath&, size_t, std::string*);
+
+struct Stream {
+  const char* trace;
+  WriteFunction write;
+  ReadFunction read;
+};
+
+const Stream kStreams[] = {
+  { "gzio", &WriteWithGzio, &ReadWithGzio },
+  { "gzip_stream", &WriteWithGzipWriter, &ReadWithGzipReader },
+};
+
+void PrintSpeed(const char* graph, const char* trace, size_t size,
+                base::TimeDelta time) {
+  printf("RESULT %s: %s= %.1f MB/s\n", graph, trace,
+         size / (1024.0 * 1024.0) / std::max(time.InSecondsF(), 1e-9));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  CommandLine::Init(argc, argv);
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+
+  // The exit manager is in charge of calling the dtors of singleton objects.
+  base::AtExitManager exit_manager;
+
+  std::string input = GenerateInput(
+      GetIntSwitch(command_line, kSizeSwitch, kDefaultSizeMB) * 1024 * 1024);
+  int level = GetIntSwitch(command_line, kLevelSwitch, kDefaultLevel);
+  size_t write_size =
+      GetIntSwitch(command_line, kWriteSizeSwitch, kDefaultWriteSizeKB) *
+      1024;
+  size_t read_size =
+      GetIntSwitch(command_line, kReadSizeSwitch, kDefaultReadSizeKB) * 1024;
+  int rounds = GetIntSwitch(command_line, kRoundsSwitch, kDefaultRounds);
+
+  ScopedTempDir temp_dir;
+  if (!temp_dir.CreateUniqueTempDir()) {
+    fprintf(stderr, "Cannot create a temporary directory\n");
+    return 1;
+  }
+
+  FilePath paths[arraysize(kStreams)];
+  for (size_t i = 0; i < arraysize(kStreams); ++i) {
+    paths[i] = temp_dir.path().AppendASCII(
+        base::StringPrintf("%s.gz", kStreams[i].trace));
+    base::TimeDelta best;
+    for (int round = 0; round < rounds; ++round) {
+      base::TimeTicks start = base::TimeTicks::HighResNow();
+      if (!kStreams[i].write(paths[i], input, level, write_size)) {
+        fprintf(stderr, "%s cannot write the file\n", kStreams[i].trace);
+        return 1;
+      }
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+      if (round == 0 || elapsed < best)
+        best = elapsed;
+    }
+    PrintSpeed("gzip_write_speed", kStreams[i].trace, input.size(), best);
+  }
+
+  // Each reader reads the file the other wrote, which also checks that the
+  // files are compatible.
+  for (size_t i = 0; i < arraysize(kStreams); ++i) {
+    const FilePath& path = paths[arraysize(kStreams) - 1 - i];
+    std::string output;
+    base::TimeDelta best;
+    for (int round = 0; round < rounds; ++round) {
+      base::TimeTicks start = base::TimeTicks::HighResNow();
+      if (!kStreams[i].read(path, read_size, &output)) {
+        fprintf(stderr, "%s cannot read the file\n", kStreams[i].trace);
+        return 1;
+      }
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+      if (round == 0 || elapsed < best)
+        best = elapsed;
+    }
+    if (output != input) {
+      fprintf(stderr, "%s read the wrong data\n", kStreams[i].trace);
+      return 1;
+    }
+    PrintSpeed("gzip_read_speed", kStreams[i].trace, input.size(), best);
+  }
+  return 0;
+}
@@ -0,0 +1,283 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "third_party/zlib/google/parallel_deflate.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
+#include "third_party/zlib/zlib.h"
+
+namespace {
+
+// Size of the deflate window, and so of the preset dictionary of a block.
+const size_t kWindowSize = 32 * 1024;
+
+// Same as deflateInit().
+const int kMemLevel = 8;
+
+// Larger blocks would overflow zlib's uInt lengths on some platforms.
+const size_t kMaxBlockSize = 1 << 30;
+
+// Bytes of a sync flush marker: an empty stored block, plus the bits needed
+// to finish the current byte.
+const size_t kFlushMarkerSize = 6;
+
+// zlib's OS_CODE for an unknown operating system.
+const char kGzipOsUnknown = static_cast<char>(255);
+
+// Deflates one block of the input into raw deflate data ending with a sync
+// flush, or with the final block if it is the last one, and computes the
+// check value of the block.
+class BlockCompressor : public base::DelegateSimpleThread::Delegate {
+ public:
+  BlockCompressor(const char* input,
+                  size_t start,
+                  size_t size,
+                  bool last,
+                  const zlib::ParallelDeflate::Options& options)
+      : input_(input),
+        start_(start),
+        size_(size),
+        last_(last),
+        options_(options),
+        check_(0),
+        succeeded_(false) {
+  }
+
+  // Overridden from base::DelegateSimpleThread::Delegate:
+  virtual void Run() OVERRIDE;
+
+  size_t size() const { return size_; }
+  uLong check() const { return check_; }
+  bool succeeded() const { return succeeded_; }
+  const std::string& output() const { return output_; }
+
+ private:
+  bool Deflate();
+
+  const char* input_;
+  const size_t start_;
+  const size_t size_;
+  const bool last_;
+  const zlib::ParallelDeflate::Options options_;
+
+  std::string output_;
+  uLong check_;
+  bool succeeded_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockCompressor);
+};
+
+void BlockCompressor::Run() {
+  const Bytef* data = reinterpret_cast<const Bytef*>(input_ + start_);
+  if (options_.format == zlib::ParallelDeflate::FORMAT_GZIP)
+    check_ = crc32(crc32(0L, Z_NULL, 0), data, static_cast<uInt>(size_));
+  else if (options_.format == zlib::ParallelDeflate::FORMAT_ZLIB)
+    check_ = adler32(adler32(0L, Z_NULL, 0), data, static_cast<uInt>(size_));
+  succeeded_ = Deflate();
+  if (!succeeded_)
+    output_.clear();
+}
+
+bool BlockCompressor::Deflate() {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, options_.level, Z_DEFLATED, -MAX_WBITS, kMemLevel,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+
+  // Let matches reach back into the previous blocks, as they would in a
+  // single stream.
+  if (start_ > 0) {
+    size_t dictionary_size = std::min(start_, kWindowSize);
+    if (deflateSetDictionary(
+            &stream,
+            reinterpret_cast<const Bytef*>(input_ + start_ - dictionary_size),
+            static_cast<uInt>(dictionary_size)) != Z_OK) {
+      deflateEnd(&stream);
+      return false;
+    }
+  }
+
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(input_ + start_));
+  stream.avail_in = static_cast<uInt>(size_);
+  output_.resize(deflateBound(&stream, static_cast<uLong>(size_)) +
+                 kFlushMarkerSize);
+
+  const int flush = last_ ? Z_FINISH : Z_SYNC_FLUSH;
+  size_t written = 0;
+  bool done = false;
+  while (!done) {
+    stream.next_out = reinterpret_cast<Bytef*>(&output_[written]);
+    stream.avail_out = static_cast<uInt>(output_.size() - written);
+    int result = deflate(&stream, flush);
+    written = output_.size() - stream.avail_out;
+    if (result == Z_STREAM_END) {
+      done = true;
+    } else if (result != Z_OK && result != Z_BUF_ERROR) {
+      deflateEnd(&stream);
+      return false;
+    } else if (!last_ && stream.avail_in == 0 && stream.avail_out != 0) {
+      // The sync flush is complete.
+      done = true;
+    } else if (stream.avail_out != 0) {
+      // deflate() stopped with room left in the output; it cannot progress.
+      deflateEnd(&stream);
+      return false;
+    } else {
+      output_.resize(output_.size() * 2);
+    }
+  }
+  output_.resize(written);
+
+  // deflateEnd() reports Z_DATA_ERROR for a stream that was not finished,
+  // which is expected for all but the last block.
+  int result = deflateEnd(&stream);
+  return result == Z_OK || (!last_ && result == Z_DATA_ERROR);
+}
+
+// Returns the level bits of the zlib header FLG byte, as deflate() does.
+int GetZlibLevelFlags(int level) {
+  if (level == Z_DEFAULT_COMPRESSION)
+    level = 6;
+  if (level < 2)
+    return 0;
+  if (level < 6)
+    return 1;
+  if (level == 6)
+    return 2;
+  return 3;
+}
+
+void AppendZlibHeader(int level, std::string* output) {
+  // CM = 8 (deflate), CINFO = 7 (32 KB window), no preset dictionary.
+  unsigned header = (0x78 << 8) | (GetZlibLevelFlags(level) << 6);
+  header += 31 - (header % 31);
+  output->push_back(static_cast<char>(header >> 8));
+  output->push_back(static_cast<char>(header & 0xff));
+}
+
+void AppendGzipHeader(int level, std::string* output) {
+  const char header[] = {
+    '\x1f', '\x8b',  // ID1, ID2
+    8,               // CM: deflate
+    0,               // FLG: no name, comment or extra field
+    0, 0, 0, 0,      // MTIME: not available
+    // XFL: 2 for maximum compression, 4 for fastest, as in deflate().
+    static_cast<char>(level == 9 ? 2 : (level == 1 ? 4 : 0)),
+    kGzipOsUnknown,
+  };
+  output->append(header, arraysize(header));
+}
+
+void AppendBigEndian32(uLong value, std::string* output) {
+  for (int shift = 24; shift >= 0; shift -= 8)
+    output->push_back(static_cast<char>((value >> shift) & 0xff));
+}
+
+void AppendLittleEndian32(uLong value, std::string* output) {
+  for (int shift = 0; shift < 32; shift += 8)
+    output->push_back(static_cast<char>((value >> shift) & 0xff));
+}
+
+}  // namespace
+
+namespace zlib {
+
+ParallelDeflate::Options::Options()
+    : format(FORMAT_ZLIB),
+      level(Z_DEFAULT_COMPRESSION),
+      block_size(kDefaultBlockSize),
+      thread_count(0) {
+}
+
+// static
+bool ParallelDeflate::Compress(const char* input,
+                               size_t size,
+                               const Options& options,
+                               std::string* output) {
+  DCHECK(output);
+  if ((options.level < 0 || options.level > 9) &&
+      options.level != Z_DEFAULT_COMPRESSION) {
+    return false;
+  }
+  if (options.block_size == 0 || options.block_size > kMaxBlockSize ||
+      options.thread_count < 0) {
+    return false;
+  }
+
+  size_t block_count =
+      std::max<size_t>(1, (size + options.block_size - 1) / options.block_size);
+  ScopedVector<BlockCompressor> blocks;
+  for (size_t i = 0; i < block_count; ++i) {
+    size_t start = i * options.block_size;
+    size_t block_size = std::min(options.block_size, size - start);
+    blocks.push_back(new BlockCompressor(input, start, block_size,
+                                         i == block_count - 1, options));
+  }
+
+  int thread_count = options.thread_count ?
+      options.thread_count : base::SysInfo::NumberOfProcessors();
+  if (static_cast<size_t>(thread_count) > block_count)
+    thread_count = static_cast<int>(block_count);
+  if (thread_count <= 1) {
+    for (size_t i = 0; i < block_count; ++i)
+      blocks[i]->Run();
+  } else {
+    base::DelegateSimpleThreadPool pool("parallel_deflate", thread_count);
+    for (size_t i = 0; i < block_count; ++i)
+      pool.AddWork(blocks[i]);
+    pool.Start();
+    pool.JoinAll();
+  }
+
+  size_t compressed_size = 0;
+  for (size_t i = 0; i < block_count; ++i) {
+    if (!blocks[i]->succeeded())
+      return false;
+    compressed_size += blocks[i]->output().size();
+  }
+
+  // Header, blocks in order, then the check value of the whole input merged
+  // from the check values of the blocks.
+  std::string stream;
+  stream.reserve(compressed_size + 18);
+  if (options.format == FORMAT_ZLIB)
+    AppendZlibHeader(options.level, &stream);
+  else if (options.format == FORMAT_GZIP)
+    AppendGzipHeader(options.level, &stream);
+
+  uLong check = blocks[0]->check();
+  for (size_t i = 0; i < block_count; ++i) {
+    stream.append(blocks[i]->output());
+    if (i == 0)
+      continue;
+    z_off_t block_size = static_cast<z_off_t>(blocks[i]->size());
+    if (options.format == FORMAT_GZIP)
+      check = crc32_combine(check, blocks[i]->check(), block_size);
+    else if (options.format == FORMAT_ZLIB)
+      check = adler32_combine(check, blocks[i]->check(), block_size);
+  }
+
+  if (options.format == FORMAT_ZLIB) {
+    AppendBigEndian32(check, &stream);
+  } else if (options.format == FORMAT_GZIP) {
+    AppendLittleEndian32(check, &stream);
+    AppendLittleEndian32(static_cast<uLong>(size), &stream);  // ISIZE mod 2^32
+  }
+
+  output->append(stream);
+  return true;
+}
+
+}  // namespace zlib
@@ -0,0 +1,65 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef THIRD_PARTY_ZLIB_GOOGLE_PARALLEL_DEFLATE_H_
+#define THIRD_PARTY_ZLIB_GOOGLE_PARALLEL_DEFLATE_H_
+#pragma once
+
+#include <string>
+
+#include "base/basictypes.h"
+
+namespace zlib {
+
+// Compresses a buffer on several threads, in the manner of pigz. The input
+// is cut into blocks that are deflated independently, each primed with the
+// 32 KB of input before it as a preset dictionary, so the ratio is within a
+// fraction of a percent of a single stream. The raw deflate blocks are
+// joined with sync flushes into one stream, and the check values of the
+// blocks are merged with crc32_combine() or adler32_combine(), so the result
+// is a single ordinary zlib, gzip or raw deflate stream that any inflater
+// reads.
+class ParallelDeflate {
+ public:
+  enum Format {
+    FORMAT_ZLIB,  // RFC 1950 header and Adler-32 trailer.
+    FORMAT_GZIP,  // RFC 1952 header and CRC-32/length trailer.
+    FORMAT_RAW,   // RFC 1951 data with no header or trailer.
+  };
+
+  struct Options {
+    Options();
+
+    Format format;
+
+    // zlib compression level, 0 to 9, or Z_DEFAULT_COMPRESSION.
+    int level;
+
+    // Bytes of input per block. Smaller blocks spread the work over more
+    // threads; each block adds a few bytes of flush markers to the output.
+    size_t block_size;
+
+    // Number of threads compressing blocks, or 0 for one per processor. With
+    // one thread, or a single block, the caller's thread does all the work.
+    int thread_count;
+  };
+
+  // Default block size, as in pigz.
+  static const size_t kDefaultBlockSize = 128 * 1024;
+
+  // Compresses |size| bytes at |input| and appends the stream to |output|.
+  // Returns false if the options are invalid or zlib fails, in which case
+  // |output| is left as it was.
+  static bool Compress(const char* input,
+                       size_t size,
+                       const Options& options,
+                       std::string* output);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(ParallelDeflate);
+};
+
+}  // namespace zlib
+
+#endif  // THIRD_PARTY_ZLIB_GOOGLE_PARALLEL_DEFLATE_H_
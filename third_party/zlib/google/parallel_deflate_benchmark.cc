@@ -0,0 +1,173 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how ParallelDeflate scales with the number of threads. For each
+// thread count from 1 up to --max-threads (doubling), compresses the input,
+// checks that it inflates back, and prints the speed and the speedup over
+// one thread in the perf bot format. Usage:
+//
+//   parallel_deflate_benchmark [--input=FILE] [--size=MB] [--level=N]
+//                              [--block-size=KB] [--max-threads=N]
+//                              [--rounds=N]
+//
+// Without --input, compresses generated log text.
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "third_party/zlib/google/parallel_deflate.h"
+#include "third_party/zlib/zlib.h"
+
+namespace {
+
+const char kInputSwitch[] = "input";
+const char kSizeSwitch[] = "size";
+const char kLevelSwitch[] = "level";
+const char kBlockSizeSwitch[] = "block-size";
+const char kMaxThreadsSwitch[] = "max-threads";
+const char kRoundsSwitch[] = "rounds";
+
+const int kDefaultSizeMB = 64;
+const int kDefaultMaxThreads = 32;
+const int kDefaultRounds = 3;
+
+int GetIntSwitch(const CommandLine& command_line,
+                 const char* name,
+                 int default_value) {
+  if (!command_line.HasSwitch(name))
+    return default_value;
+  int value = 0;
+  if (!base::StringToInt(command_line.GetSwitchValueASCII(name), &value) ||
+      value <= 0) {
+    fprintf(stderr, "Invalid value for --%s, using %d\n", name,
+            default_value);
+    return default_value;
+  }
+  return value;
+}
+
+// Log lines with enough variety that deflate does real work on them.
+std::string GenerateInput(size_t size) {
+  static const char* const kMessages[] = {
+    "Connection established to %d.%d.%d.%d:443",
+    "Cache hit for resource id %d (%d bytes)",
+    "Cache miss for resource id %d, fetching (%d bytes)",
+    "Renderer %d reported paint time %d ms",
+  };
+  std::string input;
+  input.reserve(size + 256);
+  unsigned seed = 1;
+  for (int line = 0; input.size() < size; ++line) {
+    seed = seed * 1103515245 + 12345;
+    int kind = (seed >> 16) % arraysize(kMessages);
+    input += base::StringPrintf("[%d:%d:%08d:INFO:net.cc(%d)] ",
+                                1000 + (seed >> 20) % 4, 1000 + line % 16,
+                                line * 37, 100 + kind);
+    input += base::StringPrintf(kMessages[kind], (seed >> 8) & 0xff,
+                                (seed >> 4) & 0xffff, (seed >> 12) & 0xff,
+                                (seed >> 2) & 0xff);
+    input += "\n";
+  }
+  input.resize(size);
+  return input;
+}
+
+bool Inflates(const std::string& compressed, const std::string& expected) {
+  std::string output(expected.size(), '\0');
+  uLongf output_size = static_cast<uLongf>(output.size());
+  int result = uncompress(
+      reinterpret_cast<Bytef*>(output.empty() ? NULL : &output[0]),
+      &output_size, reinterpret_cast<const Bytef*>(compressed.data()),
+      static_cast<uLong>(compressed.size()));
+  return result == Z_OK && output_size == expected.size() &&
+         output == expected;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  CommandLine::Init(argc, argv);
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+
+  // The exit manager is in charge of calling the dtors of singleton objects.
+  base::AtExitManager exit_manager;
+
+  std::string input;
+  if (command_line.HasSwitch(kInputSwitch)) {
+    FilePath path = command_line.GetSwitchValuePath(kInputSwitch);
+    if (!file_util::ReadFileToString(path, &input)) {
+      fprintf(stderr, "Cannot read the input file\n");
+      return 1;
+    }
+  } else {
+    input = GenerateInput(
+        GetIntSwitch(command_line, kSizeSwitch, kDefaultSizeMB) * 1024 * 1024);
+  }
+
+  zlib::ParallelDeflate::Options options;
+  options.format = zlib::ParallelDeflate::FORMAT_ZLIB;
+  if (command_line.HasSwitch(kLevelSwitch))
+    options.level = GetIntSwitch(command_line, kLevelSwitch, 6);
+  if (command_line.HasSwitch(kBlockSizeSwitch)) {
+    options.block_size =
+        GetIntSwitch(command_line, kBlockSizeSwitch, 128) * 1024;
+  }
+  int max_threads =
+      GetIntSwitch(command_line, kMaxThreadsSwitch, kDefaultMaxThreads);
+  int rounds = GetIntSwitch(command_line, kRoundsSwitch, kDefaultRounds);
+
+  // A single stream, for the ratio cost of cutting the input into blocks.
+  uLongf single_size = compressBound(static_cast<uLong>(input.size()));
+  std::string single(single_size, '\0');
+  compress2(reinterpret_cast<Bytef*>(&single[0]), &single_size,
+            reinterpret_cast<const Bytef*>(input.data()),
+            static_cast<uLong>(input.size()), options.level);
+  printf("RESULT parallel_deflate_size: single= %lu bytes\n",
+         static_cast<unsigned long>(single_size));
+
+  double one_thread_mb_per_s = 0;
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    options.thread_count = threads;
+    std::string output;
+    base::TimeDelta best;
+    for (int i = 0; i < rounds; ++i) {
+      output.clear();
+      base::TimeTicks start = base::TimeTicks::HighResNow();
+      if (!zlib::ParallelDeflate::Compress(input.data(), input.size(),
+                                           options, &output)) {
+        fprintf(stderr, "Compression failed with %d threads\n", threads);
+        return 1;
+      }
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+      if (i == 0 || elapsed < best)
+        best = elapsed;
+    }
+    if (!Inflates(output, input)) {
+      fprintf(stderr, "Output with %d threads does not inflate\n", threads);
+      return 1;
+    }
+
+    double mb_per_s = input.size() / (1024.0 * 1024.0) /
+        std::max(best.InSecondsF(), 1e-9);
+    if (threads == 1)
+      one_thread_mb_per_s = mb_per_s;
+    std::string trace = base::StringPrintf("threads_%d", threads);
+    printf("RESULT parallel_deflate_size: %s= %lu bytes\n", trace.c_str(),
+           static_cast<unsigned long>(output.size()));
+    printf("RESULT parallel_deflate_speed: %s= %.1f MB/s\n", trace.c_str(),
+           mb_per_s);
+    printf("RESULT parallel_deflate_speedup: %s= %.2f x\n", trace.c_str(),
+           mb_per_s / one_thread_mb_per_s);
+  }
+  return 0;
+}
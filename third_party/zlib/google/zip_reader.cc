@@ -0,0 +1,513 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "third_party/zlib/google/zip_reader.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/atomic_sequence_num.h"
+#include "base/compiler_specific.h"
+#include "base/file_path.h"
+#include "base/logging.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
+#include "third_party/zlib/zlib.h"
+
+namespace {
+
+// Signatures and fixed sizes of the records of a zip archive, from PKWARE's
+// APPNOTE.TXT.
+const uint32 kLocalHeaderSignature = 0x04034b50;
+const uint32 kCentralHeaderSignature = 0x02014b50;
+const uint32 kEndOfCentralDirectorySignature = 0x06054b50;
+const uint32 kZip64EndOfCentralDirectorySignature = 0x06064b50;
+const uint32 kZip64LocatorSignature = 0x07064b50;
+
+const size_t kLocalHeaderSize = 30;
+const size_t kCentralHeaderSize = 46;
+const size_t kEndOfCentralDirectorySize = 22;
+const size_t kZip64EndOfCentralDirectorySize = 56;
+const size_t kZip64LocatorSize = 20;
+
+// Longest comment the end of central directory record can have.
+const size_t kMaxCommentSize = 0xffff;
+
+// ID of the extra field holding the Zip64 sizes and offset of an entry.
+const uint16 kZip64ExtraFieldId = 0x0001;
+
+// Bit 0 of the general purpose flags: the entry is encrypted.
+const uint16 kEncryptedFlag = 1 << 0;
+
+// Deflate cannot compress by more than about 1032:1, so an entry claiming
+// to grow more than that is corrupt. This keeps a bad archive from making
+// Extract() allocate memory for data that is not there.
+const uint64 kMaxDeflateRatio = 1032;
+
+// Reads little-endian numbers from a range of memory, failing if they run
+// past its end.
+class LittleEndianReader {
+ public:
+  LittleEndianReader(const char* data, size_t size)
+      : data_(reinterpret_cast<const unsigned char*>(data)),
+        size_(size),
+        pos_(0) {
+  }
+
+  bool ReadUint16(uint16* value) {
+    if (remaining() < 2)
+      return false;
+    *value = static_cast<uint16>(data_[pos_] | (data_[pos_ + 1] << 8));
+    pos_ += 2;
+    return true;
+  }
+
+  bool ReadUint32(uint32* value) {
+    uint16 low, high;
+    if (!ReadUint16(&low) || !ReadUint16(&high))
+      return false;
+    *value = low | (static_cast<uint32>(high) << 16);
+    return true;
+  }
+
+  bool ReadUint64(uint64* value) {
+    uint32 low, high;
+    if (!ReadUint32(&low) || !ReadUint32(&high))
+      return false;
+    *value = low | (static_cast<uint64>(high) << 32);
+    return true;
+  }
+
+  bool Skip(size_t bytes) {
+    if (remaining() < bytes)
+      return false;
+    pos_ += bytes;
+    return true;
+  }
+
+  size_t remaining() const { return size_ - pos_; }
+
+ private:
+  const unsigned char* data_;
+  size_t size_;
+  size_t pos_;
+};
+
+// Returns the offset of the end of central directory record in |data|, or
+// std::string::npos. The record is at the end of the archive, followed only
+// by its comment.
+size_t FindEndOfCentralDirectory(const base::StringPiece& data) {
+  if (data.size() < kEndOfCentralDirectorySize)
+    return std::string::npos;
+  size_t last = data.size() - kEndOfCentralDirectorySize;
+  size_t first = last > kMaxCommentSize ? last - kMaxCommentSize : 0;
+  for (size_t pos = last + 1; pos-- > first; ) {
+    LittleEndianReader reader(data.data() + pos, data.size() - pos);
+    uint32 signature;
+    uint16 comment_size;
+    if (reader.ReadUint32(&signature) &&
+        signature == kEndOfCentralDirectorySignature &&
+        reader.Skip(16) && reader.ReadUint16(&comment_size) &&
+        pos + kEndOfCentralDirectorySize + comment_size == data.size()) {
+      return pos;
+    }
+  }
+  return std::string::npos;
+}
+
+// Replaces the fields of |entry| that the central directory could not hold
+// with the values in the Zip64 extra field among |extra|, if there is one.
+// The fields the extra field has are those set to their maximum value.
+bool ReadZip64ExtraField(const base::StringPiece& extra,
+                         zlib::ZipReader::Entry* entry) {
+  LittleEndianReader reader(extra.data(), extra.size());
+  while (reader.remaining() >= 4) {
+    uint16 id, size;
+    reader.ReadUint16(&id);
+    reader.ReadUint16(&size);
+    if (id != kZip64ExtraFieldId) {
+      if (!reader.Skip(size))
+        return false;
+      continue;
+    }
+    LittleEndianReader field(extra.data() + extra.size() - reader.remaining(),
+                             std::min<size_t>(size, reader.remaining()));
+    if (entry->uncompressed_size == kuint32max &&
+        !field.ReadUint64(&entry->uncompressed_size)) {
+      return false;
+    }
+    if (entry->compressed_size == kuint32max &&
+        !field.ReadUint64(&entry->compressed_size)) {
+      return false;
+    }
+    if (entry->local_header_offset == kuint32max &&
+        !field.ReadUint64(&entry->local_header_offset)) {
+      return false;
+    }
+    return true;
+  }
+  return true;
+}
+
+// Inflates the raw deflate data |input| into |output|, which is already the
+// size of the uncompressed data, and fails unless it fills it exactly.
+bool Inflate(const base::StringPiece& input, std::string* output) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    return false;
+
+  // Each call is limited to what a uInt can count.
+  const size_t kMaxChunk = 1 << 30;
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+  int result = Z_OK;
+  // inflate() rejects a NULL |next_out| even when there is nothing to write,
+  // as for an empty entry.
+  char empty_output;
+  while (result == Z_OK) {
+    size_t in_chunk = std::min(kMaxChunk, input.size() - in_pos);
+    size_t out_chunk = std::min(kMaxChunk, output->size() - out_pos);
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(input.data() + in_pos));
+    stream.avail_in = static_cast<uInt>(in_chunk);
+    stream.next_out = reinterpret_cast<Bytef*>(
+        output->empty() ? &empty_output : &(*output)[out_pos]);
+    stream.avail_out = static_cast<uInt>(out_chunk);
+    result = inflate(&stream, Z_NO_FLUSH);
+    in_pos += in_chunk - stream.avail_in;
+    out_pos += out_chunk - stream.avail_out;
+    if (result == Z_BUF_ERROR && in_chunk != 0 && out_chunk != 0 &&
+        (stream.avail_in == 0 || stream.avail_out == 0)) {
+      // Only a chunk ran out; there is more of the input or output left.
+      result = Z_OK;
+    }
+  }
+  inflateEnd(&stream);
+  return result == Z_STREAM_END && out_pos == output->size();
+}
+
+// Extracts entries given out by a shared counter, so that the threads of a
+// pool that run it share the entries between them however long each takes.
+class ParallelExtractor : public base::DelegateSimpleThread::Delegate {
+ public:
+  ParallelExtractor(const zlib::ZipReader* reader,
+                    const std::vector<const zlib::ZipReader::Entry*>& entries,
+                    std::vector<std::string>* contents)
+      : reader_(reader),
+        entries_(entries),
+        contents_(contents),
+        succeeded_(entries.size(), true) {
+  }
+
+  // Overridden from base::DelegateSimpleThread::Delegate:
+  virtual void Run() OVERRIDE {
+    for (;;) {
+      size_t i = static_cast<size_t>(next_entry_.GetNext());
+      if (i >= entries_.size())
+        return;
+      succeeded_[i] = reader_->Extract(*entries_[i], &(*contents_)[i]);
+    }
+  }
+
+  bool succeeded() const {
+    return std::find(succeeded_.begin(), succeeded_.end(), false) ==
+        succeeded_.end();
+  }
+
+ private:
+  const zlib::ZipReader* reader_;
+  const std::vector<const zlib::ZipReader::Entry*>& entries_;
+  std::vector<std::string>* contents_;
+
+  // Written by one thread each, so a byte per entry rather than a bit.
+  std::vector<char> succeeded_;
+
+  base::AtomicSequenceNumber next_entry_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelExtractor);
+};
+
+}  // namespace
+
+namespace zlib {
+
+ZipReader::Entry::Entry()
+    : method(METHOD_STORED),
+      crc(0),
+      compressed_size(0),
+      uncompressed_size(0),
+      local_header_offset(0) {
+}
+
+bool ZipReader::Entry::is_directory() const {
+  return !name.empty() && name[name.size() - 1] == '/';
+}
+
+ZipReader::ZipReader() {
+}
+
+ZipReader::~ZipReader() {
+}
+
+bool ZipReader::Open(const FilePath& path) {
+  DCHECK(!mapped_file_.get());
+  mapped_file_.reset(new file_util::MemoryMappedFile);
+  if (!mapped_file_->Initialize(path)) {
+    mapped_file_.reset();
+    return false;
+  }
+  return OpenFromMemory(reinterpret_cast<const char*>(mapped_file_->data()),
+                        mapped_file_->length());
+}
+
+bool ZipReader::OpenFromMemory(const char* data, size_t size) {
+  DCHECK(entries_.empty());
+  data_.set(data, size);
+  if (!ReadCentralDirectory()) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+const ZipReader::Entry* ZipReader::FindEntry(
+    const base::StringPiece& name) const {
+  base::hash_map<base::StringPiece, size_t>::const_iterator it =
+      index_.find(name);
+  return it == index_.end() ? NULL : &entries_[it->second];
+}
+
+bool ZipReader::GetStoredContents(const Entry& entry,
+                                  base::StringPiece* contents) const {
+  if (entry.method != METHOD_STORED ||
+      entry.compressed_size != entry.uncompressed_size) {
+    return false;
+  }
+  base::StringPiece data = GetEntryData(entry);
+  if (data.data() == NULL)
+    return false;
+  *contents = data;
+  return true;
+}
+
+bool ZipReader::Extract(const Entry& entry, std::string* contents) const {
+  base::StringPiece data = GetEntryData(entry);
+  if (data.data() == NULL)
+    return false;
+
+  if (entry.method == METHOD_STORED) {
+    if (entry.compressed_size != entry.uncompressed_size)
+      return false;
+    data.CopyToString(contents);
+  } else {
+    if (entry.uncompressed_size / kMaxDeflateRatio > entry.compressed_size ||
+        entry.uncompressed_size > contents->max_size()) {
+      return false;
+    }
+    contents->resize(static_cast<size_t>(entry.uncompressed_size));
+    if (!Inflate(data, contents)) {
+      contents->clear();
+      return false;
+    }
+  }
+
+  // crc32() counts in uInt, so long entries are checked in pieces.
+  const size_t kMaxChunk = 1 << 30;
+  uLong crc = crc32(0L, Z_NULL, 0);
+  for (size_t pos = 0; pos < contents->size(); pos += kMaxChunk) {
+    size_t chunk = std::min(kMaxChunk, contents->size() - pos);
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(contents->data() + pos),
+                static_cast<uInt>(chunk));
+  }
+  if (crc != entry.crc) {
+    contents->clear();
+    return false;
+  }
+  return true;
+}
+
+bool ZipReader::ExtractInParallel(const std::vector<const Entry*>& entries,
+                                  int thread_count,
+                                  std::vector<std::string>* contents) const {
+  DCHECK_GE(thread_count, 0);
+  contents->clear();
+  contents->resize(entries.size());
+  if (thread_count == 0)
+    thread_count = base::SysInfo::NumberOfProcessors();
+  if (static_cast<size_t>(thread_count) > entries.size())
+    thread_count = static_cast<int>(entries.size());
+
+  ParallelExtractor extractor(this, entries, contents);
+  if (thread_count <= 1) {
+    extractor.Run();
+  } else {
+    base::DelegateSimpleThreadPool pool("zip_reader", thread_count);
+    pool.AddWork(&extractor, thread_count);
+    pool.Start();
+    pool.JoinAll();
+  }
+  return extractor.succeeded();
+}
+
+bool ZipReader::ReadCentralDirectory() {
+  size_t end_offset = FindEndOfCentralDirectory(data_);
+  if (end_offset == std::string::npos)
+    return false;
+
+  LittleEndianReader end(data_.data() + end_offset + 4,
+                         kEndOfCentralDirectorySize - 4);
+  uint16 disk, directory_disk, disk_entry_count, entry_count16;
+  uint32 directory_size32, directory_offset32;
+  end.ReadUint16(&disk);
+  end.ReadUint16(&directory_disk);
+  end.ReadUint16(&disk_entry_count);
+  end.ReadUint16(&entry_count16);
+  end.ReadUint32(&directory_size32);
+  end.ReadUint32(&directory_offset32);
+  uint64 entry_count = entry_count16;
+  uint64 directory_size = directory_size32;
+  uint64 directory_offset = directory_offset32;
+
+  // A Zip64 archive has a locator just before the record, pointing at the
+  // Zip64 record with the real values of the fields that overflowed.
+  if (end_offset >= kZip64LocatorSize) {
+    LittleEndianReader locator(data_.data() + end_offset - kZip64LocatorSize,
+                               kZip64LocatorSize);
+    uint32 signature, zip64_disk, disk_count;
+    uint64 zip64_offset;
+    locator.ReadUint32(&signature);
+    locator.ReadUint32(&zip64_disk);
+    locator.ReadUint64(&zip64_offset);
+    locator.ReadUint32(&disk_count);
+    if (signature == kZip64LocatorSignature) {
+      // Check the size first: the subtraction would wrap around for an
+      // archive smaller than the record.
+      if (disk_count > 1 ||
+          data_.size() < kZip64EndOfCentralDirectorySize ||
+          zip64_offset > data_.size() - kZip64EndOfCentralDirectorySize) {
+        return false;
+      }
+      LittleEndianReader zip64_end(
+          data_.data() + static_cast<size_t>(zip64_offset),
+          kZip64EndOfCentralDirectorySize);
+      uint32 zip64_disk_number, zip64_directory_disk;
+      uint64 zip64_disk_entry_count;
+      zip64_end.ReadUint32(&signature);
+      if (signature != kZip64EndOfCentralDirectorySignature)
+        return false;
+      zip64_end.Skip(12);  // Record size, versions.
+      zip64_end.ReadUint32(&zip64_disk_number);
+      zip64_end.ReadUint32(&zip64_directory_disk);
+      zip64_end.ReadUint64(&zip64_disk_entry_count);
+      zip64_end.ReadUint64(&entry_count);
+      zip64_end.ReadUint64(&directory_size);
+      zip64_end.ReadUint64(&directory_offset);
+      if (zip64_disk_number != 0 || zip64_directory_disk != 0 ||
+          zip64_disk_entry_count != entry_count) {
+        return false;
+      }
+      disk = 0;
+      directory_disk = 0;
+      disk_entry_count = 0;
+      entry_count16 = 0;
+    }
+  }
+  if (disk != 0 || directory_disk != 0 || disk_entry_count != entry_count16)
+    return false;
+  if (directory_offset > data_.size() ||
+      directory_size > data_.size() - directory_offset ||
+      entry_count > directory_size / kCentralHeaderSize) {
+    return false;
+  }
+
+  const char* directory = data_.data() + static_cast<size_t>(directory_offset);
+  LittleEndianReader reader(directory, static_cast<size_t>(directory_size));
+  entries_.resize(static_cast<size_t>(entry_count));
+  index_.clear();
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    Entry* entry = &entries_[i];
+    uint32 signature, crc, compressed_size, uncompressed_size, offset;
+    uint16 flags, method, name_size, extra_size, comment_size;
+    if (!reader.ReadUint32(&signature) ||
+        signature != kCentralHeaderSignature ||
+        !reader.Skip(4) ||  // Versions.
+        !reader.ReadUint16(&flags) ||
+        !reader.ReadUint16(&method) ||
+        !reader.Skip(4) ||  // Modification time and date.
+        !reader.ReadUint32(&crc) ||
+        !reader.ReadUint32(&compressed_size) ||
+        !reader.ReadUint32(&uncompressed_size) ||
+        !reader.ReadUint16(&name_size) ||
+        !reader.ReadUint16(&extra_size) ||
+        !reader.ReadUint16(&comment_size) ||
+        !reader.Skip(8) ||  // Disk number and attributes.
+        !reader.ReadUint32(&offset)) {
+      return false;
+    }
+    if ((flags & kEncryptedFlag) ||
+        (method != METHOD_STORED && method != METHOD_DEFLATED)) {
+      return false;
+    }
+
+    const char* name = directory + static_cast<size_t>(directory_size) -
+        reader.remaining();
+    if (!reader.Skip(name_size) || !reader.Skip(extra_size) ||
+        !reader.Skip(comment_size)) {
+      return false;
+    }
+    entry->name.set(name, name_size);
+    entry->method = static_cast<Method>(method);
+    entry->crc = crc;
+    entry->compressed_size = compressed_size;
+    entry->uncompressed_size = uncompressed_size;
+    entry->local_header_offset = offset;
+    if (!ReadZip64ExtraField(base::StringPiece(name + name_size, extra_size),
+                             entry)) {
+      return false;
+    }
+
+    // insert() keeps the first entry of a name.
+    index_.insert(std::make_pair(entry->name, i));
+  }
+  return true;
+}
+
+base::StringPiece ZipReader::GetEntryData(const Entry& entry) const {
+  if (entry.local_header_offset > data_.size() ||
+      data_.size() - entry.local_header_offset < kLocalHeaderSize) {
+    return base::StringPiece();
+  }
+  size_t offset = static_cast<size_t>(entry.local_header_offset);
+  LittleEndianReader reader(data_.data() + offset, kLocalHeaderSize);
+  uint32 signature;
+  uint16 name_size, extra_size;
+  reader.ReadUint32(&signature);
+  reader.Skip(22);  // Versions, flags, method, time, CRC and sizes.
+  reader.ReadUint16(&name_size);
+  reader.ReadUint16(&extra_size);
+  if (signature != kLocalHeaderSignature)
+    return base::StringPiece();
+
+  // The local header has its own name and extra field, which can differ in
+  // size from those in the central directory.
+  uint64 data_offset =
+      static_cast<uint64>(offset) + kLocalHeaderSize + name_size + extra_size;
+  if (data_offset > data_.size() ||
+      entry.compressed_size > data_.size() - data_offset) {
+    return base::StringPiece();
+  }
+  return base::StringPiece(data_.data() + static_cast<size_t>(data_offset),
+                           static_cast<size_t>(entry.compressed_size));
+}
+
+void ZipReader::Close() {
+  entries_.clear();
+  index_.clear();
+  data_.clear();
+  mapped_file_.reset();
+}
+
+}  // namespace zlib
@@ -0,0 +1,125 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef THIRD_PARTY_ZLIB_GOOGLE_ZIP_READER_H_
+#define THIRD_PARTY_ZLIB_GOOGLE_ZIP_READER_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/file_util.h"
+#include "base/hash_tables.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string_piece.h"
+
+class FilePath;
+
+namespace zlib {
+
+// Reads a zip archive from memory, for archives such as resource bundles
+// that are read many times. Unlike minizip, which reads through stdio a few
+// bytes at a time and looks entries up by walking the central directory,
+// the reader maps the whole archive, indexes the central directory by name
+// once, and reads entries straight out of the mapping: stored entries
+// without any copy, and deflated ones on several threads at once.
+//
+// Stored (method 0) and deflated (method 8) entries are supported, in
+// archives of any size including Zip64 ones. Encrypted entries and archives
+// split over several disks are not. A ZipReader is not thread safe, but its
+// const methods can be called from several threads once Open() has
+// returned.
+class ZipReader {
+ public:
+  // Compression methods of the entries that can be read.
+  enum Method {
+    METHOD_STORED = 0,
+    METHOD_DEFLATED = 8,
+  };
+
+  // An entry of the archive, as described by the central directory.
+  struct Entry {
+    Entry();
+
+    // Path of the entry in the archive, with '/' separators. Directories end
+    // with a '/'.
+    base::StringPiece name;
+
+    Method method;
+    uint32 crc;
+    uint64 compressed_size;
+    uint64 uncompressed_size;
+
+    // Offset of the local file header of the entry in the archive.
+    uint64 local_header_offset;
+
+    bool is_directory() const;
+  };
+
+  ZipReader();
+  ~ZipReader();
+
+  // Maps the archive at |path| and reads its central directory. Returns false
+  // if the file cannot be mapped or is not an archive the reader supports.
+  bool Open(const FilePath& path);
+
+  // Same as above for an archive that is already in memory. The memory must
+  // stay valid, and unchanged, for the life of the reader.
+  bool OpenFromMemory(const char* data, size_t size);
+
+  size_t entry_count() const { return entries_.size(); }
+  const Entry& entry(size_t index) const { return entries_[index]; }
+
+  // Returns the entry called |name|, or NULL if there is none. When several
+  // entries have the same name, the first one is returned, as minizip does.
+  const Entry* FindEntry(const base::StringPiece& name) const;
+
+  // Points |*contents| at the data of a stored entry in the archive, without
+  // copying it or checking its CRC. Returns false for other entries and for
+  // entries whose data is not inside the archive.
+  bool GetStoredContents(const Entry& entry,
+                         base::StringPiece* contents) const;
+
+  // Reads the contents of |entry| into |*contents|, inflating them if they
+  // are compressed, and checks their CRC. Returns false if the entry cannot
+  // be read or is corrupt.
+  bool Extract(const Entry& entry, std::string* contents) const;
+
+  // Reads the contents of each of |entries| into the same element of
+  // |*contents|, on |thread_count| threads, or one per processor if it is 0.
+  // Returns false if any entry fails; the contents of the others are still
+  // read.
+  bool ExtractInParallel(const std::vector<const Entry*>& entries,
+                         int thread_count,
+                         std::vector<std::string>* contents) const;
+
+ private:
+  // Reads the central directory of the archive in |data_| into |entries_|
+  // and |index_|.
+  bool ReadCentralDirectory();
+
+  // Returns the data of |entry| in the archive, or an empty piece if the
+  // local header is corrupt or the data is not all inside the archive.
+  base::StringPiece GetEntryData(const Entry& entry) const;
+
+  // Forgets the archive, and unmaps it if Open() mapped it.
+  void Close();
+
+  // The archive, if it was opened with Open().
+  scoped_ptr<file_util::MemoryMappedFile> mapped_file_;
+  base::StringPiece data_;
+
+  std::vector<Entry> entries_;
+
+  // Index in |entries_| of the first entry with each name. The names point
+  // into the central directory in |data_|.
+  base::hash_map<base::StringPiece, size_t> index_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZipReader);
+};
+
+}  // namespace zlib
+
+#endif  // THIRD_PARTY_ZLIB_GOOGLE_ZIP_READER_H_
@@ -0,0 +1,283 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares ZipReader with minizip on an archive with many small entries, like
+// a resource bundle. Writes an archive of --entries entries with minizip,
+// then times opening it, looking entries up by name and extracting all of
+// them, with minizip and with ZipReader on one thread and on up to
+// --max-threads threads (doubling), and prints the results in the perf bot
+// format. Usage:
+//
+//   zip_reader_benchmark [--entries=N] [--lookups=N] [--max-threads=N]
+//                        [--rounds=N]
+//
+// Every fourth entry is stored and the others are deflated. minizip finds an
+// entry by walking the central directory, so both readers are timed over
+// --lookups lookups rather than one per entry.
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/file_path.h"
+#include "base/scoped_temp_dir.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "third_party/zlib/contrib/minizip/unzip.h"
+#include "third_party/zlib/contrib/minizip/zip.h"
+#include "third_party/zlib/google/zip_reader.h"
+
+namespace {
+
+const char kEntriesSwitch[] = "entries";
+const char kLookupsSwitch[] = "lookups";
+const char kMaxThreadsSwitch[] = "max-threads";
+const char kRoundsSwitch[] = "rounds";
+
+const int kDefaultEntries = 50000;
+const int kDefaultLookups = 1000;
+const int kDefaultMaxThreads = 32;
+const int kDefaultRounds = 3;
+
+int GetIntSwitch(const CommandLine& command_line,
+                 const char* name,
+                 int default_value) {
+  if (!command_line.HasSwitch(name))
+    return default_value;
+  int value = 0;
+  if (!base::StringToInt(command_line.GetSwitchValueASCII(name), &value) ||
+      value <= 0) {
+    fprintf(stderr, "Invalid value for --%s, using %d\n", name,
+            default_value);
+    return default_value;
+  }
+  return value;
+}
+
+std::string EntryName(int i) {
+  return base::StringPrintf("resources/%03d/resource_%06d.dat", i % 512, i);
+}
+
+// Contents of entry |i|: a few hundred bytes to a few KB of text that
+// deflate does real work on.
+std::string EntryContents(int i) {
+  std::string contents;
+  unsigned seed = i * 2654435761u + 1;
+  int lines = 4 + i % 61;
+  for (int line = 0; line < lines; ++line) {
+    seed = seed * 1103515245 + 12345;
+    contents += base::StringPrintf("resource %d line %d value %u %s\n", i,
+                                   line, (seed >> 8) & 0xffff,
+                                   (seed & 1) ? "enabled" : "disabled");
+  }
+  return contents;
+}
+
+bool WriteArchive(const std::string& path, int entry_count) {
+  zipFile file = zipOpen(path.c_str(), APPEND_STATUS_CREATE);
+  if (!file)
+    return false;
+  for (int i = 0; i < entry_count; ++i) {
+    std::string contents = EntryContents(i);
+    zip_fileinfo info = {};
+    bool stored = i % 4 == 0;
+    if (zipOpenNewFileInZip(file, EntryName(i).c_str(), &info, NULL, 0, NULL,
+                            0, NULL, stored ? 0 : Z_DEFLATED,
+                            Z_DEFAULT_COMPRESSION) != ZIP_OK ||
+        zipWriteInFileInZip(file, contents.data(),
+                            static_cast<unsigned>(contents.size())) !=
+            ZIP_OK ||
+        zipCloseFileInZip(file) != ZIP_OK) {
+      zipClose(file, NULL);
+      return false;
+    }
+  }
+  return zipClose(file, NULL) == ZIP_OK;
+}
+
+// Reads the current entry of |file| into |contents|.
+bool ReadCurrentEntry(unzFile file, std::string* contents) {
+  unz_file_info info;
+  if (unzGetCurrentFileInfo(file, &info, NULL, 0, NULL, 0, NULL, 0) !=
+          UNZ_OK ||
+      unzOpenCurrentFile(file) != UNZ_OK) {
+    return false;
+  }
+  contents->resize(info.uncompressed_size);
+  int read = unzReadCurrentFile(
+      file, contents->empty() ? NULL : &(*contents)[0],
+      static_cast<unsigned>(contents->size()));
+  return unzCloseCurrentFile(file) == UNZ_OK &&
+      read == static_cast<int>(contents->size());
+}
+
+void PrintTime(const char* graph, const std::string& trace,
+               base::TimeDelta time) {
+  printf("RESULT %s: %s= %.3f ms\n", graph, trace.c_str(),
+         time.InMillisecondsF());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  CommandLine::Init(argc, argv);
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+
+  // The exit manager is in charge of calling the dtors of singleton objects.
+  base::AtExitManager exit_manager;
+
+  int entry_count = GetIntSwitch(command_line, kEntriesSwitch,
+                                 kDefaultEntries);
+  int lookups = std::min(
+      entry_count, GetIntSwitch(command_line, kLookupsSwitch, kDefaultLookups));
+  int max_threads =
+      GetIntSwitch(command_line, kMaxThreadsSwitch, kDefaultMaxThreads);
+  int rounds = GetIntSwitch(command_line, kRoundsSwitch, kDefaultRounds);
+
+  ScopedTempDir temp_dir;
+  if (!temp_dir.CreateUniqueTempDir()) {
+    fprintf(stderr, "Cannot create a temporary directory\n");
+    return 1;
+  }
+  FilePath archive = temp_dir.path().AppendASCII("bundle.zip");
+  if (!WriteArchive(archive.AsUTF8Unsafe(), entry_count)) {
+    fprintf(stderr, "Cannot write the archive\n");
+    return 1;
+  }
+
+  std::vector<std::string> expected(entry_count);
+  for (int i = 0; i < entry_count; ++i)
+    expected[i] = EntryContents(i);
+
+  // Names to look up, spread over the archive.
+  std::vector<std::string> lookup_names;
+  for (int i = 0; i < lookups; ++i)
+    lookup_names.push_back(EntryName(
+        static_cast<int>(static_cast<int64>(i) * 7919 % entry_count)));
+
+  base::TimeDelta best_open, best_lookup, best_extract;
+  for (int round = 0; round < rounds; ++round) {
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    unzFile file = unzOpen(archive.AsUTF8Unsafe().c_str());
+    base::TimeDelta open = base::TimeTicks::HighResNow() - start;
+    if (!file) {
+      fprintf(stderr, "minizip cannot open the archive\n");
+      return 1;
+    }
+
+    start = base::TimeTicks::HighResNow();
+    for (size_t i = 0; i < lookup_names.size(); ++i) {
+      if (unzLocateFile(file, lookup_names[i].c_str(), 1) != UNZ_OK) {
+        fprintf(stderr, "minizip cannot find %s\n", lookup_names[i].c_str());
+        return 1;
+      }
+    }
+    base::TimeDelta lookup = base::TimeTicks::HighResNow() - start;
+
+    start = base::TimeTicks::HighResNow();
+    std::string contents;
+    int i = 0;
+    for (int result = unzGoToFirstFile(file); result == UNZ_OK;
+         result = unzGoToNextFile(file), ++i) {
+      if (!ReadCurrentEntry(file, &contents) || contents != expected[i]) {
+        fprintf(stderr, "minizip extracted entry %d wrong\n", i);
+        return 1;
+      }
+    }
+    base::TimeDelta extract = base::TimeTicks::HighResNow() - start;
+    unzClose(file);
+    if (i != entry_count) {
+      fprintf(stderr, "minizip extracted %d entries\n", i);
+      return 1;
+    }
+
+    if (round == 0 || open < best_open)
+      best_open = open;
+    if (round == 0 || lookup < best_lookup)
+      best_lookup = lookup;
+    if (round == 0 || extract < best_extract)
+      best_extract = extract;
+  }
+  PrintTime("zip_open", "minizip", best_open);
+  PrintTime("zip_lookups", "minizip", best_lookup);
+  PrintTime("zip_extract_all", "minizip", best_extract);
+
+  for (int round = 0; round < rounds; ++round) {
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    zlib::ZipReader reader;
+    if (!reader.Open(archive)) {
+      fprintf(stderr, "ZipReader cannot open the archive\n");
+      return 1;
+    }
+    base::TimeDelta open = base::TimeTicks::HighResNow() - start;
+
+    start = base::TimeTicks::HighResNow();
+    for (size_t i = 0; i < lookup_names.size(); ++i) {
+      if (!reader.FindEntry(lookup_names[i])) {
+        fprintf(stderr, "ZipReader cannot find %s\n", lookup_names[i].c_str());
+        return 1;
+      }
+    }
+    base::TimeDelta lookup = base::TimeTicks::HighResNow() - start;
+
+    if (round == 0 || open < best_open)
+      best_open = open;
+    if (round == 0 || lookup < best_lookup)
+      best_lookup = lookup;
+  }
+  PrintTime("zip_open", "zip_reader", best_open);
+  PrintTime("zip_lookups", "zip_reader", best_lookup);
+
+  zlib::ZipReader reader;
+  if (!reader.Open(archive) ||
+      reader.entry_count() != static_cast<size_t>(entry_count)) {
+    fprintf(stderr, "ZipReader cannot open the archive\n");
+    return 1;
+  }
+  std::vector<const zlib::ZipReader::Entry*> entries;
+  for (size_t i = 0; i < reader.entry_count(); ++i)
+    entries.push_back(&reader.entry(i));
+
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    std::vector<std::string> contents;
+    base::TimeDelta best;
+    for (int round = 0; round < rounds; ++round) {
+      base::TimeTicks start = base::TimeTicks::HighResNow();
+      if (!reader.ExtractInParallel(entries, threads, &contents)) {
+        fprintf(stderr, "ZipReader extraction failed with %d threads\n",
+                threads);
+        return 1;
+      }
+      base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+      if (round == 0 || elapsed < best)
+        best = elapsed;
+    }
+    if (contents != expected) {
+      fprintf(stderr, "ZipReader extracted the wrong contents with %d "
+              "threads\n", threads);
+      return 1;
+    }
+    PrintTime("zip_extract_all",
+              base::StringPrintf("zip_reader_threads_%d", threads), best);
+  }
+
+  // Stored entries come straight out of the mapping.
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  size_t stored_bytes = 0;
+  for (size_t i = 0; i < reader.entry_count(); ++i) {
+    base::StringPiece contents;
+    if (reader.GetStoredContents(reader.entry(i), &contents))
+      stored_bytes += contents.size();
+  }
+  PrintTime("zip_stored_contents", "zip_reader",
+            base::TimeTicks::HighResNow() - start);
+  printf("RESULT zip_stored_contents_size: zip_reader= %lu bytes\n",
+         static_cast<unsigned long>(stored_bytes));
+  return 0;
+}
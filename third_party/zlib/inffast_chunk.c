@@ -0,0 +1,336 @@
+/* inffast_chunk.c -- fast decoding with wide copies
+ * Copyright (C) 1995-2004 Mark Adler
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * This is inflate_fast() from inffast.c with three changes:
+ *
+ * - Matches copy 8 or 16 bytes at a time instead of one.  A copy may write
+ *   up to INFLATE_CHUNK_SIZE - 1 bytes past the end of the match; those bytes
+ *   are in the caller's output buffer, past next_out, and are overwritten
+ *   by later output.  That is why inflate() requires INFLATE_FAST_MIN_OUTPUT
+ *   bytes of output space instead of 258.
+ *
+ * - On 64-bit processors the bit buffer is refilled with one unaligned
+ *   eight-byte load that adds six bytes, instead of one byte at a time.
+ *   After a refill there are at least 48 bits, enough for a whole
+ *   length/distance pair.  The two bytes loaded past the six are the next
+ *   input bytes, at the bit positions the next refill puts them in, so
+ *   refills combine the buffer with | instead of +.
+ *
+ * - inflate() builds dynamic length/literal tables with a 10-bit root
+ *   instead of 9, so fewer codes need a second-level lookup.
+ *
+ * inflateBack() uses the output buffer as the window and keeps calling
+ * inflate_fast().
+ */
+
+#include "zutil.h"
+#include "inftrees.h"
+#include "inflate.h"
+#include "inffast_chunk.h"
+
+#ifdef INFLATE_CHUNK_READ64
+#  ifdef _MSC_VER
+     typedef unsigned __int64 inflate_holder_t;
+#  else
+     typedef unsigned long long inflate_holder_t;
+#  endif
+#else
+   typedef unsigned long inflate_holder_t;
+#endif
+
+local unsigned char FAR *chunk_copy_lapped OF((unsigned char FAR *out,
+                                               unsigned dist, unsigned len));
+#ifdef INFLATE_CHUNK_READ64
+local inflate_holder_t read64le OF((const unsigned char FAR *in));
+#endif
+
+/* Make sure that there are at least n bits in the bit buffer.  n is at most
+   15. */
+#ifdef INFLATE_CHUNK_READ64
+#  define FILLBITS(n) \
+    do { \
+        if (bits < (unsigned)(n)) { \
+            hold |= read64le(in) << bits; \
+            in += 6; \
+            bits += 48; \
+        } \
+    } while (0)
+#else
+#  define FILLBITS(n) \
+    do { \
+        while (bits < (unsigned)(n)) { \
+            hold += (inflate_holder_t)(*in++) << bits; \
+            bits += 8; \
+        } \
+    } while (0)
+#endif
+
+#ifdef INFLATE_CHUNK_READ64
+local inflate_holder_t read64le(in)
+const unsigned char FAR *in;
+{
+    inflate_holder_t value;
+
+    zmemcpy(&value, in, sizeof(value));
+    return value;
+}
+#endif
+
+/*
+   Copy len bytes from out - dist to out, where the two may overlap as in any
+   LZ77 match, and return out + len.  May write up to INFLATE_CHUNK_SIZE - 1
+   bytes past out + len.  Each chunk is read only from bytes that are already
+   final: the source is at least a chunk behind the destination.
+ */
+local unsigned char FAR *chunk_copy_lapped(out, dist, len)
+unsigned char FAR *out;
+unsigned dist;
+unsigned len;
+{
+    unsigned char FAR *limit = out + len;
+    unsigned char FAR *from;
+    unsigned period;
+
+    if (dist < 8) {
+        /* The bytes repeat every dist bytes, so also every multiple of dist
+           bytes.  Write one multiple that is at least 8 a byte at a time,
+           then copy chunks from that far back. */
+        period = dist;
+        while (period < 8)
+            period += dist;
+        from = out - dist;
+        len = len < period ? len : period;
+        do {
+            *out++ = *from++;
+        } while (--len);
+        if (out >= limit)
+            return limit;
+        dist = period;
+    }
+    from = out - dist;
+    if (dist < INFLATE_CHUNK_SIZE) {
+        do {
+            zmemcpy(out, from, 8);
+            out += 8;
+            from += 8;
+        } while (out < limit);
+    }
+    else {
+        do {
+            zmemcpy(out, from, INFLATE_CHUNK_SIZE);
+            out += INFLATE_CHUNK_SIZE;
+            from += INFLATE_CHUNK_SIZE;
+        } while (out < limit);
+    }
+    return limit;
+}
+
+/*
+   Decode literal, length, and distance codes and write out the resulting
+   literal and match bytes until either not enough input or output is
+   available, an end-of-block is encountered, or a data error is encountered.
+
+   Entry assumptions:
+
+        state->mode == LEN
+        strm->avail_in >= INFLATE_FAST_MIN_INPUT
+        strm->avail_out >= INFLATE_FAST_MIN_OUTPUT
+        start >= strm->avail_out
+        state->bits < 8
+
+   On return, state->mode is one of:
+
+        LEN -- ran out of enough output space or enough available input
+        TYPE -- reached end of block code, inflate() to interpret next block
+        BAD -- error in block data
+
+   See inflate_fast() for the reasoning behind the input and output limits.
+ */
+void inflate_fast_chunk(strm, start)
+z_streamp strm;
+unsigned start;         /* inflate()'s starting value for strm->avail_out */
+{
+    struct inflate_state FAR *state;
+    unsigned char FAR *in;      /* local strm->next_in */
+    unsigned char FAR *last;    /* while in < last, enough input available */
+    unsigned char FAR *out;     /* local strm->next_out */
+    unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
+    unsigned char FAR *end;     /* while out < end, enough space available */
+#ifdef INFLATE_STRICT
+    unsigned dmax;              /* maximum distance from zlib header */
+#endif
+    unsigned wsize;             /* window size or zero if not using window */
+    unsigned whave;             /* valid bytes in the window */
+    unsigned write;             /* window write index */
+    unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+    inflate_holder_t hold;      /* local strm->hold */
+    unsigned bits;              /* local strm->bits */
+    code const FAR *lcode;      /* local strm->lencode */
+    code const FAR *dcode;      /* local strm->distcode */
+    unsigned lmask;             /* mask for first level of length codes */
+    unsigned dmask;             /* mask for first level of distance codes */
+    code this;                  /* retrieved table entry */
+    unsigned op;                /* code bits, operation, extra bits, or */
+                                /*  window position, window bytes to copy */
+    unsigned len;               /* match length, unused bytes */
+    unsigned dist;              /* match distance */
+    unsigned char FAR *from;    /* where to copy match from */
+
+    /* copy state to local variables */
+    state = (struct inflate_state FAR *)strm->state;
+    in = strm->next_in;
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_INPUT - 1));
+    out = strm->next_out;
+    beg = out - (start - strm->avail_out);
+    end = out + (strm->avail_out - (INFLATE_FAST_MIN_OUTPUT - 1));
+#ifdef INFLATE_STRICT
+    dmax = state->dmax;
+#endif
+    wsize = state->wsize;
+    whave = state->whave;
+    write = state->write;
+    window = state->window;
+    hold = state->hold;
+    bits = state->bits;
+    lcode = state->lencode;
+    dcode = state->distcode;
+    lmask = (1U << state->lenbits) - 1;
+    dmask = (1U << state->distbits) - 1;
+
+    /* decode literals and length/distances until end-of-block or not enough
+       input data or output space */
+    do {
+        FILLBITS(15);
+        this = lcode[hold & lmask];
+      dolen:
+        op = (unsigned)(this.bits);
+        hold >>= op;
+        bits -= op;
+        op = (unsigned)(this.op);
+        if (op == 0) {                          /* literal */
+            Tracevv((stderr, this.val >= 0x20 && this.val < 0x7f ?
+                    "inflate:         literal '%c'\n" :
+                    "inflate:         literal 0x%02x\n", this.val));
+            *out++ = (unsigned char)(this.val);
+        }
+        else if (op & 16) {                     /* length base */
+            len = (unsigned)(this.val);
+            op &= 15;                           /* number of extra bits */
+            if (op) {
+                FILLBITS(op);
+                len += (unsigned)hold & ((1U << op) - 1);
+                hold >>= op;
+                bits -= op;
+            }
+            Tracevv((stderr, "inflate:         length %u\n", len));
+            FILLBITS(15);
+            this = dcode[hold & dmask];
+          dodist:
+            op = (unsigned)(this.bits);
+            hold >>= op;
+            bits -= op;
+            op = (unsigned)(this.op);
+            if (op & 16) {                      /* distance base */
+                dist = (unsigned)(this.val);
+                op &= 15;                       /* number of extra bits */
+                FILLBITS(op);
+                dist += (unsigned)hold & ((1U << op) - 1);
+#ifdef INFLATE_STRICT
+                if (dist > dmax) {
+                    strm->msg = (char *)"invalid distance too far back";
+                    state->mode = BAD;
+                    break;
+                }
+#endif
+                hold >>= op;
+                bits -= op;
+                Tracevv((stderr, "inflate:         distance %u\n", dist));
+                op = (unsigned)(out - beg);     /* max distance in output */
+                if (dist > op) {                /* see if copy from window */
+                    op = dist - op;             /* distance back in window */
+                    if (op > whave) {
+                        strm->msg = (char *)"invalid distance too far back";
+                        state->mode = BAD;
+                        break;
+                    }
+                    /* The window is a separate buffer, so window bytes are
+                       copied exactly; the rest of the match comes from the
+                       output. */
+                    from = window;
+                    if (write == 0) {           /* very common case */
+                        from += wsize - op;
+                    }
+                    else if (write < op) {      /* wrap around window */
+                        from += wsize + write - op;
+                        op -= write;
+                        if (op < len) {         /* some from end of window */
+                            len -= op;
+                            zmemcpy(out, from, op);
+                            out += op;
+                            from = window;
+                            op = write;         /* then start of window */
+                        }
+                    }
+                    else {                      /* contiguous in window */
+                        from += write - op;
+                    }
+                    if (op >= len) {            /* all from window */
+                        zmemcpy(out, from, len);
+                        out += len;
+                    }
+                    else {
+                        zmemcpy(out, from, op);
+                        out += op;
+                        out = chunk_copy_lapped(out, dist, len - op);
+                    }
+                }
+                else {                          /* copy direct from output */
+                    out = chunk_copy_lapped(out, dist, len);
+                }
+            }
+            else if ((op & 64) == 0) {          /* 2nd level distance code */
+                this = dcode[this.val + (hold & ((1U << op) - 1))];
+                goto dodist;
+            }
+            else {
+                strm->msg = (char *)"invalid distance code";
+                state->mode = BAD;
+                break;
+            }
+        }
+        else if ((op & 64) == 0) {              /* 2nd level length code */
+            this = lcode[this.val + (hold & ((1U << op) - 1))];
+            goto dolen;
+        }
+        else if (op & 32) {                     /* end-of-block */
+            Tracevv((stderr, "inflate:         end of block\n"));
+            state->mode = TYPE;
+            break;
+        }
+        else {
+            strm->msg = (char *)"invalid literal/length code";
+            state->mode = BAD;
+            break;
+        }
+    } while (in < last && out < end);
+
+    /* return unused bytes (on entry, bits < 8, so in won't go too far back) */
+    len = bits >> 3;
+    in -= len;
+    bits -= len << 3;
+    hold &= (1U << bits) - 1;
+
+    /* update state and return */
+    strm->next_in = in;
+    strm->next_out = out;
+    strm->avail_in = (unsigned)(in < last ?
+        (INFLATE_FAST_MIN_INPUT - 1) + (last - in) :
+        (INFLATE_FAST_MIN_INPUT - 1) - (in - last));
+    strm->avail_out = (unsigned)(out < end ?
+        (INFLATE_FAST_MIN_OUTPUT - 1) + (end - out) :
+        (INFLATE_FAST_MIN_OUTPUT - 1) - (out - end));
+    state->hold = (unsigned long)hold;
+    state->bits = bits;
+    return;
+}
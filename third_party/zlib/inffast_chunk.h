@@ -0,0 +1,34 @@
+/* inffast_chunk.h -- header to use inffast_chunk.c
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#include "inffast.h"
+
+/* Bytes a match copy may write past its end. */
+#define INFLATE_CHUNK_SIZE 16
+
+/* Read the bit buffer eight bytes at a time on 64-bit little-endian
+   processors that allow unaligned loads. */
+#if !defined(NO_INFLATE_CHUNK_READ64) && \
+    (defined(__x86_64__) || defined(_M_X64) || \
+     (defined(__aarch64__) && defined(__ORDER_LITTLE_ENDIAN__) && \
+      __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#  define INFLATE_CHUNK_READ64
+#endif
+
+/* inflate() calls inflate_fast_chunk() when it has at least this much input
+   and output space: one refill of the bit buffer past the six bytes a code
+   pair may use, and one chunk past the longest match. */
+#ifdef INFLATE_CHUNK_READ64
+#  define INFLATE_FAST_MIN_INPUT 8
+#else
+#  define INFLATE_FAST_MIN_INPUT 6
+#endif
+#define INFLATE_FAST_MIN_OUTPUT (258 + INFLATE_CHUNK_SIZE)
+
+void inflate_fast_chunk OF((z_streamp strm, unsigned start));
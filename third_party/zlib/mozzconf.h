@@ -109,6 +109,7 @@
 #define deflate_copyright MOZ_Z_deflate_copyright
 #define inflate_copyright MOZ_Z_inflate_copyright
 #define inflate_fast MOZ_Z_inflate_fast
+#define inflate_fast_chunk MOZ_Z_inflate_fast_chunk
 #define inflate_table MOZ_Z_inflate_table
 #define z_errmsg MOZ_Z_z_errmsg
 #define zcalloc MOZ_Z_zcalloc
@@ -117,6 +118,12 @@
 #define free_func MOZ_Z_free_func
 #define in_func MOZ_Z_in_func
 #define out_func MOZ_Z_out_func
+#define x86_cpu_features MOZ_Z_x86_cpu_features
+#define crc32_pclmul MOZ_Z_crc32_pclmul
+#define adler32_ssse3 MOZ_Z_adler32_ssse3
+#define adler32_avx2 MOZ_Z_adler32_avx2
+#define deflate_hash_crc32c MOZ_Z_deflate_hash_crc32c
+#define slide_hash_sse2 MOZ_Z_slide_hash_sse2
 
 /* New as of libpng-1.2.3 */
 #define adler32_combine MOZ_Z_adler32_combine
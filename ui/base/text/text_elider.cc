@@ -20,6 +20,7 @@
 // #include "net/base/net_util.h"
 // #include "net/base/registry_controlled_domain.h"
 #include "ui/gfx/font.h"
+#include "ui/gfx/text_metrics_cache.h"
 // #include "unicode/rbbi.h"
 // #include "unicode/uloc.h"
 
@@ -310,7 +311,8 @@ string16 ElideFilename(const FilePath& filename,
       filename.BaseName().RemoveExtension().value()));
 #endif
 
-  int full_width = font.GetStringWidth(filename_utf16);
+  gfx::TextMetricsCache* metrics = gfx::TextMetricsCache::GetInstance();
+  int full_width = metrics->GetStringWidth(filename_utf16, font);
   if (full_width <= available_pixel_width)
     return base::i18n::GetDisplayStringInLTRDirectionality(filename_utf16);
 
@@ -320,8 +322,8 @@ string16 ElideFilename(const FilePath& filename,
     return base::i18n::GetDisplayStringInLTRDirectionality(elided_name);
   }
 
-  int ext_width = font.GetStringWidth(extension);
-  int root_width = font.GetStringWidth(rootname);
+  int ext_width = metrics->GetStringWidth(extension, font);
+  int root_width = metrics->GetStringWidth(rootname, font);
 
   // We may have trimmed the path.
   if (root_width + ext_width <= available_pixel_width) {
@@ -351,7 +353,10 @@ string16 ElideText(const string16& text,
   if (text.empty())
     return text;
 
-  int current_text_pixel_width = font.GetStringWidth(text);
+  // Only whole strings go through the shared cache; the candidates tried by
+  // the binary search below are rarely measured twice.
+  gfx::TextMetricsCache* metrics = gfx::TextMetricsCache::GetInstance();
+  int current_text_pixel_width = metrics->GetStringWidth(text, font);
 
   // Pango will return 0 width for absurdly long strings. Cut the string in
   // half and try again.
@@ -369,7 +374,8 @@ string16 ElideText(const string16& text,
   if (current_text_pixel_width <= available_pixel_width)
     return text;
 
-  if (font.GetStringWidth(UTF8ToUTF16(kEllipsis)) > available_pixel_width)
+  if (metrics->GetStringWidth(UTF8ToUTF16(kEllipsis), font) >
+      available_pixel_width)
     return string16();
 
   // Use binary search to compute the elided text.
@@ -6,8 +6,15 @@
 
 #include <setjmp.h>
 
+#include <algorithm>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
 
@@ -189,6 +196,13 @@ class CompressDestroyer {
 bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
                        int w, int h, int row_byte_width,
                        int quality, std::vector<unsigned char>* output) {
+  return Encode(input, format, w, h, row_byte_width, quality, 0, output);
+}
+
+bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
+                       int w, int h, int row_byte_width,
+                       int quality, int restart_rows,
+                       std::vector<unsigned char>* output) {
   jpeg_compress_struct cinfo;
   CompressDestroyer destroyer;
   destroyer.SetManagedObject(&cinfo);
@@ -245,6 +259,7 @@ bool JPEGCodec::Encode(const unsigned char* input, ColorFormat format,
 
   jpeg_set_defaults(&cinfo);
   jpeg_set_quality(&cinfo, quality, 1);  // quality here is 0-100
+  cinfo.restart_in_rows = restart_rows;
 
   // set up the destination manager
   jpeg_destination_mgr destmgr;
@@ -431,15 +446,414 @@ class DecompressDestroyer {
   jpeg_decompress_struct* cinfo_;
 };
 
+// Where the decoded image goes: either a vector or the pixels of a bitmap.
+// The memory is allocated by AllocateRows() once the size of the image is
+// known, and the rows are decoded straight into it.
+struct DecodeOutput {
+  explicit DecodeOutput(std::vector<unsigned char>* o)
+      : output(o),
+        bitmap(NULL) {
+  }
+  explicit DecodeOutput(SkBitmap* b)
+      : output(NULL),
+        bitmap(b) {
+  }
+
+  std::vector<unsigned char>* output;
+  SkBitmap* bitmap;
+};
+
+// Allocates |h| rows of |w| pixels of |bytes_per_pixel| each in |output|.
+// Returns the first row, with the distance between rows in |*row_bytes|, or
+// NULL on failure. Bitmaps only take 4 bytes per pixel.
+unsigned char* AllocateRows(const DecodeOutput& output, int w, int h,
+                            int bytes_per_pixel, int* row_bytes) {
+  if (output.bitmap) {
+    DCHECK_EQ(4, bytes_per_pixel);
+    output.bitmap->setConfig(SkBitmap::kARGB_8888_Config, w, h);
+    if (!output.bitmap->allocPixels())
+      return NULL;
+    // JPEGs have no alpha, so the pixels are opaque and their premultiplied
+    // values are the same as the unpremultiplied ones.
+    output.bitmap->setIsOpaque(true);
+    *row_bytes = output.bitmap->rowBytes();
+    return static_cast<unsigned char*>(output.bitmap->getPixels());
+  }
+  *row_bytes = w * bytes_per_pixel;
+  output.output->resize(static_cast<size_t>(*row_bytes) * h);
+  return output.output->empty() ? NULL : &(*output.output)[0];
+}
+
+// Reads the next row of the image into |row|. The C color converters of
+// libjpeg-turbo leave the X byte of the 4-byte formats alone while the SIMD
+// ones write 0xFF to it, so it is made opaque here first.
+bool ReadRow(jpeg_decompress_struct* cinfo, unsigned char* row) {
+  if (cinfo->output_components == 4)
+    memset(row, 0xFF, cinfo->output_width * 4);
+  return jpeg_read_scanlines(cinfo, &row, 1) == 1;
+}
+
 }  // namespace
 
-bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
-                       ColorFormat format, std::vector<unsigned char>* output,
-                       int* w, int* h) {
+// Parallel decoder ------------------------------------------------------------
+//
+// A sequential JPEG with restart markers can be cut at any restart marker
+// that starts a row of MCUs: the DC predictions start over at each marker, so
+// the entropy-coded data after it decodes without anything before it. A strip
+// of MCU rows, behind the headers of the image with the height changed and
+// with its restart markers renumbered from 0, is then a JPEG of its own. The
+// strips are decoded at the same time, each straight into its rows of the
+// output.
+//
+// When the chroma is subsampled vertically, the upsampler blends each output
+// row with the chroma rows next to it. Such strips are decoded with rows of
+// MCUs of context above and below, which are thrown away, so that the output
+// is the same as a sequential decode.
+
+namespace {
+
+// Only images with at least this many pixels per thread are decoded in
+// parallel; for smaller ones, starting the threads costs more than it saves.
+const int kMinParallelPixelsPerThread = 256 * 256;
+
+// Where the parts of a JPEG file are, as found by ScanJpegLayout().
+struct JpegLayout {
+  JpegLayout() : height_offset(0), entropy_offset(0) {}
+
+  // Offset of the two-byte image height in the SOF segment.
+  size_t height_offset;
+
+  // Offset of the entropy-coded data, just after the SOS segment.
+  size_t entropy_offset;
+
+  // Start and end of the entropy-coded data of each restart interval. The
+  // ends are where the following RSTn or EOI marker is.
+  std::vector<size_t> interval_starts;
+  std::vector<size_t> interval_ends;
+};
+
+// Finds the parts of a baseline or extended sequential Huffman-coded JPEG
+// with a single scan. Returns false for any other kind of file, or when the
+// restart markers are out of order.
+bool ScanJpegLayout(const unsigned char* input, size_t input_size,
+                    JpegLayout* layout) {
+  if (input_size < 4 || input[0] != 0xFF || input[1] != 0xD8)
+    return false;
+
+  // Marker segments, up to and including SOS.
+  bool found_sof = false;
+  size_t pos = 2;
+  for (;;) {
+    if (pos + 4 > input_size || input[pos] != 0xFF)
+      return false;
+    while (pos < input_size && input[pos] == 0xFF)
+      pos++;
+    if (pos + 3 > input_size)
+      return false;
+    unsigned char marker = input[pos++];
+    size_t length = (input[pos] << 8) | input[pos + 1];
+    if (length < 2 || pos + length > input_size)
+      return false;
+    if (marker == 0xC0 || marker == 0xC1) {
+      if (found_sof || length < 8)
+        return false;
+      found_sof = true;
+      layout->height_offset = pos + 3;
+    } else if (marker >= 0xC2 && marker <= 0xCF &&
+               marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+      // Progressive, lossless or arithmetic-coded.
+      return false;
+    } else if (marker == 0xDA) {
+      layout->entropy_offset = pos + length;
+      break;
+    }
+    pos += length;
+  }
+  if (!found_sof)
+    return false;
+
+  // Entropy-coded data, up to EOI. Any other marker means another scan.
+  layout->interval_starts.push_back(layout->entropy_offset);
+  for (pos = layout->entropy_offset; pos + 1 < input_size; ) {
+    if (input[pos] != 0xFF) {
+      pos++;
+      continue;
+    }
+    unsigned char marker = input[pos + 1];
+    if (marker == 0x00) {
+      pos += 2;  // Stuffed zero byte.
+    } else if (marker == 0xFF) {
+      pos++;  // Fill byte.
+    } else if (marker >= 0xD0 && marker <= 0xD7) {
+      size_t expected = layout->interval_ends.size() % 8;
+      if (marker != 0xD0 + expected)
+        return false;
+      layout->interval_ends.push_back(pos);
+      pos += 2;
+      layout->interval_starts.push_back(pos);
+    } else if (marker == 0xD9) {
+      layout->interval_ends.push_back(pos);
+      return true;
+    } else {
+      return false;
+    }
+  }
+  return false;
+}
+
+// Decodes a strip of MCU rows of a JPEG into its rows of the output.
+class StripDecoder : public base::DelegateSimpleThread::Delegate {
+ public:
+  // The strip is made of the restart intervals [first_interval,
+  // last_interval) and has |height| rows. The first |skip_rows| of them are
+  // context, and the |output_rows| after them go to |output|.
+  StripDecoder(const unsigned char* input,
+               const JpegLayout& layout,
+               size_t first_interval,
+               size_t last_interval,
+               int height,
+               int skip_rows,
+               int output_rows,
+               J_COLOR_SPACE out_color_space,
+               int output_components,
+               unsigned char* output,
+               int output_stride)
+      : input_(input),
+        layout_(layout),
+        first_interval_(first_interval),
+        last_interval_(last_interval),
+        height_(height),
+        skip_rows_(skip_rows),
+        output_rows_(output_rows),
+        out_color_space_(out_color_space),
+        output_components_(output_components),
+        output_(output),
+        output_stride_(output_stride),
+        succeeded_(false) {
+  }
+
+  // Overridden from base::DelegateSimpleThread::Delegate:
+  virtual void Run() OVERRIDE;
+
+  bool succeeded() const { return succeeded_; }
+
+ private:
+  // Builds the JPEG file of the strip.
+  void BuildStrip(std::vector<unsigned char>* strip) const;
+
+  bool Decode(const std::vector<unsigned char>& strip);
+
+  const unsigned char* input_;
+  const JpegLayout& layout_;
+  const size_t first_interval_;
+  const size_t last_interval_;
+  const int height_;
+  const int skip_rows_;
+  const int output_rows_;
+  const J_COLOR_SPACE out_color_space_;
+  const int output_components_;
+  unsigned char* output_;
+  const int output_stride_;
+  bool succeeded_;
+
+  DISALLOW_COPY_AND_ASSIGN(StripDecoder);
+};
+
+void StripDecoder::Run() {
+  std::vector<unsigned char> strip;
+  BuildStrip(&strip);
+  succeeded_ = Decode(strip);
+}
+
+void StripDecoder::BuildStrip(std::vector<unsigned char>* strip) const {
+  size_t size = layout_.entropy_offset + 2;
+  for (size_t i = first_interval_; i < last_interval_; ++i)
+    size += layout_.interval_ends[i] - layout_.interval_starts[i] + 2;
+  strip->reserve(size);
+
+  strip->assign(input_, input_ + layout_.entropy_offset);
+  (*strip)[layout_.height_offset] = static_cast<unsigned char>(height_ >> 8);
+  (*strip)[layout_.height_offset + 1] = static_cast<unsigned char>(height_);
+  for (size_t i = first_interval_; i < last_interval_; ++i) {
+    if (i > first_interval_) {
+      strip->push_back(0xFF);
+      strip->push_back(
+          static_cast<unsigned char>(0xD0 + (i - first_interval_ - 1) % 8));
+    }
+    strip->insert(strip->end(), input_ + layout_.interval_starts[i],
+                  input_ + layout_.interval_ends[i]);
+  }
+  strip->push_back(0xFF);
+  strip->push_back(0xD9);
+}
+
+bool StripDecoder::Decode(const std::vector<unsigned char>& strip) {
+  // Context rows are decoded into this row. It is allocated before setjmp()
+  // so that it is freed when libjpeg fails.
+  std::vector<unsigned char> scratch(output_stride_);
+
   jpeg_decompress_struct cinfo;
   DecompressDestroyer destroyer;
   destroyer.SetManagedObject(&cinfo);
-  output->clear();
+
+  CoderErrorMgr errmgr;
+  cinfo.err = jpeg_std_error(&errmgr.pub);
+  errmgr.pub.error_exit = ErrorExit;
+  if (setjmp(errmgr.setjmp_buffer)) {
+    // See note in JPEGCodec::Encode() for why we need to destroy the cinfo
+    // manually here.
+    destroyer.DestroyManagedObject();
+    return false;
+  }
+  jpeg_create_decompress(&cinfo);
+
+  jpeg_source_mgr srcmgr;
+  srcmgr.init_source = InitSource;
+  srcmgr.fill_input_buffer = FillInputBuffer;
+  srcmgr.skip_input_data = SkipInputData;
+  srcmgr.resync_to_restart = jpeg_resync_to_restart;  // use default routine
+  srcmgr.term_source = TermSource;
+  cinfo.src = &srcmgr;
+
+  JpegDecoderState state(&strip[0], strip.size());
+  cinfo.client_data = &state;
+
+  if (jpeg_read_header(&cinfo, true) != JPEG_HEADER_OK)
+    return false;
+  cinfo.out_color_space = out_color_space_;
+  cinfo.output_components = output_components_;
+  jpeg_start_decompress(&cinfo);
+
+  // The context rows after the output rows are never read; libjpeg decodes
+  // them as it needs them to upsample the last output rows.
+  for (int row = 0; row < skip_rows_ + output_rows_; ++row) {
+    unsigned char* rowptr = row < skip_rows_ ? &scratch[0] :
+        output_ + static_cast<size_t>(row - skip_rows_) * output_stride_;
+    if (!ReadRow(&cinfo, rowptr))
+      return false;
+  }
+
+  // A warning means corrupt data, which libjpeg may have recovered from
+  // differently than it would in a sequential decode.
+  return errmgr.pub.num_warnings == 0;
+}
+
+int GreatestCommonDivisor(int a, int b) {
+  while (b) {
+    int c = a % b;
+    a = b;
+    b = c;
+  }
+  return a;
+}
+
+// Decodes the JPEG whose header |cinfo| has read into |output|, which has
+// room for the whole image in rows |output_stride| bytes apart, in strips on
+// several threads. Returns false without decoding when the image has no
+// restart markers at the start of MCU rows or is too small, and when any
+// strip fails; the caller then decodes the image sequentially.
+bool DecodeInParallel(const unsigned char* input,
+                      size_t input_size,
+                      const jpeg_decompress_struct& cinfo,
+                      unsigned char* output,
+                      int output_stride) {
+  if (cinfo.restart_interval == 0 || cinfo.progressive_mode ||
+      cinfo.arith_code || cinfo.comps_in_scan != cinfo.num_components ||
+      cinfo.scale_num != cinfo.scale_denom) {
+    return false;
+  }
+  int width = cinfo.image_width;
+  int height = cinfo.image_height;
+  int thread_count = std::min(base::SysInfo::NumberOfProcessors(),
+      static_cast<int>(static_cast<int64>(width) * height /
+                       kMinParallelPixelsPerThread));
+  if (thread_count < 2)
+    return false;
+
+  // Sizes of an MCU in pixels; a single-component scan has one block per
+  // MCU. Each component of an interleaved scan is blended with the chroma
+  // rows next to it when it has fewer rows than the image.
+  int mcu_width = DCTSIZE;
+  int mcu_height = DCTSIZE;
+  bool needs_context = false;
+  if (cinfo.num_components > 1) {
+    mcu_width *= cinfo.max_h_samp_factor;
+    mcu_height *= cinfo.max_v_samp_factor;
+    for (int i = 0; i < cinfo.num_components; ++i) {
+      if (cinfo.comp_info[i].v_samp_factor != cinfo.max_v_samp_factor)
+        needs_context = true;
+    }
+  }
+  int mcus_per_row = (width + mcu_width - 1) / mcu_width;
+  int mcu_rows = (height + mcu_height - 1) / mcu_height;
+  int interval = cinfo.restart_interval;
+
+  JpegLayout layout;
+  if (!ScanJpegLayout(input, input_size, &layout))
+    return false;
+  int64 mcu_count = static_cast<int64>(mcus_per_row) * mcu_rows;
+  if (static_cast<int64>(layout.interval_starts.size()) !=
+      (mcu_count + interval - 1) / interval) {
+    return false;
+  }
+
+  // Strips start every |strip_rows| MCU rows, a multiple of |row_step|, the
+  // distance between MCU rows that start with a restart marker.
+  int row_step = interval / GreatestCommonDivisor(interval, mcus_per_row);
+  int context_rows = needs_context ? row_step : 0;
+  int strip_rows = (mcu_rows + thread_count - 1) / thread_count;
+  strip_rows = (strip_rows + row_step - 1) / row_step * row_step;
+  int strip_count = (mcu_rows + strip_rows - 1) / strip_rows;
+  if (strip_count < 2)
+    return false;
+
+  ScopedVector<StripDecoder> strips;
+  for (int i = 0; i < strip_count; ++i) {
+    int first_row = i * strip_rows;
+    int end_row = std::min(mcu_rows, first_row + strip_rows);
+    int first_decoded_row = std::max(0, first_row - context_rows);
+    int end_decoded_row = std::min(mcu_rows, end_row + context_rows);
+    size_t first_interval =
+        static_cast<int64>(first_decoded_row) * mcus_per_row / interval;
+    size_t last_interval = end_decoded_row == mcu_rows ?
+        layout.interval_starts.size() :
+        static_cast<int64>(end_decoded_row) * mcus_per_row / interval;
+    int first_pixel_row = first_row * mcu_height;
+    int strip_height =
+        std::min(height, end_decoded_row * mcu_height) -
+        first_decoded_row * mcu_height;
+    strips.push_back(new StripDecoder(
+        input, layout, first_interval, last_interval, strip_height,
+        (first_row - first_decoded_row) * mcu_height,
+        std::min(height, end_row * mcu_height) - first_pixel_row,
+        cinfo.out_color_space, cinfo.output_components,
+        output + static_cast<size_t>(first_pixel_row) * output_stride,
+        output_stride));
+  }
+
+  base::DelegateSimpleThreadPool pool("jpeg_decoder", thread_count);
+  for (int i = 0; i < strip_count; ++i)
+    pool.AddWork(strips[i]);
+  pool.Start();
+  pool.JoinAll();
+
+  for (int i = 0; i < strip_count; ++i) {
+    if (!strips[i]->succeeded())
+      return false;
+  }
+  return true;
+}
+
+// Decodes the JPEG data contained in input of length input_size into
+// |output| in |format|, with the dimensions of the image in *w and *h.
+bool DecodeImpl(const unsigned char* input, size_t input_size,
+                JPEGCodec::ColorFormat format, const DecodeOutput& output,
+                int* w, int* h) {
+  jpeg_decompress_struct cinfo;
+  DecompressDestroyer destroyer;
+  destroyer.SetManagedObject(&cinfo);
+  if (output.output)
+    output.output->clear();
 
   // We set up the normal JPEG error routines, then override error_exit.
   // This must be done before the call to create_decompress.
@@ -485,15 +899,17 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
       // Same as JPEGCodec::Encode(), libjpeg-turbo supports all input formats
       // used by Chromium (i.e. RGB, RGBA, and BGRA) and we just map the input
       // parameters to a colorspace.
-      if (format == FORMAT_RGB) {
+      if (format == JPEGCodec::FORMAT_RGB) {
         cinfo.out_color_space = JCS_RGB;
         cinfo.output_components = 3;
-      } else if (format == FORMAT_RGBA ||
-                 (format == FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
+      } else if (format == JPEGCodec::FORMAT_RGBA ||
+                 (format == JPEGCodec::FORMAT_SkBitmap &&
+                  SK_R32_SHIFT == 0)) {
         cinfo.out_color_space = JCS_EXT_RGBX;
         cinfo.output_components = 4;
-      } else if (format == FORMAT_BGRA ||
-                 (format == FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
+      } else if (format == JPEGCodec::FORMAT_BGRA ||
+                 (format == JPEGCodec::FORMAT_SkBitmap &&
+                  SK_B32_SHIFT == 0)) {
         cinfo.out_color_space = JCS_EXT_BGRX;
         cinfo.output_components = 4;
       } else {
@@ -522,62 +938,68 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   *w = cinfo.output_width;
   *h = cinfo.output_height;
 
+#ifdef JCS_EXTENSIONS
+  // The rows are decoded straight into the output in the format it wants, so
+  // there is no conversion, the same as in JPEGCodec::Encode().
+  int row_write_stride;
+  unsigned char* rows = AllocateRows(output, *w, *h, cinfo.output_components,
+                                     &row_write_stride);
+  if (!rows)
+    return false;
+
+  // Large images with restart markers are decoded on several threads.
+  if (DecodeInParallel(input, input_size, cinfo, rows, row_write_stride))
+    return true;
+
   jpeg_start_decompress(&cinfo);
 
   // FIXME(brettw) we may want to allow the capability for callers to request
   // how to align row lengths as we do for the compressor.
-  int row_read_stride = cinfo.output_width * cinfo.output_components;
-
-#ifdef JCS_EXTENSIONS
-  // Create memory for a decoded image and write decoded lines to the memory
-  // without conversions same as JPEGCodec::Encode().
-  int row_write_stride = row_read_stride;
-  output->resize(row_write_stride * cinfo.output_height);
-
   for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
-    unsigned char* rowptr = &(*output)[row * row_write_stride];
-    if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
+    if (!ReadRow(&cinfo, rows + static_cast<size_t>(row) * row_write_stride))
       return false;
   }
 #else
-  if (format == FORMAT_RGB) {
+  jpeg_start_decompress(&cinfo);
+
+  if (format == JPEGCodec::FORMAT_RGB) {
     // easy case, row needs no conversion
-    int row_write_stride = row_read_stride;
-    output->resize(row_write_stride * cinfo.output_height);
+    int row_write_stride;
+    unsigned char* rows = AllocateRows(output, *w, *h, 3, &row_write_stride);
+    if (!rows)
+      return false;
 
     for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
-      unsigned char* rowptr = &(*output)[row * row_write_stride];
-      if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
+      if (!ReadRow(&cinfo, rows + static_cast<size_t>(row) * row_write_stride))
         return false;
     }
   } else {
     // Rows need conversion to output format: read into a temporary buffer and
-    // expand to the final one. Performance: we could avoid the extra
-    // allocation by doing the expansion in-place.
-    int row_write_stride;
+    // expand to the final one.
+    int row_read_stride = cinfo.output_width * cinfo.output_components;
     void (*converter)(const unsigned char* rgb, int w, unsigned char* out);
-    if (format == FORMAT_RGBA ||
-        (format == FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
-      row_write_stride = cinfo.output_width * 4;
+    if (format == JPEGCodec::FORMAT_RGBA ||
+        (format == JPEGCodec::FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
       converter = AddAlpha;
-    } else if (format == FORMAT_BGRA ||
-               (format == FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
-      row_write_stride = cinfo.output_width * 4;
+    } else if (format == JPEGCodec::FORMAT_BGRA ||
+               (format == JPEGCodec::FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
       converter = RGBtoBGRA;
     } else {
       NOTREACHED() << "Invalid pixel format";
-      jpeg_destroy_decompress(&cinfo);
       return false;
     }
 
-    output->resize(row_write_stride * cinfo.output_height);
+    int row_write_stride;
+    unsigned char* rows = AllocateRows(output, *w, *h, 4, &row_write_stride);
+    if (!rows)
+      return false;
 
     scoped_array<unsigned char> row_data(new unsigned char[row_read_stride]);
     unsigned char* rowptr = row_data.get();
     for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
-      if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
+      if (!ReadRow(&cinfo, rowptr))
         return false;
-      converter(rowptr, *w, &(*output)[row * row_write_stride]);
+      converter(rowptr, *w, rows + static_cast<size_t>(row) * row_write_stride);
     }
   }
 #endif
@@ -587,22 +1009,124 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   return true;
 }
 
+}  // namespace
+
+bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
+                       ColorFormat format, std::vector<unsigned char>* output,
+                       int* w, int* h) {
+  return DecodeImpl(input, input_size, format, DecodeOutput(output), w, h);
+}
+
 // static
 SkBitmap* JPEGCodec::Decode(const unsigned char* input, size_t input_size) {
+  // The image is decoded straight into the pixels of the bitmap, with no
+  // copy in between.
+  scoped_ptr<SkBitmap> bitmap(new SkBitmap());
   int w, h;
-  std::vector<unsigned char> data_vector;
-  if (!Decode(input, input_size, FORMAT_SkBitmap, &data_vector, &w, &h))
+  if (!DecodeImpl(input, input_size, FORMAT_SkBitmap,
+                  DecodeOutput(bitmap.get()), &w, &h)) {
     return NULL;
+  }
+  return bitmap.release();
+}
 
-  // Skia only handles 32 bit images.
-  int data_length = w * h * 4;
+JPEGCodec::YUVImage::YUVImage() : width(0), height(0) {
+  for (int i = 0; i < 3; ++i)
+    plane_width[i] = plane_height[i] = row_bytes[i] = 0;
+}
 
-  SkBitmap* bitmap = new SkBitmap();
-  bitmap->setConfig(SkBitmap::kARGB_8888_Config, w, h);
-  bitmap->allocPixels();
-  memcpy(bitmap->getAddr32(0, 0), &data_vector[0], data_length);
+JPEGCodec::YUVImage::~YUVImage() {
+}
 
-  return bitmap;
+// static
+bool JPEGCodec::DecodeToYUV(const unsigned char* input, size_t input_size,
+                            YUVImage* output) {
+  jpeg_decompress_struct cinfo;
+  DecompressDestroyer destroyer;
+  destroyer.SetManagedObject(&cinfo);
+
+  // Rows of the last blocks of a plane that are below the image are decoded
+  // into this row. It is declared before setjmp() so that it is freed when
+  // libjpeg fails.
+  std::vector<unsigned char> scratch;
+
+  CoderErrorMgr errmgr;
+  cinfo.err = jpeg_std_error(&errmgr.pub);
+  errmgr.pub.error_exit = ErrorExit;
+  if (setjmp(errmgr.setjmp_buffer)) {
+    // See note in JPEGCodec::Encode() for why we need to destroy the cinfo
+    // manually here.
+    destroyer.DestroyManagedObject();
+    return false;
+  }
+  jpeg_create_decompress(&cinfo);
+
+  jpeg_source_mgr srcmgr;
+  srcmgr.init_source = InitSource;
+  srcmgr.fill_input_buffer = FillInputBuffer;
+  srcmgr.skip_input_data = SkipInputData;
+  srcmgr.resync_to_restart = jpeg_resync_to_restart;  // use default routine
+  srcmgr.term_source = TermSource;
+  cinfo.src = &srcmgr;
+
+  JpegDecoderState state(input, input_size);
+  cinfo.client_data = &state;
+
+  if (jpeg_read_header(&cinfo, true) != JPEG_HEADER_OK)
+    return false;
+
+  // The planes are handed out as they are in the JPEG, which only works for
+  // YCbCr images whose Y plane is the full size of the image.
+  if (cinfo.jpeg_color_space != JCS_YCbCr || cinfo.num_components != 3 ||
+      cinfo.comp_info[0].h_samp_factor != cinfo.max_h_samp_factor ||
+      cinfo.comp_info[0].v_samp_factor != cinfo.max_v_samp_factor) {
+    return false;
+  }
+
+  // Raw data output skips the upsampling and the color conversion; the
+  // coefficients are only put through the inverse DCT.
+  cinfo.out_color_space = JCS_YCbCr;
+  cinfo.raw_data_out = TRUE;
+  jpeg_start_decompress(&cinfo);
+
+  output->width = cinfo.output_width;
+  output->height = cinfo.output_height;
+  size_t scratch_size = 0;
+  for (int i = 0; i < 3; ++i) {
+    const jpeg_component_info& comp = cinfo.comp_info[i];
+    output->plane_width[i] = comp.downsampled_width;
+    output->plane_height[i] = comp.downsampled_height;
+    // libjpeg writes whole blocks, so the rows have room for them.
+    output->row_bytes[i] = comp.width_in_blocks * DCTSIZE;
+    output->planes[i].resize(
+        static_cast<size_t>(output->row_bytes[i]) * comp.downsampled_height);
+    scratch_size = std::max(scratch_size,
+                            static_cast<size_t>(output->row_bytes[i]));
+  }
+  scratch.resize(scratch_size);
+
+  // Each call decodes one row of MCUs, v_samp_factor blocks high in each
+  // plane.
+  int lines = cinfo.max_v_samp_factor * DCTSIZE;
+  JSAMPROW rows[3][MAX_SAMP_FACTOR * DCTSIZE];
+  JSAMPARRAY planes[3] = { rows[0], rows[1], rows[2] };
+  while (cinfo.output_scanline < cinfo.output_height) {
+    int mcu_row = cinfo.output_scanline / lines;
+    for (int i = 0; i < 3; ++i) {
+      int plane_lines = cinfo.comp_info[i].v_samp_factor * DCTSIZE;
+      for (int j = 0; j < plane_lines; ++j) {
+        int y = mcu_row * plane_lines + j;
+        rows[i][j] = y < output->plane_height[i] ?
+            &output->planes[i][static_cast<size_t>(y) * output->row_bytes[i]] :
+            &scratch[0];
+      }
+    }
+    if (jpeg_read_raw_data(&cinfo, planes, lines) == 0)
+      return false;
+  }
+
+  jpeg_finish_decompress(&cinfo);
+  return true;
 }
 
 }  // namespace gfx
@@ -52,18 +52,60 @@ class UI_EXPORT JPEGCodec {
                      int w, int h, int row_byte_width,
                      int quality, std::vector<unsigned char>* output);
 
+  // Same as above, but puts a restart marker in the encoded data after every
+  // 'restart_rows' rows of MCUs (16 pixel rows each), which lets Decode()
+  // decode it on several threads. The markers cost a few bytes each. No
+  // markers are written if 'restart_rows' is 0.
+  static bool Encode(const unsigned char* input, ColorFormat format,
+                     int w, int h, int row_byte_width,
+                     int quality, int restart_rows,
+                     std::vector<unsigned char>* output);
+
   // Decodes the JPEG data contained in input of length input_size. The
   // decoded data will be placed in *output with the dimensions in *w and *h
   // on success (returns true). This data will be written in the'format'
   // format. On failure, the values of these output variables is undefined.
+  //
+  // Large baseline images with restart markers at the start of MCU rows are
+  // decoded in strips on several threads; others are decoded on the calling
+  // thread.
   static bool Decode(const unsigned char* input, size_t input_size,
                      ColorFormat format, std::vector<unsigned char>* output,
                      int* w, int* h);
 
   // Decodes the JPEG data contained in input of length input_size. If
   // successful, a SkBitmap is created and returned. It is up to the caller
-  // to delete the returned bitmap.
+  // to delete the returned bitmap. The image is decoded straight into the
+  // pixels of the bitmap.
   static SkBitmap* Decode(const unsigned char* input, size_t input_size);
+
+  // An image decoded by DecodeToYUV(): the Y, U (Cb) and V (Cr) planes of the
+  // JPEG. The U and V planes are smaller than the Y plane when the chroma is
+  // subsampled; in the common 4:2:0 JPEGs they are half as wide and half as
+  // high.
+  struct UI_EXPORT YUVImage {
+    YUVImage();
+    ~YUVImage();
+
+    // Dimensions of the image, which are those of the Y plane.
+    int width;
+    int height;
+
+    // Plane i has plane_height[i] rows of plane_width[i] samples, which are
+    // row_bytes[i] apart in planes[i]. The rows are padded to a multiple of
+    // 8 samples.
+    int plane_width[3];
+    int plane_height[3];
+    int row_bytes[3];
+    std::vector<unsigned char> planes[3];
+  };
+
+  // Decodes the JPEG data contained in input of length input_size into its
+  // planes, without upsampling the chroma or converting the colors, for
+  // callers that can draw YUV themselves. Returns false on failure, and for
+  // JPEGs that are not YCbCr or whose Y plane is not full size.
+  static bool DecodeToYUV(const unsigned char* input, size_t input_size,
+                          YUVImage* output);
 };
 
 }  // namespace gfx
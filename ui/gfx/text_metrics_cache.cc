@@ -0,0 +1,130 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/text_metrics_cache.h"
+
+#include "base/memory/singleton.h"
+#include "ui/gfx/canvas_skia.h"
+#include "ui/gfx/font.h"
+
+namespace gfx {
+
+// static
+const size_t TextMetricsCache::kMaxEntries = 2048;
+
+TextMetricsCache::Key::Key(Operation operation,
+                           const string16& text,
+                           const Font& font,
+                           int width,
+                           int height,
+                           int flags)
+    : operation(operation),
+      text(text),
+      font_name(font.GetFontName()),
+      font_size(font.GetFontSize()),
+      font_style(font.GetStyle()),
+      width(width),
+      height(height),
+      flags(flags) {
+}
+
+TextMetricsCache::Key::~Key() {
+}
+
+bool TextMetricsCache::Key::operator<(const Key& other) const {
+  // Compare the cheap fields first; the text is compared last.
+  if (operation != other.operation)
+    return operation < other.operation;
+  if (font_size != other.font_size)
+    return font_size < other.font_size;
+  if (font_style != other.font_style)
+    return font_style < other.font_style;
+  if (width != other.width)
+    return width < other.width;
+  if (height != other.height)
+    return height < other.height;
+  if (flags != other.flags)
+    return flags < other.flags;
+  if (font_name != other.font_name)
+    return font_name < other.font_name;
+  return text < other.text;
+}
+
+// static
+TextMetricsCache* TextMetricsCache::GetInstance() {
+  return Singleton<TextMetricsCache>::get();
+}
+
+void TextMetricsCache::SizeStringInt(const string16& text,
+                                     const Font& font,
+                                     int* width,
+                                     int* height,
+                                     int flags) {
+  Key key(SIZE_STRING, text, font, *width, *height, flags);
+  Size size;
+  if (!Lookup(key, &size)) {
+    // Measure without holding the lock; a racing thread measuring the same
+    // string only costs a duplicate measurement.
+    int w = *width;
+    int h = *height;
+    CanvasSkia::SizeStringInt(text, font, &w, &h, flags);
+    size.SetSize(w, h);
+    Insert(key, size);
+  }
+  *width = size.width();
+  *height = size.height();
+}
+
+int TextMetricsCache::GetStringWidth(const string16& text, const Font& font) {
+  Key key(STRING_WIDTH, text, font, 0, 0, 0);
+  Size size;
+  if (!Lookup(key, &size)) {
+    size.set_width(font.GetStringWidth(text));
+    Insert(key, size);
+  }
+  return size.width();
+}
+
+void TextMetricsCache::Clear() {
+  base::AutoLock lock(lock_);
+  cache_.Clear();
+}
+
+size_t TextMetricsCache::hit_count() const {
+  base::AutoLock lock(lock_);
+  return hit_count_;
+}
+
+size_t TextMetricsCache::miss_count() const {
+  base::AutoLock lock(lock_);
+  return miss_count_;
+}
+
+TextMetricsCache::TextMetricsCache()
+    : cache_(kMaxEntries),
+      hit_count_(0),
+      miss_count_(0) {
+}
+
+TextMetricsCache::~TextMetricsCache() {
+}
+
+bool TextMetricsCache::Lookup(const Key& key, Size* size) {
+  base::AutoLock lock(lock_);
+  Cache::iterator i = cache_.Get(key);
+  if (i == cache_.end()) {
+    miss_count_++;
+    return false;
+  }
+  hit_count_++;
+  *size = i->second;
+  return true;
+}
+
+void TextMetricsCache::Insert(const Key& key, const Size& size) {
+  base::AutoLock lock(lock_);
+  cache_.Put(key, size);
+}
+
+}  // namespace gfx
@@ -0,0 +1,107 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GFX_TEXT_METRICS_CACHE_H_
+#define UI_GFX_TEXT_METRICS_CACHE_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/memory/mru_cache.h"
+#include "base/string16.h"
+#include "base/synchronization/lock.h"
+#include "ui/base/ui_export.h"
+#include "ui/gfx/size.h"
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace gfx {
+
+class Font;
+
+// TextMetricsCache remembers the results of measuring strings, so that the
+// many views showing the same text in the same font (labels, buttons, links,
+// elided text) measure it once. Entries are keyed by the text, the font's
+// name, size and style, the CanvasSkia flags and the size constraint passed
+// in, so multi-line wrapping results are cached per width. The least
+// recently used entries are dropped once the cache is full.
+//
+// The cache is process wide and may be used from any thread.
+class UI_EXPORT TextMetricsCache {
+ public:
+  // Maximum number of measurements kept.
+  static const size_t kMaxEntries;
+
+  static TextMetricsCache* GetInstance();
+
+  // Same contract as CanvasSkia::SizeStringInt(): |width| and |height| are the
+  // constraint on input and the size of |text| on output.
+  void SizeStringInt(const string16& text,
+                     const Font& font,
+                     int* width,
+                     int* height,
+                     int flags);
+
+  // Same as Font::GetStringWidth().
+  int GetStringWidth(const string16& text, const Font& font);
+
+  // Drops all entries. Call this when the fonts installed on the system or
+  // the text rendering settings change. The counters are not reset.
+  void Clear();
+
+  // Number of lookups answered from the cache and number that had to measure.
+  size_t hit_count() const;
+  size_t miss_count() const;
+
+ private:
+  friend struct DefaultSingletonTraits<TextMetricsCache>;
+
+  // Kind of measurement an entry holds.
+  enum Operation {
+    SIZE_STRING,
+    STRING_WIDTH,
+  };
+
+  struct Key {
+    Key(Operation operation,
+        const string16& text,
+        const Font& font,
+        int width,
+        int height,
+        int flags);
+    ~Key();
+
+    bool operator<(const Key& other) const;
+
+    Operation operation;
+    string16 text;
+    string16 font_name;
+    int font_size;
+    int font_style;
+    int width;
+    int height;
+    int flags;
+  };
+
+  typedef base::MRUCache<Key, Size> Cache;
+
+  TextMetricsCache();
+  ~TextMetricsCache();
+
+  // Returns true and sets |size| if |key| is cached.
+  bool Lookup(const Key& key, Size* size);
+  void Insert(const Key& key, const Size& size);
+
+  // Guards all the members below.
+  mutable base::Lock lock_;
+
+  Cache cache_;
+  size_t hit_count_;
+  size_t miss_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TextMetricsCache);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GFX_TEXT_METRICS_CACHE_H_
@@ -22,7 +22,9 @@ namespace views {
 BoundsAnimator::BoundsAnimator(View* parent)
     : parent_(parent),
       observer_(NULL),
-      container_(new AnimationContainer()) {
+      container_(new AnimationContainer()),
+      batch_updates_(false),
+      use_layers_(false) {
   container_->set_observer(this);
 }
 
@@ -60,6 +62,15 @@ void BoundsAnimator::AnimateViewTo(View* view, const gfx::Rect& target) {
   data.start_bounds = view->bounds();
   data.target_bounds = target;
   data.animation = CreateAnimation();
+  // A view that is animated again keeps the layer it was given.
+  data.promoted_to_layer = existing_data.promoted_to_layer;
+  if (use_layers_ && !view->layer() &&
+      View::get_use_acceleration_when_possible() && view->GetCompositor()) {
+    view->SetPaintToLayer(true);
+    data.promoted_to_layer = view->layer() != NULL;
+    if (!data.promoted_to_layer)
+      view->SetPaintToLayer(false);
+  }
 
   animation_to_view_[data.animation] = view;
 
@@ -151,6 +162,7 @@ void BoundsAnimator::RemoveFromMaps(View* view) {
 
   animation_to_view_.erase(data_[view].animation);
   data_.erase(view);
+  pending_views_.erase(view);
 }
 
 void BoundsAnimator::CleanupData(bool send_cancel, Data* data, View* view) {
@@ -191,9 +203,22 @@ void BoundsAnimator::AnimationEndedOrCanceled(const Animation* animation,
 
   // Make a copy of the data as Remove empties out the maps.
   Data data = data_[view];
+  bool pending = pending_views_.count(view) > 0;
 
   RemoveFromMaps(view);
 
+  if (batch_updates_ || pending) {
+    // Intermediate frames may have skipped the layout; SetBoundsRect() runs it
+    // even if the view is already at its final bounds.
+    view->SetBoundsRect(
+        animation->CurrentValueBetween(data.start_bounds, data.target_bounds));
+    // The last step of the animation was not passed on to the delegate yet.
+    if (pending && data.delegate)
+      data.delegate->AnimationProgressed(animation);
+  }
+  if (data.promoted_to_layer)
+    view->SetPaintToLayer(false);
+
   if (data.delegate) {
     if (type == ANIMATION_ENDED) {
       data.delegate->AnimationEnded(animation);
@@ -206,15 +231,17 @@ void BoundsAnimator::AnimationEndedOrCanceled(const Animation* animation,
   CleanupData(false, &data, view);
 }
 
-void BoundsAnimator::AnimationProgressed(const Animation* animation) {
-  DCHECK(animation_to_view_.find(animation) != animation_to_view_.end());
+void BoundsAnimator::UpdateViewBounds(View* view,
+                                      const Data& data,
+                                      bool batched) {
+  gfx::Rect new_bounds = data.animation->CurrentValueBetween(
+      data.start_bounds, data.target_bounds);
+  if (new_bounds == view->bounds())
+    return;
 
-  View* view = animation_to_view_[animation];
-  DCHECK(view);
-  const Data& data = data_[view];
-  gfx::Rect new_bounds =
-      animation->CurrentValueBetween(data.start_bounds, data.target_bounds);
-  if (new_bounds != view->bounds()) {
+  // A view with a layer that only moves is repositioned by the compositor;
+  // nothing under it needs repainting.
+  if (!view->layer() || new_bounds.size() != view->size()) {
     gfx::Rect total_bounds = new_bounds.Union(view->bounds());
 
     // Build up the region to repaint in repaint_bounds_. We'll do the repaint
@@ -223,9 +250,50 @@ void BoundsAnimator::AnimationProgressed(const Animation* animation) {
       repaint_bounds_ = total_bounds;
     else
       repaint_bounds_ = repaint_bounds_.Union(total_bounds);
+  }
 
+  if (batched)
+    view->SetBoundsRectForAnimation(new_bounds);
+  else
     view->SetBoundsRect(new_bounds);
+}
+
+void BoundsAnimator::ApplyPendingBounds() {
+  if (pending_views_.empty())
+    return;
+
+  // Delegates may start or stop animations, so work from a copy.
+  std::set<View*> views;
+  views.swap(pending_views_);
+  for (std::set<View*>::const_iterator i = views.begin(); i != views.end();
+       ++i) {
+    if (IsAnimating(*i))
+      UpdateViewBounds(*i, data_[*i], true);
   }
+  for (std::set<View*>::const_iterator i = views.begin(); i != views.end();
+       ++i) {
+    if (!IsAnimating(*i))
+      continue;
+    const Data& data = data_[*i];
+    if (data.delegate)
+      data.delegate->AnimationProgressed(data.animation);
+  }
+}
+
+void BoundsAnimator::AnimationProgressed(const Animation* animation) {
+  DCHECK(animation_to_view_.find(animation) != animation_to_view_.end());
+
+  View* view = animation_to_view_[animation];
+  DCHECK(view);
+  if (batch_updates_) {
+    // Applied in AnimationContainerProgressed, after every animation has been
+    // stepped.
+    pending_views_.insert(view);
+    return;
+  }
+
+  const Data& data = data_[view];
+  UpdateViewBounds(view, data, false);
 
   if (data.delegate)
     data.delegate->AnimationProgressed(animation);
@@ -241,6 +309,8 @@ void BoundsAnimator::AnimationCanceled(const Animation* animation) {
 
 void BoundsAnimator::AnimationContainerProgressed(
     AnimationContainer* container) {
+  ApplyPendingBounds();
+
   if (!repaint_bounds_.IsEmpty()) {
     // Adjust for rtl.
     repaint_bounds_.set_x(parent_->GetMirroredXWithWidthInView(
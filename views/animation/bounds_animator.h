@@ -7,6 +7,7 @@
 #pragma once
 
 #include <map>
+#include <set>
 
 #include "base/memory/ref_counted.h"
 #include "ui/base/animation/animation_container_observer.h"
@@ -39,6 +40,12 @@ class BoundsAnimatorObserver {
 // You can attach an AnimationDelegate to the individual animation for a view
 // by way of SetAnimationDelegate. Additionally you can attach an observer to
 // the BoundsAnimator that is notified when all animations are complete.
+//
+// All the animations share one AnimationContainer, so they are stepped by a
+// single timer, and the area they uncover and cover is repainted as one
+// rectangle per tick. With batched updates (see set_batch_updates) the bounds
+// of all the views are also applied together once per tick, without per-view
+// paints or intermediate layouts.
 class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
                                     public ui::AnimationContainerObserver {
  public:
@@ -96,6 +103,22 @@ class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
     observer_ = observer;
   }
 
+  // Sets whether the bounds of the animating views are applied together once
+  // per tick. Intermediate frames then move the views without scheduling
+  // paints for them, relying on the single repaint of the parent, and without
+  // laying them out; a view is laid out when its animation ends or is
+  // stopped. Delegates set with SetAnimationDelegate() are notified after the
+  // tick's bounds have been applied. The default is false.
+  void set_batch_updates(bool batch_updates) { batch_updates_ = batch_updates; }
+  bool batch_updates() const { return batch_updates_; }
+
+  // Sets whether views without a layer are given one for the duration of their
+  // animation, so that moving them needs no repaint when compositing is
+  // available. Only affects animations started afterwards. The default is
+  // false.
+  void set_use_layers(bool use_layers) { use_layers_ = use_layers; }
+  bool use_layers() const { return use_layers_; }
+
  protected:
   // Creates the animation to use for animating views.
   virtual ui::SlideAnimation* CreateAnimation();
@@ -105,12 +128,17 @@ class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
   struct Data {
     Data()
         : delete_delegate_when_done(false),
+          promoted_to_layer(false),
           animation(NULL),
           delegate(NULL) {}
 
     // If true the delegate is deleted when done.
     bool delete_delegate_when_done;
 
+    // If true the view was given a layer for the animation, and loses it when
+    // done.
+    bool promoted_to_layer;
+
     // The initial bounds.
     gfx::Rect start_bounds;
 
@@ -151,6 +179,15 @@ class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
   void AnimationEndedOrCanceled(const ui::Animation* animation,
                                 AnimationEndType type);
 
+  // Moves |view| to the current bounds of its animation, adding the area that
+  // needs repainting to |repaint_bounds_|. If |batched| is true this is an
+  // intermediate frame of a batched update.
+  void UpdateViewBounds(View* view, const Data& data, bool batched);
+
+  // Applies the bounds of the views in |pending_views_| and notifies their
+  // delegates.
+  void ApplyPendingBounds();
+
   // ui::AnimationDelegate overrides.
   virtual void AnimationProgressed(const ui::Animation* animation);
   virtual void AnimationEnded(const ui::Animation* animation);
@@ -174,6 +211,13 @@ class VIEWS_EXPORT BoundsAnimator : public ui::AnimationDelegate,
   // Makes from animation to view.
   AnimationToViewMap animation_to_view_;
 
+  bool batch_updates_;
+  bool use_layers_;
+
+  // With batched updates, the views whose animation progressed since the last
+  // tick was applied.
+  std::set<View*> pending_views_;
+
   // As the animations we created update (AnimationProgressed is invoked) this
   // is updated. When all the animations have completed for a given tick of
   // the timer (AnimationContainerProgressed is invoked) the parent_ is asked
@@ -0,0 +1,380 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "views/benchmark/views_benchmark.h"
+
+#include "base/logging.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "views/background.h"
+#include "views/border.h"
+#include "views/controls/button/text_button.h"
+#include "views/controls/label.h"
+#include "views/layout/box_layout.h"
+#include "views/layout/fill_layout.h"
+#include "views/layout/grid_layout.h"
+#include "views/widget/native_widget_headless.h"
+#include "views/widget/widget.h"
+
+using views::GridLayout;
+using views::View;
+
+namespace {
+
+// Number of nested views in SCENARIO_DEEP.
+const int kDeepTreeDepth = 200;
+
+// Shape of the grid in SCENARIO_WIDE.
+const int kWideColumns = 25;
+const int kWideRows = 80;
+
+// Rows of the grid in SCENARIO_TEXT. Each row has two Labels and two
+// TextButtons.
+const int kTextRows = 100;
+
+// Number of views Mutate() changes per frame in SCENARIO_WIDE and
+// SCENARIO_TEXT.
+const int kMutationsPerFrame = 10;
+
+const SkColor kBoxColors[] = {
+  SkColorSetRGB(0xCC, 0xDD, 0xEE),
+  SkColorSetRGB(0xEE, 0xDD, 0xCC),
+};
+
+// A view with a fixed preferred size that paints a solid color.
+class BoxView : public View {
+ public:
+  explicit BoxView(const gfx::Size& preferred_size)
+      : preferred_size_(preferred_size) {
+    SetColor(kBoxColors[0]);
+  }
+
+  void SetColor(SkColor color) {
+    set_background(views::Background::CreateSolidBackground(color));
+    SchedulePaint();
+  }
+
+  void SetBoxPreferredSize(const gfx::Size& preferred_size) {
+    preferred_size_ = preferred_size;
+    PreferredSizeChanged();
+  }
+
+  // Overridden from View:
+  virtual gfx::Size GetPreferredSize() OVERRIDE {
+    return preferred_size_;
+  }
+
+ private:
+  gfx::Size preferred_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(BoxView);
+};
+
+// Creates a frameless Widget of |size| backed by a NativeWidgetHeadless,
+// which is returned in |native_widget|.
+views::Widget* CreateHeadlessWidget(
+    const gfx::Size& size,
+    views::NativeWidgetHeadless** native_widget) {
+  views::Widget* widget = new views::Widget;
+  *native_widget = new views::NativeWidgetHeadless(widget);
+  views::Widget::InitParams params(
+      views::Widget::InitParams::TYPE_WINDOW_FRAMELESS);
+  params.ownership = views::Widget::InitParams::WIDGET_OWNS_NATIVE_WIDGET;
+  params.native_widget = *native_widget;
+  params.bounds = gfx::Rect(size);
+  widget->Init(params);
+  return widget;
+}
+
+int CountViews(const View* view) {
+  int count = 1;
+  for (int i = 0; i < view->child_count(); ++i)
+    count += CountViews(view->child_at(i));
+  return count;
+}
+
+}  // namespace
+
+namespace views_benchmark {
+
+const char* GetScenarioName(Scenario scenario) {
+  switch (scenario) {
+    case SCENARIO_DEEP:
+      return "deep";
+    case SCENARIO_WIDE:
+      return "wide";
+    case SCENARIO_TEXT:
+      return "text";
+  }
+  NOTREACHED();
+  return "";
+}
+
+bool GetScenarioForName(const std::string& name, Scenario* scenario) {
+  const Scenario kScenarios[] = { SCENARIO_DEEP, SCENARIO_WIDE, SCENARIO_TEXT };
+  for (size_t i = 0; i < arraysize(kScenarios); ++i) {
+    if (name == GetScenarioName(kScenarios[i])) {
+      *scenario = kScenarios[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+Results::Results()
+    : frame_count(0),
+      view_count(0),
+      layout_ms(0),
+      paint_ms(0),
+      hit_test_us(0),
+      allocations_per_frame(0) {
+}
+
+BulkInsertResults::BulkInsertResults()
+    : child_count(0),
+      layout_count(0),
+      total_ms(0) {
+}
+
+BulkInsertResults RunBulkInsert(int child_count,
+                                const gfx::Size& size,
+                                bool schedule_layout) {
+  views::NativeWidgetHeadless* native_widget = NULL;
+  scoped_ptr<views::Widget> widget(CreateHeadlessWidget(size,
+                                                        &native_widget));
+  View* container = new View;
+  container->SetLayoutManager(
+      new views::BoxLayout(views::BoxLayout::kVertical, 0, 0, 0));
+  widget->SetContentsView(container);
+  widget->Show();
+  native_widget->PaintAll();
+
+  BulkInsertResults results;
+  results.child_count = child_count;
+  int start_layouts = View::GetLayoutCount();
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < child_count; ++i) {
+    container->AddChildView(new BoxView(gfx::Size(size.width(), 2)));
+    if (schedule_layout) {
+      container->ScheduleLayout();
+    } else {
+      container->InvalidateLayout();
+      container->Layout();
+    }
+  }
+  widget->LayoutIfNeeded();
+  results.total_ms =
+      (base::TimeTicks::HighResNow() - start).InMillisecondsF();
+  results.layout_count = View::GetLayoutCount() - start_layouts;
+
+  widget->CloseNow();
+  return results;
+}
+
+ViewsBenchmark::ViewsBenchmark(Scenario scenario, const gfx::Size& size)
+    : scenario_(scenario),
+      size_(size),
+      native_widget_(NULL),
+      allocation_counter_(NULL),
+      hit_tests_per_frame_(100) {
+}
+
+ViewsBenchmark::~ViewsBenchmark() {
+  if (widget_.get())
+    widget_->CloseNow();
+}
+
+void ViewsBenchmark::Init() {
+  DCHECK(!widget_.get()) << "Init called more than once.";
+  widget_.reset(CreateHeadlessWidget(size_, &native_widget_));
+
+  View* contents = NULL;
+  switch (scenario_) {
+    case SCENARIO_DEEP:
+      contents = BuildDeepTree();
+      break;
+    case SCENARIO_WIDE:
+      contents = BuildWideTree();
+      break;
+    case SCENARIO_TEXT:
+      contents = BuildTextTree();
+      break;
+  }
+  contents->set_background(
+      views::Background::CreateSolidBackground(SK_ColorWHITE));
+  widget_->SetContentsView(contents);
+  widget_->Show();
+  native_widget_->PaintAll();
+}
+
+Results ViewsBenchmark::Run(int warmup_frames, int frame_count) {
+  DCHECK(widget_.get()) << "Init must be called before Run.";
+  for (int i = 0; i < warmup_frames; ++i)
+    RunFrame(i);
+
+  Results results;
+  results.frame_count = frame_count;
+  results.view_count = GetViewCount();
+  if (frame_count <= 0)
+    return results;
+
+  size_t total_allocations = 0;
+  for (int i = 0; i < frame_count; ++i) {
+    FrameTimes times = RunFrame(warmup_frames + i);
+    results.layout_ms += times.layout_ms;
+    results.paint_ms += times.paint_ms;
+    results.hit_test_us += times.hit_test_us;
+    total_allocations += times.allocations;
+  }
+  results.layout_ms /= frame_count;
+  results.paint_ms /= frame_count;
+  results.hit_test_us /= frame_count;
+  results.allocations_per_frame =
+      static_cast<double>(total_allocations) / frame_count;
+  return results;
+}
+
+int ViewsBenchmark::GetViewCount() const {
+  return widget_.get() ? CountViews(widget_->GetRootView()) : 0;
+}
+
+View* ViewsBenchmark::BuildDeepTree() {
+  // Every leaf is a BoxView, which reports its preferred size changes, so the
+  // containers can cache their preferred sizes.
+  View* root = new View;
+  root->SetLayoutManager(new views::FillLayout);
+  root->SetPreferredSizeCachingEnabled(true);
+  View* parent = root;
+  for (int i = 0; i < kDeepTreeDepth; ++i) {
+    View* child = new View;
+    child->SetLayoutManager(new views::FillLayout);
+    child->SetPreferredSizeCachingEnabled(true);
+    child->set_border(views::Border::CreateEmptyBorder(1, 1, 1, 1));
+    if (i % 2) {
+      child->set_background(
+          views::Background::CreateSolidBackground(kBoxColors[1]));
+    }
+    parent->AddChildView(child);
+    parent = child;
+  }
+  BoxView* leaf = new BoxView(gfx::Size(10, 10));
+  parent->AddChildView(leaf);
+  mutable_views_.push_back(leaf);
+  return root;
+}
+
+View* ViewsBenchmark::BuildWideTree() {
+  View* root = new View;
+  GridLayout* layout = new GridLayout(root);
+  root->SetLayoutManager(layout);
+  root->SetPreferredSizeCachingEnabled(true);
+  views::ColumnSet* columns = layout->AddColumnSet(0);
+  for (int i = 0; i < kWideColumns; ++i) {
+    columns->AddColumn(GridLayout::FILL, GridLayout::FILL, 1,
+                       GridLayout::USE_PREF, 0, 0);
+  }
+  for (int row = 0; row < kWideRows; ++row) {
+    layout->StartRow(0, 0);
+    for (int column = 0; column < kWideColumns; ++column) {
+      BoxView* box = new BoxView(gfx::Size(20, 6));
+      layout->AddView(box);
+      mutable_views_.push_back(box);
+    }
+  }
+  return root;
+}
+
+View* ViewsBenchmark::BuildTextTree() {
+  View* root = new View;
+  GridLayout* layout = new GridLayout(root);
+  root->SetLayoutManager(layout);
+  views::ColumnSet* columns = layout->AddColumnSet(0);
+  for (int i = 0; i < 2; ++i) {
+    columns->AddColumn(GridLayout::LEADING, GridLayout::CENTER, 1,
+                       GridLayout::USE_PREF, 0, 0);
+    columns->AddColumn(GridLayout::TRAILING, GridLayout::CENTER, 0,
+                       GridLayout::USE_PREF, 0, 0);
+  }
+  for (int row = 0; row < kTextRows; ++row) {
+    layout->StartRow(0, 0);
+    for (int i = 0; i < 2; ++i) {
+      int item = row * 2 + i;
+      views::Label* label =
+          new views::Label(base::StringPrintf(L"Item %d", item));
+      layout->AddView(label);
+      mutable_views_.push_back(label);
+      layout->AddView(new views::TextButton(NULL, L"Open"));
+    }
+  }
+  return root;
+}
+
+void ViewsBenchmark::Mutate(int frame) {
+  switch (scenario_) {
+    case SCENARIO_DEEP: {
+      BoxView* leaf = static_cast<BoxView*>(mutable_views_[0]);
+      leaf->SetColor(kBoxColors[frame % 2]);
+      leaf->SetBoxPreferredSize(gfx::Size(10 + frame % 2, 10));
+      leaf->ScheduleLayout();
+      break;
+    }
+    case SCENARIO_WIDE: {
+      for (int i = 0; i < kMutationsPerFrame; ++i) {
+        size_t index = (frame * kMutationsPerFrame + i) % mutable_views_.size();
+        BoxView* box = static_cast<BoxView*>(mutable_views_[index]);
+        box->SetColor(kBoxColors[frame % 2]);
+        box->SetBoxPreferredSize(gfx::Size(20, 6 + frame % 2));
+        box->ScheduleLayout();
+      }
+      break;
+    }
+    case SCENARIO_TEXT: {
+      for (int i = 0; i < kMutationsPerFrame; ++i) {
+        size_t index = (frame * kMutationsPerFrame + i) % mutable_views_.size();
+        views::Label* label = static_cast<views::Label*>(mutable_views_[index]);
+        label->SetText(base::StringPrintf(L"Item %d, frame %d",
+                                          static_cast<int>(index), frame));
+        label->ScheduleLayout();
+      }
+      break;
+    }
+  }
+}
+
+ViewsBenchmark::FrameTimes ViewsBenchmark::RunFrame(int frame) {
+  FrameTimes times;
+  size_t start_allocations = GetAllocationCount();
+
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  Mutate(frame);
+  widget_->LayoutIfNeeded();
+  base::TimeTicks layout_end = base::TimeTicks::HighResNow();
+  native_widget_->Paint();
+  base::TimeTicks paint_end = base::TimeTicks::HighResNow();
+
+  // Hit test points spread over the widget, shifted every frame so the same
+  // views are not hit each time.
+  View* root_view = widget_->GetRootView();
+  for (int i = 0; i < hit_tests_per_frame_; ++i) {
+    gfx::Point point((i * 37 + frame * 13) % size_.width(),
+                     (i * 53 + frame * 7) % size_.height());
+    root_view->GetEventHandlerForPoint(point);
+  }
+  base::TimeTicks hit_test_end = base::TimeTicks::HighResNow();
+
+  times.layout_ms = (layout_end - start).InMillisecondsF();
+  times.paint_ms = (paint_end - layout_end).InMillisecondsF();
+  times.hit_test_us = hit_tests_per_frame_ > 0 ?
+      static_cast<double>((hit_test_end - paint_end).InMicroseconds()) /
+          hit_tests_per_frame_ :
+      0;
+  times.allocations = GetAllocationCount() - start_allocations;
+  return times;
+}
+
+size_t ViewsBenchmark::GetAllocationCount() const {
+  return allocation_counter_ ? allocation_counter_() : 0;
+}
+
+}  // namespace views_benchmark
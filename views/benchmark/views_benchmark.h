@@ -0,0 +1,162 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef VIEWS_BENCHMARK_VIEWS_BENCHMARK_H_
+#define VIEWS_BENCHMARK_VIEWS_BENCHMARK_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "ui/gfx/size.h"
+
+namespace views {
+class NativeWidgetHeadless;
+class View;
+class Widget;
+}
+
+namespace views_benchmark {
+
+// The synthetic view trees the benchmark can build.
+enum Scenario {
+  // A long chain of nested views, each filling its parent.
+  SCENARIO_DEEP,
+  // Thousands of small siblings laid out by one GridLayout.
+  SCENARIO_WIDE,
+  // A grid of Labels and TextButtons whose text changes every frame.
+  SCENARIO_TEXT,
+};
+
+// Returns the name used for |scenario| on the command line and in results.
+const char* GetScenarioName(Scenario scenario);
+
+// Sets |scenario| from |name|, returning false if |name| is unknown.
+bool GetScenarioForName(const std::string& name, Scenario* scenario);
+
+// Returns the number of heap allocations made by the process so far. The
+// benchmark executable supplies one; it may return 0 if allocations are not
+// being counted.
+typedef size_t (*AllocationCounter)();
+
+// Results of a run, averaged over the measured frames.
+struct Results {
+  Results();
+
+  int frame_count;
+  int view_count;
+
+  // Mean wall time per frame of applying the frame's mutation and running
+  // the layout pass it scheduled.
+  double layout_ms;
+
+  // Mean wall time per frame of painting the invalid region.
+  double paint_ms;
+
+  // Mean wall time of one RootView hit test.
+  double hit_test_us;
+
+  // Mean heap allocations per frame, layout, paint and hit tests included.
+  double allocations_per_frame;
+};
+
+// Results of RunBulkInsert().
+struct BulkInsertResults {
+  BulkInsertResults();
+
+  int child_count;
+
+  // Number of View::Layout() calls made by the insertions and the layouts
+  // they triggered.
+  int layout_count;
+
+  // Wall time of the insertions and layouts.
+  double total_ms;
+};
+
+// Appends |child_count| fixed-size children one at a time to a vertical
+// BoxLayout container filling a headless Widget of |size|. If
+// |schedule_layout| is false the container is laid out after every insertion,
+// the way callers did before View::ScheduleLayout(). Otherwise every
+// insertion calls ScheduleLayout() and a single pass runs at the end.
+BulkInsertResults RunBulkInsert(int child_count,
+                                const gfx::Size& size,
+                                bool schedule_layout);
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// ViewsBenchmark
+//
+//  Builds a synthetic view tree in a Widget backed by NativeWidgetHeadless and
+//  renders frames into its offscreen canvas. Each frame mutates part of the
+//  tree the way a live UI would, then runs layout, paint and a batch of hit
+//  tests, timing each phase separately.
+//
+//  A MessageLoop must exist on the calling thread.
+//
+///////////////////////////////////////////////////////////////////////////////
+class ViewsBenchmark {
+ public:
+  ViewsBenchmark(Scenario scenario, const gfx::Size& size);
+  ~ViewsBenchmark();
+
+  void set_allocation_counter(AllocationCounter counter) {
+    allocation_counter_ = counter;
+  }
+
+  // Number of hit tests run per frame. The default is 100.
+  void set_hit_tests_per_frame(int count) { hit_tests_per_frame_ = count; }
+
+  // Builds the tree and paints the first frame. Must be called once before
+  // Run().
+  void Init();
+
+  // Runs |warmup_frames| unmeasured frames, then |frame_count| measured ones.
+  Results Run(int warmup_frames, int frame_count);
+
+  // Returns the number of Views in the tree.
+  int GetViewCount() const;
+
+ private:
+  // Times of one frame.
+  struct FrameTimes {
+    double layout_ms;
+    double paint_ms;
+    double hit_test_us;
+    size_t allocations;
+  };
+
+  // Builds the contents of each scenario and returns the root of the tree.
+  views::View* BuildDeepTree();
+  views::View* BuildWideTree();
+  views::View* BuildTextTree();
+
+  // Changes the tree for frame number |frame|.
+  void Mutate(int frame);
+
+  // Runs one frame.
+  FrameTimes RunFrame(int frame);
+
+  size_t GetAllocationCount() const;
+
+  const Scenario scenario_;
+  const gfx::Size size_;
+
+  scoped_ptr<views::Widget> widget_;
+  views::NativeWidgetHeadless* native_widget_;
+
+  // Views changed by Mutate().
+  std::vector<views::View*> mutable_views_;
+
+  AllocationCounter allocation_counter_;
+  int hit_tests_per_frame_;
+
+  DISALLOW_COPY_AND_ASSIGN(ViewsBenchmark);
+};
+
+}  // namespace views_benchmark
+
+#endif  // VIEWS_BENCHMARK_VIEWS_BENCHMARK_H_
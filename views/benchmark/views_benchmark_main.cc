@@ -0,0 +1,188 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Runs the views benchmark scenarios headlessly and prints the results in
+// the perf bot format ("RESULT graph: trace= value units"), one scenario after
+// another. Usage:
+//
+//   views_benchmark [--scenario=deep|wide|text|all] [--frames=N]
+//                   [--warmup=N] [--width=N] [--height=N]
+//                   [--bulk-insert=N]
+//
+// After the scenarios, --bulk-insert compares appending N children with a
+// layout after each insertion against ScheduleLayout() (0 skips it).
+//
+// Built by views/views_benchmark.vcproj. It needs no window or display, but
+// ui/gfx only has Windows font and canvas code, so it runs on Windows only.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <new>
+
+#include "base/at_exit.h"
+#include "base/atomicops.h"
+#include "base/command_line.h"
+#include "base/message_loop.h"
+#include "base/string_number_conversions.h"
+#include "ui/base/resource/resource_bundle.h"
+#include "ui/base/ui_base_paths.h"
+#include "views/benchmark/views_benchmark.h"
+
+#if defined(OS_WIN)
+#pragma comment(lib, "skia.lib")
+#pragma comment(lib, "ui.lib")
+#pragma comment(lib, "views.lib")
+#pragma comment(lib, "base.lib")
+#endif
+
+namespace {
+
+const char kScenarioSwitch[] = "scenario";
+const char kFramesSwitch[] = "frames";
+const char kWarmupSwitch[] = "warmup";
+const char kWidthSwitch[] = "width";
+const char kHeightSwitch[] = "height";
+const char kBulkInsertSwitch[] = "bulk-insert";
+
+const int kDefaultFrames = 200;
+const int kDefaultWarmupFrames = 20;
+const int kDefaultWidth = 800;
+const int kDefaultHeight = 600;
+const int kDefaultBulkInsertChildren = 500;
+
+// Number of operator new calls made by the process. Allocations made with
+// malloc directly (Skia's pixel buffers, for instance) are not counted.
+base::subtle::Atomic32 allocation_count = 0;
+
+size_t GetAllocationCount() {
+  return static_cast<size_t>(
+      base::subtle::NoBarrier_Load(&allocation_count));
+}
+
+int GetIntSwitch(const CommandLine& command_line,
+                 const char* name,
+                 int default_value) {
+  if (!command_line.HasSwitch(name))
+    return default_value;
+  int value = 0;
+  if (!base::StringToInt(command_line.GetSwitchValueASCII(name), &value) ||
+      value < 0) {
+    fprintf(stderr, "Invalid value for --%s, using %d\n", name,
+            default_value);
+    return default_value;
+  }
+  return value;
+}
+
+void PrintResult(const char* measurement,
+                 views_benchmark::Scenario scenario,
+                 double value,
+                 const char* units) {
+  printf("RESULT views_%s: %s= %.3f %s\n", measurement,
+         views_benchmark::GetScenarioName(scenario), value, units);
+}
+
+void RunScenario(views_benchmark::Scenario scenario,
+                 const gfx::Size& size,
+                 int warmup_frames,
+                 int frame_count) {
+  views_benchmark::ViewsBenchmark benchmark(scenario, size);
+  benchmark.set_allocation_counter(&GetAllocationCount);
+  benchmark.Init();
+  views_benchmark::Results results =
+      benchmark.Run(warmup_frames, frame_count);
+
+  PrintResult("view_count", scenario, results.view_count, "views");
+  PrintResult("layout", scenario, results.layout_ms, "ms");
+  PrintResult("paint", scenario, results.paint_ms, "ms");
+  PrintResult("hit_test", scenario, results.hit_test_us, "us");
+  PrintResult("allocations", scenario, results.allocations_per_frame,
+              "allocations");
+}
+
+void RunBulkInsert(const gfx::Size& size, int child_count) {
+  const bool kScheduleLayout[] = { false, true };
+  const char* const kTraces[] = { "immediate", "scheduled" };
+  for (size_t i = 0; i < arraysize(kScheduleLayout); ++i) {
+    views_benchmark::BulkInsertResults results =
+        views_benchmark::RunBulkInsert(child_count, size, kScheduleLayout[i]);
+    printf("RESULT views_bulk_insert_layouts: %s= %d layouts\n", kTraces[i],
+           results.layout_count);
+    printf("RESULT views_bulk_insert_time: %s= %.3f ms\n", kTraces[i],
+           results.total_ms);
+  }
+}
+
+}  // namespace
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  base::subtle::NoBarrier_AtomicIncrement(&allocation_count, 1);
+  void* p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc) {
+  return operator new(size);
+}
+
+void operator delete(void* p) throw() {
+  free(p);
+}
+
+void operator delete[](void* p) throw() {
+  free(p);
+}
+
+int main(int argc, char** argv) {
+  CommandLine::Init(argc, argv);
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+
+  // The exit manager is in charge of calling the dtors of singleton objects.
+  base::AtExitManager exit_manager;
+
+  ui::RegisterPathProvider();
+  ui::ResourceBundle::InitSharedInstance("en-US");
+
+  // Widget posts its layout and close tasks to the current loop.
+  MessageLoop message_loop;
+
+  gfx::Size size(GetIntSwitch(command_line, kWidthSwitch, kDefaultWidth),
+                 GetIntSwitch(command_line, kHeightSwitch, kDefaultHeight));
+  int frame_count = GetIntSwitch(command_line, kFramesSwitch, kDefaultFrames);
+  int warmup_frames =
+      GetIntSwitch(command_line, kWarmupSwitch, kDefaultWarmupFrames);
+  if (size.IsEmpty()) {
+    fprintf(stderr, "The widget size must not be empty\n");
+    return 1;
+  }
+
+  std::string scenario_name = command_line.GetSwitchValueASCII(
+      kScenarioSwitch);
+  if (scenario_name.empty() || scenario_name == "all") {
+    RunScenario(views_benchmark::SCENARIO_DEEP, size, warmup_frames,
+                frame_count);
+    RunScenario(views_benchmark::SCENARIO_WIDE, size, warmup_frames,
+                frame_count);
+    RunScenario(views_benchmark::SCENARIO_TEXT, size, warmup_frames,
+                frame_count);
+  } else {
+    views_benchmark::Scenario scenario;
+    if (!views_benchmark::GetScenarioForName(scenario_name, &scenario)) {
+      fprintf(stderr, "Unknown scenario: %s\n", scenario_name.c_str());
+      return 1;
+    }
+    RunScenario(scenario, size, warmup_frames, frame_count);
+  }
+
+  int bulk_insert_children = GetIntSwitch(command_line, kBulkInsertSwitch,
+                                          kDefaultBulkInsertChildren);
+  if (bulk_insert_children > 0)
+    RunBulkInsert(size, bulk_insert_children);
+
+  ui::ResourceBundle::CleanupSharedInstance();
+  return 0;
+}
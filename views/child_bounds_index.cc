@@ -0,0 +1,86 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "views/child_bounds_index.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "views/view.h"
+
+namespace views {
+
+namespace internal {
+
+ChildBoundsIndex::ChildBoundsIndex(View* host)
+    : host_(host),
+      dirty_(true) {
+  DCHECK(host_);
+}
+
+ChildBoundsIndex::~ChildBoundsIndex() {
+}
+
+void ChildBoundsIndex::GetChildrenInVerticalSpan(int top,
+                                                 int bottom,
+                                                 std::vector<int>* indices) {
+  indices->clear();
+  if (dirty_)
+    Rebuild();
+  if (top >= bottom || entries_.empty())
+    return;
+
+  // Entries at or past |end| start at or below |bottom| and can't intersect.
+  std::vector<Entry>::const_iterator end = std::lower_bound(
+      entries_.begin(), entries_.end(), bottom, &CompareEntryTop);
+  // Entries before |begin| all end at or above |top|.
+  std::vector<int>::const_iterator max_bottom_end =
+      max_bottom_.begin() + (end - entries_.begin());
+  std::vector<int>::const_iterator first = std::upper_bound(
+      max_bottom_.begin(), max_bottom_end, top);
+  std::vector<Entry>::const_iterator begin =
+      entries_.begin() + (first - max_bottom_.begin());
+
+  for (std::vector<Entry>::const_iterator i = begin; i != end; ++i) {
+    if (i->bottom > top)
+      indices->push_back(i->index);
+  }
+  std::sort(indices->begin(), indices->end());
+}
+
+// static
+bool ChildBoundsIndex::CompareEntryTop(const Entry& entry, int top) {
+  return entry.top < top;
+}
+
+// static
+bool ChildBoundsIndex::CompareEntries(const Entry& a, const Entry& b) {
+  return a.top < b.top;
+}
+
+void ChildBoundsIndex::Rebuild() {
+  int count = host_->child_count();
+  entries_.resize(count);
+  for (int i = 0; i < count; ++i) {
+    View* child = host_->child_at(i);
+    gfx::Rect bounds(child->ConvertRectToParent(child->GetLocalBounds()));
+    entries_[i].top = bounds.y();
+    entries_[i].bottom = bounds.bottom();
+    entries_[i].index = i;
+  }
+  std::stable_sort(entries_.begin(), entries_.end(), &CompareEntries);
+
+  max_bottom_.resize(count);
+  int max_bottom = 0;
+  for (int i = 0; i < count; ++i) {
+    max_bottom = i ? std::max(max_bottom, entries_[i].bottom) :
+                     entries_[i].bottom;
+    max_bottom_[i] = max_bottom;
+  }
+  dirty_ = false;
+}
+
+}  // namespace internal
+
+}  // namespace views
@@ -0,0 +1,75 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef VIEWS_CHILD_BOUNDS_INDEX_H_
+#define VIEWS_CHILD_BOUNDS_INDEX_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+
+namespace views {
+
+class View;
+
+// This is a views-internal API and should not be used externally. View uses
+// this class to find the children that may intersect a point or rectangle
+// without visiting every child, which matters for Views with thousands of
+// children such as list panes.
+//
+// Children are indexed by their vertical extent in the host's coordinate
+// system (after the child's transform). The vertical extent is unaffected by
+// RTL mirroring, so the index stays valid when the locale flips. The index is
+// rebuilt lazily on the first query after Invalidate(); View invalidates it
+// whenever a child is added, removed, reordered, resized, moved or
+// transformed.
+namespace internal {
+
+class ChildBoundsIndex {
+ public:
+  explicit ChildBoundsIndex(View* host);
+  ~ChildBoundsIndex();
+
+  // Marks the index as needing a rebuild before the next query.
+  void Invalidate() { dirty_ = true; }
+
+  // Stores in |indices|, in increasing order, the indices of the children of
+  // the host whose bounds may intersect the vertical span [top, bottom) in the
+  // host's coordinate system. The caller still has to test the horizontal
+  // extent, visibility and any hit test mask.
+  void GetChildrenInVerticalSpan(int top, int bottom, std::vector<int>* indices);
+
+ private:
+  struct Entry {
+    int top;
+    int bottom;
+    int index;
+  };
+
+  static bool CompareEntryTop(const Entry& entry, int top);
+  static bool CompareEntries(const Entry& a, const Entry& b);
+
+  void Rebuild();
+
+  View* host_;
+
+  // Children sorted by the top of their bounds.
+  std::vector<Entry> entries_;
+
+  // max_bottom_[i] is the largest bottom among entries_[0..i]. It is
+  // non-decreasing, which lets queries binary search for the first entry that
+  // can reach down into a span.
+  std::vector<int> max_bottom_;
+
+  bool dirty_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChildBoundsIndex);
+};
+
+}  // namespace internal
+
+}  // namespace views
+
+#endif  // VIEWS_CHILD_BOUNDS_INDEX_H_
@@ -12,6 +12,7 @@
 #include "ui/base/animation/throb_animation.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/gfx/canvas_skia.h"
+#include "ui/gfx/text_metrics_cache.h"
 #include "views/controls/button/button.h"
 #include "views/events/event.h"
 #include "views/widget/widget.h"
@@ -409,7 +410,8 @@ void TextButtonBase::CalculateTextSize(gfx::Size* text_size, int max_width) {
   if (!multi_line_)
     flags |= gfx::Canvas::NO_ELLIPSIS;
 
-  gfx::CanvasSkia::SizeStringInt(text_, font_, &w, &h, flags);
+  gfx::TextMetricsCache::GetInstance()->SizeStringInt(text_, font_, &w, &h,
+                                                      flags);
 
   // Add 2 extra pixels to width and height when text halo is used.
   if (has_text_halo_) {
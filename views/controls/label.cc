@@ -19,6 +19,7 @@
 #include "ui/gfx/color_utils.h"
 #include "ui/gfx/font.h"
 #include "ui/gfx/insets.h"
+#include "ui/gfx/text_metrics_cache.h"
 #include "views/background.h"
 
 namespace views {
@@ -151,7 +152,8 @@ void Label::SizeToFit(int max_width) {
   int label_width = 0;
   for (std::vector<string16>::const_iterator iter = lines.begin();
        iter != lines.end(); ++iter) {
-    label_width = std::max(label_width, font_.GetStringWidth(*iter));
+    label_width = std::max(label_width,
+        gfx::TextMetricsCache::GetInstance()->GetStringWidth(*iter, font_));
   }
 
   label_width += GetInsets().width();
@@ -205,8 +207,8 @@ int Label::GetHeightForWidth(int w) {
 
   w = std::max(0, w - GetInsets().width());
   int h = font_.GetHeight();
-  gfx::CanvasSkia::SizeStringInt(text_, font_, &w, &h,
-                                 ComputeMultiLineFlags());
+  gfx::TextMetricsCache::GetInstance()->SizeStringInt(
+      text_, font_, &w, &h, ComputeMultiLineFlags());
   return h + GetInsets().height();
 }
 
@@ -246,7 +248,8 @@ bool Label::GetTooltipText(const gfx::Point& p, string16* tooltip) {
 
   // Show the full text if the text does not fit.
   if (!is_multi_line_ &&
-      (font_.GetStringWidth(text_) > GetAvailableRect().width())) {
+      (gfx::TextMetricsCache::GetInstance()->GetStringWidth(text_, font_) >
+       GetAvailableRect().width())) {
     *tooltip = text_;
     return true;
   }
@@ -289,7 +292,8 @@ gfx::Size Label::GetTextSize() const {
     int flags = ComputeMultiLineFlags();
     if (!is_multi_line_)
       flags |= gfx::Canvas::NO_ELLIPSIS;
-    gfx::CanvasSkia::SizeStringInt(text_, font_, &w, &h, flags);
+    gfx::TextMetricsCache::GetInstance()->SizeStringInt(text_, font_, &w, &h,
+                                                        flags);
     text_size_.SetSize(w, h);
     text_size_valid_ = true;
   }
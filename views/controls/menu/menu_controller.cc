@@ -1371,12 +1371,10 @@ void MenuController::OpenMenu(MenuItemView* item) {
 
 void MenuController::OpenMenuImpl(MenuItemView* item, bool show) {
   if (show) {
-    int old_count = item->GetSubmenu()->child_count();
     item->GetDelegate()->WillShowMenu(item);
-    if (old_count != item->GetSubmenu()->child_count()) {
-      // If the number of children changed then we may need to add empty items.
-      item->AddEmptyMenus();
-    }
+    // The delegate may have just added the items (see MenuModelAdapter), and
+    // the submenu needs the empty item if it added none.
+    item->AddEmptyMenus();
   }
   bool prefer_leading =
       state_.open_leading.empty() ? true : state_.open_leading.back();
@@ -1617,20 +1615,16 @@ void MenuController::IncrementSelection(int delta) {
   if (item->GetParentMenuItem()) {
     MenuItemView* parent = item->GetParentMenuItem();
     int parent_count = parent->GetSubmenu()->GetMenuItemCount();
-    if (parent_count > 1) {
-      for (int i = 0; i < parent_count; ++i) {
-        if (parent->GetSubmenu()->GetMenuItemAt(i) == item) {
-          MenuItemView* to_select =
-              FindNextSelectableMenuItem(parent, i, delta);
-          if (!to_select)
-            break;
-          ScrollToVisible(to_select);
-          SetSelection(to_select, SELECTION_DEFAULT);
-          View* to_make_hot = GetInitialFocusableView(to_select, delta == 1);
-          if (to_make_hot)
-            to_make_hot->SetHotTracked(true);
-          break;
-        }
+    int index = parent->GetSubmenu()->GetMenuItemIndex(item);
+    if (parent_count > 1 && index != -1) {
+      MenuItemView* to_select =
+          FindNextSelectableMenuItem(parent, index, delta);
+      if (to_select) {
+        ScrollToVisible(to_select);
+        SetSelection(to_select, SELECTION_DEFAULT);
+        View* to_make_hot = GetInitialFocusableView(to_select, delta == 1);
+        if (to_make_hot)
+          to_make_hot->SetHotTracked(true);
       }
     }
   }
@@ -1657,12 +1651,12 @@ MenuItemView* MenuController::FindNextSelectableMenuItem(MenuItemView* parent,
 void MenuController::OpenSubmenuChangeSelectionIfCan() {
   MenuItemView* item = pending_state_.item;
   if (item->HasSubmenu() && item->IsEnabled()) {
+    // Show the sub-menu before counting its items, as the delegate may only
+    // add them when it is shown. Then select the first one, if any.
+    SetSelection(item, SELECTION_OPEN_SUBMENU | SELECTION_UPDATE_IMMEDIATELY);
     if (item->GetSubmenu()->GetMenuItemCount() > 0) {
       SetSelection(item->GetSubmenu()->GetMenuItemAt(0),
                    SELECTION_UPDATE_IMMEDIATELY);
-    } else {
-      // No menu items, just show the sub-menu.
-      SetSelection(item, SELECTION_OPEN_SUBMENU | SELECTION_UPDATE_IMMEDIATELY);
     }
   }
 }
@@ -12,6 +12,7 @@
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/base/models/menu_model.h"
 #include "ui/gfx/canvas.h"
+#include "ui/gfx/text_metrics_cache.h"
 #include "views/controls/button/menu_button.h"
 #include "views/controls/button/text_button.h"
 #include "views/controls/menu/menu_config.h"
@@ -49,6 +50,20 @@ class EmptyMenuMenuItem : public MenuItemView {
   DISALLOW_COPY_AND_ASSIGN(EmptyMenuMenuItem);
 };
 
+// Gets the label and icon of the item of |type| for the specified entry in
+// |model|.
+void GetLabelAndIconFromModel(ui::MenuModel* model,
+                              int index,
+                              MenuItemView::Type type,
+                              std::wstring* label,
+                              SkBitmap* icon) {
+  if (type == MenuItemView::SEPARATOR)
+    return;
+  *label = UTF16ToWide(model->GetLabelAt(index));
+  if (type == MenuItemView::NORMAL || type == MenuItemView::SUBMENU)
+    model->GetIconAt(index, icon);
+}
+
 }  // namespace
 
 // Padding between child views.
@@ -199,14 +214,7 @@ MenuItemView* MenuItemView::AddMenuItemAt(int index,
     submenu_->AddChildViewAt(new MenuSeparator(), index);
     return NULL;
   }
-  MenuItemView* item = new MenuItemView(this, item_id, type);
-  if (label.empty() && GetDelegate())
-    item->SetTitle(GetDelegate()->GetLabel(item_id));
-  else
-    item->SetTitle(label);
-  item->SetIcon(icon);
-  if (type == SUBMENU)
-    item->CreateSubmenu();
+  MenuItemView* item = CreateMenuItem(item_id, label, icon, type);
   submenu_->AddChildViewAt(item, index);
   return item;
 }
@@ -231,37 +239,65 @@ MenuItemView* MenuItemView::AppendMenuItemFromModel(ui::MenuModel* model,
                                                     int id) {
   SkBitmap icon;
   std::wstring label;
-  MenuItemView::Type type;
-  ui::MenuModel::ItemType menu_type = model->GetTypeAt(index);
-  switch (menu_type) {
+  MenuItemView::Type type = GetTypeForModelItem(model, index);
+  GetLabelAndIconFromModel(model, index, type, &label, &icon);
+  return AppendMenuItemImpl(id, label, icon, type);
+}
+
+MenuItemView* MenuItemView::CreateMenuItemFromModel(ui::MenuModel* model,
+                                                    int index,
+                                                    int id) {
+  SkBitmap icon;
+  std::wstring label;
+  MenuItemView::Type type = GetTypeForModelItem(model, index);
+  DCHECK_NE(SEPARATOR, type);
+  GetLabelAndIconFromModel(model, index, type, &label, &icon);
+  return CreateMenuItem(id, label, icon, type);
+}
+
+void MenuItemView::SetFromModel(ui::MenuModel* model, int index, int id) {
+  DCHECK_EQ(type_, GetTypeForModelItem(model, index));
+  SkBitmap icon;
+  std::wstring label;
+  GetLabelAndIconFromModel(model, index, type_, &label, &icon);
+
+  command_ = id;
+  MenuDelegate* delegate = GetDelegate();
+  if (label.empty() && delegate)
+    SetTitle(delegate->GetLabel(id));
+  else
+    SetTitle(label);
+  SetIcon(icon);
+  tooltip_.clear();
+  if (delegate)
+    SetEnabled(delegate->IsCommandEnabled(id));
+
+  if (submenu_) {
+    DCHECK(!submenu_->IsShowing());
+    submenu_->SetItemSource(NULL);
+    submenu_->RemoveAllChildViews(true);
+    STLDeleteElements(&removed_items_);
+  }
+}
+
+// static
+MenuItemView::Type MenuItemView::GetTypeForModelItem(ui::MenuModel* model,
+                                                     int index) {
+  switch (model->GetTypeAt(index)) {
     case ui::MenuModel::TYPE_COMMAND:
-      model->GetIconAt(index, &icon);
-      type = MenuItemView::NORMAL;
-      label = UTF16ToWide(model->GetLabelAt(index));
-      break;
+      return NORMAL;
     case ui::MenuModel::TYPE_CHECK:
-      type = MenuItemView::CHECKBOX;
-      label = UTF16ToWide(model->GetLabelAt(index));
-      break;
+      return CHECKBOX;
     case ui::MenuModel::TYPE_RADIO:
-      type = MenuItemView::RADIO;
-      label = UTF16ToWide(model->GetLabelAt(index));
-      break;
+      return RADIO;
     case ui::MenuModel::TYPE_SEPARATOR:
-      type = MenuItemView::SEPARATOR;
-      break;
+      return SEPARATOR;
     case ui::MenuModel::TYPE_SUBMENU:
-      model->GetIconAt(index, &icon);
-      type = MenuItemView::SUBMENU;
-      label = UTF16ToWide(model->GetLabelAt(index));
-      break;
+      return SUBMENU;
     default:
       NOTREACHED();
-      type = MenuItemView::NORMAL;
-      break;
+      return NORMAL;
   }
-
-  return AppendMenuItemImpl(id, label, icon, type);
 }
 
 MenuItemView* MenuItemView::AppendMenuItemImpl(int item_id,
@@ -272,6 +308,21 @@ MenuItemView* MenuItemView::AppendMenuItemImpl(int item_id,
   return AddMenuItemAt(index, item_id, label, icon, type);
 }
 
+MenuItemView* MenuItemView::CreateMenuItem(int item_id,
+                                          const std::wstring& label,
+                                          const SkBitmap& icon,
+                                          Type type) {
+  MenuItemView* item = new MenuItemView(this, item_id, type);
+  if (label.empty() && GetDelegate())
+    item->SetTitle(GetDelegate()->GetLabel(item_id));
+  else
+    item->SetTitle(label);
+  item->SetIcon(icon);
+  if (type == SUBMENU)
+    item->CreateSubmenu();
+  return item;
+}
+
 SubmenuView* MenuItemView::CreateSubmenu() {
   if (!submenu_)
     submenu_ = new SubmenuView(this);
@@ -432,7 +483,8 @@ void MenuItemView::Layout() {
 
 int MenuItemView::GetAcceleratorTextWidth() {
   string16 text = GetAcceleratorText();
-  return text.empty() ? 0 : GetFont().GetStringWidth(text);
+  return text.empty() ? 0 :
+      gfx::TextMetricsCache::GetInstance()->GetStringWidth(text, GetFont());
 }
 
 void MenuItemView::SetMargins(int top_margin, int bottom_margin) {
@@ -573,14 +625,14 @@ const gfx::Font& MenuItemView::GetFont() {
 
 void MenuItemView::AddEmptyMenus() {
   DCHECK(HasSubmenu());
-  if (!submenu_->has_children()) {
+  if (!submenu_->has_children() && !submenu_->GetMenuItemCount()) {
     submenu_->AddChildViewAt(new EmptyMenuMenuItem(this), 0);
   } else {
-    for (int i = 0, item_count = submenu_->GetMenuItemCount(); i < item_count;
-         ++i) {
-      MenuItemView* child = submenu_->GetMenuItemAt(i);
-      if (child->HasSubmenu())
-        child->AddEmptyMenus();
+    std::vector<MenuItemView*> items;
+    submenu_->GetMenuItemViews(&items);
+    for (size_t i = 0; i < items.size(); ++i) {
+      if (items[i]->HasSubmenu())
+        items[i]->AddEmptyMenus();
     }
   }
 }
@@ -637,10 +689,10 @@ void MenuItemView::DestroyAllMenuHosts() {
     return;
 
   submenu_->Close();
-  for (int i = 0, item_count = submenu_->GetMenuItemCount(); i < item_count;
-       ++i) {
-    submenu_->GetMenuItemAt(i)->DestroyAllMenuHosts();
-  }
+  std::vector<MenuItemView*> items;
+  submenu_->GetMenuItemViews(&items);
+  for (size_t i = 0; i < items.size(); ++i)
+    items[i]->DestroyAllMenuHosts();
 }
 
 int MenuItemView::GetTopMargin() {
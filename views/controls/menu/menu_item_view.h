@@ -205,6 +205,22 @@ class VIEWS_EXPORT MenuItemView : public View {
                                         int index,
                                         int id);
 
+  // Like AppendMenuItemFromModel(), but the item is not added to this menu.
+  // This is for SubmenuView::ItemSource implementations. The entry must not
+  // be a separator.
+  MenuItemView* CreateMenuItemFromModel(ui::MenuModel* model,
+                                        int index,
+                                        int id);
+
+  // Makes this item, created for another entry of the same type, show the
+  // specified entry in the model. Any items of its submenu are deleted, so
+  // the submenu must not be showing.
+  void SetFromModel(ui::MenuModel* model, int index, int id);
+
+  // Returns the type of the item created for the specified entry in the
+  // model.
+  static Type GetTypeForModelItem(ui::MenuModel* model, int index);
+
   // All the AppendXXX methods funnel into this.
   MenuItemView* AppendMenuItemImpl(int item_id,
                                    const std::wstring& label,
@@ -332,6 +348,12 @@ class VIEWS_EXPORT MenuItemView : public View {
   // This is invoked prior to Running a menu.
   static void UpdateMenuPartSizes(bool has_icons);
 
+  // Creates an item for this menu without adding it.
+  MenuItemView* CreateMenuItem(int item_id,
+                               const std::wstring& label,
+                               const SkBitmap& icon,
+                               Type type);
+
   // Called by the two constructors to initialize this menu item.
   void Init(MenuItemView* parent,
             int command,
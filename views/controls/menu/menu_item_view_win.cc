@@ -25,6 +25,9 @@ gfx::Size MenuItemView::CalculatePreferredSize() {
         child_size.height() + GetBottomMargin() + GetTopMargin());
   }
 
+  // Titles are measured directly rather than through gfx::TextMetricsCache:
+  // they are rarely repeated, and a long menu would evict the entries shared
+  // by the rest of the UI.
   const gfx::Font& font = GetFont();
   return gfx::Size(
       font.GetStringWidth(title_) + label_start_ + item_right_margin_ +
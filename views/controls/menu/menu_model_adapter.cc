@@ -10,8 +10,82 @@
 #include "views/controls/menu/submenu_view.h"
 #include "views/views_delegate.h"
 
+namespace {
+
+// Levels with fewer items are built in full.
+const int kMinItemsForItemSource = 100;
+
+// Returns true if the items of |model| should be given to the menu through a
+// SubmenuView::ItemSource. Looking at the types is the only work done for each
+// item.
+bool ShouldUseItemSource(ui::MenuModel* model) {
+  const int item_count = model->GetItemCount();
+  if (item_count < kMinItemsForItemSource)
+    return false;
+  const int first_index = model->GetFirstItemIndex(NULL);
+  for (int i = 0; i < item_count; ++i) {
+    if (model->GetTypeAt(i + first_index) == ui::MenuModel::TYPE_SEPARATOR)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
 namespace views {
 
+// Supplies the items of one level of the menu.
+class MenuModelAdapter::ModelItemSource : public SubmenuView::ItemSource {
+ public:
+  ModelItemSource(MenuModelAdapter* adapter,
+                  MenuItemView* menu,
+                  ui::MenuModel* model)
+      : adapter_(adapter),
+        menu_(menu),
+        model_(model) {
+  }
+
+  // SubmenuView::ItemSource implementation.
+  virtual int GetItemCount() OVERRIDE {
+    return model_->GetItemCount();
+  }
+
+  virtual MenuItemView::Type GetItemType(int index) OVERRIDE {
+    return MenuItemView::GetTypeForModelItem(model_, ModelIndex(index));
+  }
+
+  virtual MenuItemView* CreateItem(int index) OVERRIDE {
+    const int model_index = ModelIndex(index);
+    MenuItemView* item = menu_->CreateMenuItemFromModel(
+        model_, model_index, model_->GetCommandIdAt(model_index));
+    AddSubmenuModel(item, model_index);
+    return item;
+  }
+
+  virtual void UpdateItem(MenuItemView* item, int index) OVERRIDE {
+    const int model_index = ModelIndex(index);
+    item->SetFromModel(model_, model_index,
+                       model_->GetCommandIdAt(model_index));
+    AddSubmenuModel(item, model_index);
+  }
+
+ private:
+  int ModelIndex(int index) const {
+    return index + model_->GetFirstItemIndex(NULL);
+  }
+
+  void AddSubmenuModel(MenuItemView* item, int model_index) {
+    if (model_->GetTypeAt(model_index) == ui::MenuModel::TYPE_SUBMENU)
+      adapter_->AddUnbuiltSubmenu(item, model_->GetSubmenuModelAt(model_index));
+  }
+
+  MenuModelAdapter* adapter_;
+  MenuItemView* menu_;
+  ui::MenuModel* model_;
+
+  DISALLOW_COPY_AND_ASSIGN(ModelItemSource);
+};
+
 MenuModelAdapter::MenuModelAdapter(ui::MenuModel* menu_model)
     : menu_model_(menu_model),
       triggerable_event_flags_(ui::EF_LEFT_BUTTON_DOWN |
@@ -27,6 +101,7 @@ void MenuModelAdapter::BuildMenu(MenuItemView* menu) {
 
   // Clear the menu.
   if (menu->HasSubmenu()) {
+    menu->GetSubmenu()->SetItemSource(NULL);
     const int subitem_count = menu->GetSubmenu()->child_count();
     for (int i = 0; i < subitem_count; ++i)
       menu->RemoveMenuItemAt(0);
@@ -38,6 +113,7 @@ void MenuModelAdapter::BuildMenu(MenuItemView* menu) {
   if (!menu->GetMenuController())
     menu_map_.clear();
   menu_map_[menu] = menu_model_;
+  unbuilt_menus_.clear();
 
   // Repopulate the menu.
   BuildMenuImpl(menu, menu_model_);
@@ -154,6 +230,8 @@ void MenuModelAdapter::WillShowMenu(MenuItemView* menu) {
       menu_map_.find(menu);
   if (map_iterator != menu_map_.end()) {
     map_iterator->second->MenuWillShow();
+    if (unbuilt_menus_.erase(menu))
+      BuildSubmenu(menu, map_iterator->second);
     return;
   }
 
@@ -177,24 +255,44 @@ void MenuModelAdapter::WillHideMenu(MenuItemView* menu) {
 void MenuModelAdapter::BuildMenuImpl(MenuItemView* menu, ui::MenuModel* model) {
   DCHECK(menu);
   DCHECK(model);
-  const int item_count = model->GetItemCount();
-  for (int i = 0; i < item_count; ++i) {
-    const int index = i + model->GetFirstItemIndex(NULL);
-    MenuItemView* item = menu->AppendMenuItemFromModel(
-        model, index, model->GetCommandIdAt(index));
-
-    if (model->GetTypeAt(index) == ui::MenuModel::TYPE_SUBMENU) {
-      DCHECK(item);
-      DCHECK_EQ(MenuItemView::SUBMENU, item->GetType());
-      ui::MenuModel* submodel = model->GetSubmenuModelAt(index);
-      DCHECK(submodel);
-      BuildMenuImpl(item, submodel);
-
-      menu_map_[item] = submodel;
+  if (ShouldUseItemSource(model)) {
+    menu->CreateSubmenu()->SetItemSource(
+        new ModelItemSource(this, menu, model));
+  } else {
+    const int item_count = model->GetItemCount();
+    for (int i = 0; i < item_count; ++i) {
+      const int index = i + model->GetFirstItemIndex(NULL);
+      MenuItemView* item = menu->AppendMenuItemFromModel(
+          model, index, model->GetCommandIdAt(index));
+
+      if (model->GetTypeAt(index) == ui::MenuModel::TYPE_SUBMENU)
+        AddUnbuiltSubmenu(item, model->GetSubmenuModelAt(index));
     }
   }
 
   menu->set_has_icons(model->HasIcons());
 }
 
+void MenuModelAdapter::BuildSubmenu(MenuItemView* menu, ui::MenuModel* model) {
+  // While the menu runs, MenuItemView puts a placeholder item in empty
+  // submenus. MenuController adds it back after WillShowMenu() if the submenu
+  // turns out to be empty.
+  SubmenuView* submenu = menu->GetSubmenu();
+  for (int i = submenu->child_count() - 1; i >= 0; --i) {
+    if (submenu->child_at(i)->id() == MenuItemView::kEmptyMenuItemViewID)
+      menu->RemoveMenuItemAt(i);
+  }
+  BuildMenuImpl(menu, model);
+}
+
+void MenuModelAdapter::AddUnbuiltSubmenu(MenuItemView* item,
+                                         ui::MenuModel* submodel) {
+  DCHECK(item);
+  DCHECK_EQ(MenuItemView::SUBMENU, item->GetType());
+  DCHECK(submodel);
+  // The items of the submenu are added when it is first shown.
+  menu_map_[item] = submodel;
+  unbuilt_menus_.insert(item);
+}
+
 }  // namespace views
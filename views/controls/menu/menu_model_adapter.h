@@ -7,6 +7,7 @@
 #pragma once
 
 #include <map>
+#include <set>
 
 #include "views/controls/menu/menu_delegate.h"
 
@@ -26,8 +27,11 @@ class VIEWS_EXPORT MenuModelAdapter : public MenuDelegate {
   explicit MenuModelAdapter(ui::MenuModel* menu_model);
   virtual ~MenuModelAdapter();
 
-  // Populate a MenuItemView menu with the ui::MenuModel items
-  // (including submenus).
+  // Populate a MenuItemView menu with the ui::MenuModel items. The items of
+  // submenus are added when each submenu is first shown, so that building a
+  // menu costs the same however large its submenus are. A level with many
+  // items and no separators gets them through a SubmenuView::ItemSource, so
+  // that only the items on screen have views.
   virtual void BuildMenu(MenuItemView* menu);
 
   // Convenience for creating and populating a menu. The caller owns the
@@ -56,11 +60,20 @@ class VIEWS_EXPORT MenuModelAdapter : public MenuDelegate {
   virtual void WillHideMenu(MenuItemView* menu) OVERRIDE;
 
  private:
+  class ModelItemSource;
+
   // Implementation of BuildMenu().  index_offset is both input and output;
   // on input it contains the offset from index to command id for the model,
   // and on output it contains the offset for the next model.
   void BuildMenuImpl(MenuItemView* menu, ui::MenuModel* model);
 
+  // Adds the items of |model| to |menu|, a submenu about to be shown for the
+  // first time.
+  void BuildSubmenu(MenuItemView* menu, ui::MenuModel* model);
+
+  // Records that |item|'s submenu shows |submodel| and is yet to be built.
+  void AddUnbuiltSubmenu(MenuItemView* item, ui::MenuModel* submodel);
+
   // Container of ui::MenuModel pointers as encountered by preorder
   // traversal.  The first element is always the top-level model
   // passed to the constructor.
@@ -72,6 +85,9 @@ class VIEWS_EXPORT MenuModelAdapter : public MenuDelegate {
   // Map MenuItems to MenuModels.  Used to implement WillShowMenu().
   std::map<MenuItemView*, ui::MenuModel*> menu_map_;
 
+  // Submenus whose items haven't been added yet.
+  std::set<MenuItemView*> unbuilt_menus_;
+
   DISALLOW_COPY_AND_ASSIGN(MenuModelAdapter);
 };
 
@@ -4,6 +4,8 @@
 
 #include "views/controls/menu/submenu_view.h"
 
+#include <algorithm>
+
 #include "ui/base/accessibility/accessible_view_state.h"
 #include "ui/gfx/canvas.h"
 #include "views/controls/menu/menu_config.h"
@@ -21,6 +23,13 @@ const int kDropIndicatorHeight = 2;
 // Color of the drop indicator.
 const SkColor kDropIndicatorColor = SK_ColorBLACK;
 
+// Rows past either edge of the screen that get views when there is an
+// ItemSource, so that scrolling by a row or two doesn't need new ones.
+const int kOverscanRows = 4;
+
+// Rows measured to size a submenu that has an ItemSource.
+const int kMeasuredRows = 50;
+
 }  // namespace
 
 namespace views {
@@ -39,10 +48,22 @@ SubmenuView::SubmenuView(MenuItemView* parent)
       scroll_view_container_(NULL),
       max_accelerator_width_(0),
       minimum_preferred_width_(0),
-      resize_open_menu_(false) {
+      resize_open_menu_(false),
+      menu_items_valid_(false),
+      item_count_(0),
+      row_height_(0),
+      max_row_width_(0),
+      rows_measured_(false),
+      transient_item_(NULL),
+      first_visible_row_(0),
+      last_visible_row_(0) {
   DCHECK(parent);
   // We'll delete ourselves, otherwise the ScrollView would delete us on close.
   set_parent_owned(false);
+  // Menus can have thousands of items of which only a screenful is visible.
+  // Let View find the items to paint and the item under the mouse without
+  // going through all of them.
+  SetChildBoundsIndexEnabled(true);
 }
 
 SubmenuView::~SubmenuView() {
@@ -51,26 +72,89 @@ SubmenuView::~SubmenuView() {
   Close();
 
   delete scroll_view_container_;
+
+  // MenuItemView's destructor is only accessible through View.
+  for (size_t i = 0; i < spare_items_.size(); ++i)
+    delete static_cast<View*>(spare_items_[i]);
 }
 
 int SubmenuView::GetMenuItemCount() {
-  int count = 0;
-  for (int i = 0; i < child_count(); ++i) {
-    if (child_at(i)->id() == MenuItemView::kMenuItemViewID)
-      count++;
-  }
-  return count;
+  if (item_source_.get())
+    return item_count_;
+  UpdateMenuItems();
+  return static_cast<int>(menu_items_.size());
 }
 
 MenuItemView* SubmenuView::GetMenuItemAt(int index) {
-  for (int i = 0, count = 0; i < child_count(); ++i) {
-    if (child_at(i)->id() == MenuItemView::kMenuItemViewID &&
-        count++ == index) {
-      return static_cast<MenuItemView*>(child_at(i));
+  if (item_source_.get()) {
+    if (index < 0 || index >= item_count_) {
+      NOTREACHED();
+      return NULL;
     }
+    std::map<int, MenuItemView*>::const_iterator i = row_items_.find(index);
+    if (i != row_items_.end())
+      return i->second;
+    MenuItemView* item = GetItemForRow(index);
+    if (index < first_visible_row_ || index >= last_visible_row_) {
+      // Only the last row off screen asked for keeps its view, so that going
+      // through all the items doesn't give each of them one.
+      MenuItemView* previous = transient_item_;
+      transient_item_ = item;
+      if (previous && !IsItemInUse(previous)) {
+        int row = item_rows_[previous];
+        if (row < first_visible_row_ || row >= last_visible_row_)
+          RecycleItem(previous);
+      }
+    }
+    return item;
+  }
+
+  UpdateMenuItems();
+  if (index < 0 || index >= static_cast<int>(menu_items_.size())) {
+    NOTREACHED();
+    return NULL;
   }
-  NOTREACHED();
-  return NULL;
+  return menu_items_[index];
+}
+
+int SubmenuView::GetMenuItemIndex(MenuItemView* item) {
+  if (item_source_.get()) {
+    std::map<MenuItemView*, int>::const_iterator i = item_rows_.find(item);
+    return i == item_rows_.end() ? -1 : i->second;
+  }
+
+  UpdateMenuItems();
+  std::vector<MenuItemView*>::const_iterator i =
+      std::find(menu_items_.begin(), menu_items_.end(), item);
+  if (i == menu_items_.end())
+    return -1;
+  return static_cast<int>(i - menu_items_.begin());
+}
+
+void SubmenuView::GetMenuItemViews(std::vector<MenuItemView*>* items) {
+  UpdateMenuItems();
+  *items = menu_items_;
+}
+
+void SubmenuView::SetItemSource(ItemSource* item_source) {
+  // MenuController may still point at the rows, so they are removed the way
+  // MenuItemView::RemoveMenuItemAt() removes items, and deleted when the
+  // menu's children are next updated.
+  while (!row_items_.empty())
+    parent_menu_item_->RemoveMenuItemAt(GetIndexOf(row_items_.begin()->second));
+  for (size_t i = 0; i < spare_items_.size(); ++i)
+    delete static_cast<View*>(spare_items_[i]);
+  spare_items_.clear();
+  DCHECK(!item_source || !has_children());
+
+  item_source_.reset(item_source);
+  item_count_ = item_source ? item_source->GetItemCount() : 0;
+  row_height_ = 0;
+  max_row_width_ = 0;
+  max_accelerator_width_ = 0;
+  rows_measured_ = false;
+  first_visible_row_ = 0;
+  last_visible_row_ = 0;
 }
 
 void SubmenuView::ChildPreferredSizeChanged(View* child) {
@@ -87,6 +171,27 @@ void SubmenuView::ChildPreferredSizeChanged(View* child) {
   }
 }
 
+void SubmenuView::ViewHierarchyChanged(bool is_add,
+                                       View* parent,
+                                       View* child) {
+  if (parent != this)
+    return;
+
+  menu_items_valid_ = false;
+  if (!is_add && child->id() == MenuItemView::kMenuItemViewID) {
+    // Forget the row whose view this was, whether it was recycled or removed
+    // with MenuItemView::RemoveMenuItemAt().
+    std::map<MenuItemView*, int>::iterator i =
+        item_rows_.find(static_cast<MenuItemView*>(child));
+    if (i != item_rows_.end()) {
+      row_items_.erase(i->second);
+      item_rows_.erase(i);
+    }
+    if (child == transient_item_)
+      transient_item_ = NULL;
+  }
+}
+
 void SubmenuView::Layout() {
   // We're in a ScrollView, and need to set our width/height ourselves.
   if (!parent())
@@ -101,6 +206,11 @@ void SubmenuView::Layout() {
     new_y = 0;
   SetBounds(x(), new_y, parent()->width(), pref_height);
 
+  if (item_source_.get()) {
+    UpdateVisibleRows();
+    return;
+  }
+
   gfx::Insets insets = GetInsets();
   int x = insets.left();
   int y = insets.top();
@@ -116,6 +226,24 @@ void SubmenuView::Layout() {
 }
 
 gfx::Size SubmenuView::GetPreferredSize() {
+  if (item_source_.get()) {
+    // Measuring every row would cost as much as giving each a view, so the
+    // width is that of the rows seen so far, starting with the first
+    // kMeasuredRows. Wider rows further down are cut off.
+    if (!rows_measured_) {
+      rows_measured_ = true;
+      for (int row = 0; row < std::min(item_count_, kMeasuredRows); ++row) {
+        if (row_items_.find(row) == row_items_.end())
+          GetItemForRow(row);
+      }
+    }
+    gfx::Insets insets = GetInsets();
+    return gfx::Size(
+        std::max(max_row_width_ + max_accelerator_width_ + insets.width(),
+                 minimum_preferred_width_ - 2 * kSubmenuBorderSize),
+        item_count_ * row_height_ + insets.height());
+  }
+
   if (!has_children())
     return gfx::Size();
 
@@ -208,12 +336,18 @@ bool SubmenuView::OnMouseWheel(const MouseWheelEvent& e) {
   // Find the index of the first menu item whose y-coordinate is >= visible
   // y-coordinate.
   int i = 0;
-  while ((i < menu_item_count) && (GetMenuItemAt(i)->y() < vis_bounds.y()))
-    ++i;
+  if (item_source_.get()) {
+    // The rows are evenly spaced, so there is no need to go through them.
+    i = std::min(menu_item_count, std::max(0,
+        (vis_bounds.y() - GetInsets().top() + row_height_ - 1) / row_height_));
+  } else {
+    while ((i < menu_item_count) && (GetMenuItemY(i) < vis_bounds.y()))
+      ++i;
+  }
   if (i == menu_item_count)
     return true;
   int first_vis_index = std::max(0,
-      (GetMenuItemAt(i)->y() == vis_bounds.y()) ? i : i - 1);
+      (GetMenuItemY(i) == vis_bounds.y()) ? i : i - 1);
 
   // If the first item isn't entirely visible, make it visible, otherwise make
   // the next/previous one entirely visible.
@@ -221,17 +355,17 @@ bool SubmenuView::OnMouseWheel(const MouseWheelEvent& e) {
   for (bool scroll_up = (e.offset() > 0); delta != 0; --delta) {
     int scroll_target;
     if (scroll_up) {
-      if (GetMenuItemAt(first_vis_index)->y() == vis_bounds.y()) {
+      if (GetMenuItemY(first_vis_index) == vis_bounds.y()) {
         if (first_vis_index == 0)
           break;
         first_vis_index--;
       }
-      scroll_target = GetMenuItemAt(first_vis_index)->y();
+      scroll_target = GetMenuItemY(first_vis_index);
     } else {
       if (first_vis_index + 1 == menu_item_count)
         break;
-      scroll_target = GetMenuItemAt(first_vis_index + 1)->y();
-      if (GetMenuItemAt(first_vis_index)->y() == vis_bounds.y())
+      scroll_target = GetMenuItemY(first_vis_index + 1);
+      if (GetMenuItemY(first_vis_index) == vis_bounds.y())
         first_vis_index++;
     }
     ScrollRectToVisible(gfx::Rect(gfx::Point(0, scroll_target),
@@ -348,6 +482,115 @@ std::string SubmenuView::GetClassName() const {
 
 void SubmenuView::OnBoundsChanged(const gfx::Rect& previous_bounds) {
   SchedulePaint();
+  // Scrolling moves the submenu within its viewport.
+  if (item_source_.get())
+    UpdateVisibleRows();
+}
+
+void SubmenuView::UpdateMenuItems() {
+  if (menu_items_valid_)
+    return;
+
+  menu_items_valid_ = true;
+  menu_items_.clear();
+  for (int i = 0; i < child_count(); ++i) {
+    if (child_at(i)->id() == MenuItemView::kMenuItemViewID)
+      menu_items_.push_back(static_cast<MenuItemView*>(child_at(i)));
+  }
+}
+
+int SubmenuView::GetMenuItemY(int index) {
+  if (item_source_.get())
+    return GetInsets().top() + index * row_height_;
+  return GetMenuItemAt(index)->y();
+}
+
+void SubmenuView::UpdateVisibleRows() {
+  if (!parent() || !item_count_)
+    return;
+  if (!row_height_)
+    GetItemForRow(0);
+
+  // The parent is the viewport of the MenuScrollViewContainer.
+  int top = -y() - GetInsets().top();
+  first_visible_row_ = std::max(0, top / row_height_ - kOverscanRows);
+  int bottom = top + parent()->height();
+  last_visible_row_ =
+      std::min(item_count_, bottom / row_height_ + 1 + kOverscanRows);
+
+  // Recycle first, so that the rows coming into view can reuse the views.
+  std::vector<MenuItemView*> unused_items;
+  for (std::map<int, MenuItemView*>::const_iterator i = row_items_.begin();
+       i != row_items_.end(); ++i) {
+    if ((i->first < first_visible_row_ || i->first >= last_visible_row_) &&
+        !IsItemInUse(i->second))
+      unused_items.push_back(i->second);
+  }
+  for (size_t i = 0; i < unused_items.size(); ++i)
+    RecycleItem(unused_items[i]);
+
+  for (int row = first_visible_row_; row < last_visible_row_; ++row) {
+    if (row_items_.find(row) == row_items_.end())
+      GetItemForRow(row);
+  }
+  for (std::map<int, MenuItemView*>::const_iterator i = row_items_.begin();
+       i != row_items_.end(); ++i) {
+    i->second->SetBoundsRect(GetRowBounds(i->first));
+  }
+}
+
+MenuItemView* SubmenuView::GetItemForRow(int row) {
+  DCHECK(row_items_.find(row) == row_items_.end());
+  MenuItemView::Type type = item_source_->GetItemType(row);
+  MenuItemView* item = NULL;
+  for (std::vector<MenuItemView*>::iterator i = spare_items_.begin();
+       i != spare_items_.end(); ++i) {
+    if ((*i)->GetType() == type) {
+      item = *i;
+      spare_items_.erase(i);
+      break;
+    }
+  }
+  if (item)
+    item_source_->UpdateItem(item, row);
+  else
+    item = item_source_->CreateItem(row);
+
+  AddChildView(item);
+  row_items_[row] = item;
+  item_rows_[item] = row;
+
+  gfx::Size pref_size = item->GetPreferredSize();
+  if (!row_height_)
+    row_height_ = pref_size.height();
+  max_row_width_ = std::max(max_row_width_, pref_size.width());
+  int accelerator_width = item->GetAcceleratorTextWidth();
+  if (accelerator_width > 0) {
+    accelerator_width += MenuConfig::instance().label_to_accelerator_padding;
+    max_accelerator_width_ = std::max(max_accelerator_width_,
+                                      accelerator_width);
+  }
+  item->SetBoundsRect(GetRowBounds(row));
+  return item;
+}
+
+void SubmenuView::RecycleItem(MenuItemView* item) {
+  // ViewHierarchyChanged() forgets the row.
+  RemoveChildView(item);
+  spare_items_.push_back(item);
+}
+
+bool SubmenuView::IsItemInUse(MenuItemView* item) {
+  // MenuController selects the items on the path to the item it points at.
+  // A submenu that was hidden keeps its host until the menu closes.
+  return item == transient_item_ || item == drop_item_ || item->IsSelected() ||
+      (item->HasSubmenu() && item->GetSubmenu()->host_);
+}
+
+gfx::Rect SubmenuView::GetRowBounds(int row) {
+  gfx::Insets insets = GetInsets();
+  return gfx::Rect(insets.left(), insets.top() + row * row_height_,
+                   width() - insets.width(), row_height_);
 }
 
 void SubmenuView::PaintDropIndicator(gfx::Canvas* canvas,
@@ -6,8 +6,11 @@
 #define VIEWS_CONTROLS_MENU_SUBMENU_VIEW_H_
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
+#include "base/memory/scoped_ptr.h"
 #include "views/controls/menu/menu_delegate.h"
 #include "views/view.h"
 
@@ -32,8 +35,34 @@ class MenuScrollViewContainer;
 // MenuScrollViewContainer handles showing as much of the SubmenuView as the
 // screen allows. If the SubmenuView is taller than the screen, scroll buttons
 // are provided that allow the user to see all the menu items.
+//
+// A submenu with thousands of items can get them from an ItemSource instead
+// of holding a child view for each. SubmenuView then only has views for the
+// rows on screen and for the rows MenuController is using. Views that scroll
+// out of sight are reused for the rows that scroll in.
 class VIEWS_EXPORT SubmenuView : public View {
  public:
+  // Supplies the items of a submenu, see SetItemSource(). All rows are
+  // given the height of the first row that gets a view. Separators are not
+  // supported.
+  class ItemSource {
+   public:
+    virtual ~ItemSource() {}
+
+    // Returns the number of rows. This is read once, when the source is set.
+    virtual int GetItemCount() = 0;
+
+    // Returns the type of the item in row |index|.
+    virtual MenuItemView::Type GetItemType(int index) = 0;
+
+    // Creates the item for row |index|. The caller adds it to the submenu.
+    virtual MenuItemView* CreateItem(int index) = 0;
+
+    // Makes |item|, which was showing another row of the same type, show
+    // row |index|.
+    virtual void UpdateItem(MenuItemView* item, int index) = 0;
+  };
+
   // The submenu's class name.
   static const char kViewClassName[];
 
@@ -45,9 +74,25 @@ class VIEWS_EXPORT SubmenuView : public View {
   // MenuItemViews are identified by ID.
   int GetMenuItemCount();
 
-  // Returns the MenuItemView at the specified index.
+  // Returns the MenuItemView at the specified index. With an ItemSource this
+  // creates a view for the row if it has none. A row off screen keeps that
+  // view until another row off screen is asked for, or for as long as
+  // MenuController uses it.
   MenuItemView* GetMenuItemAt(int index);
 
+  // Returns the index of |item|, or -1 if it isn't one of the menu items.
+  int GetMenuItemIndex(MenuItemView* item);
+
+  // Returns the menu items that have views. Without an ItemSource these are
+  // all of them.
+  void GetMenuItemViews(std::vector<MenuItemView*>* items);
+
+  // Makes the submenu get its items from |item_source|, taking ownership of
+  // it, or stop doing so if |item_source| is NULL. The submenu must have no
+  // other children.
+  void SetItemSource(ItemSource* item_source);
+  ItemSource* item_source() const { return item_source_.get(); }
+
   // Positions and sizes the child views. This tiles the views vertically,
   // giving each child the available width.
   virtual void Layout() OVERRIDE;
@@ -155,7 +200,35 @@ class VIEWS_EXPORT SubmenuView : public View {
 
   virtual void ChildPreferredSizeChanged(View* child) OVERRIDE;
 
+  virtual void ViewHierarchyChanged(bool is_add,
+                                    View* parent,
+                                    View* child) OVERRIDE;
+
  private:
+  // Rebuilds |menu_items_| if children were added or removed since.
+  void UpdateMenuItems();
+
+  // Returns the y-coordinate of the menu item at |index|.
+  int GetMenuItemY(int index);
+
+  // The methods below are only used with an ItemSource.
+
+  // Gives views to the rows on screen, positions all the rows that have
+  // views, and recycles the views of the others unless they are in use.
+  void UpdateVisibleRows();
+
+  // Returns the view of |row|, reusing a spare view or creating one.
+  MenuItemView* GetItemForRow(int row);
+
+  // Removes the view of a row and keeps it for reuse.
+  void RecycleItem(MenuItemView* item);
+
+  // Returns true if MenuController may be pointing at |item|.
+  bool IsItemInUse(MenuItemView* item);
+
+  // Returns the bounds of |row|.
+  gfx::Rect GetRowBounds(int row);
+
   // Paints the drop indicator. This is only invoked if item is non-NULL and
   // position is not DROP_NONE.
   void PaintDropIndicator(gfx::Canvas* canvas,
@@ -195,6 +268,39 @@ class VIEWS_EXPORT SubmenuView : public View {
   // Reposition open menu when contained views change size.
   bool resize_open_menu_;
 
+  // The children that are MenuItemViews, so that the MenuController, which
+  // walks them by index, doesn't scan all the children for each one.
+  std::vector<MenuItemView*> menu_items_;
+  bool menu_items_valid_;
+
+  // See SetItemSource().
+  scoped_ptr<ItemSource> item_source_;
+
+  // The number of rows |item_source_| has.
+  int item_count_;
+
+  // The height of each row, and the width of the widest row given a view so
+  // far. Zero until the first row gets a view.
+  int row_height_;
+  int max_row_width_;
+
+  // Whether the first rows have been measured, see GetPreferredSize().
+  bool rows_measured_;
+
+  // The rows that have views, both ways.
+  std::map<int, MenuItemView*> row_items_;
+  std::map<MenuItemView*, int> item_rows_;
+
+  // Views of rows that scrolled out of sight, kept for reuse.
+  std::vector<MenuItemView*> spare_items_;
+
+  // The last row off screen GetMenuItemAt() gave a view to.
+  MenuItemView* transient_item_;
+
+  // The rows on screen, including some overscan: [first, last).
+  int first_visible_row_;
+  int last_visible_row_;
+
   DISALLOW_COPY_AND_ASSIGN(SubmenuView);
 };
 
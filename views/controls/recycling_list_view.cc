@@ -0,0 +1,153 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "views/controls/recycling_list_view.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace views {
+
+// static
+const int RecyclingListView::kOverscanRowCount = 4;
+
+RecyclingListView::RecyclingListView(int row_height)
+    : row_height_(row_height),
+      first_row_(0) {
+  DCHECK_GT(row_height_, 0);
+}
+
+RecyclingListView::~RecyclingListView() {
+}
+
+int RecyclingListView::GetRowAtY(int y) {
+  if (y < 0)
+    return -1;
+  int row = y / row_height_;
+  return row < GetRowCount() ? row : -1;
+}
+
+gfx::Rect RecyclingListView::GetRowBounds(int row) const {
+  return gfx::Rect(0, row * row_height_, width(), row_height_);
+}
+
+View* RecyclingListView::GetViewForRow(int row) {
+  int index = row - first_row_;
+  if (index < 0 || index >= materialized_row_count())
+    return NULL;
+  return row_views_[index];
+}
+
+void RecyclingListView::ScrollRowToVisible(int row) {
+  ScrollRectToVisible(GetRowBounds(row));
+}
+
+gfx::Size RecyclingListView::GetPreferredSize() {
+  // The list has no natural width; it takes the width of the viewport.
+  return gfx::Size(0, GetRowCount() * row_height_);
+}
+
+void RecyclingListView::Layout() {
+  // ScrollView::Layout() lays out its contents and then reads their size to
+  // set up the scrollbars, so size this View to the viewport width and the
+  // height of all the rows first.
+  if (parent()) {
+    gfx::Size size(parent()->width(), GetRowCount() * row_height_);
+    if (size != this->size())
+      SetBounds(x(), y(), size.width(), size.height());
+  }
+
+  UpdateMaterializedRows(false);
+  for (int i = 0; i < materialized_row_count(); ++i)
+    row_views_[i]->SetBoundsRect(GetRowBounds(first_row_ + i));
+}
+
+void RecyclingListView::RowCountChanged() {
+  UpdateMaterializedRows(true);
+  Layout();
+  // Lets an enclosing ScrollView update its scrollbars for the new height.
+  ScheduleLayout();
+  SchedulePaint();
+}
+
+void RecyclingListView::RowsChanged(int start, int length) {
+  int begin = std::max(start, first_row_);
+  int end = std::min(start + length, first_row_ + materialized_row_count());
+  for (int row = begin; row < end; ++row) {
+    View* row_view = row_views_[row - first_row_];
+    BindRowView(row_view, row);
+    row_view->SchedulePaint();
+  }
+}
+
+bool RecyclingListView::NeedsNotificationWhenVisibleBoundsChange() const {
+  return true;
+}
+
+void RecyclingListView::OnVisibleBoundsChanged() {
+  Layout();
+}
+
+void RecyclingListView::UpdateMaterializedRows(bool rebind_all) {
+  int row_count = GetRowCount();
+  gfx::Rect visible_bounds(GetVisibleBounds());
+  int new_first = 0;
+  int new_end = 0;
+  if (!visible_bounds.IsEmpty() && row_count > 0) {
+    new_first = std::max(0, visible_bounds.y() / row_height_ -
+                            kOverscanRowCount);
+    new_end = std::min(row_count,
+        (visible_bounds.bottom() + row_height_ - 1) / row_height_ +
+        kOverscanRowCount);
+    new_first = std::min(new_first, new_end);
+  }
+
+  if (!rebind_all && new_first == first_row_ &&
+      new_end - new_first == materialized_row_count()) {
+    return;
+  }
+
+  // Keep the Views of rows that stay materialized and recycle the rest.
+  std::vector<View*> new_row_views(new_end - new_first,
+                                   static_cast<View*>(NULL));
+  for (int i = 0; i < materialized_row_count(); ++i) {
+    int row = first_row_ + i;
+    if (row >= new_first && row < new_end)
+      new_row_views[row - new_first] = row_views_[i];
+    else
+      spare_views_.push_back(row_views_[i]);
+  }
+
+  for (size_t i = 0; i < new_row_views.size(); ++i) {
+    int row = new_first + static_cast<int>(i);
+    View* row_view = new_row_views[i];
+    if (!row_view) {
+      if (spare_views_.empty()) {
+        row_view = CreateRowView();
+        AddChildView(row_view);
+      } else {
+        row_view = spare_views_.back();
+        spare_views_.pop_back();
+        row_view->SetVisible(true);
+      }
+      BindRowView(row_view, row);
+      row_view->SchedulePaint();
+    } else if (rebind_all) {
+      BindRowView(row_view, row);
+      row_view->SchedulePaint();
+    }
+    new_row_views[i] = row_view;
+  }
+
+  for (std::vector<View*>::iterator i = spare_views_.begin();
+       i != spare_views_.end(); ++i) {
+    (*i)->SetVisible(false);
+  }
+
+  first_row_ = new_first;
+  row_views_.swap(new_row_views);
+}
+
+}  // namespace views
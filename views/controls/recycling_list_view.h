@@ -0,0 +1,109 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef VIEWS_CONTROLS_RECYCLING_LIST_VIEW_H_
+#define VIEWS_CONTROLS_RECYCLING_LIST_VIEW_H_
+#pragma once
+
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "views/view.h"
+
+namespace views {
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// RecyclingListView
+//
+//  RecyclingListView is the base of Views that show a vertical list of fixed
+//  height rows, such as TableViewViews and TreeViewViews. It is meant to be the
+//  contents of a ScrollView. Layout() makes it as wide as the viewport and as
+//  tall as all of its rows, but it only creates child Views for the rows in
+//  the visible region plus a few rows of overscan on either side. As the
+//  visible region moves, the child Views of rows that scroll out are rebound
+//  to the rows that scroll in, so scrolling through a million rows creates no
+//  Views after the first screenful.
+//
+//  Subclasses provide the row count, create the row Views and bind a row View
+//  to the row it should show.
+//
+///////////////////////////////////////////////////////////////////////////////
+class VIEWS_EXPORT RecyclingListView : public View {
+ public:
+  // Number of rows materialized beyond each edge of the visible region.
+  static const int kOverscanRowCount;
+
+  explicit RecyclingListView(int row_height);
+  virtual ~RecyclingListView();
+
+  int row_height() const { return row_height_; }
+
+  // Returns the row at |y| in this View's coordinates, or -1 if there is no
+  // row at |y|.
+  int GetRowAtY(int y);
+
+  // Returns the bounds of |row| in this View's coordinates.
+  gfx::Rect GetRowBounds(int row) const;
+
+  // Returns the View currently showing |row|, or NULL if |row| is not
+  // materialized.
+  View* GetViewForRow(int row);
+
+  // Returns the number of rows that currently have a View.
+  int materialized_row_count() const {
+    return static_cast<int>(row_views_.size());
+  }
+
+  // Scrolls the minimum amount needed to show |row|.
+  void ScrollRowToVisible(int row);
+
+  // Overridden from View:
+  virtual gfx::Size GetPreferredSize() OVERRIDE;
+  virtual void Layout() OVERRIDE;
+
+ protected:
+  // Returns the number of rows.
+  virtual int GetRowCount() = 0;
+
+  // Creates a View to show rows. The View is owned by this View and is reused
+  // for different rows over time.
+  virtual View* CreateRowView() = 0;
+
+  // Makes |row_view|, which was returned from CreateRowView(), show |row|.
+  virtual void BindRowView(View* row_view, int row) = 0;
+
+  // Subclasses invoke these when their rows change. RowCountChanged() resizes
+  // this View, rebinds every materialized row and schedules a layout of the
+  // enclosing ScrollView. RowsChanged() rebinds the materialized rows in
+  // [start, start + length).
+  void RowCountChanged();
+  void RowsChanged(int start, int length);
+
+  // Overridden from View:
+  virtual bool NeedsNotificationWhenVisibleBoundsChange() const OVERRIDE;
+  virtual void OnVisibleBoundsChanged() OVERRIDE;
+
+ private:
+  // Materializes the rows intersecting the visible region (plus overscan),
+  // recycling the Views of rows that are no longer needed. If |rebind_all| is
+  // true rows that stay materialized are rebound as well.
+  void UpdateMaterializedRows(bool rebind_all);
+
+  const int row_height_;
+
+  // The first materialized row. row_views_[i] shows row first_row_ + i.
+  int first_row_;
+  std::vector<View*> row_views_;
+
+  // Row Views not currently bound to a row. They stay children of this View,
+  // hidden, until they are needed again.
+  std::vector<View*> spare_views_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecyclingListView);
+};
+
+}  // namespace views
+
+#endif  // VIEWS_CONTROLS_RECYCLING_LIST_VIEW_H_
@@ -182,8 +182,10 @@ bool SingleSplitView::OnMouseDragged(const MouseEvent& event) {
 
   if (new_size != divider_offset_) {
     set_divider_offset(new_size);
+    // Drag events can arrive faster than frames are painted; lay out once
+    // per frame.
     if (!observer_ || observer_->SplitHandleMoved(this))
-      Layout();
+      ScheduleLayout();
   }
   return true;
 }
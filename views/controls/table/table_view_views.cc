@@ -0,0 +1,461 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "views/controls/table/table_view_views.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/base/accessibility/accessible_view_state.h"
+#include "ui/gfx/canvas.h"
+#include "views/controls/table/table_view_observer.h"
+
+namespace {
+
+// Padding on either side of the text of a cell.
+const int kTextHorizontalPadding = 4;
+
+// Vertical padding added to the font height to get the row height.
+const int kRowVerticalPadding = 4;
+
+// Size of the icons returned by TableModel::GetIcon().
+const int kIconSize = 16;
+
+// Indent of rows for which TableModel::ShouldIndent() returns true.
+const int kIndent = 16;
+
+const SkColor kTextColor = SK_ColorBLACK;
+const SkColor kSelectedTextColor = SK_ColorWHITE;
+const SkColor kSelectedBackgroundColor = SkColorSetRGB(0x33, 0x66, 0xCC);
+
+int GetRowHeight(const gfx::Font& font) {
+  return std::max(font.GetHeight(), kIconSize) + kRowVerticalPadding;
+}
+
+int TextAlignmentFlags(ui::TableColumn::Alignment alignment) {
+  switch (alignment) {
+    case ui::TableColumn::RIGHT:
+      return gfx::Canvas::TEXT_ALIGN_RIGHT;
+    case ui::TableColumn::CENTER:
+      return gfx::Canvas::TEXT_ALIGN_CENTER;
+    default:
+      return gfx::Canvas::TEXT_ALIGN_LEFT;
+  }
+}
+
+}  // namespace
+
+namespace views {
+
+// TableViewViews::RowView ----------------------------------------------------
+
+// Paints the cells of one row. RowViews are recycled by RecyclingListView,
+// so |row_| changes as the table scrolls.
+class TableViewViews::RowView : public View {
+ public:
+  explicit RowView(TableViewViews* table) : table_(table), row_(-1) {}
+
+  void set_row(int row) { row_ = row; }
+
+  // Overridden from View:
+  virtual void OnPaint(gfx::Canvas* canvas) OVERRIDE {
+    if (row_ < 0 || !table_->model_)
+      return;
+
+    int model_row = table_->ViewToModel(row_);
+    bool selected = model_row == table_->selected_model_row_;
+    if (selected)
+      canvas->FillRectInt(kSelectedBackgroundColor, 0, 0, width(), height());
+    SkColor text_color = selected ? kSelectedTextColor : kTextColor;
+
+    for (size_t i = 0; i < table_->columns_.size(); ++i) {
+      const ui::TableColumn& column = table_->columns_[i];
+      int x = 0;
+      int w = 0;
+      table_->GetColumnBounds(static_cast<int>(i), &x, &w);
+      x += kTextHorizontalPadding;
+      w -= kTextHorizontalPadding * 2;
+      if (i == 0) {
+        if (table_->model_->ShouldIndent(model_row)) {
+          x += kIndent;
+          w -= kIndent;
+        }
+        SkBitmap icon = table_->model_->GetIcon(model_row);
+        if (!icon.isNull()) {
+          canvas->DrawBitmapInt(icon, 0, 0, icon.width(), icon.height(),
+                                x, (height() - kIconSize) / 2,
+                                kIconSize, kIconSize, true);
+          x += kIconSize + kTextHorizontalPadding;
+          w -= kIconSize + kTextHorizontalPadding;
+        }
+      }
+      if (w <= 0)
+        continue;
+      canvas->DrawStringInt(table_->model_->GetText(model_row, column.id),
+                            table_->font_, text_color, x, 0, w, height(),
+                            TextAlignmentFlags(column.alignment));
+    }
+  }
+
+ private:
+  TableViewViews* table_;
+  int row_;
+
+  DISALLOW_COPY_AND_ASSIGN(RowView);
+};
+
+// TableViewViews::SortHelper -------------------------------------------------
+
+// Rows that compare equal are ordered by model index, which keeps the sort
+// stable and gives the binary searches in InsertSortedRows() a total order.
+class TableViewViews::SortHelper {
+ public:
+  SortHelper(ui::TableModel* model, int column_id, bool ascending)
+      : model_(model),
+        column_id_(column_id),
+        ascending_(ascending) {
+  }
+
+  bool operator()(int model_row1, int model_row2) const {
+    int result = model_->CompareValues(model_row1, model_row2, column_id_);
+    if (result == 0)
+      return model_row1 < model_row2;
+    return ascending_ ? result < 0 : result > 0;
+  }
+
+ private:
+  ui::TableModel* model_;
+  int column_id_;
+  bool ascending_;
+};
+
+// TableViewViews -------------------------------------------------------------
+
+// static
+const char TableViewViews::kViewClassName[] = "views/TableViewViews";
+
+TableViewViews::TableViewViews(ui::TableModel* model,
+                               const std::vector<ui::TableColumn>& columns)
+    : RecyclingListView(GetRowHeight(gfx::Font())),
+      model_(NULL),
+      columns_(columns),
+      observer_(NULL),
+      sort_column_id_(-1),
+      sort_ascending_(true),
+      selected_model_row_(-1) {
+  set_focusable(true);
+  SetModel(model);
+}
+
+TableViewViews::~TableViewViews() {
+  if (model_)
+    model_->SetObserver(NULL);
+}
+
+void TableViewViews::SetModel(ui::TableModel* model) {
+  if (model == model_)
+    return;
+
+  if (model_)
+    model_->SetObserver(NULL);
+  model_ = model;
+  if (model_)
+    model_->SetObserver(this);
+  OnModelChanged();
+}
+
+int TableViewViews::RowCount() const {
+  return model_ ? model_->RowCount() : 0;
+}
+
+void TableViewViews::SetSortColumn(int column_id, bool ascending) {
+  sort_column_id_ = column_id;
+  sort_ascending_ = ascending;
+  SortItems();
+  RowCountChanged();
+  if (selected_model_row_ != -1)
+    ScrollRowToVisible(ModelToView(selected_model_row_));
+}
+
+void TableViewViews::ClearSort() {
+  SetSortColumn(-1, true);
+}
+
+int TableViewViews::ViewToModel(int view_index) const {
+  if (view_to_model_.empty())
+    return view_index;
+  DCHECK(view_index >= 0 &&
+         view_index < static_cast<int>(view_to_model_.size()));
+  return view_to_model_[view_index];
+}
+
+int TableViewViews::ModelToView(int model_index) const {
+  if (model_to_view_.empty())
+    return model_index;
+  DCHECK(model_index >= 0 &&
+         model_index < static_cast<int>(model_to_view_.size()));
+  return model_to_view_[model_index];
+}
+
+void TableViewViews::Select(int model_row) {
+  if (model_row == selected_model_row_)
+    return;
+
+  int old_row = selected_model_row_;
+  selected_model_row_ = model_row;
+  if (old_row != -1)
+    RowsChanged(ModelToView(old_row), 1);
+  if (model_row != -1) {
+    int view_index = ModelToView(model_row);
+    RowsChanged(view_index, 1);
+    ScrollRowToVisible(view_index);
+  }
+  if (observer_)
+    observer_->OnSelectionChanged();
+}
+
+int TableViewViews::FirstSelectedRow() const {
+  return selected_model_row_;
+}
+
+void TableViewViews::GetColumnBounds(int index, int* x, int* width) const {
+  DCHECK(index >= 0 && index < static_cast<int>(column_x_.size()));
+  *x = column_x_[index];
+  *width = column_width_[index];
+}
+
+void TableViewViews::Layout() {
+  UpdateColumnBounds();
+  RecyclingListView::Layout();
+}
+
+bool TableViewViews::OnMousePressed(const MouseEvent& event) {
+  RequestFocus();
+  int row = GetRowAtY(event.y());
+  if (row == -1)
+    return true;
+
+  Select(ViewToModel(row));
+  if (observer_) {
+    if (event.IsMiddleMouseButton())
+      observer_->OnMiddleClick();
+    else if (event.flags() & ui::EF_IS_DOUBLE_CLICK)
+      observer_->OnDoubleClick();
+  }
+  return true;
+}
+
+bool TableViewViews::OnKeyPressed(const KeyEvent& event) {
+  if (observer_)
+    observer_->OnKeyDown(event.key_code());
+
+  int row_count = RowCount();
+  if (row_count == 0)
+    return false;
+
+  int current = selected_model_row_ == -1 ?
+      -1 : ModelToView(selected_model_row_);
+  int page = std::max(1, GetVisibleBounds().height() / row_height() - 1);
+  switch (event.key_code()) {
+    case ui::VKEY_UP:
+      SelectViewIndex(current == -1 ? 0 : current - 1);
+      return true;
+    case ui::VKEY_DOWN:
+      SelectViewIndex(current + 1);
+      return true;
+    case ui::VKEY_PRIOR:
+      SelectViewIndex(current - page);
+      return true;
+    case ui::VKEY_NEXT:
+      SelectViewIndex(current + page);
+      return true;
+    case ui::VKEY_HOME:
+      SelectViewIndex(0);
+      return true;
+    case ui::VKEY_END:
+      SelectViewIndex(row_count - 1);
+      return true;
+    default:
+      return false;
+  }
+}
+
+void TableViewViews::GetAccessibleState(ui::AccessibleViewState* state) {
+  state->role = ui::AccessibilityTypes::ROLE_CLIENT;
+  state->count = RowCount();
+  state->index = selected_model_row_ == -1 ?
+      -1 : ModelToView(selected_model_row_);
+}
+
+std::string TableViewViews::GetClassName() const {
+  return kViewClassName;
+}
+
+void TableViewViews::OnModelChanged() {
+  selected_model_row_ = -1;
+  SortItems();
+  RowCountChanged();
+}
+
+void TableViewViews::OnItemsChanged(int start, int length) {
+  if (!is_sorted() || !model_) {
+    RowsChanged(start, length);
+    return;
+  }
+
+  // Changed values may move the rows, so sort them in again.
+  EraseModelRows(start, length, false);
+  std::vector<int> changed_rows(length);
+  for (int i = 0; i < length; ++i)
+    changed_rows[i] = start + i;
+  InsertSortedRows(&changed_rows);
+  UpdateModelToView();
+  RowsChanged(0, RowCount());
+}
+
+void TableViewViews::OnItemsAdded(int start, int length) {
+  if (selected_model_row_ >= start)
+    selected_model_row_ += length;
+
+  if (is_sorted() && model_) {
+    for (size_t i = 0; i < view_to_model_.size(); ++i) {
+      if (view_to_model_[i] >= start)
+        view_to_model_[i] += length;
+    }
+    std::vector<int> added_rows(length);
+    for (int i = 0; i < length; ++i)
+      added_rows[i] = start + i;
+    InsertSortedRows(&added_rows);
+    UpdateModelToView();
+  }
+  RowCountChanged();
+}
+
+void TableViewViews::OnItemsRemoved(int start, int length) {
+  if (selected_model_row_ >= start + length)
+    selected_model_row_ -= length;
+  else if (selected_model_row_ >= start)
+    selected_model_row_ = -1;
+
+  if (is_sorted() && model_) {
+    EraseModelRows(start, length, true);
+    UpdateModelToView();
+  }
+  RowCountChanged();
+}
+
+int TableViewViews::GetRowCount() {
+  return RowCount();
+}
+
+View* TableViewViews::CreateRowView() {
+  return new RowView(this);
+}
+
+void TableViewViews::BindRowView(View* row_view, int row) {
+  static_cast<RowView*>(row_view)->set_row(row);
+}
+
+void TableViewViews::SortItems() {
+  view_to_model_.clear();
+  model_to_view_.clear();
+  if (!is_sorted() || !model_)
+    return;
+
+  int row_count = model_->RowCount();
+  view_to_model_.resize(row_count);
+  for (int i = 0; i < row_count; ++i)
+    view_to_model_[i] = i;
+  std::sort(view_to_model_.begin(), view_to_model_.end(),
+            SortHelper(model_, sort_column_id_, sort_ascending_));
+  UpdateModelToView();
+}
+
+void TableViewViews::InsertSortedRows(std::vector<int>* model_rows) {
+  SortHelper helper(model_, sort_column_id_, sort_ascending_);
+  std::sort(model_rows->begin(), model_rows->end(), helper);
+
+  // Each row goes after the rows placed before it, so every binary search
+  // starts where the previous one ended.
+  std::vector<int> view_to_model;
+  view_to_model.reserve(view_to_model_.size() + model_rows->size());
+  std::vector<int>::iterator from = view_to_model_.begin();
+  for (size_t i = 0; i < model_rows->size(); ++i) {
+    int model_row = (*model_rows)[i];
+    std::vector<int>::iterator to =
+        std::upper_bound(from, view_to_model_.end(), model_row, helper);
+    view_to_model.insert(view_to_model.end(), from, to);
+    view_to_model.push_back(model_row);
+    from = to;
+  }
+  view_to_model.insert(view_to_model.end(), from, view_to_model_.end());
+  view_to_model_.swap(view_to_model);
+}
+
+void TableViewViews::EraseModelRows(int start, int length, bool renumber) {
+  std::vector<int>::iterator out = view_to_model_.begin();
+  for (std::vector<int>::const_iterator i = view_to_model_.begin();
+       i != view_to_model_.end(); ++i) {
+    int model_row = *i;
+    if (model_row >= start && model_row < start + length)
+      continue;
+    if (renumber && model_row >= start + length)
+      model_row -= length;
+    *out++ = model_row;
+  }
+  view_to_model_.erase(out, view_to_model_.end());
+}
+
+void TableViewViews::UpdateModelToView() {
+  int row_count = static_cast<int>(view_to_model_.size());
+  model_to_view_.resize(row_count);
+  for (int i = 0; i < row_count; ++i)
+    model_to_view_[view_to_model_[i]] = i;
+}
+
+void TableViewViews::UpdateColumnBounds() {
+  size_t column_count = columns_.size();
+  column_x_.resize(column_count);
+  column_width_.resize(column_count);
+
+  // Fixed and autosized columns first, then split what is left among the
+  // percentage columns.
+  int used_width = 0;
+  float total_percent = 0;
+  for (size_t i = 0; i < column_count; ++i) {
+    const ui::TableColumn& column = columns_[i];
+    if (column.width > 0) {
+      column_width_[i] = column.width;
+    } else if (column.percent > 0) {
+      column_width_[i] = 0;
+      total_percent += column.percent;
+    } else {
+      column_width_[i] = font_.GetStringWidth(column.title) +
+          kTextHorizontalPadding * 2;
+    }
+    used_width += column_width_[i];
+  }
+
+  int remaining_width = std::max(0, width() - used_width);
+  for (size_t i = 0; i < column_count; ++i) {
+    if (columns_[i].width <= 0 && columns_[i].percent > 0) {
+      column_width_[i] = static_cast<int>(
+          remaining_width * columns_[i].percent / total_percent);
+    }
+  }
+
+  int x = 0;
+  for (size_t i = 0; i < column_count; ++i) {
+    column_x_[i] = GetMirroredXWithWidthInView(x, column_width_[i]);
+    x += column_width_[i];
+  }
+}
+
+void TableViewViews::SelectViewIndex(int view_index) {
+  view_index = std::max(0, std::min(RowCount() - 1, view_index));
+  Select(ViewToModel(view_index));
+}
+
+}  // namespace views
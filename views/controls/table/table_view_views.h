@@ -0,0 +1,164 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef VIEWS_CONTROLS_TABLE_TABLE_VIEW_VIEWS_H_
+#define VIEWS_CONTROLS_TABLE_TABLE_VIEW_VIEWS_H_
+#pragma once
+
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "ui/base/models/table_model.h"
+#include "ui/base/models/table_model_observer.h"
+#include "ui/gfx/font.h"
+#include "views/controls/recycling_list_view.h"
+
+namespace views {
+
+class TableViewObserver;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// TableViewViews
+//
+//  TableViewViews is a table implemented entirely with Views, for builds
+//  without the native list view that backs TableView. It shows the rows of a
+//  ui::TableModel and only creates Views for the rows that are visible (see
+//  RecyclingListView), so it is meant to be placed in a ScrollView and copes
+//  with models of millions of rows.
+//
+//  Sorting does not copy the model: the table keeps a permutation from view
+//  indices to model indices. Rows passed to and returned from the public API
+//  are model indices unless noted otherwise.
+//
+///////////////////////////////////////////////////////////////////////////////
+class VIEWS_EXPORT TableViewViews : public RecyclingListView,
+                                   public ui::TableModelObserver {
+ public:
+  static const char kViewClassName[];
+
+  // Creates a table showing |columns| of |model|. TableViewViews does not take
+  // ownership of |model|.
+  TableViewViews(ui::TableModel* model,
+                 const std::vector<ui::TableColumn>& columns);
+  virtual ~TableViewViews();
+
+  // Replaces the model. TableViewViews does not take ownership of |model|,
+  // which may be NULL.
+  void SetModel(ui::TableModel* model);
+  ui::TableModel* model() const { return model_; }
+
+  void SetObserver(TableViewObserver* observer) { observer_ = observer; }
+  TableViewObserver* observer() const { return observer_; }
+
+  // Returns the number of rows in the table.
+  int RowCount() const;
+
+  // Sorts the rows by the column with id |column_id| using
+  // TableModel::CompareValues(). The sort is stable, so rows comparing equal
+  // keep their relative order.
+  void SetSortColumn(int column_id, bool ascending);
+
+  // Shows the rows in model order again.
+  void ClearSort();
+
+  bool is_sorted() const { return sort_column_id_ != -1; }
+  int sort_column_id() const { return sort_column_id_; }
+  bool sort_ascending() const { return sort_ascending_; }
+
+  // Conversion between the index of a row as shown and its model index.
+  int ViewToModel(int view_index) const;
+  int ModelToView(int model_index) const;
+
+  // Selects the row with |model_row| and scrolls it into view. Passing -1
+  // clears the selection.
+  void Select(int model_row);
+
+  // Returns the model index of the selected row, or -1.
+  int FirstSelectedRow() const;
+
+  // Returns the x coordinate and width of the column at |index| in |columns_|.
+  void GetColumnBounds(int index, int* x, int* width) const;
+
+  const std::vector<ui::TableColumn>& columns() const { return columns_; }
+  const gfx::Font& font() const { return font_; }
+
+  // Overridden from View:
+  virtual void Layout() OVERRIDE;
+  virtual bool OnMousePressed(const MouseEvent& event) OVERRIDE;
+  virtual bool OnKeyPressed(const KeyEvent& event) OVERRIDE;
+  virtual void GetAccessibleState(ui::AccessibleViewState* state) OVERRIDE;
+  virtual std::string GetClassName() const OVERRIDE;
+
+  // Overridden from ui::TableModelObserver:
+  virtual void OnModelChanged() OVERRIDE;
+  virtual void OnItemsChanged(int start, int length) OVERRIDE;
+  virtual void OnItemsAdded(int start, int length) OVERRIDE;
+  virtual void OnItemsRemoved(int start, int length) OVERRIDE;
+
+ protected:
+  // Overridden from RecyclingListView:
+  virtual int GetRowCount() OVERRIDE;
+  virtual View* CreateRowView() OVERRIDE;
+  virtual void BindRowView(View* row_view, int row) OVERRIDE;
+
+ private:
+  class RowView;
+  friend class RowView;
+
+  // Orders model rows for the current sort.
+  class SortHelper;
+  friend class SortHelper;
+
+  // Rebuilds the view/model permutation for the current sort.
+  void SortItems();
+
+  // The methods below keep the permutation sorted as the model changes,
+  // comparing only the rows that were added or changed.
+
+  // Merges |model_rows|, which must not be in |view_to_model_|, into it.
+  // Sorts |model_rows| as a side effect.
+  void InsertSortedRows(std::vector<int>* model_rows);
+
+  // Removes the model rows [start, start + length) from |view_to_model_|. If
+  // |renumber| is true the rows after them move up, as they do in the model
+  // when rows are removed.
+  void EraseModelRows(int start, int length, bool renumber);
+
+  // Rebuilds |model_to_view_| from |view_to_model_|.
+  void UpdateModelToView();
+
+  // Recomputes |column_x_| and |column_width_| for the current width.
+  void UpdateColumnBounds();
+
+  // Selects the row at |view_index|, clamped to the valid range.
+  void SelectViewIndex(int view_index);
+
+  ui::TableModel* model_;
+  std::vector<ui::TableColumn> columns_;
+  TableViewObserver* observer_;
+  gfx::Font font_;
+
+  // The column being sorted by, -1 if the rows are in model order.
+  int sort_column_id_;
+  bool sort_ascending_;
+
+  // When sorted, view_to_model_[i] is the model index of the row shown at i and
+  // model_to_view_ is its inverse. Both are empty when unsorted.
+  std::vector<int> view_to_model_;
+  std::vector<int> model_to_view_;
+
+  // Model index of the selected row, or -1.
+  int selected_model_row_;
+
+  // Horizontal extent of each column in |columns_|.
+  std::vector<int> column_x_;
+  std::vector<int> column_width_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableViewViews);
+};
+
+}  // namespace views
+
+#endif  // VIEWS_CONTROLS_TABLE_TABLE_VIEW_VIEWS_H_
@@ -0,0 +1,470 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "views/controls/tree/tree_view_views.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "ui/base/accessibility/accessible_view_state.h"
+#include "ui/gfx/canvas.h"
+
+namespace {
+
+// Horizontal indent of each level of the tree.
+const int kIndent = 16;
+
+// Size of the expand/collapse box.
+const int kExpanderSize = 9;
+
+// Padding between the expander and the title, and around the title.
+const int kTextHorizontalPadding = 4;
+
+// Vertical padding added to the font height to get the row height.
+const int kRowVerticalPadding = 4;
+
+const SkColor kTextColor = SK_ColorBLACK;
+const SkColor kExpanderColor = SkColorSetRGB(0x80, 0x80, 0x80);
+const SkColor kSelectedTextColor = SK_ColorWHITE;
+const SkColor kSelectedBackgroundColor = SkColorSetRGB(0x33, 0x66, 0xCC);
+
+}  // namespace
+
+namespace views {
+
+// TreeViewViews::RowView -----------------------------------------------------
+
+// Paints one row. RowViews are recycled by RecyclingListView, so |row_|
+// changes as the tree scrolls.
+class TreeViewViews::RowView : public View {
+ public:
+  explicit RowView(TreeViewViews* tree) : tree_(tree), row_(-1) {}
+
+  void set_row(int row) { row_ = row; }
+
+  // Overridden from View:
+  virtual void OnPaint(gfx::Canvas* canvas) OVERRIDE {
+    if (row_ < 0 || row_ >= static_cast<int>(tree_->rows_.size()))
+      return;
+
+    ui::TreeModelNode* node = tree_->rows_[row_].node;
+    bool selected = node == tree_->selected_node_;
+    if (selected)
+      canvas->FillRectInt(kSelectedBackgroundColor, 0, 0, width(), height());
+
+    int expander_x = GetMirroredXWithWidthInView(tree_->GetExpanderX(row_),
+                                                 kExpanderSize);
+    int expander_y = (height() - kExpanderSize) / 2;
+    if (tree_->model_->GetChildCount(node) > 0) {
+      int mid = kExpanderSize / 2;
+      canvas->DrawRectInt(kExpanderColor, expander_x, expander_y,
+                          kExpanderSize - 1, kExpanderSize - 1);
+      canvas->DrawLineInt(kExpanderColor, expander_x + 2, expander_y + mid,
+                          expander_x + kExpanderSize - 3, expander_y + mid);
+      if (!tree_->IsExpanded(node)) {
+        canvas->DrawLineInt(kExpanderColor, expander_x + mid, expander_y + 2,
+                            expander_x + mid, expander_y + kExpanderSize - 3);
+      }
+    }
+
+    int text_x = tree_->GetExpanderX(row_) + kExpanderSize +
+        kTextHorizontalPadding;
+    int text_width = width() - text_x - kTextHorizontalPadding;
+    if (text_width <= 0)
+      return;
+    canvas->DrawStringInt(node->GetTitle(), tree_->font_,
+                          selected ? kSelectedTextColor : kTextColor,
+                          GetMirroredXWithWidthInView(text_x, text_width), 0,
+                          text_width, height());
+  }
+
+ private:
+  TreeViewViews* tree_;
+  int row_;
+
+  DISALLOW_COPY_AND_ASSIGN(RowView);
+};
+
+// TreeViewViews --------------------------------------------------------------
+
+// static
+const char TreeViewViews::kViewClassName[] = "views/TreeViewViews";
+
+TreeViewViews::TreeViewViews()
+    : RecyclingListView(gfx::Font().GetHeight() + kRowVerticalPadding),
+      model_(NULL),
+      controller_(NULL),
+      root_shown_(true),
+      node_rows_valid_(0),
+      selected_node_(NULL) {
+  set_focusable(true);
+}
+
+TreeViewViews::~TreeViewViews() {
+  if (model_)
+    model_->RemoveObserver(this);
+}
+
+void TreeViewViews::SetModel(ui::TreeModel* model) {
+  if (model == model_)
+    return;
+
+  if (model_)
+    model_->RemoveObserver(this);
+  model_ = model;
+  if (model_)
+    model_->AddObserver(this);
+  expanded_.clear();
+  selected_node_ = NULL;
+  RebuildRows();
+}
+
+void TreeViewViews::SetRootShown(bool root_shown) {
+  if (root_shown == root_shown_)
+    return;
+
+  root_shown_ = root_shown;
+  RebuildRows();
+}
+
+void TreeViewViews::Expand(ui::TreeModelNode* node) {
+  DCHECK(model_);
+  ui::TreeModelNode* parent = model_->GetParent(node);
+  if (parent)
+    Expand(parent);
+  if (IsExpanded(node))
+    return;
+
+  expanded_.insert(node);
+  int row = GetRowForNode(node);
+  if (row == -1)
+    return;
+
+  // Splice the newly shown rows in after |node|.
+  std::vector<Row> child_rows;
+  AppendChildRows(node, rows_[row].depth + 1, &child_rows);
+  rows_.insert(rows_.begin() + row + 1, child_rows.begin(), child_rows.end());
+  InvalidateNodeRows(row + 1);
+  RowCountChanged();
+}
+
+void TreeViewViews::Collapse(ui::TreeModelNode* node) {
+  if (!IsExpanded(node))
+    return;
+
+  expanded_.erase(node);
+  int row = GetRowForNode(node);
+  if (row == -1)
+    return;
+
+  // Remove the descendants of |node|. They include all of its expanded
+  // descendants, which are collapsed too.
+  bool selection_hidden = EraseRows(row + 1, GetRowAfterDescendants(row));
+  RowCountChanged();
+  if (selection_hidden)
+    SetSelectedNode(node);
+}
+
+bool TreeViewViews::IsExpanded(ui::TreeModelNode* node) const {
+  return expanded_.find(node) != expanded_.end();
+}
+
+void TreeViewViews::SetSelectedNode(ui::TreeModelNode* node) {
+  if (node == selected_node_)
+    return;
+
+  if (node) {
+    ui::TreeModelNode* parent = model_->GetParent(node);
+    if (parent)
+      Expand(parent);
+  }
+
+  int old_row = selected_node_ ? GetRowForNode(selected_node_) : -1;
+  selected_node_ = node;
+  if (old_row != -1)
+    RowsChanged(old_row, 1);
+  int row = node ? GetRowForNode(node) : -1;
+  if (row != -1) {
+    RowsChanged(row, 1);
+    ScrollRowToVisible(row);
+  }
+  if (controller_)
+    controller_->OnTreeViewViewsSelectionChanged(this);
+}
+
+ui::TreeModelNode* TreeViewViews::GetNodeForRow(int row) const {
+  DCHECK(row >= 0 && row < static_cast<int>(rows_.size()));
+  return rows_[row].node;
+}
+
+int TreeViewViews::GetRowForNode(ui::TreeModelNode* node) const {
+  std::map<ui::TreeModelNode*, int>::const_iterator i = node_rows_.find(node);
+  if (i != node_rows_.end() && i->second < node_rows_valid_ &&
+      rows_[i->second].node == node) {
+    return i->second;
+  }
+
+  // Refresh the entries after the valid ones until |node| turns up.
+  const int row_count = static_cast<int>(rows_.size());
+  while (node_rows_valid_ < row_count) {
+    ui::TreeModelNode* row_node = rows_[node_rows_valid_].node;
+    node_rows_[row_node] = node_rows_valid_++;
+    if (row_node == node)
+      return node_rows_valid_ - 1;
+  }
+  return -1;
+}
+
+bool TreeViewViews::OnMousePressed(const MouseEvent& event) {
+  RequestFocus();
+  int row = GetRowAtY(event.y());
+  if (row == -1)
+    return true;
+
+  ui::TreeModelNode* node = rows_[row].node;
+  int expander_x = GetMirroredXWithWidthInView(GetExpanderX(row),
+                                               kExpanderSize);
+  bool on_expander = event.x() >= expander_x &&
+                     event.x() < expander_x + kExpanderSize;
+  if (on_expander || (event.flags() & ui::EF_IS_DOUBLE_CLICK)) {
+    if (IsExpanded(node))
+      Collapse(node);
+    else if (model_->GetChildCount(node) > 0)
+      Expand(node);
+  }
+  if (!on_expander)
+    SetSelectedNode(node);
+  return true;
+}
+
+bool TreeViewViews::OnKeyPressed(const KeyEvent& event) {
+  if (rows_.empty())
+    return false;
+
+  int row = selected_node_ ? GetRowForNode(selected_node_) : -1;
+  int page = std::max(1, GetVisibleBounds().height() / row_height() - 1);
+  switch (event.key_code()) {
+    case ui::VKEY_UP:
+      SelectRow(row == -1 ? 0 : row - 1);
+      return true;
+    case ui::VKEY_DOWN:
+      SelectRow(row + 1);
+      return true;
+    case ui::VKEY_PRIOR:
+      SelectRow(row - page);
+      return true;
+    case ui::VKEY_NEXT:
+      SelectRow(row + page);
+      return true;
+    case ui::VKEY_HOME:
+      SelectRow(0);
+      return true;
+    case ui::VKEY_END:
+      SelectRow(static_cast<int>(rows_.size()) - 1);
+      return true;
+    case ui::VKEY_LEFT:
+      if (row == -1)
+        return false;
+      if (IsExpanded(selected_node_)) {
+        Collapse(selected_node_);
+      } else if (rows_[row].depth > 0) {
+        SetSelectedNode(model_->GetParent(selected_node_));
+      }
+      return true;
+    case ui::VKEY_RIGHT:
+      if (row == -1 || model_->GetChildCount(selected_node_) == 0)
+        return false;
+      if (!IsExpanded(selected_node_))
+        Expand(selected_node_);
+      else
+        SelectRow(row + 1);
+      return true;
+    default:
+      return false;
+  }
+}
+
+void TreeViewViews::GetAccessibleState(ui::AccessibleViewState* state) {
+  state->role = ui::AccessibilityTypes::ROLE_OUTLINE;
+  state->count = static_cast<int>(rows_.size());
+  if (selected_node_) {
+    state->name = selected_node_->GetTitle();
+    state->index = GetRowForNode(selected_node_);
+  }
+}
+
+std::string TreeViewViews::GetClassName() const {
+  return kViewClassName;
+}
+
+void TreeViewViews::TreeNodesAdded(ui::TreeModel* model,
+                                   ui::TreeModelNode* parent,
+                                   int start,
+                                   int count) {
+  if (!AreChildrenShown(parent)) {
+    // The expander of |parent| may have appeared.
+    int row = GetRowForNode(parent);
+    if (row != -1)
+      RowsChanged(row, 1);
+    return;
+  }
+
+  std::vector<Row> new_rows;
+  int depth = GetChildDepth(parent);
+  for (int i = start; i < start + count; ++i)
+    AppendNodeRows(model_->GetChild(parent, i), depth, &new_rows);
+  int row = GetRowForChildAt(parent, start);
+  rows_.insert(rows_.begin() + row, new_rows.begin(), new_rows.end());
+  InvalidateNodeRows(row);
+  RowCountChanged();
+}
+
+void TreeViewViews::TreeNodesRemoved(ui::TreeModel* model,
+                                     ui::TreeModelNode* parent,
+                                     int start,
+                                     int count) {
+  if (!AreChildrenShown(parent)) {
+    // Neither the removed nodes nor the selection, which is always shown, had
+    // rows. The expander of |parent| may have gone.
+    int row = GetRowForNode(parent);
+    if (row != -1)
+      RowsChanged(row, 1);
+    return;
+  }
+
+  // The removed nodes may already be deleted, so their rows are found from
+  // the rows of the children before them.
+  int first = GetRowForChildAt(parent, start);
+  int last = first;
+  for (int i = 0; i < count; ++i)
+    last = GetRowAfterDescendants(last);
+  bool selection_removed = EraseRows(first, last);
+  RowCountChanged();
+
+  // Fall back to |parent| unless it is the hidden root.
+  if (selection_removed) {
+    selected_node_ = NULL;
+    if (GetRowForNode(parent) != -1)
+      SetSelectedNode(parent);
+    else if (controller_)
+      controller_->OnTreeViewViewsSelectionChanged(this);
+  }
+}
+
+void TreeViewViews::TreeNodeChanged(ui::TreeModel* model,
+                                    ui::TreeModelNode* node) {
+  int row = GetRowForNode(node);
+  if (row != -1)
+    RowsChanged(row, 1);
+}
+
+int TreeViewViews::GetRowCount() {
+  return static_cast<int>(rows_.size());
+}
+
+View* TreeViewViews::CreateRowView() {
+  return new RowView(this);
+}
+
+void TreeViewViews::BindRowView(View* row_view, int row) {
+  static_cast<RowView*>(row_view)->set_row(row);
+}
+
+void TreeViewViews::RebuildRows() {
+  rows_.clear();
+  node_rows_.clear();
+  node_rows_valid_ = 0;
+  std::set<ui::TreeModelNode*> expanded;
+  if (model_) {
+    ui::TreeModelNode* root = model_->GetRoot();
+    if (IsExpanded(root))
+      expanded.insert(root);
+    if (root_shown_) {
+      rows_.push_back(Row(root, 0));
+      if (IsExpanded(root))
+        AppendChildRows(root, 1, &rows_);
+    } else {
+      AppendChildRows(root, 0, &rows_);
+    }
+  }
+  // Every expanded node that is still in the model was reached above, so this
+  // forgets the removed ones without touching them.
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    if (IsExpanded(rows_[i].node))
+      expanded.insert(rows_[i].node);
+  }
+  expanded_.swap(expanded);
+  RowCountChanged();
+}
+
+void TreeViewViews::AppendChildRows(ui::TreeModelNode* parent,
+                                    int depth,
+                                    std::vector<Row>* rows) {
+  for (int i = 0, count = model_->GetChildCount(parent); i < count; ++i)
+    AppendNodeRows(model_->GetChild(parent, i), depth, rows);
+}
+
+void TreeViewViews::AppendNodeRows(ui::TreeModelNode* node,
+                                   int depth,
+                                   std::vector<Row>* rows) {
+  rows->push_back(Row(node, depth));
+  if (IsExpanded(node))
+    AppendChildRows(node, depth + 1, rows);
+}
+
+bool TreeViewViews::AreChildrenShown(ui::TreeModelNode* parent) const {
+  if (parent == model_->GetRoot() && !root_shown_)
+    return true;
+  // Expanded nodes are always shown.
+  return IsExpanded(parent);
+}
+
+int TreeViewViews::GetChildDepth(ui::TreeModelNode* parent) const {
+  int row = GetRowForNode(parent);
+  return row == -1 ? 0 : rows_[row].depth + 1;
+}
+
+int TreeViewViews::GetRowForChildAt(ui::TreeModelNode* parent,
+                                    int index) const {
+  if (index == 0)
+    return GetRowForNode(parent) + 1;
+  return GetRowAfterDescendants(
+      GetRowForNode(model_->GetChild(parent, index - 1)));
+}
+
+int TreeViewViews::GetRowAfterDescendants(int row) const {
+  const int row_count = static_cast<int>(rows_.size());
+  int depth = rows_[row].depth;
+  for (++row; row < row_count && rows_[row].depth > depth; ++row) {}
+  return row;
+}
+
+bool TreeViewViews::EraseRows(int first, int last) {
+  bool selection_erased = false;
+  for (int row = first; row < last; ++row) {
+    ui::TreeModelNode* node = rows_[row].node;
+    if (node == selected_node_)
+      selection_erased = true;
+    expanded_.erase(node);
+    node_rows_.erase(node);
+  }
+  rows_.erase(rows_.begin() + first, rows_.begin() + last);
+  InvalidateNodeRows(first);
+  return selection_erased;
+}
+
+void TreeViewViews::InvalidateNodeRows(int row) {
+  node_rows_valid_ = std::min(node_rows_valid_, row);
+}
+
+int TreeViewViews::GetExpanderX(int row) const {
+  return kTextHorizontalPadding + rows_[row].depth * kIndent;
+}
+
+void TreeViewViews::SelectRow(int row) {
+  row = std::max(0, std::min(static_cast<int>(rows_.size()) - 1, row));
+  SetSelectedNode(rows_[row].node);
+}
+
+}  // namespace views
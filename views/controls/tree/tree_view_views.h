@@ -0,0 +1,190 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef VIEWS_CONTROLS_TREE_TREE_VIEW_VIEWS_H_
+#define VIEWS_CONTROLS_TREE_TREE_VIEW_VIEWS_H_
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "ui/base/models/tree_model.h"
+#include "ui/gfx/font.h"
+#include "views/controls/recycling_list_view.h"
+
+namespace views {
+
+class TreeViewViews;
+
+// Controller for TreeViewViews.
+class TreeViewViewsController {
+ public:
+  // Notification that the selection of |tree_view| has changed. Use
+  // GetSelectedNode() to find the current selection.
+  virtual void OnTreeViewViewsSelectionChanged(TreeViewViews* tree_view) = 0;
+
+ protected:
+  virtual ~TreeViewViewsController() {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// TreeViewViews
+//
+//  TreeViewViews shows a ui::TreeModel using Views only, for builds without
+//  the native tree control that backs TreeView. The expanded part of the tree
+//  is kept as a flat list of rows, and only the visible rows have Views (see
+//  RecyclingListView), so it is meant to be placed in a ScrollView and copes
+//  with very large trees.
+//
+///////////////////////////////////////////////////////////////////////////////
+class VIEWS_EXPORT TreeViewViews : public RecyclingListView,
+                                  public ui::TreeModelObserver {
+ public:
+  static const char kViewClassName[];
+
+  TreeViewViews();
+  virtual ~TreeViewViews();
+
+  // Sets the model. TreeViewViews does not take ownership of the model.
+  void SetModel(ui::TreeModel* model);
+  ui::TreeModel* model() const { return model_; }
+
+  void SetController(TreeViewViewsController* controller) {
+    controller_ = controller;
+  }
+
+  // Sets whether the root is shown. If false, the children of the root are
+  // the top level rows. The default is true.
+  void SetRootShown(bool root_shown);
+
+  // Expands or collapses |node|. Expanding |node| expands its ancestors as
+  // well, and collapsing it collapses its descendants.
+  void Expand(ui::TreeModelNode* node);
+  void Collapse(ui::TreeModelNode* node);
+  bool IsExpanded(ui::TreeModelNode* node) const;
+
+  // Selects |node|, expanding its ancestors and scrolling it into view.
+  // Passing NULL clears the selection.
+  void SetSelectedNode(ui::TreeModelNode* node);
+  ui::TreeModelNode* GetSelectedNode() const { return selected_node_; }
+
+  // Returns the node shown at |row|.
+  ui::TreeModelNode* GetNodeForRow(int row) const;
+
+  // Returns the row of |node|, or -1 if |node| is not shown because an
+  // ancestor is collapsed.
+  int GetRowForNode(ui::TreeModelNode* node) const;
+
+  // Overridden from View:
+  virtual bool OnMousePressed(const MouseEvent& event) OVERRIDE;
+  virtual bool OnKeyPressed(const KeyEvent& event) OVERRIDE;
+  virtual void GetAccessibleState(ui::AccessibleViewState* state) OVERRIDE;
+  virtual std::string GetClassName() const OVERRIDE;
+
+  // Overridden from ui::TreeModelObserver:
+  virtual void TreeNodesAdded(ui::TreeModel* model,
+                              ui::TreeModelNode* parent,
+                              int start,
+                              int count) OVERRIDE;
+  virtual void TreeNodesRemoved(ui::TreeModel* model,
+                                ui::TreeModelNode* parent,
+                                int start,
+                                int count) OVERRIDE;
+  virtual void TreeNodeChanged(ui::TreeModel* model,
+                               ui::TreeModelNode* node) OVERRIDE;
+
+ protected:
+  // Overridden from RecyclingListView:
+  virtual int GetRowCount() OVERRIDE;
+  virtual View* CreateRowView() OVERRIDE;
+  virtual void BindRowView(View* row_view, int row) OVERRIDE;
+
+ private:
+  class RowView;
+  friend class RowView;
+
+  // A shown node and its depth (0 for the top level rows).
+  struct Row {
+    Row(ui::TreeModelNode* node, int depth) : node(node), depth(depth) {}
+
+    ui::TreeModelNode* node;
+    int depth;
+  };
+
+  // Rebuilds |rows_| from the model, and drops the nodes that are no longer
+  // in the model from |expanded_|.
+  void RebuildRows();
+
+  // Appends rows for the children of |parent|, and recursively for the
+  // children of expanded children, to |rows|.
+  void AppendChildRows(ui::TreeModelNode* parent,
+                       int depth,
+                       std::vector<Row>* rows);
+
+  // Appends a row for |node|, and rows for its children if it is expanded,
+  // to |rows|.
+  void AppendNodeRows(ui::TreeModelNode* node,
+                      int depth,
+                      std::vector<Row>* rows);
+
+  // Returns true if the children of |parent| have rows.
+  bool AreChildrenShown(ui::TreeModelNode* parent) const;
+
+  // Returns the depth of the rows of the children of |parent|, whose children
+  // must be shown.
+  int GetChildDepth(ui::TreeModelNode* parent) const;
+
+  // Returns the row of the child of |parent| at |index|, or the row it would
+  // be given if it were added, given that the children of |parent| are
+  // shown. Only the children before |index| are looked at, so this works
+  // while removed children are still in |rows_|.
+  int GetRowForChildAt(ui::TreeModelNode* parent, int index) const;
+
+  // Returns the row after the descendants of the node at |row|.
+  int GetRowAfterDescendants(int row) const;
+
+  // Removes rows [first, last), collapsing the nodes and forgetting them.
+  // Returns true if the selected node was among them. The nodes are not
+  // dereferenced, so they may already be deleted.
+  bool EraseRows(int first, int last);
+
+  // Called when rows from |row| on have moved.
+  void InvalidateNodeRows(int row);
+
+  // Returns the x coordinate of the expand/collapse box for |row|.
+  int GetExpanderX(int row) const;
+
+  // Selects the node at |row|, clamped to the valid range.
+  void SelectRow(int row);
+
+  ui::TreeModel* model_;
+  TreeViewViewsController* controller_;
+  gfx::Font font_;
+  bool root_shown_;
+
+  // The shown nodes, in display order.
+  std::vector<Row> rows_;
+
+  // Maps the nodes in |rows_| to their rows. The nodes of the first
+  // |node_rows_valid_| rows have the right entries; other entries may be
+  // stale, and are refreshed by GetRowForNode() as needed. Rows inserted or
+  // erased only move the rows after them, so they only invalidate those.
+  mutable std::map<ui::TreeModelNode*, int> node_rows_;
+  mutable int node_rows_valid_;
+
+  // Nodes that are expanded. The ancestors of an expanded node are expanded
+  // too, so every expanded node is shown unless it is the hidden root.
+  std::set<ui::TreeModelNode*> expanded_;
+
+  ui::TreeModelNode* selected_node_;
+
+  DISALLOW_COPY_AND_ASSIGN(TreeViewViews);
+};
+
+}  // namespace views
+
+#endif  // VIEWS_CONTROLS_TREE_TREE_VIEW_VIEWS_H_
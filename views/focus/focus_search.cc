@@ -12,7 +12,9 @@ namespace views {
 FocusSearch::FocusSearch(View* root, bool cycle, bool accessibility_mode)
     : root_(root),
       cycle_(cycle),
-      accessibility_mode_(accessibility_mode) {
+      accessibility_mode_(accessibility_mode),
+      focus_order_usable_(false),
+      focus_order_version_(-1) {
 }
 
 View* FocusSearch::FindNextFocusableView(View* starting_view,
@@ -49,22 +51,31 @@ View* FocusSearch::FindNextFocusableView(View* starting_view,
 
   View* v = NULL;
   if (!reverse) {
-    v = FindNextFocusableViewImpl(starting_view, check_starting_view,
-                                  true,
-                                  (direction == DOWN) ? true : false,
-                                  starting_view_group,
-                                  focus_traversable,
-                                  focus_traversable_view);
+    bool can_go_down = (direction == DOWN);
+    if (!FindInFocusOrder(starting_view, false, check_starting_view,
+                          can_go_down, starting_view_group, focus_traversable,
+                          focus_traversable_view, &v)) {
+      v = FindNextFocusableViewImpl(starting_view, check_starting_view,
+                                    true,
+                                    can_go_down,
+                                    starting_view_group,
+                                    focus_traversable,
+                                    focus_traversable_view);
+    }
   } else {
     // If the starting view is focusable, we don't want to go down, as we are
     // traversing the view hierarchy tree bottom-up.
     bool can_go_down = (direction == DOWN) && !IsFocusable(starting_view);
-    v = FindPreviousFocusableViewImpl(starting_view, check_starting_view,
-                                      true,
-                                      can_go_down,
-                                      starting_view_group,
-                                      focus_traversable,
-                                      focus_traversable_view);
+    if (!FindInFocusOrder(starting_view, true, check_starting_view,
+                          can_go_down, starting_view_group, focus_traversable,
+                          focus_traversable_view, &v)) {
+      v = FindPreviousFocusableViewImpl(starting_view, check_starting_view,
+                                        true,
+                                        can_go_down,
+                                        starting_view_group,
+                                        focus_traversable,
+                                        focus_traversable_view);
+    }
   }
 
   // Don't set the focus to something outside of this view hierarchy.
@@ -92,6 +103,213 @@ View* FocusSearch::FindNextFocusableView(View* starting_view,
   return NULL;
 }
 
+void FocusSearch::GetFocusableViews(std::vector<View*>* views) {
+  UpdateFocusOrder();
+  for (std::vector<View*>::const_iterator i = focus_order_.begin();
+       i != focus_order_.end(); ++i) {
+    if (IsFocusable(*i))
+      views->push_back(*i);
+  }
+}
+
+void FocusSearch::UpdateFocusOrder() {
+  int version = root_->focus_order_version();
+  if (version == focus_order_version_)
+    return;
+
+  focus_order_version_ = version;
+  focus_order_.clear();
+  traversable_ancestors_.clear();
+  focus_order_ranges_.clear();
+  focus_order_usable_ = true;
+
+  FocusOrderRange& range = focus_order_ranges_[root_];
+  range.begin = 0;
+  range.traversable_ancestor = -1;
+  AppendChildrenToFocusOrder(root_, -1);
+  range.end = static_cast<int>(focus_order_.size());
+}
+
+void FocusSearch::AppendToFocusOrder(View* view, int traversable_ancestor) {
+  // Views that can't be focusable in any state are left out. The overrides
+  // of View::IsFocusable() only add conditions to |focusable_|.
+  FocusOrderRange& range = focus_order_ranges_[view];
+  range.begin = static_cast<int>(focus_order_.size());
+  range.traversable_ancestor = traversable_ancestor;
+  bool has_focus_traversable = view->GetFocusTraversable() != NULL;
+  if (view->focusable() || view->accessibility_focusable() ||
+      has_focus_traversable) {
+    focus_order_.push_back(view);
+    traversable_ancestors_.push_back(traversable_ancestor);
+    if (has_focus_traversable && traversable_ancestor == -1)
+      traversable_ancestor = range.begin;
+  }
+
+  // Nothing below a hidden view can be focused. FocusTraversables there are
+  // left out too; the hierarchy walk would enter them only to find nothing
+  // to focus.
+  if (view->IsVisible())
+    AppendChildrenToFocusOrder(view, traversable_ancestor);
+  range.end = static_cast<int>(focus_order_.size());
+}
+
+void FocusSearch::AppendChildrenToFocusOrder(View* parent,
+                                             int traversable_ancestor) {
+  int count = parent->child_count();
+  if (count == 0)
+    return;
+
+  // The forward traversal visits the children from the first one along
+  // GetNextFocusableView(), and the reverse traversal from the last one along
+  // GetPreviousFocusableView(). One list serves both only if they visit the
+  // same children in opposite orders, which is the case unless
+  // SetNextFocusableView() was used to link views of different parents.
+  std::vector<View*> children;
+  bool is_list = true;
+  for (View* v = parent->child_at(0); v && is_list;
+       v = v->GetNextFocusableView()) {
+    is_list = v->parent() == parent &&
+        static_cast<int>(children.size()) < count;
+    children.push_back(v);
+  }
+  size_t remaining = children.size();
+  for (View* v = parent->child_at(count - 1); v && is_list;
+       v = v->GetPreviousFocusableView()) {
+    is_list = remaining > 0 && children[--remaining] == v;
+  }
+  if (!is_list || remaining != 0) {
+    focus_order_usable_ = false;
+    children.clear();
+    for (int i = 0; i < count; ++i)
+      children.push_back(parent->child_at(i));
+  }
+
+  for (std::vector<View*>::const_iterator i = children.begin();
+       i != children.end(); ++i) {
+    AppendToFocusOrder(*i, traversable_ancestor);
+  }
+}
+
+bool FocusSearch::FindInFocusOrder(View* starting_view,
+                                   bool reverse,
+                                   bool check_starting_view,
+                                   bool can_go_down,
+                                   int skip_group_id,
+                                   FocusTraversable** focus_traversable,
+                                   View** focus_traversable_view,
+                                   View** result) {
+  UpdateFocusOrder();
+  if (!focus_order_usable_ || starting_view == root_)
+    return false;
+
+  // Hidden views and the descendants of views with a FocusTraversable are
+  // left to the hierarchy walk: the latter are only reached when the walk
+  // starts from them.
+  FocusOrderRanges::const_iterator i =
+      focus_order_ranges_.find(starting_view);
+  if (i == focus_order_ranges_.end() || !starting_view->IsVisible() ||
+      i->second.traversable_ancestor != -1) {
+    return false;
+  }
+
+  const FocusOrderRange& range = i->second;
+  int size = static_cast<int>(focus_order_.size());
+  bool starting_view_listed =
+      range.begin < size && focus_order_[range.begin] == starting_view;
+  *result = NULL;
+
+  if (!reverse) {
+    // A View comes before its descendants, which come before its next
+    // sibling. Stop at the first view that can be focused or that has a
+    // FocusTraversable; the descendants of the latter are never reached.
+    int index = range.begin;
+    if (starting_view_listed) {
+      if (check_starting_view &&
+          CheckForwardCandidate(starting_view, skip_group_id,
+                                focus_traversable, focus_traversable_view,
+                                result)) {
+        return true;
+      }
+      index++;
+    }
+    if (!can_go_down)
+      index = range.end;
+    for (; index < size; ++index) {
+      if (CheckForwardCandidate(focus_order_[index], skip_group_id,
+                                focus_traversable, focus_traversable_view,
+                                result)) {
+        return true;
+      }
+    }
+    return true;
+  }
+
+  // Going backwards, a View is reached after its descendants, but its
+  // FocusTraversable is checked when entering it, before them.
+  if (can_go_down) {
+    FocusTraversable* traversable = starting_view->GetFocusTraversable();
+    if (traversable) {
+      *focus_traversable = traversable;
+      *focus_traversable_view = starting_view;
+      return true;
+    }
+  }
+  int index = can_go_down ? range.end - 1 :
+      (starting_view_listed ? range.begin : range.begin - 1);
+  for (; index >= 0; --index) {
+    View* v = focus_order_[index];
+    if (v == starting_view) {
+      // Only the view itself, since its FocusTraversable was checked above.
+      if (check_starting_view) {
+        *result = GetFocusableCandidate(v, skip_group_id);
+        if (*result)
+          return true;
+      }
+      continue;
+    }
+
+    // The ancestors of |starting_view| have no FocusTraversable, so any view
+    // with one is entered from its last descendant.
+    View* traversable_view = traversable_ancestors_[index] == -1 ?
+        v : focus_order_[traversable_ancestors_[index]];
+    FocusTraversable* traversable = traversable_view->GetFocusTraversable();
+    if (traversable) {
+      *focus_traversable = traversable;
+      *focus_traversable_view = traversable_view;
+      return true;
+    }
+    *result = GetFocusableCandidate(v, skip_group_id);
+    if (*result)
+      return true;
+  }
+  return true;
+}
+
+bool FocusSearch::CheckForwardCandidate(View* v,
+                                        int skip_group_id,
+                                        FocusTraversable** focus_traversable,
+                                        View** focus_traversable_view,
+                                        View** result) {
+  *result = GetFocusableCandidate(v, skip_group_id);
+  if (*result)
+    return true;
+  FocusTraversable* traversable = v->GetFocusTraversable();
+  if (!traversable)
+    return false;
+  *focus_traversable = traversable;
+  *focus_traversable_view = v;
+  return true;
+}
+
+View* FocusSearch::GetFocusableCandidate(View* v, int skip_group_id) {
+  if (!IsViewFocusableCandidate(v, skip_group_id))
+    return NULL;
+  // The selected view might not be focusable (if it is disabled for
+  // example).
+  View* selected_view = FindSelectedViewForGroup(v);
+  return IsFocusable(selected_view) ? selected_view : NULL;
+}
+
 bool FocusSearch::IsViewFocusableCandidate(View* v, int skip_group_id) {
   return IsFocusable(v) &&
       (v->IsGroupFocusTraversable() || skip_group_id == -1 ||
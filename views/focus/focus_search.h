@@ -6,6 +6,9 @@
 #define VIEWS_WIDGET_FOCUS_SEARCH_H_
 #pragma once
 
+#include <map>
+#include <vector>
+
 #include "views/view.h"
 
 namespace views {
@@ -14,6 +17,12 @@ class FocusTraversable;
 
 // FocusSearch is an object that implements the algorithm to find the
 // next view to focus.
+//
+// To avoid walking the view hierarchy on every Tab press, FocusSearch keeps
+// the views under its root that may take the focus in a flat list in
+// traversal order. The list is rebuilt when the focus_order_version() of the
+// root changes, which only happens for changes under the root, so only
+// whether each view is focusable right now is checked when searching.
 class VIEWS_EXPORT FocusSearch {
  public:
   // The direction in which the focus traversal is going.
@@ -69,7 +78,61 @@ class VIEWS_EXPORT FocusSearch {
                                       FocusTraversable** focus_traversable,
                                       View** focus_traversable_view);
 
+  // Appends the views under the root that can currently be focused to
+  // |views|, in the order Tab visits them. Views inside a FocusTraversable
+  // other than the root are not included.
+  void GetFocusableViews(std::vector<View*>* views);
+
  private:
+  // Where a View is in |focus_order_|.
+  struct FocusOrderRange {
+    // The index of the View in |focus_order_| if it is listed there, and
+    // otherwise of the first listed view after it; and the index after its
+    // last listed descendant.
+    int begin;
+    int end;
+
+    // The index of the outermost ancestor of the View below |root_| that has a
+    // FocusTraversable, or -1 if there is none.
+    int traversable_ancestor;
+  };
+  typedef std::map<View*, FocusOrderRange> FocusOrderRanges;
+
+  // Rebuilds |focus_order_| if a View changed since it was built.
+  void UpdateFocusOrder();
+
+  // Adds |view| and its descendants to |focus_order_|. |traversable_ancestor|
+  // is the index of the outermost ancestor with a FocusTraversable, or -1.
+  void AppendToFocusOrder(View* view, int traversable_ancestor);
+  void AppendChildrenToFocusOrder(View* parent, int traversable_ancestor);
+
+  // Looks for the next (or previous if |reverse|) view using |focus_order_|.
+  // The arguments are those of FindNextFocusableViewImpl(), and |result| is
+  // set to the view found or NULL. Returns false, without changing any of the
+  // out arguments, if |focus_order_| can't be used for |starting_view|, in
+  // which case the view hierarchy has to be walked.
+  bool FindInFocusOrder(View* starting_view,
+                        bool reverse,
+                        bool check_starting_view,
+                        bool can_go_down,
+                        int skip_group_id,
+                        FocusTraversable** focus_traversable,
+                        View** focus_traversable_view,
+                        View** result);
+
+  // Used by FindInFocusOrder() going forward. Returns true, setting |result|
+  // or |focus_traversable| and |focus_traversable_view|, if the search stops
+  // at |v|.
+  bool CheckForwardCandidate(View* v,
+                             int skip_group_id,
+                             FocusTraversable** focus_traversable,
+                             View** focus_traversable_view,
+                             View** result);
+
+  // Returns the view to focus if |v| is a candidate that can be focused (see
+  // IsViewFocusableCandidate() and FindSelectedViewForGroup()), or NULL.
+  View* GetFocusableCandidate(View* v, int skip_group_id);
+
   // Convenience method that returns true if a view is focusable and does not
   // belong to the specified group.
   bool IsViewFocusableCandidate(View* v, int skip_group_id);
@@ -114,6 +177,27 @@ class VIEWS_EXPORT FocusSearch {
   bool cycle_;
   bool accessibility_mode_;
 
+  // The views under |root_| that may be focused or have a FocusTraversable,
+  // in the order of a forward traversal: a View comes before its children,
+  // and children are in the order of their focus siblings. The children of
+  // hidden views are left out since none of them can be focused.
+  std::vector<View*> focus_order_;
+
+  // For each view in |focus_order_|, the index of its outermost ancestor with
+  // a FocusTraversable, or -1.
+  std::vector<int> traversable_ancestors_;
+
+  // The range of each View under |root_|, visible or with a visible parent.
+  FocusOrderRanges focus_order_ranges_;
+
+  // False if the focus siblings of some View's children don't form a single
+  // list over those children, in which case |focus_order_| may not match the
+  // traversal and is only used by GetFocusableViews().
+  bool focus_order_usable_;
+
+  // The focus_order_version() of |root_| when |focus_order_| was built, or -1.
+  int focus_order_version_;
+
   DISALLOW_COPY_AND_ASSIGN(FocusSearch);
 };
 
@@ -332,7 +332,10 @@ struct ViewState {
         pref_height(pref_height),
         remaining_width(0),
         remaining_height(0),
-        baseline(-1) {
+        baseline(-1),
+        measurement_valid(false),
+        height_for_width_width(-1),
+        height_for_width(0) {
     DCHECK(view && start_col >= 0 && start_row >= 0 && col_span > 0 &&
            row_span > 0 && start_col < column_set->num_columns() &&
            (start_col + col_span) <= column_set->num_columns());
@@ -364,6 +367,21 @@ struct ViewState {
   // The baseline. Only used if the view is vertically aligned along the
   // baseline.
   int baseline;
+
+  // The measurements below are kept across layouts until the view's
+  // preferred size may have changed (see ViewPreferredSizeInvalidated()), so
+  // resizing the host doesn't ask the views for their sizes again. Only views
+  // that cache their own preferred size promise to report every change, so
+  // the others are measured on every pass.
+  bool measurement_valid;
+
+  // The preferred size of the view, empty if both dimensions are fixed.
+  gfx::Size measured_size;
+
+  // The last width passed to GetHeightForWidth() and the result, or -1 if
+  // GetHeightForWidth() hasn't been called since the view was measured.
+  int height_for_width_width;
+  int height_for_width;
 };
 
 static bool CompareByColumnSpan(const ViewState* v1, const ViewState* v2) {
@@ -374,9 +392,28 @@ static bool CompareByRowSpan(const ViewState* v1, const ViewState* v2) {
   return v1->row_span < v2->row_span;
 }
 
+// Asks the view of |view_state| for its preferred size and baseline, unless
+// they are already known.
+static void EnsureMeasured(ViewState* view_state) {
+  if (view_state->measurement_valid)
+    return;
+
+  view_state->measurement_valid =
+      view_state->view->preferred_size_caching_enabled();
+  view_state->height_for_width_width = -1;
+  if (!view_state->pref_width_fixed || !view_state->pref_height_fixed)
+    view_state->measured_size = view_state->view->GetPreferredSize();
+  else
+    view_state->measured_size = gfx::Size();
+  if (!view_state->pref_width_fixed)
+    view_state->pref_width = view_state->measured_size.width();
+  view_state->baseline = view_state->v_align == GridLayout::BASELINE ?
+      view_state->view->GetBaseline() : -1;
+}
+
 // ColumnSet -------------------------------------------------------------
 
-ColumnSet::ColumnSet(int id) : id_(id) {
+ColumnSet::ColumnSet(int id) : id_(id), size_valid_(false) {
 }
 
 ColumnSet::~ColumnSet() {
@@ -410,6 +447,7 @@ void ColumnSet::LinkColumnSizes(int first, ...) {
     last = next;
   }
   va_end(marker);
+  size_valid_ = false;
 }
 
 void ColumnSet::AddColumn(GridLayout::Alignment h_align,
@@ -423,6 +461,7 @@ void ColumnSet::AddColumn(GridLayout::Alignment h_align,
                               fixed_width, min_width, columns_.size(),
                               is_padding);
   columns_.push_back(column);
+  size_valid_ = false;
 }
 
 void ColumnSet::AddViewState(ViewState* view_state) {
@@ -432,6 +471,7 @@ void ColumnSet::AddViewState(ViewState* view_state) {
                                                     view_state,
                                                     CompareByColumnSpan);
   view_states_.insert(i, view_state);
+  size_valid_ = false;
 }
 
 void ColumnSet::CalculateMasterColumns() {
@@ -600,20 +640,24 @@ void ColumnSet::ResetColumnXCoordinates() {
 }
 
 void ColumnSet::CalculateSize() {
-  gfx::Size pref;
-  // Reset the preferred and remaining sizes.
+  if (size_valid_) {
+    // None of the views changed since the sizes were last calculated. Resize()
+    // may have changed the columns since then, so restore them.
+    for (size_t i = 0; i < columns_.size(); ++i)
+      columns_[i]->SetSize(column_sizes_[i]);
+    return;
+  }
+
+  // Reset the preferred and remaining sizes. Only the views whose preferred
+  // size changed, or that don't report changes, are asked for it again.
+  bool all_measurements_valid = true;
   for (std::vector<ViewState*>::iterator i = view_states_.begin();
        i != view_states_.end(); ++i) {
     ViewState* view_state = *i;
-    if (!view_state->pref_width_fixed || !view_state->pref_height_fixed) {
-      pref = view_state->view->GetPreferredSize();
-      if (!view_state->pref_width_fixed)
-        view_state->pref_width = pref.width();
-      if (!view_state->pref_height_fixed)
-        view_state->pref_height = pref.height();
-    }
-    view_state->remaining_width = pref.width();
-    view_state->remaining_height = pref.height();
+    EnsureMeasured(view_state);
+    all_measurements_valid &= view_state->measurement_valid;
+    view_state->remaining_width = view_state->measured_size.width();
+    view_state->remaining_height = view_state->measured_size.height();
   }
 
   // Let layout element reset the sizes for us.
@@ -647,6 +691,11 @@ void ColumnSet::CalculateSize() {
     // This may need to be combined with previous step.
     UnifySameSizedColumnSizes();
   }
+
+  column_sizes_.resize(columns_.size());
+  for (size_t i = 0; i < columns_.size(); ++i)
+    column_sizes_[i] = columns_[i]->Size();
+  size_valid_ = all_measurements_valid;
 }
 
 void ColumnSet::Resize(int delta) {
@@ -797,6 +846,15 @@ void GridLayout::ViewRemoved(View* host, View* view) {
   DCHECK(host_ == host);
 }
 
+void GridLayout::ViewPreferredSizeInvalidated(View* host, View* view) {
+  DCHECK(host_ == host);
+  std::map<View*, ViewState*>::iterator i = view_states_by_view_.find(view);
+  if (i != view_states_by_view_.end()) {
+    i->second->measurement_valid = false;
+    i->second->column_set->size_valid_ = false;
+  }
+}
+
 void GridLayout::Layout(View* host) {
   DCHECK(host_ == host);
   // SizeRowsAndColumns sets the size and location of each row/column, but
@@ -876,19 +934,18 @@ void GridLayout::SizeRowsAndColumns(bool layout, int width, int height,
   LayoutElement::ResetSizes(&rows_);
 
   // Do the following:
-  // . If the view is aligned along it's baseline, obtain the baseline from the
-  //   view and update the rows ascent/descent.
-  // . Reset the remaining_height of each view state.
+  // . Reset the pref_height and remaining_height of each view state. The
+  //   baseline of views aligned along their baseline was obtained when they
+  //   were measured.
   // . If the width the view will be given is different than it's pref, ask
   //   for the height given a particularly width.
   for (std::vector<ViewState*>::iterator i= view_states_.begin();
        i != view_states_.end() ; ++i) {
     ViewState* view_state = *i;
+    if (!view_state->pref_height_fixed)
+      view_state->pref_height = view_state->measured_size.height();
     view_state->remaining_height = view_state->pref_height;
 
-    if (view_state->v_align == BASELINE)
-      view_state->baseline = view_state->view->GetBaseline();
-
     if (view_state->h_align == FILL) {
       // The view is resizable. As the pref height may vary with the width,
       // ask for the pref again.
@@ -898,9 +955,14 @@ void GridLayout::SizeRowsAndColumns(bool layout, int width, int height,
       if (actual_width != view_state->pref_width &&
           !view_state->pref_height_fixed) {
         // The width this view will get differs from it's preferred. Some Views
-        // pref height varies with it's width; ask for the preferred again.
-        view_state->pref_height =
-            view_state->view->GetHeightForWidth(actual_width);
+        // pref height varies with it's width; ask for the preferred again,
+        // unless the view was given the same width last time.
+        if (view_state->height_for_width_width != actual_width) {
+          view_state->height_for_width =
+              view_state->view->GetHeightForWidth(actual_width);
+          view_state->height_for_width_width = actual_width;
+        }
+        view_state->pref_height = view_state->height_for_width;
         view_state->remaining_height = view_state->pref_height;
       }
     }
@@ -967,6 +1029,9 @@ void GridLayout::AddViewState(ViewState* view_state) {
     host_->AddChildView(view_state->view);
     adding_view_ = false;
   }
+  DCHECK(view_states_by_view_.find(view_state->view) ==
+         view_states_by_view_.end());
+  view_states_by_view_[view_state->view] = view_state;
   remaining_row_span_ = std::max(remaining_row_span_, view_state->row_span);
   next_column_ += view_state->col_span;
   current_row_col_set_->AddViewState(view_state);
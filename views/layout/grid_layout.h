@@ -6,6 +6,7 @@
 #define VIEWS_LAYOUT_GRID_LAYOUT_H_
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -61,6 +62,12 @@ class Insets;
 //
 // AddView takes care of adding the View to the View the GridLayout was
 // created with.
+//
+// GridLayout remembers the preferred sizes of its views and the column sizes
+// of each ColumnSet between layouts. A view is asked for its preferred size
+// again only after it invalidates it (see View::PreferredSizeChanged()), and
+// only the ColumnSets containing such views are recalculated, so resizing the
+// host is cheap even with many rows.
 namespace views {
 
 class Column;
@@ -174,6 +181,9 @@ class VIEWS_EXPORT GridLayout : public LayoutManager {
   // Notification that a view has been removed.
   virtual void ViewRemoved(View* host, View* view);
 
+  // Drops the remembered measurements of |view|.
+  virtual void ViewPreferredSizeInvalidated(View* host, View* view);
+
   // Layouts out the components.
   virtual void Layout(View* host);
 
@@ -250,6 +260,9 @@ class VIEWS_EXPORT GridLayout : public LayoutManager {
   // ViewStates. This is ordered by row_span in ascending order.
   std::vector<ViewState*> view_states_;
 
+  // The ViewState of each view, for ViewPreferredSizeInvalidated().
+  std::map<View*, ViewState*> view_states_by_view_;
+
   // ColumnSets.
   std::vector<ColumnSet*> column_sets_;
 
@@ -343,7 +356,8 @@ class VIEWS_EXPORT ColumnSet {
   void ResetColumnXCoordinates();
 
   // Calculate the preferred width of each view in this column set, as well
-  // as updating the remaining_width.
+  // as updating the remaining_width. If no view changed since the last call
+  // the column sizes calculated then are reused.
   void CalculateSize();
 
   // Distributes delta amoung the resizable columns.
@@ -363,6 +377,12 @@ class VIEWS_EXPORT ColumnSet {
   // for a description of what the master column is.
   std::vector<Column*> master_columns_;
 
+  // Whether |column_sizes_| holds the current size of each column, before
+  // Resize(). Cleared when a column, link or view is added, or the preferred
+  // size of a view changes.
+  bool size_valid_;
+  std::vector<int> column_sizes_;
+
   DISALLOW_COPY_AND_ASSIGN(ColumnSet);
 };
 
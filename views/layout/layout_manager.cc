@@ -27,4 +27,7 @@ void LayoutManager::ViewAdded(View* host, View* view) {
 void LayoutManager::ViewRemoved(View* host, View* view) {
 }
 
+void LayoutManager::ViewPreferredSizeInvalidated(View* host, View* view) {
+}
+
 }  // namespace views
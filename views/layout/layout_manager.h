@@ -54,6 +54,11 @@ class VIEWS_EXPORT LayoutManager {
 
   // Notification that a view has been removed.
   virtual void ViewRemoved(View* host, View* view);
+
+  // Notification that the preferred size of |view|, a child of |host|, may
+  // have changed. LayoutManagers that remember measurements of the children
+  // of |host| should drop those of |view|.
+  virtual void ViewPreferredSizeInvalidated(View* host, View* view);
 };
 
 }  // namespace views
@@ -0,0 +1,93 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "views/paint_cache.h"
+
+#include "base/logging.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "ui/gfx/canvas_skia.h"
+#include "ui/gfx/size.h"
+#include "views/views_delegate.h"
+
+namespace views {
+
+namespace internal {
+
+// static
+size_t PaintCache::total_bytes_ = 0;
+
+// static
+int PaintCache::replay_count_ = 0;
+
+// static
+int PaintCache::record_count_ = 0;
+
+PaintCache::PaintCache() : bytes_(0), valid_(false) {
+}
+
+PaintCache::~PaintCache() {
+  Invalidate();
+}
+
+void PaintCache::Invalidate() {
+  DCHECK_GE(total_bytes_, bytes_);
+  total_bytes_ -= bytes_;
+  bytes_ = 0;
+  canvas_.reset();
+  valid_ = false;
+}
+
+// static
+bool PaintCache::CanReplayInto(gfx::Canvas* canvas) {
+  gfx::CanvasSkia* skia_canvas = canvas->AsCanvasSkia();
+  if (!skia_canvas)
+    return false;
+
+  // Only integral translations replay pixel-exact.
+  const SkMatrix& matrix = skia_canvas->getTotalMatrix();
+  if (matrix.getType() & ~SkMatrix::kTranslate_Mask)
+    return false;
+  SkScalar tx = matrix.getTranslateX();
+  SkScalar ty = matrix.getTranslateY();
+  return tx == SkIntToScalar(SkScalarRound(tx)) &&
+         ty == SkIntToScalar(SkScalarRound(ty));
+}
+
+gfx::CanvasSkia* PaintCache::BeginRecording(const gfx::Size& size) {
+  Invalidate();
+  if (size.IsEmpty())
+    return NULL;
+
+  size_t bytes = static_cast<size_t>(size.width()) * size.height() * 4;
+  if (total_bytes_ + bytes > GetMemoryLimit())
+    return NULL;
+
+  canvas_.reset(new gfx::CanvasSkia(size.width(), size.height(), true));
+  bytes_ = bytes;
+  total_bytes_ += bytes_;
+  return canvas_.get();
+}
+
+void PaintCache::EndRecording() {
+  DCHECK(canvas_.get());
+  valid_ = true;
+  ++record_count_;
+}
+
+void PaintCache::Replay(gfx::Canvas* canvas) const {
+  DCHECK(valid_);
+  canvas->DrawBitmapInt(canvas_->getDevice()->accessBitmap(false), 0, 0);
+  ++replay_count_;
+}
+
+// static
+size_t PaintCache::GetMemoryLimit() {
+  if (ViewsDelegate::views_delegate)
+    return ViewsDelegate::views_delegate->GetPaintCacheMemoryLimit();
+  return ViewsDelegate::kDefaultPaintCacheMemoryLimit;
+}
+
+}  // namespace internal
+
+}  // namespace views
@@ -0,0 +1,87 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef VIEWS_PAINT_CACHE_H_
+#define VIEWS_PAINT_CACHE_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+
+namespace gfx {
+class Canvas;
+class CanvasSkia;
+class Size;
+}
+
+namespace views {
+
+// This is a views-internal API and should not be used externally. View uses
+// this class to hold the result of its last OnPaint() so that repaints that do
+// not invalidate the view itself can be satisfied by replaying the cached
+// result rather than running the view's paint code again.
+namespace internal {
+
+class PaintCache {
+ public:
+  PaintCache();
+  ~PaintCache();
+
+  // Returns true if the cache holds the output of the last OnPaint().
+  bool is_valid() const { return valid_; }
+
+  // Discards the cached contents, releasing the memory held by them.
+  void Invalidate();
+
+  // Returns true if |canvas| can be painted from a cache recorded in the
+  // view's local coordinate space. Caching is skipped for canvases that are
+  // scaled, rotated or not backed by Skia, as replaying at a different scale
+  // would not match what OnPaint() produces.
+  static bool CanReplayInto(gfx::Canvas* canvas);
+
+  // Returns an opaque offscreen canvas of |size| for the view to paint into,
+  // or NULL if caching |size| would exceed the memory limit returned by the
+  // ViewsDelegate. The view must paint every pixel of the canvas. The cache
+  // becomes valid once the returned canvas has been painted and EndRecording()
+  // is invoked.
+  gfx::CanvasSkia* BeginRecording(const gfx::Size& size);
+  void EndRecording();
+
+  // Draws the cached contents at the origin of |canvas|. The cache must be
+  // valid.
+  void Replay(gfx::Canvas* canvas) const;
+
+  // Returns the number of bytes currently held by all valid caches.
+  static size_t total_bytes() { return total_bytes_; }
+
+  // Returns the number of Replay() and Record() calls since startup.
+  static int replay_count() { return replay_count_; }
+  static int record_count() { return record_count_; }
+
+ private:
+  // Returns the limit for |total_bytes_|. Recording is refused if it would
+  // push the total above this value.
+  static size_t GetMemoryLimit();
+
+  // The canvas OnPaint() was recorded into. On Windows this is backed by a
+  // DIB section, so every valid cache holds a GDI handle.
+  scoped_ptr<gfx::CanvasSkia> canvas_;
+
+  // Number of bytes held by |canvas_|, included in |total_bytes_|.
+  size_t bytes_;
+
+  bool valid_;
+
+  static size_t total_bytes_;
+  static int replay_count_;
+  static int record_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(PaintCache);
+};
+
+}  // namespace internal
+
+}  // namespace views
+
+#endif  // VIEWS_PAINT_CACHE_H_
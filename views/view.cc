@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "base/auto_reset.h"
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -23,10 +24,12 @@
 #include "ui/gfx/point3.h"
 #include "ui/gfx/transform.h"
 #include "views/background.h"
+#include "views/child_bounds_index.h"
 #include "views/context_menu_controller.h"
 #include "views/drag_controller.h"
 #include "views/layer_property_setter.h"
 #include "views/layout/layout_manager.h"
+#include "views/paint_cache.h"
 #include "views/views_delegate.h"
 #include "views/widget/native_widget_private.h"
 #include "views/widget/native_widget_views.h"
@@ -52,6 +55,9 @@ bool use_acceleration_when_possible = true;
 bool use_acceleration_when_possible = false;
 #endif
 
+// Number of times View::Layout() has run.
+int layout_count = 0;
+
 // Saves the drawing state, and restores the state when going out of scope.
 class ScopedCanvas {
  public:
@@ -112,6 +118,10 @@ View::View()
       clip_x_(0.0),
       clip_y_(0.0),
       needs_layout_(true),
+      defer_layout_on_resize_(false),
+      preferred_size_valid_(false),
+      preferred_size_caching_enabled_(false),
+      scheduling_paint_for_child_(false),
       flip_canvas_on_paint_for_rtl_ui_(false),
       accelerator_registration_delayed_(false),
       accelerator_focus_manager_(NULL),
@@ -120,6 +130,7 @@ View::View()
       previous_focusable_view_(NULL),
       focusable_(false),
       accessibility_focusable_(false),
+      focus_order_version_(0),
       context_menu_controller_(NULL),
       drag_controller_(NULL) {
 }
@@ -165,10 +176,13 @@ void View::AddChildViewAt(View* view, int index) {
 
   // Sets the prev/next focus views.
   InitFocusSiblings(view, index);
+  FocusOrderChanged();
 
   // Let's insert the view.
   view->parent_ = this;
   children_.insert(children_.begin() + index, view);
+  InvalidateChildBoundsIndex();
+  InvalidatePreferredSize();
 
   if (GetWidget()) {
     // Sending out notification of insert may result in adding other views.
@@ -214,6 +228,8 @@ void View::ReorderChildView(View* view, int index) {
   // Add it in the specified index now.
   InitFocusSiblings(view, index);
   children_.insert(children_.begin() + index, view);
+  InvalidateChildBoundsIndex();
+  FocusOrderChanged();
 }
 
 void View::RemoveChildView(View* view) {
@@ -264,6 +280,8 @@ void View::SetBoundsRect(const gfx::Rect& bounds) {
 
   gfx::Rect prev = bounds_;
   bounds_ = bounds;
+  if (parent_)
+    parent_->InvalidateChildBoundsIndex();
   BoundsChanged(prev);
 }
 
@@ -343,9 +361,22 @@ gfx::Rect View::GetScreenBounds() const {
 }
 
 gfx::Size View::GetPreferredSize() {
-  if (layout_manager_.get())
+  if (!layout_manager_.get())
+    return gfx::Size();
+
+  if (!preferred_size_caching_enabled_)
     return layout_manager_->GetPreferredSize(this);
-  return gfx::Size();
+
+  if (!preferred_size_valid_) {
+    preferred_size_ = layout_manager_->GetPreferredSize(this);
+    preferred_size_valid_ = true;
+  }
+  return preferred_size_;
+}
+
+void View::SetPreferredSizeCachingEnabled(bool enabled) {
+  preferred_size_caching_enabled_ = enabled;
+  preferred_size_valid_ = false;
 }
 
 int View::GetBaseline() const {
@@ -375,6 +406,9 @@ void View::SetVisible(bool visible) {
       SchedulePaint();
 
     visible_ = visible;
+    FocusOrderChanged();
+    if (parent_)
+      InvalidatePreferredSize();
 
     if (visible_)
       CreateLayerIfNecessary();
@@ -402,6 +436,8 @@ bool View::IsVisibleInRootView() const {
 void View::SetEnabled(bool enabled) {
   if (enabled != enabled_) {
     enabled_ = enabled;
+    InvalidatePaintCache();
+    FocusOrderChanged();
     OnEnabledChanged();
   }
 }
@@ -422,6 +458,9 @@ const ui::Transform& View::GetTransform() const {
 }
 
 void View::SetTransform(const ui::Transform& transform) {
+  if (parent_)
+    parent_->InvalidateChildBoundsIndex();
+
   if (!transform.HasChange()) {
     if (!layer_helper_.get() || !this->transform())
       return;
@@ -517,6 +556,7 @@ int View::GetMirroredXWithWidthInView(int x, int w) const {
 
 void View::Layout() {
   needs_layout_ = false;
+  ++layout_count;
 
   // If we have a layout manager, let it handle the layout for us.
   if (layout_manager_.get())
@@ -541,8 +581,25 @@ void View::InvalidateLayout() {
   // Always invalidate up. This is needed to handle the case of us already being
   // valid, but not our parent.
   needs_layout_ = true;
-  if (parent_)
+  preferred_size_valid_ = false;
+  if (parent_) {
+    if (parent_->layout_manager_.get())
+      parent_->layout_manager_->ViewPreferredSizeInvalidated(parent_, this);
     parent_->InvalidateLayout();
+  }
+}
+
+void View::ScheduleLayout() {
+  InvalidateLayout();
+  // Views outside a Widget are laid out when they are added and sized.
+  Widget* widget = GetWidget();
+  if (widget)
+    widget->ScheduleLayout();
+}
+
+// static
+int View::GetLayoutCount() {
+  return layout_count;
 }
 
 LayoutManager* View::GetLayoutManager() const {
@@ -556,6 +613,7 @@ void View::SetLayoutManager(LayoutManager* layout_manager) {
   layout_manager_.reset(layout_manager);
   if (layout_manager_.get())
     layout_manager_->Installed(this);
+  InvalidatePreferredSize();
 }
 
 // Attributes ------------------------------------------------------------------
@@ -677,6 +735,11 @@ void View::SchedulePaint() {
 }
 
 void View::SchedulePaintInRect(const gfx::Rect& rect) {
+  // Invalidate even when the paint itself is dropped so that a stale cache is
+  // not replayed once this View becomes paintable again.
+  if (!scheduling_paint_for_child_)
+    InvalidatePaintCache();
+
   if (!IsVisible() || !painting_enabled_)
     return;
 
@@ -685,6 +748,7 @@ void View::SchedulePaintInRect(const gfx::Rect& rect) {
   } else if (parent_) {
     // Translate the requested paint rect to the parent's coordinate system
     // then pass this notification up to the parent.
+    AutoReset<bool> for_child(&parent_->scheduling_paint_for_child_, true);
     parent_->SchedulePaintInRect(ConvertRectToParent(rect));
   }
 }
@@ -716,6 +780,18 @@ void View::Paint(gfx::Canvas* canvas) {
   PaintCommon(canvas);
 }
 
+void View::SetPaintCachingEnabled(bool enabled) {
+  if (enabled == paint_caching_enabled())
+    return;
+
+  paint_cache_.reset(enabled ? new internal::PaintCache() : NULL);
+}
+
+// static
+size_t View::GetPaintCacheMemoryUsage() {
+  return internal::PaintCache::total_bytes();
+}
+
 ThemeProvider* View::GetThemeProvider() const {
   const Widget* widget = GetWidget();
   return widget ? widget->GetThemeProvider() : NULL;
@@ -736,6 +812,25 @@ bool View::get_use_acceleration_when_possible() {
 // Input -----------------------------------------------------------------------
 
 View* View::GetEventHandlerForPoint(const gfx::Point& point) {
+  if (child_bounds_index_.get()) {
+    // Only the children whose bounds span the point can contain it.
+    std::vector<int> candidates;
+    child_bounds_index_->GetChildrenInVerticalSpan(point.y(), point.y() + 1,
+                                                   &candidates);
+    for (std::vector<int>::reverse_iterator i = candidates.rbegin();
+         i != candidates.rend(); ++i) {
+      View* child = child_at(*i);
+      if (!child->IsVisible())
+        continue;
+
+      gfx::Point point_in_child_coords(point);
+      View::ConvertPointToView(this, child, &point_in_child_coords);
+      if (child->HitTest(point_in_child_coords))
+        return child->GetEventHandlerForPoint(point_in_child_coords);
+    }
+    return this;
+  }
+
   // Walk the child Views recursively looking for the View that most
   // tightly encloses the specified point.
   for (int i = child_count() - 1; i >= 0; --i) {
@@ -751,6 +846,14 @@ View* View::GetEventHandlerForPoint(const gfx::Point& point) {
   return this;
 }
 
+void View::SetChildBoundsIndexEnabled(bool enabled) {
+  if (enabled == child_bounds_index_enabled())
+    return;
+
+  child_bounds_index_.reset(
+      enabled ? new internal::ChildBoundsIndex(this) : NULL);
+}
+
 gfx::NativeCursor View::GetCursor(const MouseEvent& event) {
 #if defined(OS_WIN)
   static HCURSOR arrow = LoadCursor(NULL, IDC_ARROW);
@@ -910,6 +1013,8 @@ View* View::GetPreviousFocusableView() {
 void View::SetNextFocusableView(View* view) {
   view->previous_focusable_view_ = this;
   next_focusable_view_ = view;
+  FocusOrderChanged();
+  view->FocusOrderChanged();
 }
 
 bool View::IsFocusableInRootView() const {
@@ -1075,6 +1180,21 @@ void View::NativeViewHierarchyChanged(bool attached,
 // Painting --------------------------------------------------------------------
 
 void View::PaintChildren(gfx::Canvas* canvas) {
+  SkRect clip;
+  if (child_bounds_index_.get() && canvas->AsCanvasSkia()) {
+    // Skip the children that lie entirely outside the dirty region.
+    if (!canvas->AsCanvasSkia()->getClipBounds(&clip))
+      return;
+    std::vector<int> candidates;
+    child_bounds_index_->GetChildrenInVerticalSpan(
+        SkScalarFloor(clip.fTop), SkScalarCeil(clip.fBottom), &candidates);
+    for (std::vector<int>::const_iterator i = candidates.begin();
+         i != candidates.end(); ++i) {
+      child_at(*i)->Paint(canvas);
+    }
+    return;
+  }
+
   for (int i = 0, count = child_count(); i < count; ++i)
     child_at(i)->Paint(canvas);
 }
@@ -1456,12 +1576,48 @@ void View::PaintCommon(gfx::Canvas* canvas) {
       canvas->ScaleInt(-1, 1);
     }
 
-    OnPaint(canvas);
+    PaintSelf(canvas);
   }
 
   PaintChildren(canvas);
 }
 
+void View::PaintSelf(gfx::Canvas* canvas) {
+  // The cache is recorded on its own, not on top of what is already in
+  // |canvas|, so it only replays correctly if OnPaint() covers every pixel.
+  // GDI text in particular leaves the pixels it touches opaque, and computes
+  // ClearType against whatever it is drawn over.
+  bool fills_bounds_opaquely =
+      layer_helper_.get() && layer_helper_->fills_bounds_opaquely();
+  if (!paint_cache_.get() || !fills_bounds_opaquely ||
+      !internal::PaintCache::CanReplayInto(canvas)) {
+    OnPaint(canvas);
+    return;
+  }
+
+  if (!paint_cache_->is_valid()) {
+    gfx::CanvasSkia* recording_canvas = paint_cache_->BeginRecording(size());
+    if (!recording_canvas) {
+      // Over the memory limit; paint directly.
+      OnPaint(canvas);
+      return;
+    }
+    OnPaint(recording_canvas);
+    paint_cache_->EndRecording();
+  }
+  paint_cache_->Replay(canvas);
+}
+
+void View::InvalidatePaintCache() {
+  if (paint_cache_.get())
+    paint_cache_->Invalidate();
+}
+
+void View::InvalidateChildBoundsIndex() {
+  if (child_bounds_index_.get())
+    child_bounds_index_->Invalidate();
+}
+
 // Tree operations -------------------------------------------------------------
 
 void View::DoRemoveChildView(View* view,
@@ -1492,6 +1648,9 @@ void View::DoRemoveChildView(View* view,
       view_to_be_deleted.reset(view);
 
     children_.erase(i);
+    InvalidateChildBoundsIndex();
+    InvalidatePreferredSize();
+    FocusOrderChanged();
   }
 
   if (update_tool_tip)
@@ -1606,8 +1765,13 @@ void View::BoundsChanged(const gfx::Rect& previous_bounds) {
   OnBoundsChanged(previous_bounds);
 
   if (previous_bounds.size() != size()) {
-    needs_layout_ = false;
-    Layout();
+    InvalidatePaintCache();
+    if (defer_layout_on_resize_) {
+      needs_layout_ = true;
+    } else {
+      needs_layout_ = false;
+      Layout();
+    }
   }
 
   if (NeedsNotificationWhenVisibleBoundsChange()) {
@@ -1624,6 +1788,36 @@ void View::BoundsChanged(const gfx::Rect& previous_bounds) {
   }
 }
 
+void View::SetBoundsRectForAnimation(const gfx::Rect& bounds) {
+  // SetBoundsRect() lays out a View needing layout even when the bounds are
+  // unchanged; that has to wait for the end of the animation too.
+  if (bounds == bounds_)
+    return;
+
+  // Restores the previous value, so a PaintLock held on this View stays in
+  // effect.
+  AutoReset<bool> painting(&painting_enabled_, false);
+  AutoReset<bool> defer_layout(&defer_layout_on_resize_, true);
+  SetBoundsRect(bounds);
+}
+
+void View::InvalidatePreferredSize() {
+  // A LayoutManager may skip some children, so an ancestor can hold a valid
+  // size while this View's is invalid. Walk the whole chain.
+  for (View* v = this; v; v = v->parent_) {
+    v->preferred_size_valid_ = false;
+    if (v->parent_ && v->parent_->layout_manager_.get())
+      v->parent_->layout_manager_->ViewPreferredSizeInvalidated(v->parent_, v);
+  }
+}
+
+void View::FocusOrderChanged() {
+  // The change only affects the focus order under this View's ancestors, so
+  // a change in one Widget doesn't invalidate the focus order of the others.
+  for (View* v = this; v; v = v->parent_)
+    ++v->focus_order_version_;
+}
+
 // static
 void View::RegisterChildrenForVisibleBoundsNotification(View* view) {
   if (view->NeedsNotificationWhenVisibleBoundsChange())
@@ -2002,12 +2196,14 @@ void View::InitFocusSiblings(View* v, int index) {
 void View::PropagateThemeChanged() {
   for (int i = child_count() - 1; i >= 0; --i)
     child_at(i)->PropagateThemeChanged();
+  InvalidatePaintCache();
   OnThemeChanged();
 }
 
 void View::PropagateLocaleChanged() {
   for (int i = child_count() - 1; i >= 0; --i)
     child_at(i)->PropagateLocaleChanged();
+  InvalidatePaintCache();
   OnLocaleChanged();
 }
 
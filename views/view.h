@@ -63,7 +63,9 @@ class TextInputClient;
 class Widget;
 
 namespace internal {
+class ChildBoundsIndex;
 class NativeWidgetView;
+class PaintCache;
 class RootView;
 }
 
@@ -222,8 +224,23 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   virtual int GetBaseline() const;
 
   // Get the size the View would like to be, if enough space were available.
+  // View's implementation asks the LayoutManager. If preferred size caching
+  // is enabled the result is remembered; see
+  // SetPreferredSizeCachingEnabled().
   virtual gfx::Size GetPreferredSize();
 
+  // Enables remembering the LayoutManager's preferred size until
+  // InvalidateLayout() is invoked on this View or a descendant, or the
+  // children, visibility of a child, border or LayoutManager change. Only
+  // enable this for Views whose descendants all invoke PreferredSizeChanged()
+  // (or InvalidateLayout()) whenever their preferred size changes; a
+  // descendant whose size depends on other state, such as a Label's focus
+  // border insets, would otherwise leave a stale size behind. Off by default.
+  void SetPreferredSizeCachingEnabled(bool enabled);
+  bool preferred_size_caching_enabled() const {
+    return preferred_size_caching_enabled_;
+  }
+
   // Convenience method that sizes this view to its preferred size.
   void SizeToPreferredSize();
 
@@ -258,7 +275,7 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // This indicates that the view completely fills its bounds in an opaque
   // color.
   // This doesn't affect compositing but is a hint to the compositor to optimize
-  // painting.
+  // painting. It is also required for SetPaintCachingEnabled() to take effect.
   void SetFillsBoundsOpaquely(bool fills_bounds_opaquely);
 
   // Transformations -----------------------------------------------------------
@@ -355,6 +372,15 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // parent views do not change.
   void InvalidateLayout();
 
+  // Invalidates the layout of this view and asks the Widget to lay out the
+  // hierarchy before the next paint. Use this rather than calling Layout()
+  // after each of a series of mutations; all of them are then handled by a
+  // single top-down pass (see Widget::ScheduleLayout()).
+  void ScheduleLayout();
+
+  // Returns the number of times View::Layout() has run, across all Views.
+  static int GetLayoutCount();
+
   // Gets/Sets the Layout Manager used by this view to size and place its
   // children.
   // The LayoutManager is owned by the View and is deleted when the view is
@@ -465,13 +491,42 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // the hierarchy beneath it.
   virtual void Paint(gfx::Canvas* canvas);
 
+  // Enables or disables caching of the output of OnPaint(). While the cache is
+  // valid, paints that reach this View replay the cached result instead of
+  // invoking OnPaint(); children are painted as usual and are not part of the
+  // cache. The cache is discarded by SchedulePaint()/SchedulePaintInRect() on
+  // this View (but not on its children), size changes and background, border,
+  // enabled, theme and locale changes. Only enable this for Views whose
+  // OnPaint() schedules a paint whenever its output would change.
+  //
+  // The cache is only used by Views that have called
+  // SetFillsBoundsOpaquely(true): it is recorded without the pixels beneath
+  // the View, so anything OnPaint() leaves uncovered would replay black.
+  // Caching is also bypassed when the canvas is scaled or rotated, and is
+  // limited in total by ViewsDelegate::GetPaintCacheMemoryLimit(). On Windows
+  // each cache holds a GDI DIB section, which counts against the per-process
+  // GDI handle limit; enable caching for a handful of expensive Views, not for
+  // every row of a list.
+  void SetPaintCachingEnabled(bool enabled);
+  bool paint_caching_enabled() const { return paint_cache_.get() != NULL; }
+
+  // Returns the number of bytes held by the paint caches of all Views.
+  static size_t GetPaintCacheMemoryUsage();
+
   // The background object is owned by this object and may be NULL.
-  void set_background(Background* b) { background_.reset(b); }
+  void set_background(Background* b) {
+    background_.reset(b);
+    InvalidatePaintCache();
+  }
   const Background* background() const { return background_.get(); }
   Background* background() { return background_.get(); }
 
   // The border object is owned by this object and may be NULL.
-  void set_border(Border* b) { border_.reset(b); }
+  void set_border(Border* b) {
+    border_.reset(b);
+    InvalidatePaintCache();
+    InvalidatePreferredSize();
+  }
   const Border* border() const { return border_.get(); }
   Border* border() { return border_.get(); }
 
@@ -519,6 +574,15 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // Returns the deepest visible descendant that contains the specified point.
   virtual View* GetEventHandlerForPoint(const gfx::Point& point);
 
+  // Enables or disables an index of the children by their bounds. When
+  // enabled, GetEventHandlerForPoint() and PaintChildren() only visit the
+  // children whose bounds intersect the point or the canvas clip, rather than
+  // every child. Worthwhile for Views with many children, such as list panes.
+  void SetChildBoundsIndexEnabled(bool enabled);
+  bool child_bounds_index_enabled() const {
+    return child_bounds_index_.get() != NULL;
+  }
+
   // Return the cursor that should be used for this view or the default cursor.
   // The event location is in the receiver's coordinate system. The caller is
   // responsible for managing the lifetime of the returned object, though that
@@ -674,7 +738,11 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // Sets whether this view can accept the focus.
   // Note that this is false by default so that a view used as a container does
   // not get the focus.
-  void set_focusable(bool focusable) { focusable_ = focusable; }
+  void set_focusable(bool focusable) {
+    focusable_ = focusable;
+    FocusOrderChanged();
+  }
+  bool focusable() const { return focusable_; }
 
   // Returns true if the view is focusable (IsFocusable) and visible in the root
   // view. See also IsFocusable.
@@ -689,7 +757,16 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // Note that this is false by default.
   void set_accessibility_focusable(bool accessibility_focusable) {
     accessibility_focusable_ = accessibility_focusable;
+    FocusOrderChanged();
   }
+  bool accessibility_focusable() const { return accessibility_focusable_; }
+
+  // Returns a number that changes whenever the focus order of this View or a
+  // descendant may have changed: a child was added, removed or reordered, the
+  // focus siblings were changed, or a View's visibility, enabled state or
+  // focusability changed. FocusSearch rebuilds its cached focus order when the
+  // version of its root changes.
+  int focus_order_version() const { return focus_order_version_; }
 
   // Convenience method to retrieve the FocusManager associated with the
   // Widget that contains this view.  This can return NULL if this view is not
@@ -1101,6 +1178,7 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   friend class ViewStorage;
   friend class Widget;
   friend class PaintLock;
+  friend class BoundsAnimator;
 
   // Used to track a drag. RootView passes this into
   // ProcessMousePressed/Dragged.
@@ -1139,6 +1217,16 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // invoke OnPaint() on the View.
   void PaintCommon(gfx::Canvas* canvas);
 
+  // Invokes OnPaint(), going through the paint cache if it is enabled.
+  void PaintSelf(gfx::Canvas* canvas);
+
+  // Discards the cached OnPaint() output, if any.
+  void InvalidatePaintCache();
+
+  // Marks the child bounds index, if any, as needing a rebuild. Invoked when a
+  // child is added, removed, reordered, moved, resized or transformed.
+  void InvalidateChildBoundsIndex();
+
   // Tree operations -----------------------------------------------------------
 
   // Removes |view| from the hierarchy tree.  If |update_focus_cycle| is true,
@@ -1183,6 +1271,13 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // views.
   void BoundsChanged(const gfx::Rect& previous_bounds);
 
+  // Used by BoundsAnimator for the intermediate frames of a batched animation.
+  // Like SetBoundsRect(), but schedules no paints for this View or its
+  // descendants (the caller repaints the affected area of the parent) and, if
+  // the size changes, defers the layout until the bounds are next set with
+  // SetBoundsRect() or the parent lays out.
+  void SetBoundsRectForAnimation(const gfx::Rect& bounds);
+
   // Visible bounds notification registration.
   // When a view is added to a hierarchy, it and all its children are asked if
   // they need to be registered for "visible bounds within root" notifications
@@ -1193,6 +1288,13 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   void RegisterForVisibleBoundsNotification();
   void UnregisterForVisibleBoundsNotification();
 
+  // Discards the remembered preferred size of this View and its ancestors,
+  // telling each parent's LayoutManager.
+  void InvalidatePreferredSize();
+
+  // Changes the focus_order_version() of this View and its ancestors.
+  void FocusOrderChanged();
+
   // Adds/removes view to the list of descendants that are notified any time
   // this views location and possibly size are changed.
   void AddDescendantToNotify(View* view);
@@ -1338,6 +1440,9 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // This view's children.
   Views children_;
 
+  // Index of |children_| by bounds. NULL unless enabled.
+  scoped_ptr<internal::ChildBoundsIndex> child_bounds_index_;
+
   // Size and disposition ------------------------------------------------------
 
   // This View's bounds in the parent coordinate system.
@@ -1371,6 +1476,17 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // Whether the view needs to be laid out.
   bool needs_layout_;
 
+  // True while SetBoundsRectForAnimation() runs: a size change marks the view
+  // as needing layout instead of laying it out.
+  bool defer_layout_on_resize_;
+
+  // The preferred size last returned by the LayoutManager, valid if
+  // |preferred_size_valid_| is true. Only used if
+  // |preferred_size_caching_enabled_| is true.
+  gfx::Size preferred_size_;
+  bool preferred_size_valid_;
+  bool preferred_size_caching_enabled_;
+
   // The View's LayoutManager defines the sizing heuristics applied to child
   // Views. The default is absolute positioning according to bounds_.
   scoped_ptr<LayoutManager> layout_manager_;
@@ -1383,6 +1499,13 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // Border.
   scoped_ptr<Border> border_;
 
+  // Cached output of OnPaint(). NULL unless paint caching is enabled.
+  scoped_ptr<internal::PaintCache> paint_cache_;
+
+  // True while a child is propagating SchedulePaintInRect() through this
+  // View. Such paints leave this View's own paint cache intact.
+  bool scheduling_paint_for_child_;
+
   // RTL painting --------------------------------------------------------------
 
   // Indicates whether or not the gfx::Canvas object passed to View::Paint()
@@ -1424,6 +1547,9 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // even though it may not be normally focusable.
   bool accessibility_focusable_;
 
+  // See focus_order_version().
+  int focus_order_version_;
+
   // Context menus -------------------------------------------------------------
 
   // The menu controller.
@@ -36,6 +36,9 @@ class Widget;
 // implementation.
 class VIEWS_EXPORT ViewsDelegate {
  public:
+  // Paint cache limit used when no ViewsDelegate has been installed.
+  static const size_t kDefaultPaintCacheMemoryLimit = 32 * 1024 * 1024;
+
   virtual ~ViewsDelegate() {}
 
   // Gets the clipboard.
@@ -86,6 +89,13 @@ class VIEWS_EXPORT ViewsDelegate {
   // Converts views::Event::flags to a WindowOpenDisposition.
   virtual int GetDispositionForEvent(int event_flags) = 0;
 
+  // Returns the maximum number of bytes Views with paint caching enabled (see
+  // View::SetPaintCachingEnabled()) may hold in total. Returning 0 turns paint
+  // caching off; Views then always invoke OnPaint().
+  virtual size_t GetPaintCacheMemoryLimit() const {
+    return kDefaultPaintCacheMemoryLimit;
+  }
+
   // The active ViewsDelegate used by the views system.
   static ViewsDelegate* views_delegate;
 };
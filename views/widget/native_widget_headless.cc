@@ -0,0 +1,456 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "views/widget/native_widget_headless.h"
+
+#include "base/logging.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/canvas_skia.h"
+#include "views/events/event.h"
+#include "views/focus/focus_manager.h"
+#include "views/ime/mock_input_method.h"
+#include "views/widget/native_widget_delegate.h"
+
+namespace views {
+
+////////////////////////////////////////////////////////////////////////////////
+// NativeWidgetHeadless, public:
+
+NativeWidgetHeadless::NativeWidgetHeadless(
+    internal::NativeWidgetDelegate* delegate)
+    : delegate_(delegate),
+      visible_(false),
+      active_(false),
+      has_mouse_capture_(false),
+      window_state_(ui::SHOW_STATE_DEFAULT),
+      destroyed_(false),
+      ALLOW_THIS_IN_INITIALIZER_LIST(close_widget_factory_(this)),
+      ownership_(Widget::InitParams::NATIVE_WIDGET_OWNS_WIDGET) {
+}
+
+NativeWidgetHeadless::~NativeWidgetHeadless() {
+  if (!destroyed_) {
+    destroyed_ = true;
+    delegate_->OnNativeWidgetDestroying();
+    delegate_->OnNativeWidgetDestroyed();
+  }
+  if (ownership_ == Widget::InitParams::NATIVE_WIDGET_OWNS_WIDGET)
+    delete delegate_;
+}
+
+bool NativeWidgetHeadless::Paint() {
+  // Layout first: it may schedule more paints.
+  GetWidget()->LayoutIfNeeded();
+  if (!canvas_.get() || invalid_rect_.IsEmpty())
+    return false;
+
+  gfx::Rect paint_rect = invalid_rect_;
+  invalid_rect_ = gfx::Rect();
+  canvas_->Save();
+  canvas_->ClipRectInt(paint_rect.x(), paint_rect.y(), paint_rect.width(),
+                       paint_rect.height());
+  delegate_->OnNativeWidgetPaint(canvas_.get());
+  canvas_->Restore();
+  return true;
+}
+
+void NativeWidgetHeadless::PaintAll() {
+  SchedulePaintInRect(gfx::Rect(bounds_.size()));
+  Paint();
+}
+
+SkBitmap NativeWidgetHeadless::GetBitmap() const {
+  return canvas_.get() ? canvas_->ExtractBitmap() : SkBitmap();
+}
+
+bool NativeWidgetHeadless::DispatchMouseEvent(const MouseEvent& event) {
+  return delegate_->OnMouseEvent(event);
+}
+
+bool NativeWidgetHeadless::DispatchKeyEvent(const KeyEvent& event) {
+  InputMethod* input_method = GetWidget()->GetInputMethod();
+  DCHECK(input_method);
+  input_method->DispatchKeyEvent(event);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NativeWidgetHeadless, NativeWidget implementation:
+
+void NativeWidgetHeadless::InitNativeWidget(const Widget::InitParams& params) {
+  ownership_ = params.ownership;
+  bounds_ = params.bounds;
+  ResizeCanvas();
+  delegate_->OnNativeWidgetCreated();
+  delegate_->OnNativeWidgetSizeChanged(bounds_.size());
+}
+
+NonClientFrameView* NativeWidgetHeadless::CreateNonClientFrameView() {
+  return NULL;
+}
+
+void NativeWidgetHeadless::UpdateFrameAfterFrameChange() {
+}
+
+bool NativeWidgetHeadless::ShouldUseNativeFrame() const {
+  return false;
+}
+
+void NativeWidgetHeadless::FrameTypeChanged() {
+}
+
+Widget* NativeWidgetHeadless::GetWidget() {
+  return delegate_->AsWidget();
+}
+
+const Widget* NativeWidgetHeadless::GetWidget() const {
+  return delegate_->AsWidget();
+}
+
+gfx::NativeView NativeWidgetHeadless::GetNativeView() const {
+  return NULL;
+}
+
+gfx::NativeWindow NativeWidgetHeadless::GetNativeWindow() const {
+  return NULL;
+}
+
+Widget* NativeWidgetHeadless::GetTopLevelWidget() {
+  return GetWidget();
+}
+
+const ui::Compositor* NativeWidgetHeadless::GetCompositor() const {
+  return NULL;
+}
+
+ui::Compositor* NativeWidgetHeadless::GetCompositor() {
+  return NULL;
+}
+
+void NativeWidgetHeadless::CalculateOffsetToAncestorWithLayer(
+    gfx::Point* offset,
+    ui::Layer** layer_parent) {
+}
+
+void NativeWidgetHeadless::ViewRemoved(View* view) {
+}
+
+void NativeWidgetHeadless::SetNativeWindowProperty(const char* name,
+                                                   void* value) {
+  if (value)
+    window_properties_[name] = value;
+  else
+    window_properties_.erase(name);
+}
+
+void* NativeWidgetHeadless::GetNativeWindowProperty(const char* name) const {
+  std::map<const char*, void*>::const_iterator iter =
+      window_properties_.find(name);
+  return iter != window_properties_.end() ? iter->second : NULL;
+}
+
+TooltipManager* NativeWidgetHeadless::GetTooltipManager() const {
+  return NULL;
+}
+
+bool NativeWidgetHeadless::IsScreenReaderActive() const {
+  return false;
+}
+
+void NativeWidgetHeadless::SendNativeAccessibilityEvent(
+    View* view,
+    ui::AccessibilityTypes::Event event_type) {
+}
+
+void NativeWidgetHeadless::SetMouseCapture() {
+  has_mouse_capture_ = true;
+}
+
+void NativeWidgetHeadless::ReleaseMouseCapture() {
+  has_mouse_capture_ = false;
+}
+
+bool NativeWidgetHeadless::HasMouseCapture() const {
+  return has_mouse_capture_;
+}
+
+InputMethod* NativeWidgetHeadless::CreateInputMethod() {
+  InputMethod* input_method = new MockInputMethod(this);
+  input_method->Init(GetWidget());
+  return input_method;
+}
+
+void NativeWidgetHeadless::CenterWindow(const gfx::Size& size) {
+  SetSize(size);
+}
+
+void NativeWidgetHeadless::GetWindowPlacement(
+    gfx::Rect* bounds,
+    ui::WindowShowState* show_state) const {
+  *bounds = window_state_ == ui::SHOW_STATE_MAXIMIZED ?
+      restored_bounds_ : bounds_;
+  *show_state = window_state_;
+}
+
+void NativeWidgetHeadless::SetWindowTitle(const string16& title) {
+}
+
+void NativeWidgetHeadless::SetWindowIcons(const SkBitmap& window_icon,
+                                          const SkBitmap& app_icon) {
+}
+
+void NativeWidgetHeadless::SetAccessibleName(const std::wstring& name) {
+}
+
+void NativeWidgetHeadless::SetAccessibleRole(
+    ui::AccessibilityTypes::Role role) {
+}
+
+void NativeWidgetHeadless::SetAccessibleState(
+    ui::AccessibilityTypes::State state) {
+}
+
+void NativeWidgetHeadless::BecomeModal() {
+}
+
+gfx::Rect NativeWidgetHeadless::GetWindowScreenBounds() const {
+  return bounds_;
+}
+
+gfx::Rect NativeWidgetHeadless::GetClientAreaScreenBounds() const {
+  return bounds_;
+}
+
+gfx::Rect NativeWidgetHeadless::GetRestoredBounds() const {
+  return window_state_ == ui::SHOW_STATE_MAXIMIZED ?
+      restored_bounds_ : bounds_;
+}
+
+void NativeWidgetHeadless::SetBounds(const gfx::Rect& bounds) {
+  gfx::Size old_size = bounds_.size();
+  bounds_ = bounds;
+  if (bounds_.size() == old_size)
+    return;
+
+  ResizeCanvas();
+  delegate_->OnNativeWidgetSizeChanged(bounds_.size());
+}
+
+void NativeWidgetHeadless::SetSize(const gfx::Size& size) {
+  SetBounds(gfx::Rect(bounds_.origin(), size));
+}
+
+void NativeWidgetHeadless::SetBoundsConstrained(const gfx::Rect& bounds,
+                                                Widget* other_widget) {
+  SetBounds(bounds);
+}
+
+void NativeWidgetHeadless::MoveAbove(gfx::NativeView native_view) {
+}
+
+void NativeWidgetHeadless::MoveToTop() {
+}
+
+void NativeWidgetHeadless::SetShape(gfx::NativeRegion region) {
+}
+
+void NativeWidgetHeadless::Close() {
+  Hide();
+  if (close_widget_factory_.empty()) {
+    MessageLoop::current()->PostTask(FROM_HERE,
+        close_widget_factory_.NewRunnableMethod(
+            &NativeWidgetHeadless::CloseNow));
+  }
+}
+
+void NativeWidgetHeadless::CloseNow() {
+  if (destroyed_)
+    return;
+
+  if (ownership_ == Widget::InitParams::NATIVE_WIDGET_OWNS_WIDGET) {
+    delete this;
+    return;
+  }
+  // The Widget owns us and deletes us later; just tell it we are gone.
+  destroyed_ = true;
+  delegate_->OnNativeWidgetDestroying();
+  delegate_->OnNativeWidgetDestroyed();
+}
+
+void NativeWidgetHeadless::EnableClose(bool enable) {
+}
+
+void NativeWidgetHeadless::Show() {
+  if (visible_)
+    return;
+
+  visible_ = true;
+  delegate_->OnNativeWidgetVisibilityChanged(true);
+  GetWidget()->SetInitialFocus();
+  SchedulePaintInRect(gfx::Rect(bounds_.size()));
+}
+
+void NativeWidgetHeadless::Hide() {
+  if (!visible_)
+    return;
+
+  visible_ = false;
+  if (HasMouseCapture())
+    ReleaseMouseCapture();
+  delegate_->OnNativeWidgetVisibilityChanged(false);
+}
+
+void NativeWidgetHeadless::ShowWithWindowState(
+    ui::WindowShowState show_state) {
+  Show();
+}
+
+void NativeWidgetHeadless::ShowMaximizedWithBounds(
+    const gfx::Rect& restored_bounds) {
+  Show();
+}
+
+bool NativeWidgetHeadless::IsVisible() const {
+  return visible_;
+}
+
+void NativeWidgetHeadless::Activate() {
+  OnActivate(true);
+}
+
+void NativeWidgetHeadless::Deactivate() {
+  OnActivate(false);
+}
+
+bool NativeWidgetHeadless::IsActive() const {
+  return active_;
+}
+
+void NativeWidgetHeadless::SetAlwaysOnTop(bool on_top) {
+}
+
+void NativeWidgetHeadless::Maximize() {
+  if (window_state_ == ui::SHOW_STATE_MAXIMIZED)
+    return;
+
+  if (window_state_ != ui::SHOW_STATE_MINIMIZED)
+    restored_bounds_ = bounds_;
+  window_state_ = ui::SHOW_STATE_MAXIMIZED;
+  SetBounds(GetWorkAreaBoundsInScreen());
+}
+
+void NativeWidgetHeadless::Minimize() {
+  if (window_state_ != ui::SHOW_STATE_MAXIMIZED)
+    restored_bounds_ = bounds_;
+  window_state_ = ui::SHOW_STATE_MINIMIZED;
+}
+
+bool NativeWidgetHeadless::IsMaximized() const {
+  return window_state_ == ui::SHOW_STATE_MAXIMIZED;
+}
+
+bool NativeWidgetHeadless::IsMinimized() const {
+  return window_state_ == ui::SHOW_STATE_MINIMIZED;
+}
+
+void NativeWidgetHeadless::Restore() {
+  if (window_state_ == ui::SHOW_STATE_MAXIMIZED ||
+      window_state_ == ui::SHOW_STATE_MINIMIZED) {
+    SetBounds(restored_bounds_);
+  }
+  window_state_ = ui::SHOW_STATE_NORMAL;
+}
+
+void NativeWidgetHeadless::SetFullscreen(bool fullscreen) {
+  NOTIMPLEMENTED();
+}
+
+bool NativeWidgetHeadless::IsFullscreen() const {
+  return false;
+}
+
+void NativeWidgetHeadless::SetOpacity(unsigned char opacity) {
+}
+
+void NativeWidgetHeadless::SetUseDragFrame(bool use_drag_frame) {
+}
+
+bool NativeWidgetHeadless::IsAccessibleWidget() const {
+  return false;
+}
+
+void NativeWidgetHeadless::RunShellDrag(View* view,
+                                        const ui::OSExchangeData& data,
+                                        int operation) {
+  NOTIMPLEMENTED();
+}
+
+void NativeWidgetHeadless::SchedulePaintInRect(const gfx::Rect& rect) {
+  invalid_rect_ = invalid_rect_.Union(
+      rect.Intersect(gfx::Rect(bounds_.size())));
+}
+
+void NativeWidgetHeadless::SetCursor(gfx::NativeCursor cursor) {
+}
+
+void NativeWidgetHeadless::ClearNativeFocus() {
+}
+
+void NativeWidgetHeadless::FocusNativeView(gfx::NativeView native_view) {
+}
+
+bool NativeWidgetHeadless::ConvertPointFromAncestor(
+    const Widget* ancestor, gfx::Point* point) const {
+  // Headless widgets are always top level.
+  return ancestor == GetWidget();
+}
+
+gfx::Rect NativeWidgetHeadless::GetWorkAreaBoundsInScreen() const {
+  // There is no screen; maximizing keeps the current bounds.
+  return bounds_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NativeWidgetHeadless, InputMethodDelegate implementation:
+
+void NativeWidgetHeadless::DispatchKeyEventPostIME(const KeyEvent& key) {
+  delegate_->OnKeyEvent(key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NativeWidgetHeadless, private:
+
+void NativeWidgetHeadless::OnActivate(bool active) {
+  if (active_ == active)
+    return;
+  active_ = active;
+  delegate_->OnNativeWidgetActivationChanged(active);
+
+  Widget* widget = GetWidget();
+  InputMethod* input_method = widget->GetInputMethod();
+  FocusManager* focus_manager = widget->GetFocusManager();
+  if (active) {
+    if (input_method)
+      input_method->OnFocus();
+    if (focus_manager)
+      focus_manager->RestoreFocusedView();
+  } else {
+    if (input_method)
+      input_method->OnBlur();
+    if (focus_manager)
+      focus_manager->StoreFocusedView();
+  }
+  SchedulePaintInRect(gfx::Rect(bounds_.size()));
+}
+
+void NativeWidgetHeadless::ResizeCanvas() {
+  invalid_rect_ = gfx::Rect(bounds_.size());
+  if (bounds_.IsEmpty()) {
+    canvas_.reset();
+    return;
+  }
+  canvas_.reset(new gfx::CanvasSkia(bounds_.width(), bounds_.height(), true));
+}
+
+}  // namespace views
@@ -0,0 +1,196 @@
+// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef VIEWS_WIDGET_NATIVE_WIDGET_HEADLESS_H_
+#define VIEWS_WIDGET_NATIVE_WIDGET_HEADLESS_H_
+#pragma once
+
+#include <map>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "ui/gfx/rect.h"
+#include "views/widget/native_widget_private.h"
+#include "views/widget/widget.h"
+
+class SkBitmap;
+
+namespace gfx {
+class CanvasSkia;
+}
+
+namespace views {
+
+////////////////////////////////////////////////////////////////////////////////
+// NativeWidgetHeadless
+//
+//  A NativeWidget implementation that has no native window. The Widget is
+//  painted into an offscreen gfx::CanvasSkia the size of the widget, and
+//  events are delivered by calling the Dispatch methods. This lets the views
+//  hierarchy, layout and painting be driven from tests and benchmarks on
+//  machines without a display.
+//
+//  Like NativeWidgetViews, paints requested through SchedulePaintInRect() are
+//  accumulated; nothing is painted until Paint() is called.
+//
+class VIEWS_EXPORT NativeWidgetHeadless : public internal::NativeWidgetPrivate {
+ public:
+  explicit NativeWidgetHeadless(internal::NativeWidgetDelegate* delegate);
+  virtual ~NativeWidgetHeadless();
+
+  // Paints the invalid region into the offscreen canvas. Returns false if
+  // there was nothing to paint.
+  bool Paint();
+
+  // Invalidates the whole widget and paints it.
+  void PaintAll();
+
+  // Returns the area scheduled to be painted by the next Paint().
+  const gfx::Rect& invalid_rect() const { return invalid_rect_; }
+
+  // Returns the offscreen canvas, or NULL if the widget is empty.
+  gfx::CanvasSkia* canvas() const { return canvas_.get(); }
+
+  // Returns a copy of the painted contents.
+  SkBitmap GetBitmap() const;
+
+  // Deliver events to the Widget as the native window would. Locations are
+  // in the coordinates of the widget.
+  bool DispatchMouseEvent(const MouseEvent& event);
+  bool DispatchKeyEvent(const KeyEvent& event);
+
+  internal::NativeWidgetDelegate* delegate() const { return delegate_; }
+
+ protected:
+  // Overridden from internal::NativeWidgetPrivate:
+  virtual void InitNativeWidget(const Widget::InitParams& params) OVERRIDE;
+  virtual NonClientFrameView* CreateNonClientFrameView() OVERRIDE;
+  virtual void UpdateFrameAfterFrameChange() OVERRIDE;
+  virtual bool ShouldUseNativeFrame() const OVERRIDE;
+  virtual void FrameTypeChanged() OVERRIDE;
+  virtual Widget* GetWidget() OVERRIDE;
+  virtual const Widget* GetWidget() const OVERRIDE;
+  virtual gfx::NativeView GetNativeView() const OVERRIDE;
+  virtual gfx::NativeWindow GetNativeWindow() const OVERRIDE;
+  virtual Widget* GetTopLevelWidget() OVERRIDE;
+  virtual const ui::Compositor* GetCompositor() const OVERRIDE;
+  virtual ui::Compositor* GetCompositor() OVERRIDE;
+  virtual void CalculateOffsetToAncestorWithLayer(
+      gfx::Point* offset,
+      ui::Layer** layer_parent) OVERRIDE;
+  virtual void ViewRemoved(View* view) OVERRIDE;
+  virtual void SetNativeWindowProperty(const char* name, void* value) OVERRIDE;
+  virtual void* GetNativeWindowProperty(const char* name) const OVERRIDE;
+  virtual TooltipManager* GetTooltipManager() const OVERRIDE;
+  virtual bool IsScreenReaderActive() const OVERRIDE;
+  virtual void SendNativeAccessibilityEvent(
+      View* view,
+      ui::AccessibilityTypes::Event event_type) OVERRIDE;
+  virtual void SetMouseCapture() OVERRIDE;
+  virtual void ReleaseMouseCapture() OVERRIDE;
+  virtual bool HasMouseCapture() const OVERRIDE;
+  virtual InputMethod* CreateInputMethod() OVERRIDE;
+  virtual void CenterWindow(const gfx::Size& size) OVERRIDE;
+  virtual void GetWindowPlacement(
+      gfx::Rect* bounds,
+      ui::WindowShowState* show_state) const OVERRIDE;
+  virtual void SetWindowTitle(const string16& title) OVERRIDE;
+  virtual void SetWindowIcons(const SkBitmap& window_icon,
+                              const SkBitmap& app_icon) OVERRIDE;
+  virtual void SetAccessibleName(const std::wstring& name) OVERRIDE;
+  virtual void SetAccessibleRole(ui::AccessibilityTypes::Role role) OVERRIDE;
+  virtual void SetAccessibleState(ui::AccessibilityTypes::State state) OVERRIDE;
+  virtual void BecomeModal() OVERRIDE;
+  virtual gfx::Rect GetWindowScreenBounds() const OVERRIDE;
+  virtual gfx::Rect GetClientAreaScreenBounds() const OVERRIDE;
+  virtual gfx::Rect GetRestoredBounds() const OVERRIDE;
+  virtual void SetBounds(const gfx::Rect& bounds) OVERRIDE;
+  virtual void SetSize(const gfx::Size& size) OVERRIDE;
+  virtual void SetBoundsConstrained(const gfx::Rect& bounds,
+                                    Widget* other_widget) OVERRIDE;
+  virtual void MoveAbove(gfx::NativeView native_view) OVERRIDE;
+  virtual void MoveToTop() OVERRIDE;
+  virtual void SetShape(gfx::NativeRegion shape) OVERRIDE;
+  virtual void Close() OVERRIDE;
+  virtual void CloseNow() OVERRIDE;
+  virtual void EnableClose(bool enable) OVERRIDE;
+  virtual void Show() OVERRIDE;
+  virtual void Hide() OVERRIDE;
+  virtual void ShowMaximizedWithBounds(
+      const gfx::Rect& restored_bounds) OVERRIDE;
+  virtual void ShowWithWindowState(ui::WindowShowState window_state) OVERRIDE;
+  virtual bool IsVisible() const OVERRIDE;
+  virtual void Activate() OVERRIDE;
+  virtual void Deactivate() OVERRIDE;
+  virtual bool IsActive() const OVERRIDE;
+  virtual void SetAlwaysOnTop(bool always_on_top) OVERRIDE;
+  virtual void Maximize() OVERRIDE;
+  virtual void Minimize() OVERRIDE;
+  virtual bool IsMaximized() const OVERRIDE;
+  virtual bool IsMinimized() const OVERRIDE;
+  virtual void Restore() OVERRIDE;
+  virtual void SetFullscreen(bool fullscreen) OVERRIDE;
+  virtual bool IsFullscreen() const OVERRIDE;
+  virtual void SetOpacity(unsigned char opacity) OVERRIDE;
+  virtual void SetUseDragFrame(bool use_drag_frame) OVERRIDE;
+  virtual bool IsAccessibleWidget() const OVERRIDE;
+  virtual void RunShellDrag(View* view,
+                            const ui::OSExchangeData& data,
+                            int operation) OVERRIDE;
+  virtual void SchedulePaintInRect(const gfx::Rect& rect) OVERRIDE;
+  virtual void SetCursor(gfx::NativeCursor cursor) OVERRIDE;
+  virtual void ClearNativeFocus() OVERRIDE;
+  virtual void FocusNativeView(gfx::NativeView native_view) OVERRIDE;
+  virtual bool ConvertPointFromAncestor(
+      const Widget* ancestor, gfx::Point* point) const OVERRIDE;
+  virtual gfx::Rect GetWorkAreaBoundsInScreen() const OVERRIDE;
+
+  // Overridden from internal::InputMethodDelegate
+  virtual void DispatchKeyEventPostIME(const KeyEvent& key) OVERRIDE;
+
+ private:
+  // Notifies the delegate of activation changes, moving focus like
+  // NativeWidgetViews::OnActivate().
+  void OnActivate(bool active);
+
+  // Recreates |canvas_| for the current size, invalidating everything.
+  void ResizeCanvas();
+
+  internal::NativeWidgetDelegate* delegate_;
+
+  // Bounds of the widget. The origin is only remembered; the widget paints
+  // at (0, 0) of |canvas_|.
+  gfx::Rect bounds_;
+  gfx::Rect restored_bounds_;
+
+  scoped_ptr<gfx::CanvasSkia> canvas_;
+
+  // Area to paint on the next Paint(), in widget coordinates.
+  gfx::Rect invalid_rect_;
+
+  bool visible_;
+  bool active_;
+  bool has_mouse_capture_;
+
+  ui::WindowShowState window_state_;
+
+  // Set once the delegate has been told the native widget is gone, so the
+  // destructor does not tell it again.
+  bool destroyed_;
+
+  // The following factory is used for calls to close the NativeWidgetHeadless
+  // instance.
+  ScopedRunnableMethodFactory<NativeWidgetHeadless> close_widget_factory_;
+
+  // See class documentation for Widget in widget.h for a note about ownership.
+  Widget::InitParams::Ownership ownership_;
+
+  std::map<const char*, void*> window_properties_;
+
+  DISALLOW_COPY_AND_ASSIGN(NativeWidgetHeadless);
+};
+
+}  // namespace views
+
+#endif  // VIEWS_WIDGET_NATIVE_WIDGET_HEADLESS_H_
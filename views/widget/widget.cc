@@ -165,7 +165,10 @@ Widget::Widget()
       is_top_level_(false),
       native_widget_initialized_(false),
       is_mouse_button_pressed_(false),
-      last_mouse_event_was_move_(false) {
+      last_mouse_event_was_move_(false),
+      layout_scheduled_(false),
+      layout_pass_count_(0),
+      ALLOW_THIS_IN_INITIALIZER_LIST(layout_factory_(this)) {
 }
 
 Widget::~Widget() {
@@ -650,6 +653,27 @@ void Widget::SchedulePaintInRect(const gfx::Rect& rect) {
   native_widget_->SchedulePaintInRect(rect);
 }
 
+void Widget::ScheduleLayout() {
+  if (layout_scheduled_)
+    return;
+
+  layout_scheduled_ = true;
+  MessageLoop::current()->PostTask(FROM_HERE,
+      layout_factory_.NewRunnableMethod(&Widget::LayoutIfNeeded));
+}
+
+void Widget::LayoutIfNeeded() {
+  if (!layout_scheduled_)
+    return;
+
+  layout_scheduled_ = false;
+  layout_factory_.RevokeAll();
+  if (root_view_.get() && root_view_->needs_layout_) {
+    ++layout_pass_count_;
+    root_view_->Layout();
+  }
+}
+
 void Widget::SetCursor(gfx::NativeCursor cursor) {
   native_widget_->SetCursor(cursor);
 }
@@ -929,6 +953,8 @@ bool Widget::OnNativeWidgetPaintAccelerated(const gfx::Rect& dirty_region) {
   if (!compositor)
     return false;
 
+  LayoutIfNeeded();
+
   // If the root view is animating, it is likely that it does not cover the same
   // set of pixels it did at the last frame, so we must clear when compositing
   // to avoid leaving ghosts.
@@ -960,6 +986,7 @@ bool Widget::OnNativeWidgetPaintAccelerated(const gfx::Rect& dirty_region) {
 }
 
 void Widget::OnNativeWidgetPaint(gfx::Canvas* canvas) {
+  LayoutIfNeeded();
   GetRootView()->Paint(canvas);
 }
 
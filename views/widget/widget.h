@@ -11,6 +11,7 @@
 #include "base/gtest_prod_util.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/observer_list.h"
+#include "base/task.h"
 #include "ui/base/accessibility/accessibility_types.h"
 #include "ui/base/ui_base_types.h"
 #include "ui/gfx/native_widget_types.h"
@@ -417,6 +418,17 @@ class VIEWS_EXPORT Widget : public internal::NativeWidgetDelegate,
   // redrawn.
   void SchedulePaintInRect(const gfx::Rect& rect);
 
+  // Schedules a single top-down layout pass over the Views whose layout was
+  // invalidated. The pass runs before the next paint, or from a posted task if
+  // no paint happens first. Multiple calls before the pass runs are coalesced.
+  void ScheduleLayout();
+
+  // Runs the scheduled layout pass now, if there is one.
+  void LayoutIfNeeded();
+
+  // Returns the number of scheduled layout passes that have run.
+  int layout_pass_count() const { return layout_pass_count_; }
+
   // Sets the currently visible cursor. If |cursor| is NULL, the cursor used
   // before the current is restored.
   void SetCursor(gfx::NativeCursor cursor);
@@ -738,6 +750,15 @@ class VIEWS_EXPORT Widget : public internal::NativeWidgetDelegate,
   bool last_mouse_event_was_move_;
   gfx::Point last_mouse_event_position_;
 
+  // True if ScheduleLayout() was invoked and the layout pass has not run yet.
+  bool layout_scheduled_;
+
+  // See |layout_pass_count()| accessor.
+  int layout_pass_count_;
+
+  // Used to post the scheduled layout pass.
+  ScopedRunnableMethodFactory<Widget> layout_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(Widget);
 };
 